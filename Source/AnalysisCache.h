@@ -0,0 +1,29 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import <Foundation/Foundation.h>
+
+// Caches/<bundle identifier> of the app, from either the app or the worker
+extern NSURL *GetSharedCachesDirectoryURL(void);
+
+
+// Persistent cache of loudness analysis results, shared by the app and the
+// worker. Entries are keyed by file identity (size, modification date, and
+// a hash of sampled content) rather than by Track UUID, so re-adding or
+// duplicating a file reuses its analysis.
+//
+// Entries are stored per analysis version and evicted in least recently
+// used order once the cache exceeds its size limit.
+//
+@interface AnalysisCache : NSObject
+
++ (instancetype) sharedInstance;
+
+// Returns nil if the file can't be read
+- (NSString *) keyForFileURL:(NSURL *)fileURL;
+
+// Returns a dictionary of TrackKeys, or nil on a cache miss
+- (NSDictionary *) resultsForKey:(NSString *)key;
+- (void) storeResults:(NSDictionary *)results forKey:(NSString *)key;
+
+@end
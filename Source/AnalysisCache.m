@@ -0,0 +1,229 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import "AnalysisCache.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+// Increment when LoudnessMeasurer output changes, old entries are then discarded
+static NSInteger const sAnalysisVersion = 4;
+
+static unsigned long long const sSizeLimit    = 256 * 1024 * 1024;
+static NSUInteger         const sSampleLength = 64 * 1024;
+
+
+@implementation AnalysisCache {
+    NSURL *_directoryURL;
+    dispatch_queue_t _queue;
+}
+
+
++ (instancetype) sharedInstance
+{
+    static AnalysisCache *sSharedInstance = nil;
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+        sSharedInstance = [[AnalysisCache alloc] init];
+    });
+
+    return sSharedInstance;
+}
+
+
+// The worker runs from Embrace.app/Contents/XPCServices/EmbraceWorker.xpc,
+// both processes need to agree on the cache directory.
+//
+static NSBundle *sGetHostBundle()
+{
+    NSURL *bundleURL = [[NSBundle mainBundle] bundleURL];
+
+    if ([[bundleURL pathExtension] isEqualToString:@"xpc"]) {
+        NSURL *hostURL = [[[bundleURL URLByDeletingLastPathComponent] URLByDeletingLastPathComponent] URLByDeletingLastPathComponent];
+        NSBundle *hostBundle = [NSBundle bundleWithURL:hostURL];
+        if (hostBundle) return hostBundle;
+    }
+
+    return [NSBundle mainBundle];
+}
+
+
+NSURL *GetSharedCachesDirectoryURL(void)
+{
+    NSURL *cachesURL = [[[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+    return [cachesURL URLByAppendingPathComponent:[sGetHostBundle() bundleIdentifier]];
+}
+
+
+- (instancetype) init
+{
+    if ((self = [super init])) {
+        NSFileManager *manager = [NSFileManager defaultManager];
+
+        NSURL *analysisURL = [GetSharedCachesDirectoryURL() URLByAppendingPathComponent:@"Analysis"];
+        NSString *versionString = [NSString stringWithFormat:@"%ld", (long)sAnalysisVersion];
+
+        _directoryURL = [analysisURL URLByAppendingPathComponent:versionString];
+        _queue = dispatch_queue_create("AnalysisCache", DISPATCH_QUEUE_SERIAL);
+
+        NSError *error = nil;
+        [manager createDirectoryAtURL:_directoryURL withIntermediateDirectories:YES attributes:nil error:&error];
+
+        // Remove entries from other analysis versions
+        for (NSURL *url in [manager contentsOfDirectoryAtURL:analysisURL includingPropertiesForKeys:nil options:0 error:&error]) {
+            if (![[url lastPathComponent] isEqualToString:versionString]) {
+                [manager removeItemAtURL:url error:&error];
+            }
+        }
+    }
+
+    return self;
+}
+
+
+#pragma mark - Private Methods
+
+- (NSURL *) _URLForKey:(NSString *)key
+{
+    return [[_directoryURL URLByAppendingPathComponent:key] URLByAppendingPathExtension:@"plist"];
+}
+
+
+- (void) _trimToSizeLimit
+{
+    NSArray *keys = @[ NSURLTotalFileAllocatedSizeKey, NSURLContentModificationDateKey ];
+
+    NSError *error = nil;
+    NSArray *urls = [[NSFileManager defaultManager] contentsOfDirectoryAtURL:_directoryURL includingPropertiesForKeys:keys options:NSDirectoryEnumerationSkipsHiddenFiles error:&error];
+
+    unsigned long long totalSize = 0;
+
+    for (NSURL *url in urls) {
+        NSNumber *size = nil;
+        [url getResourceValue:&size forKey:NSURLTotalFileAllocatedSizeKey error:NULL];
+        totalSize += [size unsignedLongLongValue];
+    }
+
+    if (totalSize <= sSizeLimit) return;
+
+    // The modification date is touched on each hit, oldest is least recently used
+    NSArray *sortedURLs = [urls sortedArrayUsingComparator:^(NSURL *a, NSURL *b) {
+        NSDate *dateA = nil, *dateB = nil;
+        [a getResourceValue:&dateA forKey:NSURLContentModificationDateKey error:NULL];
+        [b getResourceValue:&dateB forKey:NSURLContentModificationDateKey error:NULL];
+        return [dateA compare:dateB];
+    }];
+
+    // Trim to 90% so that every store doesn't evict
+    unsigned long long targetSize = (sSizeLimit / 10) * 9;
+
+    for (NSURL *url in sortedURLs) {
+        if (totalSize <= targetSize) break;
+
+        NSNumber *size = nil;
+        [url getResourceValue:&size forKey:NSURLTotalFileAllocatedSizeKey error:NULL];
+
+        if ([[NSFileManager defaultManager] removeItemAtURL:url error:&error]) {
+            totalSize -= MIN(totalSize, [size unsignedLongLongValue]);
+        }
+    }
+}
+
+
+#pragma mark - Public Methods
+
+- (NSString *) keyForFileURL:(NSURL *)fileURL
+{
+    if (!fileURL) return nil;
+
+    NSError *error = nil;
+    NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[fileURL path] error:&error];
+    if (!attributes) return nil;
+
+    unsigned long long fileSize = [attributes fileSize];
+    NSTimeInterval modificationTime = [[attributes fileModificationDate] timeIntervalSinceReferenceDate];
+
+    NSFileHandle *handle = [NSFileHandle fileHandleForReadingFromURL:fileURL error:&error];
+    if (!handle) return nil;
+
+    CC_SHA256_CTX context;
+    CC_SHA256_Init(&context);
+
+    CC_SHA256_Update(&context, &fileSize, sizeof(fileSize));
+    CC_SHA256_Update(&context, &modificationTime, sizeof(modificationTime));
+
+    // Sample the start, middle, and end of the file
+    unsigned long long middle = fileSize > sSampleLength ? (fileSize - sSampleLength) / 2 : 0;
+    unsigned long long end    = fileSize > sSampleLength ? (fileSize - sSampleLength)     : 0;
+
+    for (NSNumber *offset in @[ @0, @(middle), @(end) ]) {
+        NSData *data = nil;
+
+        if ([handle seekToOffset:[offset unsignedLongLongValue] error:&error]) {
+            data = [handle readDataUpToLength:sSampleLength error:&error];
+        }
+
+        if (!data) {
+            [handle closeAndReturnError:NULL];
+            return nil;
+        }
+
+        CC_SHA256_Update(&context, [data bytes], (CC_LONG)[data length]);
+    }
+
+    [handle closeAndReturnError:NULL];
+
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256_Final(digest, &context);
+
+    NSMutableString *result = [NSMutableString stringWithCapacity:(CC_SHA256_DIGEST_LENGTH * 2)];
+
+    for (NSInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [result appendFormat:@"%02x", digest[i]];
+    }
+
+    return result;
+}
+
+
+- (NSDictionary *) resultsForKey:(NSString *)key
+{
+    if (!key) return nil;
+
+    NSURL *url = [self _URLForKey:key];
+
+    NSError *error = nil;
+    NSData *data = [NSData dataWithContentsOfURL:url options:0 error:&error];
+    if (!data) return nil;
+
+    NSDictionary *results = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:&error];
+    if (![results isKindOfClass:[NSDictionary class]]) return nil;
+
+    dispatch_async(_queue, ^{
+        NSError *touchError = nil;
+        [url setResourceValue:[NSDate date] forKey:NSURLContentModificationDateKey error:&touchError];
+    });
+
+    return results;
+}
+
+
+- (void) storeResults:(NSDictionary *)results forKey:(NSString *)key
+{
+    if (!key || !results) return;
+
+    dispatch_async(_queue, ^{
+        NSError *error = nil;
+        NSData *data = [NSPropertyListSerialization dataWithPropertyList:results format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+
+        if (![data writeToURL:[self _URLForKey:key] options:NSDataWritingAtomic error:&error]) {
+            NSLog(@"AnalysisCache failed to write %@: %@", key, error);
+            return;
+        }
+
+        [self _trimToSizeLimit];
+    });
+}
+
+
+@end
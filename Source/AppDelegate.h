@@ -12,6 +12,13 @@
 
 - (id<WorkerProtocol>) workerProxyWithErrorHandler:(void (^)(NSError *error))handler;
 
+// Called on the main thread as the worker analyzes the track with UUID
+- (void) setWorkerProgressHandler:(void (^)(double progress))handler forUUID:(NSUUID *)UUID;
+- (void) removeWorkerProgressHandlerForUUID:(NSUUID *)UUID;
+
+// Sets -[DecodedAudioCache sampleRate] in both the app and the worker
+- (void) setDecodedAudioSampleRate:(double)sampleRate;
+
 - (void) performPreferredPlaybackAction;
 
 - (void) displayErrorForTrack:(Track *)track;
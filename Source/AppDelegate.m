@@ -24,6 +24,7 @@
 #import "HugAudioDevice.h"
 
 #import "WorkerService.h"
+#import "DecodedAudioCache.h"
 
 #import "HugCrashPad.h"
 #import "CrashReportSender.h"
@@ -38,7 +39,7 @@
 #include "../Private/EmbracePrivate.m"
 #endif
 
-@interface AppDelegate () <NSMenuItemValidation>
+@interface AppDelegate () <NSMenuItemValidation, WorkerClientProtocol>
 
 - (IBAction) openFile:(id)sender;
 
@@ -101,6 +102,7 @@
     NSMutableArray    *_editEffectControllers;
     
     NSXPCConnection   *_connectionToWorker;
+    NSMutableDictionary<NSUUID *, void (^)(double)> *_workerProgressHandlers;
 }
 
 
@@ -381,18 +383,62 @@
         NSXPCConnection *connection = [[NSXPCConnection alloc] initWithServiceName:serviceName];
         [connection setRemoteObjectInterface:interface];
 
+        [connection setExportedInterface:[NSXPCInterface interfaceWithProtocol:@protocol(WorkerClientProtocol)]];
+        [connection setExportedObject:self];
+
         [connection setInvalidationHandler:^{
             [weakSelf _clearConnectionToWorker];
         }];
             
         _connectionToWorker = connection;
         [_connectionToWorker resume];
+
+        // Messages are delivered in order, this arrives before any track command
+        double sampleRate = [[DecodedAudioCache sharedInstance] sampleRate];
+        [[_connectionToWorker remoteObjectProxy] setDecodedAudioSampleRate:sampleRate];
     }
     
     return [_connectionToWorker remoteObjectProxyWithErrorHandler:handler];
 }
 
 
+- (void) setWorkerProgressHandler:(void (^)(double progress))handler forUUID:(NSUUID *)UUID
+{
+    if (!_workerProgressHandlers) {
+        _workerProgressHandlers = [NSMutableDictionary dictionary];
+    }
+
+    [_workerProgressHandlers setObject:[handler copy] forKey:UUID];
+}
+
+
+- (void) removeWorkerProgressHandlerForUUID:(NSUUID *)UUID
+{
+    [_workerProgressHandlers removeObjectForKey:UUID];
+}
+
+
+- (void) setDecodedAudioSampleRate:(double)sampleRate
+{
+    [[DecodedAudioCache sharedInstance] setSampleRate:sampleRate];
+
+    id<WorkerProtocol> worker = [self workerProxyWithErrorHandler:^(NSError *error) {
+        EmbraceLog(@"AppDelegate", @"Received error for setDecodedAudioSampleRate: %@", error);
+    }];
+
+    [worker setDecodedAudioSampleRate:sampleRate];
+}
+
+
+- (void) reportAnalysisProgress:(double)progress forUUID:(NSUUID *)UUID
+{
+    dispatch_async(dispatch_get_main_queue(), ^{
+        void (^handler)(double) = [_workerProgressHandlers objectForKey:UUID];
+        if (handler) handler(progress);
+    });
+}
+
+
 - (void) performPreferredPlaybackAction
 {
     [self performPreferredPlaybackAction:self];
@@ -14,6 +14,11 @@
 
 - (IBAction) explode:(id)sender;
 
+- (IBAction) resetRenderProfile:(id)sender;
+- (IBAction) benchmarkRingBuffer:(id)sender;
+- (IBAction) runRenderBenchmark:(id)sender;
+
+@property (nonatomic, weak) IBOutlet NSTextField *renderProfileField;
 
 @end
 
@@ -8,6 +8,9 @@
 #import "SetlistController.h"
 #import "AppDelegate.h"
 #import "Track.h"
+#import "HugAudioEngine.h"
+#import "HugRingBuffer.h"
+#import "HugRenderBenchmark.h"
 #import "WrappedUtils.h"
 
 @interface DebugController ()
@@ -15,7 +18,9 @@
 @end
 
 
-@implementation DebugController
+@implementation DebugController {
+    NSTimer *_renderProfileTimer;
+}
 
 - (NSString *) windowNibName
 {
@@ -23,12 +28,60 @@
 }
 
 
+- (void) windowDidLoad
+{
+    [super windowDidLoad];
+
+    _renderProfileTimer = [NSTimer scheduledTimerWithTimeInterval:0.5 target:self selector:@selector(_updateRenderProfile:) userInfo:nil repeats:YES];
+    [self _updateRenderProfile:nil];
+}
+
+
 - (SetlistController *) _setlistController
 {
     return [GetAppDelegate() valueForKey:@"setlistController"];
 }
 
 
+- (HugAudioEngine *) _engine
+{
+    return [[Player sharedInstance] valueForKey:@"engine"];
+}
+
+
+- (void) _updateRenderProfile:(NSTimer *)timer
+{
+    if (![[self window] isVisible]) return;
+
+    HugAudioEngine *engine = [self _engine];
+    NSArray *names = [engine renderNodeNames];
+
+    if (![names count]) {
+        [[self renderProfileField] setStringValue:@"No render profile"];
+        return;
+    }
+
+    // Percent of the render deadline
+    NSMutableString *string = [NSMutableString stringWithFormat:@"%-20s %8s %6s %6s %6s\n", "Node", "Count", "p50", "p99", "Max"];
+
+    [names enumerateObjectsUsingBlock:^(NSString *name, NSUInteger i, BOOL *stop) {
+        HugRenderProfileStatistics statistics = [engine renderStatisticsForNodeAtIndex:i];
+
+        NSString *truncatedName = [name length] > 20 ? [name substringToIndex:20] : name;
+
+        [string appendFormat:@"%-20s %8lu %5.1f%% %5.1f%% %5.1f%%\n",
+            [truncatedName UTF8String],
+            (unsigned long)statistics.count,
+            statistics.median  * 100.0,
+            statistics.p99     * 100.0,
+            statistics.maximum * 100.0
+        ];
+    }];
+
+    [[self renderProfileField] setStringValue:string];
+}
+
+
 - (IBAction) populatePlaylist:(id)sender
 {
     NSInteger tag = [sender selectedTag];
@@ -131,6 +184,82 @@
 }
 
 
+- (IBAction) resetRenderProfile:(id)sender
+{
+    [[self _engine] resetRenderStatistics];
+    [self _updateRenderProfile:nil];
+}
+
+
+- (IBAction) benchmarkRingBuffer:(id)sender
+{
+    [sender setEnabled:NO];
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        // Packet sizes of the status and error channels, up to a small render quantum
+        size_t packetSizes[] = { 8, 16, 32, 64, 256, 1024 };
+
+        for (size_t i = 0; i < sizeof(packetSizes) / sizeof(packetSizes[0]); i++) {
+            HugRingBufferBenchmarkResult result;
+
+            if (!HugRingBufferRunBenchmark(65536, packetSizes[i], 1000000, &result)) {
+                EmbraceLog(@"DebugController", @"HugRingBufferRunBenchmark() failed for %lu byte packets", (unsigned long)packetSizes[i]);
+                continue;
+            }
+
+            EmbraceLog(@"DebugController", @"HugRingBuffer %4lu bytes: %8.1f MB/s, %6.2f M packets/s, latency p50 %.0f ns, p99 %.0f ns, max %.0f ns",
+                (unsigned long)result.packetSize,
+                result.bytesPerSecond   / 1e6,
+                result.packetsPerSecond / 1e6,
+                result.medianLatency  * 1e9,
+                result.p99Latency     * 1e9,
+                result.maximumLatency * 1e9
+            );
+        }
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [sender setEnabled:YES];
+        });
+    });
+}
+
+
+static void sLogRenderBenchmarkResult(void *context, const HugRenderBenchmarkResult *result)
+{
+    EmbraceLog(@"DebugController", @"%-14s %-17s %4lu frames: %7.2f ns/frame, worst buffer %8.0f ns, %s",
+        HugRenderBenchmarkGetStageName(result->stage),
+        HugRenderBenchmarkGetSignalName(result->signal),
+        (unsigned long)result->frameSize,
+        result->nanosecondsPerFrame,
+        result->worstBufferNanoseconds,
+        result->passed ? "ok" : (result->hasGolden ? "FAILED" : "no golden")
+    );
+}
+
+
+- (IBAction) runRenderBenchmark:(id)sender
+{
+    // HugRenderBenchmarkRun() resets the kernel table, which the render thread reads
+    if ([[Player sharedInstance] isPlaying]) {
+        EmbraceLog(@"DebugController", @"Stop playback before running the render benchmark");
+        return;
+    }
+
+    [sender setEnabled:NO];
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        HugKernelLevel level = HugKernels.level;
+        NSInteger failureCount = HugRenderBenchmarkRun(level, sLogRenderBenchmarkResult, NULL);
+
+        EmbraceLog(@"DebugController", @"Render benchmark with %s kernels: %ld failure(s)", HugKernelsGetLevelName(level), (long)failureCount);
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [sender setEnabled:YES];
+        });
+    });
+}
+
+
 @end
 
 #endif
@@ -0,0 +1,33 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import <Foundation/Foundation.h>
+
+
+// Persistent cache of decoded audio (HugPCMFile), shared by the app and the
+// worker. Entries are keyed by AnalysisCache keys and sampling rate.
+//
+// The worker writes an entry at sampleRate when the app asks for one,
+// usually for the track after the current one, so that HugAudioSource can
+// map it rather than decoding. The app evicts entries in least recently
+// used order once the cache exceeds its size limit.
+//
+@interface DecodedAudioCache : NSObject
+
++ (instancetype) sharedInstance;
+
+// Sampling rate of new entries, usually the output device's. 0 disables the cache.
+@property (atomic) double sampleRate;
+
+// Returns nil on a cache miss
+- (NSURL *) fileURLForKey:(NSString *)key sampleRate:(double)sampleRate;
+
+// Calls block with a temporary URL to write to. If block returns YES,
+// the file becomes the entry for key and sampleRate.
+- (BOOL) storeFileForKey:(NSString *)key sampleRate:(double)sampleRate usingBlock:(BOOL (^)(NSURL *fileURL))block;
+
+// Evicts entries if the cache is over its size limit, never those for keys.
+// Runs asynchronously.
+- (void) trimRetainingKeys:(NSSet<NSString *> *)keys;
+
+@end
@@ -0,0 +1,187 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import "DecodedAudioCache.h"
+#import "AnalysisCache.h"
+
+// Increment when the resampler or HugPCMFile layout changes
+static NSInteger const sDecodedAudioVersion = 1;
+
+// About six hours of stereo audio at 48 kHz, enough for a long set
+static unsigned long long const sSizeLimit = 8ull * 1024 * 1024 * 1024;
+
+
+@implementation DecodedAudioCache {
+    NSURL *_directoryURL;
+    NSURL *_incomingURL;
+    dispatch_queue_t _queue;
+}
+
+
++ (instancetype) sharedInstance
+{
+    static DecodedAudioCache *sSharedInstance = nil;
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+        sSharedInstance = [[DecodedAudioCache alloc] init];
+    });
+
+    return sSharedInstance;
+}
+
+
+- (instancetype) init
+{
+    if ((self = [super init])) {
+        NSFileManager *manager = [NSFileManager defaultManager];
+
+        NSURL *decodedURL = [GetSharedCachesDirectoryURL() URLByAppendingPathComponent:@"DecodedAudio"];
+        NSString *versionString = [NSString stringWithFormat:@"%ld", (long)sDecodedAudioVersion];
+
+        _directoryURL = [decodedURL URLByAppendingPathComponent:versionString];
+        _incomingURL  = [decodedURL URLByAppendingPathComponent:@"Incoming"];
+        _queue = dispatch_queue_create("DecodedAudioCache", DISPATCH_QUEUE_SERIAL);
+
+        NSError *error = nil;
+        [manager createDirectoryAtURL:_directoryURL withIntermediateDirectories:YES attributes:nil error:&error];
+        [manager createDirectoryAtURL:_incomingURL  withIntermediateDirectories:YES attributes:nil error:&error];
+
+        // Remove entries from other versions. Incoming is shared between
+        // processes, so partial writes are only removed by -_trimRetainingKeys:.
+        for (NSURL *url in [manager contentsOfDirectoryAtURL:decodedURL includingPropertiesForKeys:nil options:0 error:&error]) {
+            NSString *name = [url lastPathComponent];
+
+            if (![name isEqualToString:versionString] && ![name isEqualToString:@"Incoming"]) {
+                [manager removeItemAtURL:url error:&error];
+            }
+        }
+    }
+
+    return self;
+}
+
+
+#pragma mark - Private Methods
+
+- (NSURL *) _URLForKey:(NSString *)key sampleRate:(double)sampleRate
+{
+    NSString *name = [NSString stringWithFormat:@"%@-%ld", key, (long)sampleRate];
+    return [[_directoryURL URLByAppendingPathComponent:name] URLByAppendingPathExtension:@"pcm"];
+}
+
+
+- (NSString *) _keyForURL:(NSURL *)url
+{
+    NSString *name = [[url lastPathComponent] stringByDeletingPathExtension];
+    NSRange range = [name rangeOfString:@"-" options:NSBackwardsSearch];
+
+    return (range.location != NSNotFound) ? [name substringToIndex:range.location] : name;
+}
+
+
+- (void) _trimRetainingKeys:(NSSet<NSString *> *)keys
+{
+    NSFileManager *manager = [NSFileManager defaultManager];
+    NSArray *keys = @[ NSURLTotalFileAllocatedSizeKey, NSURLContentModificationDateKey ];
+
+    NSError *error = nil;
+    NSArray *urls = [manager contentsOfDirectoryAtURL:_directoryURL includingPropertiesForKeys:keys options:NSDirectoryEnumerationSkipsHiddenFiles error:&error];
+
+    // Writes which were interrupted a day or more ago
+    for (NSURL *url in [manager contentsOfDirectoryAtURL:_incomingURL includingPropertiesForKeys:keys options:0 error:&error]) {
+        NSDate *date = nil;
+        [url getResourceValue:&date forKey:NSURLContentModificationDateKey error:NULL];
+
+        if ([date timeIntervalSinceNow] < -86400) {
+            [manager removeItemAtURL:url error:&error];
+        }
+    }
+
+    unsigned long long totalSize = 0;
+
+    for (NSURL *url in urls) {
+        NSNumber *size = nil;
+        [url getResourceValue:&size forKey:NSURLTotalFileAllocatedSizeKey error:NULL];
+        totalSize += [size unsignedLongLongValue];
+    }
+
+    if (totalSize <= sSizeLimit) return;
+
+    // The modification date is touched on each hit, oldest is least recently used
+    NSArray *sortedURLs = [urls sortedArrayUsingComparator:^(NSURL *a, NSURL *b) {
+        NSDate *dateA = nil, *dateB = nil;
+        [a getResourceValue:&dateA forKey:NSURLContentModificationDateKey error:NULL];
+        [b getResourceValue:&dateB forKey:NSURLContentModificationDateKey error:NULL];
+        return [dateA compare:dateB];
+    }];
+
+    // Trim to 90% so that every store doesn't evict. Mapped files stay
+    // readable until they are unmapped.
+    unsigned long long targetSize = (sSizeLimit / 10) * 9;
+
+    for (NSURL *url in sortedURLs) {
+        if (totalSize <= targetSize) break;
+        if ([keys containsObject:[self _keyForURL:url]]) continue;
+
+        NSNumber *size = nil;
+        [url getResourceValue:&size forKey:NSURLTotalFileAllocatedSizeKey error:NULL];
+
+        if ([manager removeItemAtURL:url error:&error]) {
+            totalSize -= MIN(totalSize, [size unsignedLongLongValue]);
+        }
+    }
+}
+
+
+#pragma mark - Public Methods
+
+- (NSURL *) fileURLForKey:(NSString *)key sampleRate:(double)sampleRate
+{
+    if (!key || !sampleRate) return nil;
+
+    NSURL *url = [self _URLForKey:key sampleRate:sampleRate];
+    if (![[NSFileManager defaultManager] fileExistsAtPath:[url path]]) return nil;
+
+    dispatch_async(_queue, ^{
+        NSError *touchError = nil;
+        [url setResourceValue:[NSDate date] forKey:NSURLContentModificationDateKey error:&touchError];
+    });
+
+    return url;
+}
+
+
+- (BOOL) storeFileForKey:(NSString *)key sampleRate:(double)sampleRate usingBlock:(BOOL (^)(NSURL *fileURL))block
+{
+    if (!key || !sampleRate) return NO;
+
+    NSURL *incomingURL = [_incomingURL URLByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+    NSURL *entryURL    = [self _URLForKey:key sampleRate:sampleRate];
+
+    BOOL ok = block(incomingURL);
+
+    if (ok) {
+        ok = (rename([[incomingURL path] fileSystemRepresentation], [[entryURL path] fileSystemRepresentation]) == 0);
+    }
+
+    if (!ok) {
+        unlink([[incomingURL path] fileSystemRepresentation]);
+        return NO;
+    }
+
+    return YES;
+}
+
+
+- (void) trimRetainingKeys:(NSSet<NSString *> *)keys
+{
+    keys = [keys copy];
+
+    dispatch_async(_queue, ^{
+        [self _trimRetainingKeys:keys];
+    });
+}
+
+
+@end
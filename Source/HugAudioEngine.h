@@ -3,8 +3,11 @@
 
 #import <Foundation/Foundation.h>
 #import "HugAudioSource.h"
+#import "HugRenderProfile.h"
+#import "HugAutomation.h"
+#import "HugCrossfader.h"
 
-@class TrackScheduler, HugMeterData;
+@class TrackScheduler, HugMeterData, HugLoudnessData;
 
 @interface HugAudioEngine : NSObject
 
@@ -15,6 +18,32 @@
               stopTime: (NSTimeInterval) stopTime
                padding: (NSTimeInterval) padding;
 
+// Plays the audio file over the current one. The new file starts at hostTime
+// (0 = as soon as possible) and reaches full level after crossfadeDuration,
+// while the current file fades out. Effects and the rendering chain run once
+// on the mix. Falls back to -playAudioFile: when nothing is playing.
+//
+- (BOOL) playAudioFile: (HugAudioFile *) file
+             startTime: (NSTimeInterval) startTime
+              stopTime: (NSTimeInterval) stopTime
+               padding: (NSTimeInterval) padding
+     crossfadeDuration: (NSTimeInterval) crossfadeDuration
+        crossfadeCurve: (HugCrossfadeCurve) crossfadeCurve
+              hostTime: (UInt64) hostTime;
+
+// Opens, primes, and prepares the audio file on a background queue. If the next
+// call to -playAudioFile: uses the same file URL and times, the prepared source
+// is handed to the render thread without blocking. If it is still priming,
+// -playAudioFile: returns YES and playback starts once it primes.
+//
+- (void) preloadAudioFile: (HugAudioFile *) file
+                startTime: (NSTimeInterval) startTime
+                 stopTime: (NSTimeInterval) stopTime
+                  padding: (NSTimeInterval) padding;
+
+// Stops decoding the preloaded source
+- (void) cancelPreload;
+
 // Stops playback of the audio file
 - (void) stopPlayback;
 
@@ -33,6 +62,16 @@
 // -1.0 = left, 0.0 = center, 1.0 = right
 - (void) updateStereoBalance:(float)stereoBalance;
 
+// Ramps parameter to value over duration, starting at hostTime (0 = as soon
+// as possible). Sample-accurate, independent of the frame size, and does
+// not wake the main thread. The -update methods use a short linear ramp.
+//
+- (void) scheduleParameter: (HugAutomationParameter) parameter
+                     value: (float) value
+                  hostTime: (UInt64) hostTime
+                  duration: (NSTimeInterval) duration
+                     curve: (HugAutomationCurve) curve;
+
 - (void) updateEffectAudioUnits:(NSArray<AUAudioUnit *> *)effectAudioUnits;
 
 // Graph -> Player
@@ -44,11 +83,19 @@
 
 @property (nonatomic, readonly) HugMeterData *leftMeterData;
 @property (nonatomic, readonly) HugMeterData *rightMeterData;
+@property (nonatomic, readonly) HugLoudnessData *loudnessData;
 
 @property (nonatomic, readonly) float dangerLevel;
 
 @property (nonatomic, readonly) NSTimeInterval lastOverloadTime;
 
+// Per-node render time, as fractions of the render deadline. Nodes are the
+// input (source and rendering chain input), each effect, and the output.
+// renderNodeNames is nil unless HugAudioSettingRenderProfiling is @YES.
+@property (nonatomic, readonly) NSArray<NSString *> *renderNodeNames;
+- (HugRenderProfileStatistics) renderStatisticsForNodeAtIndex:(NSInteger)index;
+- (void) resetRenderStatistics;
+
 @end
 
 
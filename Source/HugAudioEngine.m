@@ -4,17 +4,19 @@
 #import "HugAudioEngine.h"
 
 #import "HugCrashPad.h"
-#import "HugLimiter.h"
-#import "HugLinearRamper.h"
-#import "HugStereoField.h"
+#import "HugRenderChain.h"
 #import "HugFastUtils.h"
-#import "HugLevelMeter.h"
 #import "HugMeterData.h"
 #import "HugSimpleGraph.h"
-#import "HugRingBuffer.h"
+#import "HugErrorChannel.h"
+#import "HugStatusChannel.h"
+#import "HugRenderProfile.h"
+#import "HugAutomation.h"
+#import "HugCrossfader.h"
 #import "HugUtils.h"
 #import "HugAudioSettings.h"
 #import "HugAudioSource.h"
+#import "HugAudioFile.h"
 
 #import <AVFoundation/AVFoundation.h>
 
@@ -27,41 +29,41 @@ extern volatile BOOL _HugCrashPadEnabled;
 typedef NS_ENUM(NSInteger, PacketType) {
     PacketTypeUnknown = 0,
 
-    // Transmitted via _statusRingBuffer
-    PacketTypePlayback = 1,
-    PacketTypeMeter    = 2,
-    PacketTypeDanger   = 3,
+    // Transmitted via _statusChannel
+    PacketTypePlayback = 1, // Uses HugPlaybackInfo
+    PacketTypeMeter    = 2, // Uses StatusDataMeter
+    PacketTypeDanger   = 3, // Uses StatusDataDanger
     
-    // Transmitted via _errorRingBuffer
-    PacketTypeStatusBufferFull = 101, // Uses PacketDataUnknown
+    // Transmitted via _errorChannel
     PacketTypeOverload         = 102, // Uses PacketDataUnknown
     PacketTypeRenderError      = 200, // Uses PacketDataError
 };
 
-typedef struct {
-    uint64_t timestamp;
-    UInt16 type;
-} PacketDataUnknown;
+// Each producer of _errorChannel writes to its own lane
+typedef NS_ENUM(NSInteger, ErrorLane) {
+    ErrorLaneRender = 0, // Render thread
+    ErrorLaneDevice = 1, // HAL property listener thread
+
+    ErrorLaneCount
+};
 
 typedef struct {
-    uint64_t timestamp;
-    UInt16 type;
-    HugPlaybackInfo info;
-} PacketDataPlayback;
+    HugMeterDataStruct    leftMeterData;
+    HugMeterDataStruct    rightMeterData;
+    HugLoudnessDataStruct loudnessData;
+} StatusDataMeter;
+
+_Static_assert(sizeof(StatusDataMeter) <= HugStatusChannelPayloadSize, "StatusDataMeter is too large");
 
 typedef struct {
-    uint64_t timestamp;
-    UInt16 type;
-    UInt16 frameCount;
+    UInt32 frameCount;
     uint64_t renderTime;
-} PacketDataDanger;
+} StatusDataDanger;
 
 typedef struct {
     uint64_t timestamp;
     UInt16 type;
-    HugMeterDataStruct leftMeterData;
-    HugMeterDataStruct rightMeterData;
-} PacketDataMeter;
+} PacketDataUnknown;
 
 typedef struct {
     uint64_t timestamp;
@@ -73,19 +75,47 @@ typedef struct {
 typedef struct {
     _Atomic HugAudioSourceInputBlock inputBlock;
     _Atomic HugAudioSourceInputBlock nextInputBlock;
+
+    // Outgoing source during a crossfade. The render thread clears it once the
+    // crossfade finishes, the main thread then releases the source.
+    _Atomic HugAudioSourceInputBlock fadingInputBlock;
+
+    // How to switch to nextInputBlock, written before it. A duration of 0 cuts.
+    _Atomic UInt64 transitionHostTime;
+    _Atomic UInt64 transitionHostDuration;
+    _Atomic UInt32 transitionCurve;
+
+    HugCrossfader *crossfader;
     
     _Atomic AURenderPullInputBlock renderBlock;
     _Atomic AURenderPullInputBlock nextRenderBlock;
 
-    volatile float stereoWidth;
-    volatile float stereoBalance;
-    volatile float volume;
-    volatile float preGain;
+    // Pre-gain, volume, stereo width, and stereo balance
+    HugAutomation *automation;
 
     volatile UInt64 renderStart;
 } RenderUserInfo;
 
 
+typedef struct {
+    UInt32      mNumberBuffers;
+    AudioBuffer mBuffers[2];
+} StereoBufferList;
+
+
+static AudioBufferList *sMakeStereoBufferList(StereoBufferList *list, float *left, float *right, size_t frameCount)
+{
+    UInt32 byteSize = (UInt32)(frameCount * sizeof(float));
+
+    list->mNumberBuffers = 0;
+
+    if (left)  list->mBuffers[list->mNumberBuffers++] = (AudioBuffer) { 1, byteSize, left  };
+    if (right) list->mBuffers[list->mNumberBuffers++] = (AudioBuffer) { 1, byteSize, right };
+
+    return (AudioBufferList *)list;
+}
+
+
 static OSStatus sOutputUnitRenderCallback(
     void *inRefCon,
     AudioUnitRenderActionFlags *ioActionFlags,
@@ -111,10 +141,28 @@ static OSStatus sOutputUnitRenderCallback(
 }
 
 
+static const size_t sStatusChannelSlotCount = 256;
+
+static const size_t sAutomationEventCount = 256;
+
+// Bytes per lane of _errorChannel
+static const size_t sErrorChannelCapacity = 8192;
+
+// Changes from -updateVolume: and friends ramp over this duration, independent
+// of the frame size, to avoid zipper noise
+static const NSTimeInterval sParameterRampDuration = 0.01;
+
+// The status thread forwards at most one update per interval to the main thread
+static const NSTimeInterval sStatusUpdateInterval = 1.0 / 30.0;
+static const NSTimeInterval sStatusIdleTimeout    = 1.0;
+
+
 static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNumberAddresses, const AudioObjectPropertyAddress inAddresses[], void *inClientData)
 {
-    PacketDataUnknown packet = { 0, PacketTypeOverload };
-    HugRingBufferWrite((HugRingBuffer *)inClientData, &packet, sizeof(packet));
+    // The HAL calls property listeners on its notification thread, which is
+    // the only producer for ErrorLaneDevice
+    PacketDataUnknown packet = { HugGetCurrentHostTime(), PacketTypeOverload };
+    HugErrorChannelPost((HugErrorChannel *)inClientData, ErrorLaneDevice, &packet, sizeof(packet));
     
     return noErr;
 }
@@ -125,6 +173,23 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 
     HugAudioSource *_currentSource;
     HugAudioSourceInputBlock _currentInputBlock;
+
+    // Outgoing source of a crossfade, kept alive until the render thread is done
+    HugAudioSource *_fadingSource;
+    HugAudioSourceInputBlock _fadingInputBlock;
+
+    dispatch_queue_t _preloadQueue;
+    dispatch_group_t _preloadGroup;
+    HugAudioSource  *_preloadSource;
+    NSTimeInterval   _preloadStartTime;
+    NSTimeInterval   _preloadStopTime;
+    NSTimeInterval   _preloadPadding;
+    BOOL             _preloadDidFinish;
+
+    // Preloaded source which was still priming when played, sent once primed
+    HugAudioSource  *_pendingSource;
+    BOOL             _pendingDidFinish;
+
     AudioUnit _outputAudioUnit;
 
     HugSimpleGraph *_graph;
@@ -135,26 +200,36 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 
     BOOL _switchingSources;
 
-    NSTimer *_updateTimer;
+    dispatch_queue_t _statusQueue;
+    BOOL             _statusUpdatesRunning;
+    atomic_long      _statusGeneration;
+    atomic_bool      _statusUpdatePending;
+    uint64_t         _statusDroppedCount;
 
-    HugLimiter      *_emergencyLimiter;
-    HugStereoField  *_stereoField;
-    HugLevelMeter   *_leftLevelMeter;
-    HugLevelMeter   *_rightLevelMeter;
-    HugLinearRamper *_preGainRamper;
-    HugLinearRamper *_volumeRamper;
+    HugRenderChain  *_renderChain;
 
-    HugRingBuffer   *_errorRingBuffer;
-    HugRingBuffer   *_statusRingBuffer;
+    HugErrorChannel  *_errorChannel;
+    uint64_t          _errorLostCount;
+    HugStatusChannel *_statusChannel;
 
     HugPlaybackStatus _playbackStatus;
     NSTimeInterval    _timeElapsed;
     NSTimeInterval    _timeRemaining;
     HugMeterData     *_leftMeterData;
     HugMeterData     *_rightMeterData;
+    HugLoudnessData  *_loudnessData;
+    StatusDataMeter   _meterSnapshot;
+    BOOL              _hasMeterSnapshot;
+    double            _outputSampleRate;
     float             _dangerLevel;
     NSTimeInterval    _lastOverloadTime;
 
+    // Latest value of each automated parameter, sent when the output starts
+    float _parameterValues[HugAutomationParameterCount];
+
+    HugRenderProfile *_renderProfile;
+    NSArray<NSString *> *_renderNodeNames;
+
     NSArray<AUAudioUnit *> *_effectAudioUnits;
 }
 
@@ -179,15 +254,17 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
             @"HugAudioEngine", @"AudioComponentInstanceNew[ Output ]"
         );
 
-        _stereoField      = HugStereoFieldCreate();
-        _preGainRamper    = HugLinearRamperCreate();
-        _volumeRamper     = HugLinearRamperCreate();
-        _leftLevelMeter   = HugLevelMeterCreate();
-        _rightLevelMeter  = HugLevelMeterCreate();
-        _emergencyLimiter = HugLimiterCreate();
+        _renderChain = HugRenderChainCreate();
+        _renderProfile = HugRenderProfileCreate(HugSimpleGraphMaximumNodeCount);
         
-        _statusRingBuffer = HugRingBufferCreate(8196);
-        _errorRingBuffer  = HugRingBufferCreate(8196);
+        _statusChannel   = HugStatusChannelCreate(sStatusChannelSlotCount);
+        _renderUserInfo.automation = HugAutomationCreate(sAutomationEventCount);
+        _renderUserInfo.crossfader = HugCrossfaderCreate();
+        _errorChannel    = HugErrorChannelCreate(ErrorLaneCount, sErrorChannelCapacity);
+
+        _statusQueue = dispatch_queue_create("HugAudioEngine.status", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0));
+
+        _preloadQueue = dispatch_queue_create("HugAudioEngine.preload", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INITIATED, 0));
     }
 
     return self;
@@ -195,6 +272,15 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 
 
 - (void) _sendAudioSourceToRenderThread:(HugAudioSource *)source
+{
+    [self _sendAudioSourceToRenderThread:source crossfadeDuration:0 curve:HugCrossfadeCurveEqualPower hostTime:0];
+}
+
+
+- (void) _sendAudioSourceToRenderThread: (HugAudioSource *) source
+                      crossfadeDuration: (NSTimeInterval) crossfadeDuration
+                                  curve: (HugCrossfadeCurve) curve
+                               hostTime: (UInt64) hostTime
 {
     if (_currentSource == source) return;
 
@@ -215,12 +301,19 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
         return blockToCall(frameCount, inputData, outInfo);
     } copy] : nil;
 
+    // Matches the check on the render thread
+    BOOL crossfades = (crossfadeDuration > 0) && _currentInputBlock && blockToSend;
+
+    atomic_store(&_renderUserInfo.transitionHostTime,     hostTime);
+    atomic_store(&_renderUserInfo.transitionHostDuration, crossfades ? HugGetHostTimeWithSeconds(crossfadeDuration) : 0);
+    atomic_store(&_renderUserInfo.transitionCurve,        (UInt32)curve);
+
     if ([self _isRunning]) {
         atomic_store(&_renderUserInfo.nextInputBlock, blockToSend);
 
         NSInteger loopGuard = 0;
         while (1) {
-            HugRingBufferConfirmReadAll(_statusRingBuffer);
+            HugStatusChannelFlush(_statusChannel);
 
             if (blockToSend == atomic_load(&_renderUserInfo.inputBlock)) {
                 break;
@@ -238,14 +331,27 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
         }
 
     } else {
-        atomic_store(&_renderUserInfo.inputBlock,     nil);
-        atomic_store(&_renderUserInfo.nextInputBlock, blockToSend);
+        atomic_store(&_renderUserInfo.inputBlock,       nil);
+        atomic_store(&_renderUserInfo.fadingInputBlock, nil);
+        atomic_store(&_renderUserInfo.nextInputBlock,   blockToSend);
+
+        crossfades = NO;
     }
     
+    NSInteger underrunCount = [_currentSource underrunCount];
+    if (underrunCount > 0) {
+        HugLog(@"HugAudioEngine", @"%@ had %ld streaming underruns", _currentSource, (long)underrunCount);
+    }
+
+    // The render thread has dropped any previous outgoing source by now.
+    // During a crossfade, the current source becomes the outgoing one.
+    _fadingSource     = crossfades ? _currentSource     : nil;
+    _fadingInputBlock = crossfades ? _currentInputBlock : nil;
+
     _currentSource = source;
     _currentInputBlock = blockToSend;
 
-    HugRingBufferConfirmReadAll(_statusRingBuffer);
+    HugStatusChannelFlush(_statusChannel);
     _switchingSources = NO;
 }
 
@@ -266,86 +372,84 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 }
 
 
-- (void) _readRingBuffers
+- (void) _readStatusChannel
 {
     uint64_t current = HugGetCurrentHostTime();
     uint64_t tooFar  = current + HugGetHostTimeWithSeconds(1.0);
 
-    NSInteger loopGuard = HugRingBufferGetCapacity(_statusRingBuffer) / sizeof(PacketDataUnknown);
+    NSInteger loopGuard = sStatusChannelSlotCount * 2;
 
-    NSInteger overloadCount   = 0;
-    NSInteger statusFullCount = 0;
+    NSInteger overloadCount = 0;
 
-    // Process status
+    // Process status. Each message supersedes the previous one of its type,
+    // so only the latest due value is kept.
+    //
     for (NSInteger i = 0; i < loopGuard; i++) {
-        // If we are switching sources, clear the entire _statusRingBuffer
+        // If we are switching sources, discard everything in _statusChannel
         if (_switchingSources) {
-            HugRingBufferConfirmReadAll(_statusRingBuffer);
+            HugStatusChannelFlush(_statusChannel);
             break;
         }
 
-        PacketDataUnknown *unknown = HugRingBufferGetReadPtr(_statusRingBuffer, sizeof(PacketDataUnknown));
-        if (!unknown) break;
+        const HugStatusMessage *message = HugStatusChannelPeek(_statusChannel);
+        if (!message) break;
                
-        if ((unknown->timestamp >= current) && (unknown->timestamp < tooFar)) {
+        if ((message->timestamp >= current) && (message->timestamp < tooFar)) {
             break;
         }
         
-        if (unknown->type == PacketTypePlayback) {
-            PacketDataPlayback packet;
-            if (!HugRingBufferRead(_statusRingBuffer, &packet, sizeof(PacketDataPlayback))) return;
+        if (message->type == PacketTypePlayback) {
+            HugPlaybackInfo info;
+            memcpy(&info, message->payload, sizeof(HugPlaybackInfo));
 
-            _playbackStatus = packet.info.status;
-            _timeElapsed    = packet.info.timeElapsed;
-            _timeRemaining  = packet.info.timeRemaining;
+            _playbackStatus = info.status;
+            _timeElapsed    = info.timeElapsed;
+            _timeRemaining  = info.timeRemaining;
 
-        } else if (unknown->type == PacketTypeMeter) {
-            PacketDataMeter packet;
-            if (!HugRingBufferRead(_statusRingBuffer, &packet, sizeof(PacketDataMeter))) return;
-            
-            _leftMeterData  = [[HugMeterData alloc] initWithStruct:packet.leftMeterData];
-            _rightMeterData = [[HugMeterData alloc] initWithStruct:packet.rightMeterData];
+        } else if (message->type == PacketTypeMeter) {
+            memcpy(&_meterSnapshot, message->payload, sizeof(StatusDataMeter));
+            _hasMeterSnapshot = YES;
 
-        } else if (unknown->type == PacketTypeDanger) {
-            PacketDataDanger packet;
-            if (!HugRingBufferRead(_statusRingBuffer, &packet, sizeof(PacketDataDanger))) return;
-            
-            uint64_t renderTime = packet.renderTime;
+            // Rebuilt on demand by -leftMeterData / -rightMeterData / -loudnessData
+            _leftMeterData  = nil;
+            _rightMeterData = nil;
+            _loudnessData   = nil;
 
-            double outputSampleRate = [[_outputSettings objectForKey:HugAudioSettingSampleRate] doubleValue];
-            
-            double callbackDuration = packet.frameCount / outputSampleRate;
-            double elapsedDuration  = HugGetSecondsWithHostTime(renderTime);
+        } else if (message->type == PacketTypeDanger) {
+            StatusDataDanger danger;
+            memcpy(&danger, message->payload, sizeof(StatusDataDanger));
+
+            double callbackDuration = danger.frameCount / _outputSampleRate;
+            double elapsedDuration  = HugGetSecondsWithHostTime(danger.renderTime);
             
-            _dangerLevel = elapsedDuration / callbackDuration;
+            _dangerLevel = callbackDuration > 0 ? (elapsedDuration / callbackDuration) : 0;
 
         } else {
-            NSAssert(NO, @"Unknown packet type: %ld", (long)unknown->type);
+            NSAssert(NO, @"Unknown message type: %ld", (long)message->type);
         }
+
+        HugStatusChannelConsume(_statusChannel);
     }
     
-    // Process error buffer
+    // Process error channel, oldest first across all lanes
+    loopGuard = (ErrorLaneCount * sErrorChannelCapacity) / sizeof(PacketDataUnknown);
+
     for (NSInteger i = 0; i < loopGuard; i++) {
-        PacketDataUnknown *unknown = HugRingBufferGetReadPtr(_errorRingBuffer, sizeof(PacketDataUnknown));
-        if (!unknown) return;
+        size_t packetSize = 0;
+        const void *bytes = HugErrorChannelPeek(_errorChannel, &packetSize);
+        if (!bytes) break;
 
-        if (unknown->type == PacketTypeOverload) {
-            PacketDataUnknown packet;
-            if (!HugRingBufferRead(_errorRingBuffer, &packet, sizeof(PacketDataUnknown))) return;
+        PacketDataUnknown unknown;
+        memcpy(&unknown, bytes, sizeof(PacketDataUnknown));
 
+        if (unknown.type == PacketTypeOverload) {
             _lastOverloadTime = [NSDate timeIntervalSinceReferenceDate];
 
             overloadCount++;
            
-        } else if (unknown->type == PacketTypeStatusBufferFull) {
-            PacketDataUnknown packet;
-            if (!HugRingBufferRead(_errorRingBuffer, &packet, sizeof(PacketDataUnknown))) return;
-
-            statusFullCount++;
-        
-        } else if (unknown->type == PacketTypeRenderError) {
+        } else if (unknown.type == PacketTypeRenderError && packetSize >= sizeof(PacketDataRenderError)) {
             PacketDataRenderError packet;
-            if (!HugRingBufferRead(_errorRingBuffer, &packet, sizeof(PacketDataRenderError))) return;
+            memcpy(&packet, bytes, sizeof(PacketDataRenderError));
 
             HugLog(@"HugAudioEngine", @"Render error on audio thread: index=%ld, error=%@",
                 (long)packet.index,
@@ -353,50 +457,146 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
             );
             
         } else {
-            NSAssert(NO, @"Unknown packet type: %ld", (long)unknown->type);
+            NSAssert(NO, @"Unknown packet type: %ld", (long)unknown.type);
         }
+
+        HugErrorChannelConsume(_errorChannel);
+    }
+
+    uint64_t errorLostCount = HugErrorChannelGetLostCount(_errorChannel);
+
+    if (errorLostCount != _errorLostCount) {
+        HugLog(@"HugAudioEngine", @"Error channel full, %llu packets lost", (unsigned long long)(errorLostCount - _errorLostCount));
+        _errorLostCount = errorLostCount;
     }
     
-    // Aggregate logging for overloads and "buffer full" errors. Else, we can spend
-    // too much time in HugLog while _statusRingBuffer continues to fill.
+    // Aggregate logging for overloads and coalesced status. Else, we can spend
+    // too much time in HugLog while _statusChannel continues to fill.
     //
     if (overloadCount > 0) {
         HugLog(@"HugAudioEngine", @"kAudioDeviceProcessorOverload detected (%ld)", overloadCount);
     }
     
-    if (statusFullCount > 0) {
-        HugLog(@"HugAudioEngine", @"_statusRingBuffer is full (%ld)", statusFullCount);
+    // Release the outgoing source here rather than on the render thread
+    if (_fadingInputBlock && (atomic_load(&_renderUserInfo.fadingInputBlock) != _fadingInputBlock)) {
+        HugLog(@"HugAudioEngine", @"Finished crossfade from %@", _fadingSource);
+
+        _fadingSource     = nil;
+        _fadingInputBlock = nil;
+    }
+
+    uint64_t droppedCount = HugStatusChannelGetDroppedCount(_statusChannel);
+    if (droppedCount != _statusDroppedCount) {
+        HugLog(@"HugAudioEngine", @"_statusChannel coalesced %llu messages", droppedCount - _statusDroppedCount);
+        _statusDroppedCount = droppedCount;
     }
 }
 
 
+- (void) _startStatusUpdates
+{
+    if (_statusUpdatesRunning) return;
+    _statusUpdatesRunning = YES;
+
+    long generation = atomic_fetch_add(&_statusGeneration, 1) + 1;
+    HugStatusChannel *statusChannel = _statusChannel;
+
+    __weak id weakSelf = self;
+
+    // Sleep until the render thread posts, then forward a single update to
+    // the main thread. This replaces a fixed-rate NSTimer, so nothing wakes
+    // up while no audio is being rendered.
+    //
+    dispatch_async(_statusQueue, ^{
+        while (1) {
+            BOOL pending = HugStatusChannelWait(statusChannel, sStatusIdleTimeout);
+            
+            HugAudioEngine *strongSelf = weakSelf;
+            if (!strongSelf || (atomic_load(&strongSelf->_statusGeneration) != generation)) {
+                break;
+            }
+
+            if (!pending) continue;
+
+            if (!atomic_exchange(&strongSelf->_statusUpdatePending, YES)) {
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [strongSelf _handleStatusUpdate];
+                });
+            }
+
+            strongSelf = nil;
+
+            usleep(sStatusUpdateInterval * USEC_PER_SEC);
+        }
+    });
+}
+
+
+- (void) _stopStatusUpdates
+{
+    if (!_statusUpdatesRunning) return;
+    _statusUpdatesRunning = NO;
+
+    atomic_fetch_add(&_statusGeneration, 1);
+    HugStatusChannelSignal(_statusChannel);
+}
+
+
 - (void) _reconnectGraph
 {
     HugLogMethod();
 
-    HugLimiter      *limiter          = _emergencyLimiter;
-    HugStereoField  *stereoField      = _stereoField;
-    HugLevelMeter   *leftLevelMeter   = _leftLevelMeter;
-    HugLevelMeter   *rightLevelMeter  = _rightLevelMeter;
-    HugLinearRamper *preGainRamper    = _preGainRamper;
-    HugLinearRamper *volumeRamper     = _volumeRamper;
-    HugRingBuffer   *statusRingBuffer = _statusRingBuffer;
-    HugRingBuffer   *errorRingBuffer  = _errorRingBuffer;
+    HugRenderChain   *renderChain     = _renderChain;
+    HugStatusChannel *statusChannel   = _statusChannel;
+    HugErrorChannel  *errorChannel    = _errorChannel;
 
     RenderUserInfo *userInfo = &_renderUserInfo;
+    HugAutomation  *automation = _renderUserInfo.automation;
+    HugCrossfader  *crossfader = _renderUserInfo.crossfader;
 
-    HugSimpleGraph *graph = [[HugSimpleGraph alloc] initWithErrorBlock:^(OSStatus err, NSInteger index) {
-        PacketDataRenderError packet = { 0, PacketTypeRenderError, index, err };
-        HugRingBufferWrite(errorRingBuffer, &packet, sizeof(packet));
-    }];
-     
-    void (^__sendStatusPacket)(void *, CFIndex) = ^(void *buffer, CFIndex length) {
-        if (!HugRingBufferWrite(statusRingBuffer, buffer, length)) {
-            PacketDataUnknown packet = { 0, PacketTypeStatusBufferFull };
-            HugRingBufferWrite(errorRingBuffer, &packet, sizeof(packet));
-        }
+    double sampleRate = [[_outputSettings objectForKey:HugAudioSettingSampleRate] doubleValue];
+    UInt32 frameSize  = [[_outputSettings objectForKey:HugAudioSettingFrameSize] unsignedIntValue];
+
+    double hostTicksPerFrame = sampleRate ? (HugGetHostTimeWithSeconds(1.0) / sampleRate) : 0;
+
+    BOOL profilesRender = [[_outputSettings objectForKey:HugAudioSettingRenderProfiling] boolValue];
+    HugRenderProfile *renderProfile = _renderProfile;
+
+    HugSimpleGraphErrorBlock errorBlock = ^(OSStatus err, NSInteger index) {
+        PacketDataRenderError packet = { HugGetCurrentHostTime(), PacketTypeRenderError, index, err };
+        HugErrorChannelPost(errorChannel, ErrorLaneRender, &packet, sizeof(packet));
     };
-    #define sendStatusPacket(packet) __sendStatusPacket(&(packet), sizeof((packet)));
+
+    // Every callback is added to renderProfile here, rather than being sent
+    // through the status channel, which coalesces packets under load.
+    // Without HugAudioSettingRenderProfiling, the graph isn't timed at all.
+    HugSimpleGraphTimingBlock timingBlock = nil;
+
+    if (profilesRender) {
+        timingBlock = ^(
+            const AudioTimeStamp *timestamp,
+            AUAudioFrameCount frameCount,
+            const UInt64 *nodeTimes,
+            NSInteger nodeCount
+        ) {
+            double deadline = frameCount * hostTicksPerFrame;
+            if (!(deadline > 0)) return;
+
+            double loads[HugSimpleGraphMaximumNodeCount];
+            NSInteger loadCount = MIN(nodeCount, HugSimpleGraphMaximumNodeCount);
+
+            for (NSInteger i = 0; i < loadCount; i++) {
+                loads[i] = nodeTimes[i] / deadline;
+            }
+
+            HugRenderProfileAddSamples(renderProfile, loads, loadCount);
+        };
+    }
+
+    HugSimpleGraph *graph = [[HugSimpleGraph alloc] initWithErrorBlock:errorBlock timingBlock:timingBlock];
+
+    // Source, sample rate converter, and the input half of _renderChain
+    NSMutableArray *nodeNames = [NSMutableArray arrayWithObject:@"Input"];
      
     [graph addBlock:^(
         AudioUnitRenderActionFlags *ioActionFlags,
@@ -407,27 +607,95 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
     ) {
         userInfo->renderStart = HugGetCurrentHostTime();
 
-        __unsafe_unretained HugAudioSourceInputBlock inputBlock     = atomic_load(&userInfo->inputBlock);
-        __unsafe_unretained HugAudioSourceInputBlock nextInputBlock = atomic_load(&userInfo->nextInputBlock);
+        uint64_t startTime = (timestamp->mFlags & kAudioTimeStampHostTimeValid) ?
+            timestamp->mHostTime :
+            userInfo->renderStart;
+
+        HugAutomationBeginBuffer(automation, startTime, hostTicksPerFrame, inNumberFrames);
+
+        __unsafe_unretained HugAudioSourceInputBlock inputBlock       = atomic_load(&userInfo->inputBlock);
+        __unsafe_unretained HugAudioSourceInputBlock nextInputBlock   = atomic_load(&userInfo->nextInputBlock);
+        __unsafe_unretained HugAudioSourceInputBlock fadingInputBlock = atomic_load(&userInfo->fadingInputBlock);
         
         HugPlaybackInfo info = {0};
         OSStatus err = noErr;
         
-        BOOL willChangeUnits = (nextInputBlock != inputBlock);
+        BOOL willChangeUnits  = (nextInputBlock != inputBlock);
+        BOOL willStartFade    = NO;
+        BOOL didFinishFade    = NO;
+
+        // Crossfade: the current source becomes the outgoing one. Any previous
+        // outgoing source is cut.
+        if (willChangeUnits && inputBlock && nextInputBlock) {
+            UInt64 hostDuration = atomic_load(&userInfo->transitionHostDuration);
+
+            if (hostDuration && hostTicksPerFrame && (inNumberFrames <= HugCrossfaderGetMaxFrameCount(crossfader))) {
+                UInt64 hostTime = atomic_load(&userInfo->transitionHostTime);
+                SInt64 delay = hostTime ? llround((double)(SInt64)(hostTime - startTime) / hostTicksPerFrame) : 0;
+
+                HugCrossfaderStart(crossfader,
+                    (size_t)MAX(delay, 0),
+                    (size_t)llround(hostDuration / hostTicksPerFrame),
+                    (HugCrossfadeCurve)atomic_load(&userInfo->transitionCurve)
+                );
+
+                fadingInputBlock = inputBlock;
+                inputBlock       = nextInputBlock;
+                willChangeUnits  = NO;
+                willStartFade    = YES;
+            }
+        }
+
+        // Sources that outlast the scratch buffers are cut
+        if (fadingInputBlock && (inNumberFrames > HugCrossfaderGetMaxFrameCount(crossfader))) {
+            HugCrossfaderStop(crossfader);
+            fadingInputBlock = nil;
+            didFinishFade = YES;
+        }
 
         float *leftData  = ioData->mNumberBuffers > 0 ? ioData->mBuffers[0].mData : NULL;
         float *rightData = ioData->mNumberBuffers > 1 ? ioData->mBuffers[1].mData : NULL;
 
-        if (!inputBlock) {
+        size_t delay = fadingInputBlock ? MIN(HugCrossfaderGetDelayFrameCount(crossfader), inNumberFrames) : 0;
+
+        if (!inputBlock && !fadingInputBlock) {
             *ioActionFlags |= kAudioUnitRenderAction_OutputIsSilence;
             HugApplySilence(leftData, inNumberFrames);
             HugApplySilence(rightData, inNumberFrames);
 
         } else {
-            err = inputBlock(inNumberFrames, ioData, &info);
-            
-            HugStereoFieldProcess(stereoField, leftData, rightData, inNumberFrames, userInfo->stereoBalance, userInfo->stereoWidth);
-            HugLinearRamperProcess(preGainRamper, leftData, rightData, inNumberFrames, userInfo->preGain);
+            if (fadingInputBlock) {
+                StereoBufferList fadingList;
+                HugPlaybackInfo  fadingInfo = {0};
+
+                float *fadingLeft  = leftData  ? HugCrossfaderGetScratchBuffer(crossfader, 0) : NULL;
+                float *fadingRight = rightData ? HugCrossfaderGetScratchBuffer(crossfader, 1) : NULL;
+
+                fadingInputBlock(inNumberFrames, sMakeStereoBufferList(&fadingList, fadingLeft, fadingRight, inNumberFrames), &fadingInfo);
+            }
+
+            // The incoming source starts after the crossfade's delay
+            if (inputBlock && (delay < inNumberFrames)) {
+                StereoBufferList inputList;
+
+                float *inputLeft  = leftData  ? leftData  + delay : NULL;
+                float *inputRight = rightData ? rightData + delay : NULL;
+
+                HugApplySilence(leftData,  delay);
+                HugApplySilence(rightData, delay);
+
+                err = inputBlock(inNumberFrames - delay, sMakeStereoBufferList(&inputList, inputLeft, inputRight, inNumberFrames - delay), &info);
+
+            } else {
+                HugApplySilence(leftData,  inNumberFrames);
+                HugApplySilence(rightData, inNumberFrames);
+            }
+
+            if (fadingInputBlock && !HugCrossfaderProcess(crossfader, leftData, rightData, inNumberFrames)) {
+                didFinishFade = YES;
+            }
+
+            HugRenderChainProcessAutomatedInput(renderChain, leftData, rightData, inNumberFrames, automation);
 
             if (willChangeUnits) {
                 HugApplyFade(leftData,  inNumberFrames, 1.0, 0.0);
@@ -435,26 +703,34 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
             }
         }
 
-        if (willChangeUnits) {
-            HugLinearRamperReset(preGainRamper, userInfo->preGain);
-            HugLinearRamperReset(volumeRamper,  userInfo->volume);
-            HugStereoFieldReset(stereoField, userInfo->stereoBalance, userInfo->stereoWidth);
+        if (willStartFade) {
+            // Published before inputBlock, so the main thread sees both together
+            atomic_store(&userInfo->fadingInputBlock, didFinishFade ? nil : fadingInputBlock);
+            atomic_store(&userInfo->inputBlock, inputBlock);
+
+        } else if (willChangeUnits) {
+            // Pre-gain belongs to the track, the next source starts at its final value
+            HugAutomationFinishRamp(automation, HugAutomationParameterPreGain);
+
+            HugCrossfaderStop(crossfader);
+            atomic_store(&userInfo->fadingInputBlock, nil);
 
             atomic_store(&userInfo->inputBlock, nextInputBlock);
 
         } else {
-            if (inputBlock && (timestamp->mFlags & kAudioTimeStampHostTimeValid)) {
-                PacketDataPlayback packet = { timestamp->mHostTime, PacketTypePlayback, info };
-                sendStatusPacket(packet);
+            if (didFinishFade) {
+                atomic_store(&userInfo->fadingInputBlock, nil);
+            }
+
+            // Until the incoming source starts, there is nothing to report
+            if (inputBlock && (delay < inNumberFrames) && (timestamp->mFlags & kAudioTimeStampHostTimeValid)) {
+                HugStatusChannelPost(statusChannel, PacketTypePlayback, timestamp->mHostTime, &info, sizeof(info));
             }
         }
 
         return err;
     }];
 
-    double sampleRate = [[_outputSettings objectForKey:HugAudioSettingSampleRate] doubleValue];
-    UInt32 frameSize  = [[_outputSettings objectForKey:HugAudioSettingFrameSize] unsignedIntValue];
-    
     if (sampleRate && frameSize) {
         AVAudioFormat *format = [[AVAudioFormat alloc] initStandardFormatWithSampleRate:sampleRate channels:2];
         
@@ -483,6 +759,7 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
                 HugLog(@"HugAudioEngine", @"Error when configuring %@: %@", unit, error);
             } else  {
                 [graph addAudioUnit:unit];
+                [nodeNames addObject:[unit audioUnitName] ?: @"Audio Unit"];
             }
         }
     }
@@ -498,58 +775,52 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
             timestamp->mHostTime :
             HugGetCurrentHostTime();
         
-        size_t meterFrameCount = HugLevelMeterGetMaxFrameCount(_leftLevelMeter);
-        
-        NSInteger offset = 0;
-        NSInteger framesRemaining = inNumberFrames;
-
         float *leftData  = ioData->mNumberBuffers > 0 ? ioData->mBuffers[0].mData : NULL;
         float *rightData = ioData->mNumberBuffers > 1 ? ioData->mBuffers[1].mData : NULL;
 
-        float volume = userInfo->volume;
-        HugLinearRamperProcess(volumeRamper, leftData, rightData, inNumberFrames, volume);
-        
-        while (framesRemaining > 0) {
-            NSInteger framesToProcess = MIN(framesRemaining, meterFrameCount);
-
-            PacketDataMeter packet = {0};
-            packet.timestamp = currentTime + HugGetHostTimeWithSeconds(offset / sampleRate);
-            packet.type = PacketTypeMeter;
-
-            if (leftData) {
-                HugLevelMeterProcess(leftLevelMeter, leftData + offset, framesToProcess);
-
-                packet.leftMeterData.peakLevel = HugLevelMeterGetPeakLevel(leftLevelMeter);
-                packet.leftMeterData.heldLevel = HugLevelMeterGetHeldLevel(leftLevelMeter);
-            }
+        HugRenderChainProcessAutomatedOutput(renderChain, leftData, rightData, inNumberFrames, automation);
 
-            if (rightData) {
-                HugLevelMeterProcess(rightLevelMeter, rightData + offset, framesToProcess);
+        const HugRenderChainMeterPacket *meterPackets = HugRenderChainGetMeterPackets(renderChain);
+        size_t meterPacketCount = HugRenderChainGetMeterPacketCount(renderChain);
 
-                packet.rightMeterData.peakLevel = HugLevelMeterGetPeakLevel(rightLevelMeter);
-                packet.rightMeterData.heldLevel = HugLevelMeterGetHeldLevel(rightLevelMeter);
-            }
+        for (size_t i = 0; i < meterPacketCount; i++) {
+            const HugRenderChainMeterPacket *meterPacket = &meterPackets[i];
 
-            HugLimiterProcess(limiter, leftData + offset, rightData + offset, framesToProcess);
-            packet.leftMeterData.limiterActive = HugLimiterIsActive(limiter);
-            packet.rightMeterData.limiterActive = packet.leftMeterData.limiterActive;
+            // Meters run before the limiter, which may delay the audio
+            size_t frameOffset = meterPacket->frameOffset + HugRenderChainGetLatency(renderChain);
+            uint64_t packetTime = currentTime + HugGetHostTimeWithSeconds(frameOffset / sampleRate);
 
-            sendStatusPacket(packet);
+            StatusDataMeter packet = {0};
+            packet.leftMeterData.peakLevel      = meterPacket->leftPeakLevel;
+            packet.leftMeterData.heldLevel      = meterPacket->leftHeldLevel;
+            packet.leftMeterData.limiterActive  = meterPacket->limiterActive;
+            packet.rightMeterData.peakLevel     = meterPacket->rightPeakLevel;
+            packet.rightMeterData.heldLevel     = meterPacket->rightHeldLevel;
+            packet.rightMeterData.limiterActive = meterPacket->limiterActive;
+            packet.loudnessData.momentaryLoudness = meterPacket->momentaryLoudness;
+            packet.loudnessData.shortTermLoudness = meterPacket->shortTermLoudness;
+            packet.loudnessData.correlation       = meterPacket->correlation;
 
-            framesRemaining -= meterFrameCount;
-            offset += meterFrameCount;
+            HugStatusChannelPost(statusChannel, PacketTypeMeter, packetTime, &packet, sizeof(packet));
         }
         
         // Calculate danger level and send packet
         {
             uint64_t renderTime = HugGetCurrentHostTime() - userInfo->renderStart;
-            PacketDataDanger packet = { currentTime, PacketTypeDanger, inNumberFrames, renderTime };
-            sendStatusPacket(packet);
+            StatusDataDanger packet = { inNumberFrames, renderTime };
+            HugStatusChannelPost(statusChannel, PacketTypeDanger, currentTime, &packet, sizeof(packet));
         }
         
         return noErr;
     }];
 
+    // The output half of _renderChain, including the limiter
+    [nodeNames addObject:@"Output"];
+
+    // The previous graph may add a final callback before the swap below
+    HugRenderProfileReset(_renderProfile);
+    _renderNodeNames = profilesRender ? nodeNames : nil;
+
     AURenderPullInputBlock blockToSend = [graph renderBlock];
     
     if ([self _isRunning]) {
@@ -557,7 +828,7 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 
         NSInteger loopGuard = 0;
         while (1) {
-            HugRingBufferConfirmReadAll(_statusRingBuffer);
+            HugStatusChannelFlush(_statusChannel);
 
             if (blockToSend == atomic_load(&_renderUserInfo.renderBlock)) {
                 break;
@@ -597,16 +868,158 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
         [unit reset];
     }
     
-    if (_updateTimer) {
-        [_updateTimer invalidate];
-        _updateTimer = nil;
+    [self _stopStatusUpdates];
+}
+
+
+// Returns the preloaded source if it matches. If it is still priming,
+// outPrimingGroup is set to the group to wait on.
+//
+- (HugAudioSource *) _takePreloadedSourceForFile: (HugAudioFile *) file
+                                       startTime: (NSTimeInterval) startTime
+                                        stopTime: (NSTimeInterval) stopTime
+                                         padding: (NSTimeInterval) padding
+                                    primingGroup: (dispatch_group_t *) outPrimingGroup
+{
+    HugAudioSource  *source = _preloadSource;
+    dispatch_group_t group  = _preloadGroup;
+
+    if (!source) return nil;
+
+    BOOL matches = [[[source audioFile] fileURL] isEqual:[file fileURL]] &&
+                   ([source settings] == _outputSettings) &&
+                   (_preloadStartTime == startTime) &&
+                   (_preloadStopTime  == stopTime)  &&
+                   (_preloadPadding   == padding);
+
+    BOOL didFinish = _preloadDidFinish;
+
+    // Never wait here, priming can take seconds
+    BOOL didReturn = dispatch_group_wait(group, DISPATCH_TIME_NOW) == 0;
+
+    _preloadSource = nil;
+    _preloadGroup = nil;
+    _preloadDidFinish = NO;
+
+    if (!matches) {
+        HugLog(@"HugAudioEngine", @"Discarding preloaded %@", source);
+        [source cancel];
+        return nil;
+    }
+
+    if (!didReturn) {
+        HugLog(@"HugAudioEngine", @"Preloaded %@ is still priming", source);
+        *outPrimingGroup = group;
+        return source;
+    }
+
+    if (![source isPrepared]) {
+        HugLog(@"HugAudioEngine", @"Preloaded %@ failed to prepare: %@", source, [source error]);
+        return nil;
+    }
+
+    if (didFinish) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self _handleDidPrepareSource:source];
+        });
+    }
+
+    return source;
+}
+
+
+- (void) _cancelPendingSource
+{
+    [_pendingSource cancel];
+    _pendingSource = nil;
+    _pendingDidFinish = NO;
+}
+
+
+- (void) _handlePrimedPendingSource:(HugAudioSource *)source readyHandler:(void (^)(HugAudioSource *))readyHandler
+{
+    // Superseded by another play, a stop, or new settings
+    if (source != _pendingSource) return;
+
+    BOOL didFinish = _pendingDidFinish;
+
+    _pendingSource = nil;
+    _pendingDidFinish = NO;
+
+    if (![source isPrepared]) {
+        HugLog(@"HugAudioEngine", @"Preloaded %@ failed to prepare: %@", source, [source error]);
+        [self stopPlayback];
+        return;
+    }
+
+    HugLog(@"HugAudioEngine", @"Using preloaded %@ after priming", source);
+
+    readyHandler(source);
+
+    if (didFinish) {
+        [self _handleDidPrepareSource:source];
+    }
+}
+
+
+// Calls readyHandler with a prepared source before returning. If a matching
+// preload is still priming, it is called later on the main queue instead,
+// rather than blocking here or decoding the file twice.
+//
+- (BOOL) _makeSourceForFile: (HugAudioFile *) file
+                  startTime: (NSTimeInterval) startTime
+                   stopTime: (NSTimeInterval) stopTime
+                    padding: (NSTimeInterval) padding
+               readyHandler: (void (^)(HugAudioSource *source)) readyHandler
+{
+    [self _cancelPendingSource];
+
+    dispatch_group_t primingGroup = nil;
+    HugAudioSource *source = [self _takePreloadedSourceForFile:file startTime:startTime stopTime:stopTime padding:padding primingGroup:&primingGroup];
+
+    if (source && primingGroup) {
+        _pendingSource = source;
+
+        HugAuto weakSelf = self;
+        dispatch_group_notify(primingGroup, dispatch_get_main_queue(), ^{
+            [weakSelf _handlePrimedPendingSource:source readyHandler:readyHandler];
+        });
+
+        return YES;
+    }
+    
+    if (source) {
+        HugLog(@"HugAudioEngine", @"Using preloaded %@", source);
+
+    } else {
+        source = [[HugAudioSource alloc] initWithAudioFile:file settings:_outputSettings];
+
+        HugAuto weakSelf = self;
+        BOOL didPrepare = [source prepareWithStartTime:startTime stopTime:stopTime padding:padding completionHandler:^(HugAudioSource *inSource) {
+            [weakSelf _handleDidPrepareSource:inSource];
+        }];
+
+        if (!didPrepare) {
+            HugLog(@"HugAudioEngine", @"Couldn't prepare %@", source);
+            return NO;
+        }
     }
+
+    readyHandler(source);
+
+    return YES;
 }
 
 
 - (void) _handleDidPrepareSource:(HugAudioSource *)source
 {
-    if (source == _currentSource) {
+    if (source == _preloadSource) {
+        _preloadDidFinish = YES;
+
+    } else if (source == _pendingSource) {
+        _pendingDidFinish = YES;
+
+    } else if (source == _currentSource) {
         if ([source error]) {
             [self stopPlayback];
         } else {
@@ -616,9 +1029,11 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 }
 
 
-- (void) _handleUpdateTimer:(NSTimer *)timer
+- (void) _handleStatusUpdate
 {
-    [self _readRingBuffers];
+    atomic_store(&_statusUpdatePending, NO);
+
+    [self _readStatusChannel];
     if (_updateBlock) _updateBlock();
 }
 
@@ -627,6 +1042,10 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 
 - (BOOL) configureWithDeviceID:(AudioDeviceID)deviceID settings:(NSDictionary *)settings
 {
+    // Any preloaded source was prepared for the previous settings
+    [self cancelPreload];
+    [self _cancelPendingSource];
+
     // Listen for kAudioDeviceProcessorOverload
     {
         AudioObjectPropertyAddress overloadAddress = {
@@ -636,11 +1055,11 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
         };
 
         if (_outputDeviceID) {
-            AudioObjectRemovePropertyListener(_outputDeviceID, &overloadAddress, sHandleAudioDeviceOverload, (void *)_errorRingBuffer);
+            AudioObjectRemovePropertyListener(_outputDeviceID, &overloadAddress, sHandleAudioDeviceOverload, (void *)_errorChannel);
         }
         
         if (deviceID) {
-            AudioObjectAddPropertyListener(deviceID, &overloadAddress, sHandleAudioDeviceOverload, (void *)_errorRingBuffer);
+            AudioObjectAddPropertyListener(deviceID, &overloadAddress, sHandleAudioDeviceOverload, (void *)_errorChannel);
         }
     }
 
@@ -682,8 +1101,9 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
         sizeof(renderCallback)
     ), @"HugAudioEngine", @"AudioUnitSetProperty[ Output, SetRenderCallback ]");
 
-    _outputDeviceID = deviceID;
-    _outputSettings = settings;
+    _outputDeviceID   = deviceID;
+    _outputSettings   = settings;
+    _outputSampleRate = sampleRate;
 
     HugLog(@"HugAudioEngine", @"Configuring audio units with %lf sample rate, %ld frame size", sampleRate, (long)frames);
 
@@ -692,17 +1112,19 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
         @"HugAudioEngine", @"AudioUnitInitialize[ Output ]"
     );
 
-    HugLevelMeterSetSampleRate(_leftLevelMeter, sampleRate);
-    HugLevelMeterSetSampleRate(_rightLevelMeter, sampleRate);
-    HugLimiterSetSampleRate(_emergencyLimiter, sampleRate);
+    BOOL truePeakLimiter = [[settings objectForKey:HugAudioSettingTruePeakLimiter] boolValue];
 
-    HugLinearRamperSetMaxFrameCount(_preGainRamper, frames);
-    HugLinearRamperSetMaxFrameCount(_volumeRamper, frames);
-    HugStereoFieldSetMaxFrameCount(_stereoField, frames);
+    HugRenderChainSetLimiterMode(_renderChain, truePeakLimiter ?
+        HugRenderChainLimiterModeTruePeak :
+        HugRenderChainLimiterModeEmergency
+    );
 
-    size_t meterFrame = MIN(frames, 1024);
-    HugLevelMeterSetMaxFrameCount(_leftLevelMeter, meterFrame);
-    HugLevelMeterSetMaxFrameCount(_rightLevelMeter, meterFrame);
+    HugRenderChainConfigure(_renderChain, sampleRate, frames);
+    HugCrossfaderSetMaxFrameCount(_renderUserInfo.crossfader, frames);
+
+    if (truePeakLimiter) {
+        HugLog(@"HugAudioEngine", @"Using true-peak limiter, %ld frames latency", (long)HugRenderChainGetLatency(_renderChain));
+    }
 
     [self _reconnectGraph];
 
@@ -724,63 +1146,134 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 
     _playbackStatus = HugPlaybackStatusPreparing;
 
-    HugAudioSource *source = [[HugAudioSource alloc] initWithAudioFile:file settings:_outputSettings];
-    
     HugAuto weakSelf = self;
-    BOOL didPrepare = [source prepareWithStartTime:startTime stopTime:stopTime padding:padding completionHandler:^(HugAudioSource *inSource) {
-        [weakSelf _handleDidPrepareSource:inSource];
+
+    return [self _makeSourceForFile:file startTime:startTime stopTime:stopTime padding:padding readyHandler:^(HugAudioSource *source) {
+        [weakSelf _startPlaybackWithSource:source];
     }];
+}
 
-    if (!didPrepare) {
-        HugLog(@"HugAudioEngine", @"Couldn't prepare %@", source);
-        return NO;
-    }
-    
+
+- (void) _startPlaybackWithSource:(HugAudioSource *)source
+{
     [self _sendAudioSourceToRenderThread:source];
 
     HugLog(@"HugAudioEngine", @"setup complete, starting output");
 
     if (![self _isRunning]) {
+        [self _sendParameterValues];
+
         HugCheckError(
             AudioOutputUnitStart(_outputAudioUnit),
             @"HugAudioEngine", @"AudioOutputUnitStart"
         );
     }
 
-    if (!_updateTimer) {
-        _updateTimer = [NSTimer timerWithTimeInterval:(1.0/30.0) target:self selector:@selector(_handleUpdateTimer:) userInfo:nil repeats:YES];
-        [_updateTimer setTolerance:(1.0/60.0)];
+    [self _startStatusUpdates];
+
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(_reallyStopHardware) object:nil];
+}
+
+
+- (BOOL) playAudioFile: (HugAudioFile *) file
+             startTime: (NSTimeInterval) startTime
+              stopTime: (NSTimeInterval) stopTime
+               padding: (NSTimeInterval) padding
+     crossfadeDuration: (NSTimeInterval) crossfadeDuration
+        crossfadeCurve: (HugCrossfadeCurve) crossfadeCurve
+              hostTime: (UInt64) hostTime
+{
+    HugLogMethod();
 
-        [[NSRunLoop mainRunLoop] addTimer:_updateTimer forMode:NSRunLoopCommonModes];
-        [[NSRunLoop mainRunLoop] addTimer:_updateTimer forMode:NSEventTrackingRunLoopMode];
+    if (!_currentSource || (crossfadeDuration <= 0) || ![self _isRunning]) {
+        return [self playAudioFile:file startTime:startTime stopTime:stopTime padding:padding];
     }
 
-    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(_reallyStopHardware) object:nil];
+    HugAuto weakSelf = self;
+
+    // A hostTime which passed while priming starts the crossfade immediately
+    BOOL ok = [self _makeSourceForFile:file startTime:startTime stopTime:stopTime padding:padding readyHandler:^(HugAudioSource *source) {
+        [weakSelf _sendAudioSourceToRenderThread:source crossfadeDuration:crossfadeDuration curve:crossfadeCurve hostTime:hostTime];
+    }];
+
+    if (!ok) return NO;
+
+    _playbackStatus = HugPlaybackStatusPreparing;
+    _timeElapsed    = 0;
+    _timeRemaining  = 0;
 
     return YES;
 }
 
 
+- (void) preloadAudioFile: (HugAudioFile *) file
+                startTime: (NSTimeInterval) startTime
+                 stopTime: (NSTimeInterval) stopTime
+                  padding: (NSTimeInterval) padding
+{
+    HugLogMethod();
+
+    [self cancelPreload];
+
+    if (!_outputSettings) return;
+
+    HugAudioSource *source = [[HugAudioSource alloc] initWithAudioFile:file settings:_outputSettings];
+
+    _preloadSource    = source;
+    _preloadStartTime = startTime;
+    _preloadStopTime  = stopTime;
+    _preloadPadding   = padding;
+    _preloadDidFinish = NO;
+    _preloadGroup     = dispatch_group_create();
+
+    HugAuto weakSelf = self;
+
+    dispatch_group_async(_preloadGroup, _preloadQueue, ^{
+        BOOL didPrepare = [source prepareWithStartTime:startTime stopTime:stopTime padding:padding completionHandler:^(HugAudioSource *inSource) {
+            [weakSelf _handleDidPrepareSource:inSource];
+        }];
+
+        if (!didPrepare) {
+            HugLog(@"HugAudioEngine", @"Couldn't preload %@", source);
+        }
+    });
+}
+
+
+- (void) cancelPreload
+{
+    [_preloadSource cancel];
+
+    _preloadSource = nil;
+    _preloadGroup = nil;
+    _preloadDidFinish = NO;
+}
+
+
 - (void) stopPlayback
 {
     _HugCrashPadEnabled = NO;
 
+    [self _cancelPendingSource];
+
     if ([self _isRunning]) {
         [self _sendAudioSourceToRenderThread:nil];
         [self performSelector:@selector(_reallyStopHardware) withObject:nil afterDelay:30];
     }
 
-    HugRingBufferConfirmReadAll(_statusRingBuffer);
+    HugStatusChannelFlush(_statusChannel);
 
-    HugLevelMeterReset(_leftLevelMeter);
-    HugLevelMeterReset(_rightLevelMeter);
+    HugRenderChainResetMeters(_renderChain);
     
     _playbackStatus = HugPlaybackStatusStopped;
     _timeElapsed    = 0;
     _timeRemaining  = 0;
     _leftMeterData  = nil;
     _rightMeterData = nil;
+    _loudnessData   = nil;
     _dangerLevel    = 0;
+
+    _hasMeterSnapshot = NO;
 }
 
 
@@ -791,27 +1284,70 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 }
 
 
+- (void) _sendParameterValues
+{
+    for (NSInteger i = 0; i < HugAutomationParameterCount; i++) {
+        HugAutomationEvent event = { 0, 0, _parameterValues[i], i, HugAutomationCurveLinear };
+        HugAutomationSchedule(_renderUserInfo.automation, &event);
+    }
+}
+
+
+- (void) scheduleParameter: (HugAutomationParameter) parameter
+                     value: (float) value
+                  hostTime: (UInt64) hostTime
+                  duration: (NSTimeInterval) duration
+                     curve: (HugAutomationCurve) curve
+{
+    if (parameter < 0 || parameter >= HugAutomationParameterCount) return;
+
+    _parameterValues[parameter] = value;
+
+    // Nothing drains the queue while stopped, -_sendParameterValues
+    // catches up when the output starts.
+    if (![self _isRunning]) return;
+
+    HugAutomationEvent event = {
+        hostTime,
+        HugGetHostTimeWithSeconds(MAX(duration, 0)),
+        value,
+        parameter,
+        curve
+    };
+
+    if (!HugAutomationSchedule(_renderUserInfo.automation, &event)) {
+        HugLog(@"HugAudioEngine", @"Automation queue is full, dropping event for parameter %ld", (long)parameter);
+    }
+}
+
+
+- (void) _updateParameter:(HugAutomationParameter)parameter value:(float)value
+{
+    [self scheduleParameter:parameter value:value hostTime:0 duration:sParameterRampDuration curve:HugAutomationCurveLinear];
+}
+
+
 - (void) updateStereoWidth:(float)stereoWidth
 {
-    _renderUserInfo.stereoWidth = stereoWidth;
+    [self _updateParameter:HugAutomationParameterStereoWidth value:stereoWidth];
 }
 
 
 - (void) updateStereoBalance:(float)stereoBalance
 {
-    _renderUserInfo.stereoBalance = stereoBalance;
+    [self _updateParameter:HugAutomationParameterStereoBalance value:stereoBalance];
 }
 
 
 - (void) updatePreGain:(float)preGain
 {
-    _renderUserInfo.preGain = preGain;
+    [self _updateParameter:HugAutomationParameterPreGain value:preGain];
 }
 
 
 - (void) updateVolume:(float)volume
 {
-    _renderUserInfo.volume = volume;
+    [self _updateParameter:HugAutomationParameterVolume value:volume];
 }
 
 
@@ -843,4 +1379,61 @@ static OSStatus sHandleAudioDeviceOverload(AudioObjectID inObjectID, UInt32 inNu
 }
 
 
+
+#pragma mark - Accessors
+
+- (HugMeterData *) leftMeterData
+{
+    if (!_leftMeterData && _hasMeterSnapshot) {
+        _leftMeterData = [[HugMeterData alloc] initWithStruct:_meterSnapshot.leftMeterData];
+    }
+
+    return _leftMeterData;
+}
+
+
+- (HugMeterData *) rightMeterData
+{
+    if (!_rightMeterData && _hasMeterSnapshot) {
+        _rightMeterData = [[HugMeterData alloc] initWithStruct:_meterSnapshot.rightMeterData];
+    }
+
+    return _rightMeterData;
+}
+
+
+- (HugLoudnessData *) loudnessData
+{
+    if (!_loudnessData && _hasMeterSnapshot) {
+        _loudnessData = [[HugLoudnessData alloc] initWithStruct:_meterSnapshot.loudnessData];
+    }
+
+    return _loudnessData;
+}
+
+
+- (NSArray<NSString *> *) renderNodeNames
+{
+    return _renderNodeNames;
+}
+
+
+- (HugRenderProfileStatistics) renderStatisticsForNodeAtIndex:(NSInteger)index
+{
+    HugRenderProfileStatistics result = {0};
+
+    if (index >= 0 && index < (NSInteger)[_renderNodeNames count]) {
+        result = HugRenderProfileGetStatistics(_renderProfile, index);
+    }
+
+    return result;
+}
+
+
+- (void) resetRenderStatistics
+{
+    HugRenderProfileReset(_renderProfile);
+}
+
+
 @end
@@ -24,4 +24,8 @@
 @property (nonatomic, readonly) NSURL *fileURL;
 @property (nonatomic, readonly) NSError *error;
 
+// A HugPCMFile of this file's audio. If it matches the output format,
+// HugAudioSource maps it rather than decoding.
+@property (nonatomic) NSURL *decodedFileURL;
+
 @end
@@ -4,6 +4,7 @@
 #import "HugAudioFile.h"
 #import "HugUtils.h"
 #import "HugError.h"
+#import "HugDecoder.h"
 
 #import <AVFoundation/AVFoundation.h>
 
@@ -17,7 +18,7 @@ static NSError *sMakeError(NSInteger code)
 @implementation HugAudioFile {
     NSURL *_fileURL;
     NSURL *_exportedURL;
-    ExtAudioFileRef _extAudioFile;
+    HugDecoder *_decoder;
 }
 
 
@@ -56,69 +57,23 @@ static NSError *sMakeError(NSInteger code)
 
 #pragma mark - Private Methods
 
-- (BOOL) _reopenAudioFileWithURL:(NSURL *)url
+- (BOOL) _openDecoderWithURL:(NSURL *)url backend:(const HugDecoderBackend *)backend
 {
-    AudioStreamBasicDescription fileDataFormat   = {0};
-    AudioStreamBasicDescription clientDataFormat = {0};
-    
-    BOOL ok = YES;
-
-    if (ok) {
-        ok = [self _getClientDataFormat:&clientDataFormat];
-    }
-
     [self close];
 
-    if (ok) {
-        OSStatus err = ExtAudioFileOpenURL((__bridge CFURLRef)_exportedURL, &_extAudioFile);
-
-        if (err != noErr) {
-            HugLog(@"HugAudioFile", @"%@, ExtAudioFileOpenURL() failed %ld", self, (long)err);
-            ok = NO;
-        }
-    }
-    
-    if (ok) ok = [self _setClientDataFormat:&clientDataFormat];
-    if (ok) ok = [self _getFileDataFormat:&fileDataFormat];
-
-    if (!ok) HugLog(@"HugAudioFile", @"-_reopenAudioFileWithURL: failed");
-
-    return ok;
-}
-
-
-- (BOOL) _canRead
-{
-    SInt64 fileLengthFrames = 0;
-    if (![self _getFileLengthFrames:&fileLengthFrames]) return NO;
-    
-    AudioStreamBasicDescription clientDataFormat = {0};
-    if (![self _getClientDataFormat:&clientDataFormat]) return NO;
-
-    UInt32 channelCount = clientDataFormat.mChannelsPerFrame;
-    if (!channelCount) return NO;
+    const char *path = [[url path] fileSystemRepresentation];
+    if (!path) return NO;
 
-    UInt32 framesToRead = 1024;
-    AudioBufferList *bufferList = HugAudioBufferListCreate(channelCount, framesToRead, YES);
-    
-    OSStatus err = noErr;
+    _decoder = backend ? HugDecoderOpenWithBackend(path, backend) : HugDecoderOpen(path);
 
-    SInt64 frameOffset = 0;
-    if (err == noErr) {
-        err = ExtAudioFileTell(_extAudioFile, &frameOffset);
+    if (!_decoder) {
+        HugLog(@"HugAudioFile", @"%@, no decoder for %@", self, url);
+        return NO;
     }
 
-    if (err == noErr) {
-        err = ExtAudioFileRead(_extAudioFile, &framesToRead, bufferList);
-    }
-    
-    if (err == noErr) {
-        err = ExtAudioFileSeek(_extAudioFile, frameOffset);
-    }
-    
-    HugAudioBufferListFree(bufferList, YES);
+    HugLog(@"HugAudioFile", @"%@, decoding with %s", self, HugDecoderGetBackend(_decoder)->name);
 
-    return err == noErr;
+    return YES;
 }
 
 
@@ -187,63 +142,7 @@ static NSError *sMakeError(NSInteger code)
         return NO;
     }
     
-    return [self _reopenAudioFileWithURL:_exportedURL];
-}
-
-
-- (BOOL) _getFileDataFormat:(AudioStreamBasicDescription *)fileDataFormat
-{
-    UInt32 size = sizeof(AudioStreamBasicDescription);
-    OSStatus err = ExtAudioFileGetProperty(_extAudioFile, kExtAudioFileProperty_FileDataFormat, &size, fileDataFormat);
-
-    if (err != noErr) {
-        HugLog(@"HugAudioFile", @"%@, -getFileDataFormat: error %ld", self, (long)err);
-        return NO;
-    }
-
-    return YES;
-}
-
-
-- (BOOL) _getFileLengthFrames:(SInt64 *)fileLengthFrames
-{
-    UInt32 size = sizeof(SInt64);
-    OSStatus err = ExtAudioFileGetProperty(_extAudioFile, kExtAudioFileProperty_FileLengthFrames, &size, fileLengthFrames);
-
-    if (err != noErr) {
-        HugLog(@"HugAudioFile", @"%@, -getFileLengthFrames: error %ld", self, (long)err);
-        return NO;
-    }
-
-    return YES;
-}
-
-
-- (BOOL) _setClientDataFormat:(AudioStreamBasicDescription *)clientDataFormat
-{
-    UInt32 size = sizeof(AudioStreamBasicDescription);
-    OSStatus err = ExtAudioFileSetProperty(_extAudioFile, kExtAudioFileProperty_ClientDataFormat, size, clientDataFormat);
-
-    if (err != noErr) {
-        HugLog(@"HugAudioFile", @"%@, -setClientDataFormat: error %ld", self, (long)err);
-        return NO;
-    }
-
-    return YES;
-}
-
-
-- (BOOL) _getClientDataFormat:(AudioStreamBasicDescription *)clientDataFormat
-{
-    UInt32 size = sizeof(AudioStreamBasicDescription);
-    OSStatus err = ExtAudioFileGetProperty(_extAudioFile, kExtAudioFileProperty_ClientDataFormat, &size, clientDataFormat);
-    
-    if (err != noErr) {
-        HugLog(@"HugAudioFile", @"%@, -getClientDataFormat: returned %ld", self, (long)err);
-        return NO;
-    }
-
-    return YES;
+    return [self _openDecoderWithURL:_exportedURL backend:&HugDecoderBackendExtAudioFile];
 }
 
 
@@ -251,51 +150,32 @@ static NSError *sMakeError(NSInteger code)
 
 - (BOOL) open
 {
-    if (_extAudioFile) {
+    if (_decoder) {
         return !_error;
     }
 
     _error = sMakeError(HugErrorOpenFailed);
-    
-    OSStatus openErr = ExtAudioFileOpenURL((__bridge CFURLRef)_fileURL, &_extAudioFile);
-    if (openErr != noErr) {
-        HugLog(@"HugAudioFile", @"ExtAudioFileOpenURL() returned %ld", (long)openErr);
-        return NO;
-    }
 
-    AudioStreamBasicDescription fileDataFormat = {0};
-    
-    if (![self _getFileDataFormat:&fileDataFormat]) {
+    if (![self _openDecoderWithURL:_fileURL backend:NULL] && ![self _convert]) {
         return NO;
     }
-    
+
+    HugDecoderInfo info = HugDecoderGetInfo(_decoder);
+
     AudioStreamBasicDescription clientDataFormat = {
-        fileDataFormat.mSampleRate,
+        info.sampleRate,
         kAudioFormatLinearPCM,
         kAudioFormatFlagsNativeFloatPacked | kAudioFormatFlagIsNonInterleaved,
         /* mBytesPerPacket   */  sizeof(float),             
         /* mFramesPerPacket  */  1, 
         /* mBytesPerFrame    */  sizeof(float),
-        /* mChannelsPerFrame */  fileDataFormat.mChannelsPerFrame,
+        /* mChannelsPerFrame */  info.channelCount,
         /* mBitsPerChannel   */  sizeof(float) * 8,
         0
     };
 
-    if (![self _setClientDataFormat:&clientDataFormat]) {
-        return NO;
-    }
-    
-    if (![self _canRead] && ![self _convert] && ![self _canRead]) {
-        return NO;
-    }
-    
-    SInt64 fileLengthFrames = 0;
-    if (![self _getFileLengthFrames:&fileLengthFrames]) {
-        return NO;
-    }
-
     _error            = nil;
-    _fileLengthFrames = fileLengthFrames;
+    _fileLengthFrames = info.frameCount;
     _format           = clientDataFormat;
 
     return YES;
@@ -304,9 +184,9 @@ static NSError *sMakeError(NSInteger code)
 
 - (void) close
 {
-    if (_extAudioFile) {
-        ExtAudioFileDispose(_extAudioFile);
-        _extAudioFile = NULL;
+    if (_decoder) {
+        HugDecoderClose(_decoder);
+        _decoder = NULL;
     }
 }
 
@@ -315,14 +195,34 @@ static NSError *sMakeError(NSInteger code)
 {
     if (_error) return NO;
 
-    OSStatus err = ExtAudioFileRead(_extAudioFile, ioNumberFrames, bufferList);
+    UInt32 channelCount = _format.mChannelsPerFrame;
+    size_t frameCount = *ioNumberFrames;
 
-    if (err != noErr) {
-        HugLog(@"HugAudioFile", @"%@, -readFrames:intoBufferList: error %ld", self, (long)err);
+    if (bufferList->mNumberBuffers < channelCount) {
+        HugLog(@"HugAudioFile", @"%@, -readFrames:intoBufferList: %ld buffers for %ld channels", self, (long)bufferList->mNumberBuffers, (long)channelCount);
         _error = sMakeError(HugErrorReadFailed);
         return NO;
     }
 
+    float *channels[channelCount];
+
+    for (UInt32 i = 0; i < channelCount; i++) {
+        channels[i] = bufferList->mBuffers[i].mData;
+        frameCount = MIN(frameCount, bufferList->mBuffers[i].mDataByteSize / sizeof(float));
+    }
+
+    if (!HugDecoderRead(_decoder, channels, &frameCount)) {
+        HugLog(@"HugAudioFile", @"%@, -readFrames:intoBufferList: %s failed", self, HugDecoderGetBackend(_decoder)->name);
+        _error = sMakeError(HugErrorReadFailed);
+        return NO;
+    }
+
+    for (UInt32 i = 0; i < channelCount; i++) {
+        bufferList->mBuffers[i].mDataByteSize = (UInt32)(frameCount * sizeof(float));
+    }
+
+    *ioNumberFrames = (UInt32)frameCount;
+
     return YES;
 }
 
@@ -331,10 +231,8 @@ static NSError *sMakeError(NSInteger code)
 {
     if (_error) return NO;
 
-    OSStatus err = ExtAudioFileSeek(_extAudioFile, startFrame);
-    
-    if (err != noErr) {
-        HugLog(@"HugAudioFile", @"%@, -seekToFrame: error %ld", self, (long)err);
+    if (!HugDecoderSeek(_decoder, startFrame)) {
+        HugLog(@"HugAudioFile", @"%@, -seekToFrame: %s failed", self, HugDecoderGetBackend(_decoder)->name);
         _error = sMakeError(HugErrorReadFailed);
         return NO;
     }
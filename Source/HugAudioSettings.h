@@ -11,10 +11,28 @@ extern HugAudioSettings const HugAudioSettingSampleRate;
 // NSNumber, the desired value of kAudioDevicePropertyBufferFrameSize.
 extern HugAudioSettings const HugAudioSettingFrameSize;
 
+// NSNumber, in seconds. If non-zero, HugAudioSource decodes into a window of this
+// duration ahead of the play head rather than decoding the entire track up front.
+extern HugAudioSettings const HugAudioSettingStreamingBufferDuration;
+
 // If @YES, Hug attempts to take exclusive access of the device (Hog Mode) upon playback.
 extern HugAudioSettings const HugAudioSettingTakeExclusiveAccess;
 
 // If @YES, the device is reset to the maximum volume upon playback.
 extern HugAudioSettings const HugAudioSettingResetDeviceVolume;
 
+// If @YES, the output limiter uses lookahead true-peak detection, which
+// holds a fixed ceiling at the cost of a short delay.
+extern HugAudioSettings const HugAudioSettingTruePeakLimiter;
+
+// NSNumber, a HugResamplerQuality used when the file's sampling rate differs
+// from HugAudioSettingSampleRate. Defaults to HugResamplerQualityHigh.
+extern HugAudioSettings const HugAudioSettingResamplerQuality;
+
+// If @YES, HugAudioSource resamples as it decodes, rather than in the render callback.
+extern HugAudioSettings const HugAudioSettingResampleWhileDecoding;
+
 
+// If @YES, HugAudioEngine times each node of its render graph for
+// -renderStatisticsForNodeAtIndex:. Otherwise the graph is built without timing.
+extern HugAudioSettings const HugAudioSettingRenderProfiling;
@@ -5,6 +5,10 @@
 
 HugAudioSettings const HugAudioSettingSampleRate = @"SampleRate";
 HugAudioSettings const HugAudioSettingFrameSize = @"FrameSize";
+HugAudioSettings const HugAudioSettingStreamingBufferDuration = @"StreamingBufferDuration";
 HugAudioSettings const HugAudioSettingTakeExclusiveAccess = @"TakeExclusiveAccess";
 HugAudioSettings const HugAudioSettingResetDeviceVolume = @"ResetDeviceVolume";
-
+HugAudioSettings const HugAudioSettingTruePeakLimiter = @"TruePeakLimiter";
+HugAudioSettings const HugAudioSettingResamplerQuality = @"ResamplerQuality";
+HugAudioSettings const HugAudioSettingResampleWhileDecoding = @"ResampleWhileDecoding";
+HugAudioSettings const HugAudioSettingRenderProfiling = @"RenderProfiling";
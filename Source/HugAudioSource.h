@@ -37,17 +37,34 @@ typedef void (^HugAudioSourceCompletionHandler)(HugAudioSource *source);
 // Primes the audio buffer. If this returns YES, completionHandler will be invoked
 // after the buffer is completely prepared.
 //
+// This may block for several seconds and may be called from a background queue.
+// completionHandler is always invoked on the main queue.
+//
 - (BOOL) prepareWithStartTime: (NSTimeInterval) startTime
                      stopTime: (NSTimeInterval) stopTime
                       padding: (NSTimeInterval) padding
             completionHandler: (HugAudioSourceCompletionHandler) completionHandler;
 
+// Stops decoding as soon as possible, for a source which won't be played.
+// May be called from any thread, before or during -prepareWithStartTime:...
+//
+- (void) cancel;
+
 @property (nonatomic, readonly) HugAudioFile *audioFile;
 @property (nonatomic, readonly) NSDictionary *settings;
 
 @property (nonatomic, readonly) NSError *error;
 
+// YES once -prepareWithStartTime:... has returned YES
+@property (nonatomic, readonly, getter=isPrepared) BOOL prepared;
+
 @property (nonatomic, readonly) HugAudioSourceInputBlock inputBlock;
 
+// YES if HugAudioSettingStreamingBufferDuration caused a windowed decode
+@property (nonatomic, readonly, getter=isStreaming) BOOL streaming;
+
+// Number of render callbacks which ran out of decoded audio. Streaming only.
+@property (nonatomic, readonly) NSInteger underrunCount;
+
 @end
 
@@ -4,28 +4,111 @@
 #import "HugAudioSource.h"
 
 #import "HugAudioFile.h"
+#import "HugPCMFile.h"
 #import "HugProtectedBuffer.h"
+#import "HugRingBuffer.h"
 #import "HugError.h"
 #import "HugUtils.h"
 #import "HugAudioSettings.h"
 #import "HugDebugFile.h"
+#import "HugResampler.h"
+#import "HugPCMMap.h"
+
+#include <stdatomic.h>
 
 #define DEBUG_AUDIO_SOURCE_BUFFERS 0
 
+// When streaming and the window is full, the decoder sleeps until the render
+// thread consumes frames. This timeout only bounds the wait if a wakeup is lost.
+static const NSTimeInterval sStreamingWaitTimeout = 0.25;
+
+// When streaming, the decoder waits until at least this many frames are free
+static const NSInteger sStreamingMinimumChunk = 4096;
+
+// Largest read from the file in one call
+static const UInt32 sDecodeChunkFrames = 32768;
+
+// When playing a HugPCMFile or HugPCMMap, this much audio is kept wired behind the play head.
+// The window ahead is HugAudioSettingStreamingBufferDuration, or 30 seconds.
+static const NSTimeInterval sWiredDurationBehind = 2.0;
+static const NSTimeInterval sDefaultWiredDurationAhead = 30.0;
+static const NSTimeInterval sWiringInterval = 1.0;
+
+// Returned from the input block, and reported through the engine's error channel,
+// when the resampler doesn't take every frame read from the source
+static const OSStatus sResamplerDroppedInputError = 'rsdi';
+
 typedef struct {
     NSInteger frameIndex;
     NSInteger totalFrames;
     double sampleRate;
+    UInt32 channelCount;
+
+    // Either bufferList (entire track), ringBuffers (streaming window), or
+    // pcmMap (uncompressed file, converted while rendering) is used.
+    // bufferList points into a HugPCMFile when playing decoded audio.
     AudioBufferList *bufferList;
+    HugRingBuffer  **ringBuffers;
+    HugPCMMap       *pcmMap;
+    NSInteger        pcmMapStartFrame;
+
+    atomic_bool streamingCancelled;
+    atomic_long underrunCount;
+
+    // The decoder sets streamingWaiting and sleeps on streamingSemaphore when
+    // the window is full. The render thread signals only if it is set.
+    __unsafe_unretained dispatch_semaphore_t streamingSemaphore;
+    atomic_bool streamingWaiting;
 
     AudioBufferList *inputScratch;
     UInt32           inputScratchFrameSize;
 
     AudioBufferList *converterScratch;
     UInt32           converterScratchFrameSize;
+
+    // Resampling in the render callback
+    HugResampler    *resampler;
+    AudioBufferList *resamplerScratch;
+    UInt32           resamplerChunkFrames;
+    const float    **resamplerInputs;
+    float          **resamplerOutputs;
+    NSInteger        resamplerFrameIndex;  // At the output rate
+    NSInteger        resamplerTotalFrames; // Including padding and the filter's tail
+
+    // Resampling while decoding, used by the decoder thread only. When set,
+    // sampleRate, totalFrames, and the buffers are at the output rate.
+    HugResampler    *decodeResampler;
+    AudioBufferList *decodeScratch;
+    NSInteger        decodeFramesRemaining; // At the file's rate
 } RenderContext;
 
 
+static NSInteger sGetStreamingFramesAvailable(RenderContext *context)
+{
+    size_t bytesAvailable = SIZE_MAX;
+
+    for (NSInteger b = 0; b < context->channelCount; b++) {
+        size_t available = HugRingBufferGetReadAvailable(context->ringBuffers[b]);
+        if (available < bytesAvailable) bytesAvailable = available;
+    }
+
+    return bytesAvailable / sizeof(float);
+}
+
+
+static NSInteger sGetStreamingFramesWritable(RenderContext *context)
+{
+    size_t bytesWritable = SIZE_MAX;
+
+    for (NSInteger b = 0; b < context->channelCount; b++) {
+        size_t writable = HugRingBufferGetWriteAvailable(context->ringBuffers[b]);
+        if (writable < bytesWritable) bytesWritable = writable;
+    }
+
+    return bytesWritable / sizeof(float);
+}
+
+
 static void sFillBufferList(RenderContext *context, UInt32 rawFrameCount, AudioBufferList *ioData)
 {
     NSInteger frameCount = rawFrameCount;
@@ -49,27 +132,200 @@ static void sFillBufferList(RenderContext *context, UInt32 rawFrameCount, AudioB
     // Copy track data
     {
         NSUInteger framesToCopy = MIN(frameCount - offset, context->totalFrames - context->frameIndex);
+
+        // If the decoder hasn't kept up, play what we have and pad with silence.
+        // frameIndex only advances by the frames actually copied.
+        //
+        if (context->ringBuffers) {
+            NSInteger framesAvailable = sGetStreamingFramesAvailable(context);
+
+            if (framesAvailable < framesToCopy) {
+                framesToCopy = framesAvailable;
+                atomic_fetch_add_explicit(&context->underrunCount, 1, memory_order_relaxed);
+            }
+        }
+
         NSInteger framesRemaining = (frameCount - offset) - framesToCopy;
 
+        if (context->pcmMap) {
+            float *outputs[bufferCount];
+
+            for (NSInteger b = 0; b < bufferCount; b++) {
+                outputs[b] = (float *)ioData->mBuffers[b].mData + offset;
+            }
+
+            HugPCMMapRead(context->pcmMap, outputs, context->pcmMapStartFrame + context->frameIndex, framesToCopy);
+        }
+
         for (NSInteger b = 0; b < bufferCount; b++) {
-            float *inSamples  = (float *)context->bufferList->mBuffers[b].mData;
             float *outSamples = (float *)ioData->mBuffers[b].mData;
-            
-            inSamples  += context->frameIndex;
             outSamples += offset;
 
-            memcpy(outSamples, inSamples, sizeof(float) * framesToCopy);
-            
+            if (context->ringBuffers) {
+                float *inSamples = HugRingBufferGetReadPtr(context->ringBuffers[b], sizeof(float) * framesToCopy);
+                memcpy(outSamples, inSamples, sizeof(float) * framesToCopy);
+
+            } else if (context->bufferList) {
+                float *inSamples = (float *)context->bufferList->mBuffers[b].mData;
+                memcpy(outSamples, inSamples + context->frameIndex, sizeof(float) * framesToCopy);
+            }
+
             if (framesRemaining > 0) {
                 memset(&outSamples[framesToCopy], 0, sizeof(float) * framesRemaining);
             }
+
+            if (context->ringBuffers) {
+                HugRingBufferConfirmRead(context->ringBuffers[b], sizeof(float) * framesToCopy);
+            }
         }
 
         context->frameIndex += framesToCopy;
+
+        // Wake the decoder now that there is room. The fence orders the read
+        // index stores above before the load of streamingWaiting.
+        //
+        if (context->ringBuffers && framesToCopy) {
+            atomic_thread_fence(memory_order_seq_cst);
+
+            if (atomic_exchange_explicit(&context->streamingWaiting, false, memory_order_relaxed)) {
+                dispatch_semaphore_signal(context->streamingSemaphore);
+            }
+        }
     }
 }
 
 
+// Past the end of the track, sFillBufferList() pads with silence, which
+// flushes the filter's lookahead.
+//
+static OSStatus sFillBufferListResampled(RenderContext *context, UInt32 frameCount, AudioBufferList *ioData)
+{
+    HugResampler    *resampler = context->resampler;
+    AudioBufferList *scratch   = context->resamplerScratch;
+    UInt32 written = 0;
+    OSStatus result = noErr;
+
+    while (written < frameCount) {
+        UInt32 outputFrames = MIN(frameCount - written, context->resamplerChunkFrames);
+        UInt32 inputFrames  = (UInt32)HugResamplerGetInputFrameCount(resampler, outputFrames);
+
+        sFillBufferList(context, inputFrames, scratch);
+
+        for (NSInteger b = 0; b < scratch->mNumberBuffers; b++) {
+            context->resamplerInputs[b]  = scratch->mBuffers[b].mData;
+            context->resamplerOutputs[b] = (float *)ioData->mBuffers[b].mData + written;
+        }
+
+        // The frames were already taken from the source, so all of them must be used
+        size_t inputUsed = inputFrames;
+        size_t processed = HugResamplerProcess(resampler, context->resamplerInputs, &inputUsed, context->resamplerOutputs, outputFrames);
+        if (inputUsed != inputFrames) result = sResamplerDroppedInputError;
+
+        if (!processed) break;
+
+        written += processed;
+    }
+
+    context->resamplerFrameIndex += written;
+
+    return result;
+}
+
+
+// The filter's output lags its input, so the track ends after the tail is rendered
+static BOOL sIsDrainingResampler(RenderContext *context)
+{
+    return context->resampler && (context->resamplerFrameIndex < context->resamplerTotalFrames);
+}
+
+
+// Mirrors -[HugAudioFile readFrames:intoBufferList:], resampling when
+// decodeResampler is set. After the end of the file, the filter is flushed
+// with silence.
+//
+static BOOL sReadFrames(HugAudioFile *audioFile, RenderContext *context, UInt32 *ioFrameCount, AudioBufferList *bufferList)
+{
+    HugResampler *resampler = context->decodeResampler;
+    if (!resampler) return [audioFile readFrames:ioFrameCount intoBufferList:bufferList];
+
+    AudioBufferList *scratch = context->decodeScratch;
+    UInt32 bufferCount = scratch->mNumberBuffers;
+    UInt32 frameCount = *ioFrameCount;
+    UInt32 written = 0;
+
+    float *scratchData[bufferCount];
+    const float *inputs[bufferCount];
+    float *outputs[bufferCount];
+
+    for (NSInteger b = 0; b < bufferCount; b++) {
+        scratchData[b] = scratch->mBuffers[b].mData;
+    }
+
+    BOOL ok = YES;
+
+    while (ok && (written < frameCount)) {
+        UInt32 outputFrames = frameCount - written;
+        UInt32 inputFrames  = (UInt32)MIN(HugResamplerGetInputFrameCount(resampler, outputFrames), sDecodeChunkFrames);
+        UInt32 readFrames   = 0;
+
+        // Reads may return fewer frames than asked for. Keep reading until the
+        // chunk is full, so that silence is only fed to the resampler at the end.
+        //
+        while ((readFrames < inputFrames) && (context->decodeFramesRemaining > 0)) {
+            UInt32 chunkFrames = (UInt32)MIN(inputFrames - readFrames, context->decodeFramesRemaining);
+
+            for (NSInteger b = 0; b < bufferCount; b++) {
+                scratch->mBuffers[b].mData = scratchData[b] + readFrames;
+                scratch->mBuffers[b].mDataByteSize = chunkFrames * sizeof(float);
+            }
+
+            if (![audioFile readFrames:&chunkFrames intoBufferList:scratch]) {
+                ok = NO;
+                break;
+            }
+
+            // End of file, even if fileLengthFrames disagreed
+            if (chunkFrames == 0) context->decodeFramesRemaining = 0;
+
+            context->decodeFramesRemaining -= MIN(chunkFrames, context->decodeFramesRemaining);
+            readFrames += chunkFrames;
+        }
+
+        for (NSInteger b = 0; b < bufferCount; b++) {
+            scratch->mBuffers[b].mData = scratchData[b];
+            scratch->mBuffers[b].mDataByteSize = sDecodeChunkFrames * sizeof(float);
+        }
+
+        if (!ok) break;
+
+        // Past the end of the file, flush the filter with silence
+        for (NSInteger b = 0; b < bufferCount; b++) {
+            memset(scratchData[b] + readFrames, 0, (inputFrames - readFrames) * sizeof(float));
+
+            inputs[b]  = scratchData[b];
+            outputs[b] = (float *)bufferList->mBuffers[b].mData + written;
+        }
+
+        size_t inputUsed = inputFrames;
+        size_t processed = HugResamplerProcess(resampler, inputs, &inputUsed, outputs, outputFrames);
+
+        if (inputUsed != inputFrames) {
+            HugLog(@"HugAudioSource", @"%@ resampler dropped %ld input frames", audioFile, (long)(inputFrames - inputUsed));
+            ok = NO;
+            break;
+        }
+
+        if (!processed) break;
+
+        written += processed;
+    }
+
+    *ioFrameCount = written;
+
+    return ok;
+}
+
+
 static OSStatus sConverterInputCallback(
     AudioConverterRef inAudioConverter,
     UInt32 *ioNumberDataPackets,
@@ -104,8 +360,16 @@ static OSStatus sConverterInputCallback(
     AudioConverterRef _converter;
     RenderContext *_context;
     NSArray<HugProtectedBuffer *> *_protectedBuffers;
+    dispatch_group_t _streamingGroup;
+    dispatch_semaphore_t _streamingSemaphore;
+
+    HugPCMFile *_decodedFile;
+    NSInteger _decodedFileStartFrame;
+    dispatch_queue_t _wiringQueue;
+    dispatch_source_t _wiringTimer;
     
     HugAudioSourceCompletionHandler _completionHandler;
+    atomic_bool _cancelled;
 }
 
 
@@ -122,6 +386,21 @@ static OSStatus sConverterInputCallback(
 
 - (void) dealloc
 {
+    // Stop the streaming decoder before tearing down the ring buffers and file
+    if (_streamingGroup) {
+        atomic_store(&_context->streamingCancelled, true);
+        dispatch_semaphore_signal(_streamingSemaphore);
+        dispatch_group_wait(_streamingGroup, DISPATCH_TIME_FOREVER);
+    }
+
+    // Wait for any wiring in progress before unmapping
+    if (_wiringTimer) {
+        dispatch_source_cancel(_wiringTimer);
+        dispatch_sync(_wiringQueue, ^{ });
+    }
+
+    [_decodedFile close];
+
     if (_converter) {
         AudioConverterDispose(_converter);
         _converter = NULL;
@@ -138,6 +417,26 @@ static OSStatus sConverterInputCallback(
 
         HugAudioBufferListFree(_context->inputScratch, YES);
         _context->inputScratch = NULL;
+
+        HugResamplerFree(_context->resampler);
+        HugAudioBufferListFree(_context->resamplerScratch, YES);
+        free(_context->resamplerInputs);
+        free(_context->resamplerOutputs);
+
+        HugResamplerFree(_context->decodeResampler);
+        HugAudioBufferListFree(_context->decodeScratch, YES);
+
+        HugPCMMapFree(_context->pcmMap);
+        _context->pcmMap = NULL;
+
+        if (_context->ringBuffers) {
+            for (NSInteger i = 0; i < _context->channelCount; i++) {
+                HugRingBufferFree(_context->ringBuffers[i]);
+            }
+
+            free(_context->ringBuffers);
+            _context->ringBuffers = NULL;
+        }
         
         free(_context);
     }
@@ -146,6 +445,74 @@ static OSStatus sConverterInputCallback(
 
 #pragma mark - Private Methods
 
+// Returns the decoded file if it can be played without conversion
+- (HugPCMFile *) _openDecodedFile
+{
+    NSURL *decodedFileURL = [_audioFile decodedFileURL];
+    if (!decodedFileURL) return nil;
+
+    double outputSampleRate = [[_settings objectForKey:HugAudioSettingSampleRate] doubleValue];
+
+    HugPCMFile *decodedFile = [[HugPCMFile alloc] initWithFileURL:decodedFileURL];
+
+    BOOL ok = [decodedFile open] &&
+        [decodedFile sampleRate] == outputSampleRate &&
+        [decodedFile channelCount] == [_audioFile format].mChannelsPerFrame &&
+        [decodedFile sourceFrameCount] == [_audioFile fileLengthFrames];
+
+    if (!ok) {
+        HugLog(@"HugAudioSource", @"%@ not using decoded file %@", _audioFile, decodedFileURL);
+        return nil;
+    }
+
+    return decodedFile;
+}
+
+
+// Returns a map of the file if it can be played without decoding. Mapped pages
+// raise SIGBUS if their volume goes away, so only fixed local disks qualify.
+//
+- (HugPCMMap *) _openPCMMap
+{
+    AudioStreamBasicDescription format = [_audioFile format];
+
+    double outputSampleRate = [[_settings objectForKey:HugAudioSettingSampleRate] doubleValue];
+    BOOL resamplesWhileDecoding = [[_settings objectForKey:HugAudioSettingResampleWhileDecoding] boolValue];
+
+    if (resamplesWhileDecoding && outputSampleRate && (outputSampleRate != format.mSampleRate)) {
+        return NULL;
+    }
+
+    NSURL *fileURL = [_audioFile fileURL];
+
+    NSArray *keys = @[ NSURLVolumeIsLocalKey, NSURLVolumeIsEjectableKey, NSURLVolumeIsRemovableKey ];
+    NSDictionary *values = [fileURL resourceValuesForKeys:keys error:NULL];
+
+    if (![[values objectForKey:NSURLVolumeIsLocalKey] boolValue] ||
+         [[values objectForKey:NSURLVolumeIsEjectableKey] boolValue] ||
+         [[values objectForKey:NSURLVolumeIsRemovableKey] boolValue]
+    ) {
+        return NULL;
+    }
+
+    HugPCMMap *pcmMap = HugPCMMapOpen([[fileURL path] fileSystemRepresentation]);
+    if (!pcmMap) return NULL;
+
+    HugDecoderInfo info = HugPCMMapGetInfo(pcmMap);
+
+    BOOL ok = info.sampleRate == format.mSampleRate &&
+        info.channelCount == format.mChannelsPerFrame &&
+        info.frameCount == [_audioFile fileLengthFrames];
+
+    if (!ok) {
+        HugLog(@"HugAudioSource", @"%@ not mapping, file info does not match", _audioFile);
+        HugPCMMapFree(pcmMap);
+        return NULL;
+    }
+
+    return pcmMap;
+}
+
 
 - (BOOL) _makeContextWithStartTime: (NSTimeInterval) startTime
                           stopTime: (NSTimeInterval) stopTime
@@ -162,18 +529,23 @@ static OSStatus sConverterInputCallback(
     SInt64 fileFrames = [_audioFile fileLengthFrames];
     AudioStreamBasicDescription format = [_audioFile format];
 
-    NSInteger totalFrames = fileFrames;
+    HugPCMFile *decodedFile = [self _openDecodedFile];
+    HugPCMMap  *pcmMap      = decodedFile ? NULL : [self _openPCMMap];
+
+    // Decoded audio is already at the output rate
+    double    sampleRate  = decodedFile ? [decodedFile sampleRate] : format.mSampleRate;
+    NSInteger totalFrames = decodedFile ? [decodedFile frameCount] : fileFrames;
+    NSInteger startFrame  = startTime * sampleRate;
 
     // Apply startTime/stopTime
     {
-        NSInteger startFrame  = startTime * format.mSampleRate;
         NSInteger stopFrame   = 0;
 
         if (startFrame < 0) startFrame = 0;
         if (startFrame > totalFrames) startFrame = totalFrames;
 
         if (stopTime) {
-            stopFrame  = stopTime * format.mSampleRate;
+            stopFrame  = stopTime * sampleRate;
             if (stopFrame < 0) stopFrame = 0;
             if (stopFrame > totalFrames) stopFrame = totalFrames;
 
@@ -184,7 +556,7 @@ static OSStatus sConverterInputCallback(
 
         HugLog(@"HugAudioSource", @"%@ fileFrames: %ld, totalFrames: %ld, startFrame: %ld, stopFrame: %ld", _audioFile, (long)fileFrames, (long)totalFrames, (long)startFrame, (long)stopFrame);
 
-        if (startFrame) {
+        if (startFrame && !decodedFile && !pcmMap) {
             if (![_audioFile seekToFrame:startFrame]) {
                 HugLog(@"HugAudioSource", @"seekToFrame %ld failed for %@", (long)startFrame, _audioFile);
                 _error = [_audioFile error];
@@ -194,14 +566,106 @@ static OSStatus sConverterInputCallback(
         
         if ((totalFrames < 0) || (totalFrames > UINT32_MAX)) {
             _error = [NSError errorWithDomain:HugErrorDomain code:HugErrorInvalidFrameCount userInfo:nil];
+            HugPCMMapFree(pcmMap);
             return NO;
         }
     }
 
-    // Setup _context and _protectedBuffers
-    {
-        UInt32 channelCount = format.mChannelsPerFrame;
-        UInt32 totalBytes   = (UInt32)totalFrames * format.mBytesPerFrame;
+    UInt32 channelCount = format.mChannelsPerFrame;
+
+    UInt32 outputFrameSize = [[_settings objectForKey:HugAudioSettingFrameSize] unsignedIntValue];
+    AudioBufferList *inputScratch = HugAudioBufferListCreate(channelCount, outputFrameSize, YES);
+
+    _context = calloc(1, sizeof(RenderContext));
+    _context->sampleRate   = format.mSampleRate;
+    _context->channelCount = channelCount;
+    _context->inputScratch = inputScratch;
+
+    if (decodedFile) {
+        AudioBufferList *list = HugAudioBufferListCreate(channelCount, 0, NO);
+
+        for (NSInteger i = 0; i < channelCount; i++) {
+            list->mBuffers[i].mNumberChannels = 1;
+            list->mBuffers[i].mDataByteSize = (UInt32)(totalFrames * sizeof(float));
+            list->mBuffers[i].mData = (void *)([decodedFile samplesForChannel:i] + startFrame);
+        }
+
+        _context->sampleRate  = sampleRate;
+        _context->frameIndex  = sampleRate * -padding;
+        _context->totalFrames = totalFrames;
+        _context->bufferList  = list;
+
+        _decodedFile = decodedFile;
+        _decodedFileStartFrame = startFrame;
+
+        HugLog(@"HugAudioSource", @"%@ playing decoded file %@", _audioFile, [decodedFile fileURL]);
+
+        return YES;
+    }
+
+    // Uncompressed audio is converted by the render callback, straight from the file
+    if (pcmMap) {
+        _context->frameIndex  = sampleRate * -padding;
+        _context->totalFrames = totalFrames;
+        _context->pcmMap      = pcmMap;
+        _context->pcmMapStartFrame = startFrame;
+
+        HugLog(@"HugAudioSource", @"%@ playing mapped file", _audioFile);
+
+        return YES;
+    }
+
+    // Resample while decoding, so that the render callback only copies
+    double outputSampleRate = [[_settings objectForKey:HugAudioSettingSampleRate] doubleValue];
+    BOOL resamplesWhileDecoding = [[_settings objectForKey:HugAudioSettingResampleWhileDecoding] boolValue];
+
+    if (resamplesWhileDecoding && outputSampleRate && (outputSampleRate != format.mSampleRate)) {
+        HugResampler *resampler = HugResamplerCreate(format.mSampleRate, outputSampleRate, channelCount, [self _resamplerQuality], sDecodeChunkFrames);
+
+        if (resampler) {
+            _context->decodeResampler = resampler;
+            _context->decodeScratch = HugAudioBufferListCreate(channelCount, sDecodeChunkFrames, YES);
+            _context->decodeFramesRemaining = totalFrames;
+
+            _context->sampleRate = outputSampleRate;
+            totalFrames = HugResamplerGetOutputLength(resampler, totalFrames);
+
+            HugLog(@"HugAudioSource", @"%@ resampling from %g to %g while decoding", _audioFile, format.mSampleRate, outputSampleRate);
+
+        } else {
+            HugLog(@"HugAudioSource", @"%@ cannot resample from %g to %g while decoding", _audioFile, format.mSampleRate, outputSampleRate);
+        }
+    }
+
+    _context->frameIndex  = _context->sampleRate * -padding;
+    _context->totalFrames = (UInt32)totalFrames;
+
+    NSTimeInterval streamingDuration = [[_settings objectForKey:HugAudioSettingStreamingBufferDuration] doubleValue];
+    NSInteger      streamingFrames   = streamingDuration * _context->sampleRate;
+
+    // Setup ring buffers. Only the window is wired, so memory use is independent of track length
+    if (streamingFrames > 0 && streamingFrames < totalFrames) {
+        HugRingBuffer **ringBuffers = calloc(channelCount, sizeof(HugRingBuffer *));
+        
+        _context->ringBuffers = ringBuffers;
+
+        for (NSInteger i = 0; i < channelCount; i++) {
+            ringBuffers[i] = HugRingBufferCreate(streamingFrames * sizeof(float));
+
+            if (!ringBuffers[i]) {
+                HugLog(@"HugAudioSource", @"HugRingBufferCreate() failed for %@", _audioFile);
+                _error = [NSError errorWithDomain:HugErrorDomain code:HugErrorInvalidFrameCount userInfo:nil];
+                return NO;
+            }
+
+            HugRingBufferLock(ringBuffers[i]);
+        }
+        
+        HugLog(@"HugAudioSource", @"%@ streaming with %ld frame window", _audioFile, (long)streamingFrames);
+
+    // Setup _protectedBuffers
+    } else {
+        UInt32 totalBytes = (UInt32)totalFrames * format.mBytesPerFrame;
 
         AudioBufferList *list = HugAudioBufferListCreate(channelCount, 0, NO);
         
@@ -217,16 +681,7 @@ static OSStatus sConverterInputCallback(
             [protectedBuffers addObject:protectedBuffer];
         }
 
-        UInt32 outputFrameSize = [[_settings objectForKey:HugAudioSettingFrameSize] unsignedIntValue];
-        AudioBufferList *inputScratch = HugAudioBufferListCreate(channelCount, outputFrameSize, YES);
-
-        _context = calloc(1, sizeof(RenderContext));
-        _context->sampleRate   = format.mSampleRate;
-        _context->frameIndex   = format.mSampleRate * -padding;
-        _context->totalFrames  = (UInt32)totalFrames;
-        _context->bufferList   = list;
-        _context->inputScratch = inputScratch;
-
+        _context->bufferList = list;
         _protectedBuffers = protectedBuffers;
     }
 
@@ -236,6 +691,9 @@ static OSStatus sConverterInputCallback(
 
 - (void) _finishFillBuffer
 {
+    // Nobody is waiting for a cancelled source
+    if (atomic_load(&_cancelled)) return;
+
     if (!_error) {
         _error = [_audioFile error];
     }
@@ -247,9 +705,11 @@ static OSStatus sConverterInputCallback(
     }
 
 #if DEBUG_AUDIO_SOURCE_BUFFERS
-    [HugDebugFile writeWithSampleRate: _context->sampleRate
-                          totalFrames: _context->totalFrames
-                           bufferList: _context->bufferList];
+    if (_context->bufferList) {
+        [HugDebugFile writeWithSampleRate: _context->sampleRate
+                              totalFrames: _context->totalFrames
+                               bufferList: _context->bufferList];
+    }
 #endif
 
     if (_completionHandler) {
@@ -258,6 +718,52 @@ static OSStatus sConverterInputCallback(
 }
 
 
+// Keeps the region of _decodedFile or pcmMap around the play head wired. The first
+// window is wired before returning, so playback starts without page faults.
+//
+- (void) _startWiring
+{
+    RenderContext *context = _context;
+    HugPCMFile *decodedFile = _decodedFile;
+    HugPCMMap  *pcmMap      = context->pcmMap;
+
+    NSTimeInterval durationAhead = [[_settings objectForKey:HugAudioSettingStreamingBufferDuration] doubleValue];
+    if (durationAhead <= 0) durationAhead = sDefaultWiredDurationAhead;
+
+    NSInteger startFrame   = decodedFile ? _decodedFileStartFrame : context->pcmMapStartFrame;
+    NSInteger framesBehind = sWiredDurationBehind * context->sampleRate;
+    NSInteger framesAhead  = durationAhead * context->sampleRate;
+
+    void (^wire)() = ^{
+        // frameIndex is written by the render thread, a stale value only shifts the window slightly
+        NSInteger playFrame = startFrame + MAX(context->frameIndex, 0);
+        NSInteger fromFrame = MAX(playFrame - framesBehind, 0);
+
+        NSInteger frameCount = (playFrame + framesAhead) - fromFrame;
+
+        if (decodedFile) {
+            [decodedFile wireFramesInRange:NSMakeRange(fromFrame, frameCount)];
+        } else {
+            HugPCMMapWireFrames(pcmMap, fromFrame, frameCount);
+        }
+    };
+
+    _wiringQueue = dispatch_queue_create("HugAudioSource.wiring", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+    dispatch_sync(_wiringQueue, wire);
+
+    _wiringTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, _wiringQueue);
+    dispatch_source_set_timer(_wiringTimer, dispatch_time(DISPATCH_TIME_NOW, sWiringInterval * NSEC_PER_SEC), sWiringInterval * NSEC_PER_SEC, NSEC_PER_SEC / 4);
+    dispatch_source_set_event_handler(_wiringTimer, wire);
+    dispatch_resume(_wiringTimer);
+
+    __weak id weakSelf = self;
+
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [weakSelf _finishFillBuffer];
+    });
+}
+
+
 - (BOOL) _fillBuffer
 {
     RenderContext *context = _context;
@@ -266,7 +772,7 @@ static OSStatus sConverterInputCallback(
 
     NSInteger bytesPerFrame = format.mBytesPerFrame;
     NSInteger totalFrames   = _context->totalFrames;
-    NSInteger primeAmount   = (format.mSampleRate * 10);
+    NSInteger primeAmount   = (context->sampleRate * 10);
     if (totalFrames < primeAmount) primeAmount = totalFrames;
 
     dispatch_semaphore_t primeSemaphore = dispatch_semaphore_create(0);
@@ -291,9 +797,9 @@ static OSStatus sConverterInputCallback(
         BOOL needsSignal = YES;
         
         while (ok) {
-            if (shouldCancel) break;
+            if (shouldCancel || atomic_load(&_cancelled)) break;
         
-            UInt32 maxFrames  = 32768;
+            UInt32 maxFrames  = sDecodeChunkFrames;
             UInt32 frameCount = (UInt32)framesRemaining;
             if (frameCount > maxFrames) frameCount = maxFrames;
 
@@ -307,10 +813,10 @@ static OSStatus sConverterInputCallback(
             }
 
             if (frameCount > 0) {
-                ok = [_audioFile readFrames:&frameCount intoBufferList:fillBufferList];
+                ok = sReadFrames(_audioFile, context, &frameCount, fillBufferList);
             }
 
-            // ExtAudioFileRead() is documented to return 0 when the end of the file is reached.
+            // -readFrames:intoBufferList: returns 0 when the end of the file is reached.
             //
             if ((frameCount == 0) || (framesRemaining == 0)) {
                 break;
@@ -363,6 +869,171 @@ static OSStatus sConverterInputCallback(
 }
 
 
+// Decodes into _context->ringBuffers on a background queue, staying a fixed window
+// ahead of the play head. completionHandler is invoked once the entire track has
+// been decoded, matching -_fillBuffer.
+//
+- (BOOL) _startStreaming
+{
+    RenderContext *context = _context;
+    HugAudioFile *audioFile = _audioFile;
+
+    AudioStreamBasicDescription format = [audioFile format];
+
+    UInt32    channelCount  = context->channelCount;
+    NSInteger totalFrames   = context->totalFrames;
+    NSInteger windowFrames  = HugRingBufferGetCapacity(context->ringBuffers[0]) / sizeof(float);
+    NSInteger primeAmount   = (context->sampleRate * 10);
+    if (windowFrames < primeAmount) primeAmount = windowFrames;
+    if (totalFrames  < primeAmount) primeAmount = totalFrames;
+
+    dispatch_semaphore_t primeSemaphore = dispatch_semaphore_create(0);
+
+    __weak id weakSelf = self;
+
+    NSTimeInterval startTime = [NSDate timeIntervalSinceReferenceDate];
+
+    _streamingGroup = dispatch_group_create();
+    _streamingSemaphore = dispatch_semaphore_create(0);
+
+    dispatch_semaphore_t streamingSemaphore = _streamingSemaphore;
+    context->streamingSemaphore = streamingSemaphore;
+
+    // -dealloc waits for _streamingGroup, so this outlives the block
+    atomic_bool *cancelled = &_cancelled;
+
+    dispatch_group_async(_streamingGroup, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        NSInteger framesRemaining = totalFrames;
+        NSInteger framesAvailable = 0;
+
+        AudioBufferList *fillBufferList = HugAudioBufferListCreate(channelCount, 0, NO);
+        
+        BOOL ok = YES;
+        BOOL needsSignal = YES;
+        
+        while (ok && (framesRemaining > 0)) {
+            if (atomic_load(&context->streamingCancelled) || atomic_load(cancelled)) break;
+
+            NSInteger writableFrames = sGetStreamingFramesWritable(context);
+
+            // Window is full, wait for the render thread to consume. streamingWaiting
+            // is published before the re-check, so either we see the new space or
+            // the render thread sees the flag and signals.
+            //
+            if (writableFrames < MIN(framesRemaining, sStreamingMinimumChunk)) {
+                atomic_store_explicit(&context->streamingWaiting, true, memory_order_relaxed);
+                atomic_thread_fence(memory_order_seq_cst);
+
+                if (sGetStreamingFramesWritable(context) < MIN(framesRemaining, sStreamingMinimumChunk)) {
+                    dispatch_semaphore_wait(streamingSemaphore, dispatch_time(DISPATCH_TIME_NOW, sStreamingWaitTimeout * NSEC_PER_SEC));
+                }
+
+                atomic_store_explicit(&context->streamingWaiting, false, memory_order_relaxed);
+                continue;
+            }
+
+            UInt32 frameCount = (UInt32)MIN(MIN(framesRemaining, writableFrames), sDecodeChunkFrames);
+            UInt32 byteCount  = frameCount * sizeof(float);
+
+            for (NSInteger i = 0; i < channelCount; i++) {
+                fillBufferList->mBuffers[i].mNumberChannels = 1;
+                fillBufferList->mBuffers[i].mDataByteSize = byteCount;
+                fillBufferList->mBuffers[i].mData = HugRingBufferGetWritePtr(context->ringBuffers[i], byteCount);
+            }
+
+            ok = sReadFrames(audioFile, context, &frameCount, fillBufferList);
+
+            if (!ok || (frameCount == 0)) {
+                break;
+            }
+
+            for (NSInteger i = 0; i < channelCount; i++) {
+                HugRingBufferConfirmWrite(context->ringBuffers[i], frameCount * sizeof(float));
+            }
+       
+            framesAvailable += frameCount;
+            framesRemaining -= frameCount;
+            
+            if ((framesAvailable >= primeAmount) && needsSignal) {
+                dispatch_semaphore_signal(primeSemaphore);
+                needsSignal = NO;
+            }
+        }
+
+        if (needsSignal) {
+            dispatch_semaphore_signal(primeSemaphore);
+        }
+        
+        HugAudioBufferListFree(fillBufferList, NO);
+
+        if (atomic_load(&context->streamingCancelled) || atomic_load(cancelled)) {
+            return;
+        }
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+            
+            HugLog(@"HugAudioSource", @"Streaming read finished in %ldms", (long)((now - startTime) * 1000));
+        
+            [weakSelf _finishFillBuffer];
+        });
+    });
+
+    int64_t fiveSecondsInNs = 5l * 1000 * 1000 * 1000;
+    if (dispatch_semaphore_wait(primeSemaphore, dispatch_time(0, fiveSecondsInNs))) {
+        HugLog(@"HugAudioSource", @"dispatch_semaphore_wait() timed out for %@", _audioFile);
+        _error = [NSError errorWithDomain:HugErrorDomain code:HugErrorReadTooSlow userInfo:nil];
+        atomic_store(&context->streamingCancelled, true);
+
+        return NO;
+
+    } else {
+        HugLog(@"HugAudioSource", @"%@ primed!", _audioFile);
+        
+        return YES;
+    }
+}
+
+
+- (HugResamplerQuality) _resamplerQuality
+{
+    NSNumber *quality = [_settings objectForKey:HugAudioSettingResamplerQuality];
+    return quality ? [quality intValue] : HugResamplerQualityHigh;
+}
+
+
+- (BOOL) _makeResampler
+{
+    AudioStreamBasicDescription inputFormat = [_audioFile format];
+
+    double outputSampleRate = [[_settings objectForKey:HugAudioSettingSampleRate] doubleValue];
+    UInt32 frameSize        = [[_settings objectForKey:HugAudioSettingFrameSize] unsignedIntValue];
+    UInt32 channelCount     = inputFormat.mChannelsPerFrame;
+
+    if (!frameSize) return NO;
+
+    // Advance of frameSize output frames at any phase
+    UInt32 maxInputFrameCount = (UInt32)ceil(frameSize * (inputFormat.mSampleRate / outputSampleRate)) + 2;
+
+    HugResampler *resampler = HugResamplerCreate(inputFormat.mSampleRate, outputSampleRate, channelCount, [self _resamplerQuality], maxInputFrameCount);
+    if (!resampler) return NO;
+
+    // The first call after a reset also fills the filter's lookahead
+    UInt32 scratchFrameSize = maxInputFrameCount + (UInt32)HugResamplerGetTapCount(resampler);
+
+    _context->resampler            = resampler;
+    _context->resamplerScratch     = HugAudioBufferListCreate(channelCount, scratchFrameSize, YES);
+    _context->resamplerChunkFrames = frameSize;
+    _context->resamplerInputs      = calloc(channelCount, sizeof(float *));
+    _context->resamplerOutputs     = calloc(channelCount, sizeof(float *));
+
+    // The render thread hasn't started, so frameIndex is still -padding
+    _context->resamplerTotalFrames = HugResamplerGetOutputLength(resampler, _context->totalFrames - _context->frameIndex);
+
+    return YES;
+}
+
+
 - (BOOL) _makeConverter
 {
     AudioStreamBasicDescription inputFormat = [_audioFile format];
@@ -374,6 +1045,13 @@ static OSStatus sConverterInputCallback(
 
     if (inputFormat.mSampleRate == outputSampleRate) return YES;
 
+    // Resampled while decoding, or decoded audio
+    if (_context->sampleRate == outputSampleRate) return YES;
+
+    if ([self _makeResampler]) return YES;
+
+    HugLog(@"HugAudioSource", @"%@ falling back to AudioConverter for %g to %g", _audioFile, inputFormat.mSampleRate, outputSampleRate);
+
     UInt32 channelCount = inputFormat.mChannelsPerFrame;
 
     AudioStreamBasicDescription outputFormat = inputFormat;
@@ -413,18 +1091,42 @@ static OSStatus sConverterInputCallback(
 
 #pragma mark - Public Methods
 
+- (void) cancel
+{
+    // A streaming decoder waiting on the render thread sees this within sStreamingWaitTimeout
+    atomic_store(&_cancelled, true);
+}
+
+
 - (BOOL) prepareWithStartTime: (NSTimeInterval) startTime
                      stopTime: (NSTimeInterval) stopTime
                       padding: (NSTimeInterval) padding
             completionHandler: (void (^)(HugAudioSource *)) completionHandler
 {
+    // Set this before decoding starts, as the decoder may finish before we return
+    // when called off the main queue. On failure it may still be invoked with -error set.
+    _completionHandler = completionHandler;
+
+    if (atomic_load(&_cancelled)) return NO;
+
     if (![self _makeContextWithStartTime:startTime stopTime:stopTime padding:padding]) {
         return NO;
     }
     
-    if (![self _fillBuffer]) {
+    if (_decodedFile || _context->pcmMap) {
+        [self _startWiring];
+
+    } else if (_context->ringBuffers) {
+        if (![self _startStreaming]) {
+            return NO;
+        }
+
+    } else if (![self _fillBuffer]) {
         return NO;
     }
+
+    // Priming ends early once cancelled
+    if (atomic_load(&_cancelled)) return NO;
     
     if (![self _makeConverter]) {
         return NO;
@@ -440,12 +1142,14 @@ static OSStatus sConverterInputCallback(
     ) {
         OSStatus result = noErr;
 
-        UInt32 sourceChannelCount = context->bufferList->mNumberBuffers;
+        UInt32 sourceChannelCount = context->channelCount;
         UInt32 outputChannelCount = ioData->mNumberBuffers;
 
         AudioBufferList *bufferToFill = (sourceChannelCount == outputChannelCount) ? ioData : context->inputScratch;
 
-        if (!converter) {
+        if (context->resampler) {
+            result = sFillBufferListResampled(context, frameCount, bufferToFill);
+        } else if (!converter) {
             sFillBufferList(context, frameCount, bufferToFill);
         } else {
             result = AudioConverterFillComplexBuffer(converter, sConverterInputCallback, context, &frameCount, bufferToFill, NULL);
@@ -466,7 +1170,7 @@ static OSStatus sConverterInputCallback(
                 outInfo->timeElapsed   = context->frameIndex  / sampleRate;
                 outInfo->timeRemaining = context->totalFrames / sampleRate;
 
-            } else if (context->frameIndex >= context->totalFrames) {
+            } else if ((context->frameIndex >= context->totalFrames) && !sIsDrainingResampler(context)) {
                 outInfo->status = HugPlaybackStatusFinished;
                 outInfo->timeElapsed   = context->totalFrames / sampleRate;
                 outInfo->timeRemaining = 0;
@@ -482,10 +1186,24 @@ static OSStatus sConverterInputCallback(
 
     } copy];
     
-    _completionHandler = completionHandler;
+    _prepared = YES;
 
     return YES;
 }
 
 
+#pragma mark - Accessors
+
+- (NSInteger) underrunCount
+{
+    return _context ? atomic_load(&_context->underrunCount) : 0;
+}
+
+
+- (BOOL) isStreaming
+{
+    return _context && _context->ringBuffers;
+}
+
+
 @end
@@ -0,0 +1,320 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugAutomation.h"
+#include "HugKernels.h"
+
+#include <stdatomic.h>
+
+
+#define HUG_CACHE_LINE 64
+
+// Events which have been received but have not yet started, per parameter.
+// When full, the latest event replaces the last one.
+enum { sPendingCapacity = 16 };
+
+// -100 dB, exponential ramps to or from silence use this instead of 0
+static const double sExponentialFloor = 0.00001;
+
+
+typedef struct {
+    SInt64 startFrame;
+    SInt64 endFrame;
+    float  value;
+    HugAutomationCurve curve;
+} HugAutomationRamp;
+
+typedef struct {
+    SInt64 position;  // Next frame to read
+    float  value;     // Value at position
+
+    BOOL   ramping;
+    float  rampFrom;
+    HugAutomationRamp ramp;
+
+    HugAutomationRamp pending[sPendingCapacity];
+    size_t pendingCount;
+} HugAutomationLane;
+
+
+struct HugAutomation {
+    // Producer
+    _Alignas(HUG_CACHE_LINE) atomic_uint_fast64_t _writeIndex;
+
+    // Consumer
+    _Alignas(HUG_CACHE_LINE) atomic_uint_fast64_t _readIndex;
+    SInt64 _bufferStart;
+    SInt64 _bufferEnd;
+
+    HugAutomationLane _lanes[HugAutomationParameterCount];
+
+    HugAutomationEvent *_events;
+    size_t _eventCount;
+    size_t _eventMask;
+};
+
+
+#pragma mark - Lifecycle
+
+HugAutomation *HugAutomationCreate(size_t eventCount)
+{
+    size_t count = 1;
+    while (count < eventCount) count <<= 1;
+
+    size_t size = ((sizeof(HugAutomation) + HUG_CACHE_LINE - 1) / HUG_CACHE_LINE) * HUG_CACHE_LINE;
+
+    HugAutomation *self = aligned_alloc(HUG_CACHE_LINE, size);
+    if (!self) return NULL;
+
+    memset(self, 0, size);
+
+    self->_events = calloc(count, sizeof(HugAutomationEvent));
+    self->_eventCount = count;
+    self->_eventMask = count - 1;
+
+    atomic_init(&self->_writeIndex, 0);
+    atomic_init(&self->_readIndex, 0);
+
+    return self;
+}
+
+
+void HugAutomationFree(HugAutomation *self)
+{
+    if (!self) return;
+
+    free(self->_events);
+    free(self);
+}
+
+
+#pragma mark - Private Functions
+
+static BOOL sIsGainParameter(NSInteger parameter)
+{
+    return parameter == HugAutomationParameterPreGain ||
+           parameter == HugAutomationParameterVolume;
+}
+
+
+// Value at t in [0, 1] of the active ramp. Exponential ramps end at the
+// floor rather than 0, the lane jumps to the target once the ramp ends.
+static float sGetRampValue(const HugAutomationLane *lane, double t)
+{
+    double from = lane->rampFrom;
+    double to   = lane->ramp.value;
+
+    if (t <= 0) t = 0;
+    if (t >= 1) t = 1;
+
+    if (lane->ramp.curve == HugAutomationCurveExponential) {
+        from = MAX(from, sExponentialFloor);
+        to   = MAX(to,   sExponentialFloor);
+
+        return from * pow(to / from, t);
+    }
+
+    return from + ((to - from) * t);
+}
+
+
+static float sGetRampValueAtFrame(const HugAutomationLane *lane, SInt64 frame)
+{
+    SInt64 length = lane->ramp.endFrame - lane->ramp.startFrame;
+    return sGetRampValue(lane, length > 0 ? ((double)(frame - lane->ramp.startFrame) / length) : 1.0);
+}
+
+
+static void sAddPending(HugAutomationLane *lane, const HugAutomationRamp *ramp)
+{
+    size_t count = lane->pendingCount;
+
+    if (count == sPendingCapacity) {
+        count--;
+    }
+
+    // Keep pending sorted by start frame, events with equal times stay in order
+    size_t index = count;
+    while (index > 0 && lane->pending[index - 1].startFrame > ramp->startFrame) {
+        lane->pending[index] = lane->pending[index - 1];
+        index--;
+    }
+
+    lane->pending[index] = *ramp;
+    lane->pendingCount = count + 1;
+}
+
+
+static void sStartDueRamps(HugAutomationLane *lane)
+{
+    while (lane->pendingCount && lane->pending[0].startFrame <= lane->position) {
+        HugAutomationRamp ramp = lane->pending[0];
+
+        lane->pendingCount--;
+        memmove(&lane->pending[0], &lane->pending[1], lane->pendingCount * sizeof(HugAutomationRamp));
+
+        // A late ramp still ends on time, it just starts later
+        if (ramp.endFrame <= lane->position) {
+            lane->value   = ramp.value;
+            lane->ramping = NO;
+
+        } else {
+            ramp.startFrame = lane->position;
+
+            lane->rampFrom = lane->value;
+            lane->ramp     = ramp;
+            lane->ramping  = YES;
+        }
+    }
+}
+
+
+static SInt64 sGetFrameForHostTime(const HugAutomation *self, UInt64 time, UInt64 hostTime, double hostTicksPerFrame)
+{
+    if (!time || hostTicksPerFrame <= 0) return self->_bufferStart;
+
+    double delta = (double)(SInt64)(time - hostTime) / hostTicksPerFrame;
+    SInt64 frame = self->_bufferStart + llround(delta);
+
+    return MAX(frame, self->_bufferStart);
+}
+
+
+#pragma mark - Public Functions
+
+BOOL HugAutomationSchedule(HugAutomation *self, const HugAutomationEvent *event)
+{
+    if (event->parameter >= HugAutomationParameterCount) return NO;
+
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_relaxed);
+    uint64_t readIndex  = atomic_load_explicit(&self->_readIndex,  memory_order_acquire);
+
+    if ((writeIndex - readIndex) >= self->_eventCount) {
+        return NO;
+    }
+
+    HugAutomationEvent *slot = &self->_events[writeIndex & self->_eventMask];
+    *slot = *event;
+
+    if (!sIsGainParameter(slot->parameter)) {
+        slot->curve = HugAutomationCurveLinear;
+    }
+
+    atomic_store_explicit(&self->_writeIndex, writeIndex + 1, memory_order_release);
+
+    return YES;
+}
+
+
+void HugAutomationBeginBuffer(HugAutomation *self, UInt64 hostTime, double hostTicksPerFrame, size_t frameCount)
+{
+    // Catch up lanes which were not read during the previous cycle
+    for (NSInteger i = 0; i < HugAutomationParameterCount; i++) {
+        HugAutomationSegment unused;
+
+        while (self->_lanes[i].position < self->_bufferEnd) {
+            HugAutomationRead(self, (HugAutomationParameter)i, self->_bufferEnd - self->_lanes[i].position, &unused);
+        }
+    }
+
+    self->_bufferStart = self->_bufferEnd;
+    self->_bufferEnd  += frameCount;
+
+    uint64_t readIndex  = atomic_load_explicit(&self->_readIndex,  memory_order_relaxed);
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_acquire);
+
+    while (readIndex != writeIndex) {
+        const HugAutomationEvent *event = &self->_events[readIndex & self->_eventMask];
+
+        HugAutomationRamp ramp;
+        ramp.startFrame = sGetFrameForHostTime(self, event->hostTime, hostTime, hostTicksPerFrame);
+        ramp.endFrame   = ramp.startFrame + (hostTicksPerFrame > 0 ? llround(event->hostDuration / hostTicksPerFrame) : 0);
+        ramp.value      = event->value;
+        ramp.curve      = event->curve;
+
+        sAddPending(&self->_lanes[event->parameter], &ramp);
+
+        readIndex++;
+    }
+
+    atomic_store_explicit(&self->_readIndex, readIndex, memory_order_release);
+}
+
+
+size_t HugAutomationRead(HugAutomation *self, HugAutomationParameter parameter, size_t frameCount, HugAutomationSegment *outSegment)
+{
+    HugAutomationLane *lane = &self->_lanes[parameter];
+
+    outSegment->curve = HugAutomationCurveLinear;
+
+    // Reading past the end of the cycle holds the current value
+    if (lane->position >= self->_bufferEnd) {
+        outSegment->from = outSegment->to = lane->value;
+        return frameCount;
+    }
+
+    sStartDueRamps(lane);
+
+    SInt64 start = lane->position;
+    SInt64 end   = MIN(start + (SInt64)frameCount, self->_bufferEnd);
+
+    if (lane->ramping)      end = MIN(end, lane->ramp.endFrame);
+    if (lane->pendingCount) end = MIN(end, lane->pending[0].startFrame);
+    if (end <= start)       end = start + 1;
+
+    if (lane->ramping) {
+        outSegment->from  = lane->value;
+        outSegment->to    = sGetRampValueAtFrame(lane, end);
+        outSegment->curve = lane->ramp.curve;
+
+        if (end >= lane->ramp.endFrame) {
+            lane->value   = lane->ramp.value;
+            lane->ramping = NO;
+        } else {
+            lane->value = outSegment->to;
+        }
+
+    } else {
+        outSegment->from = outSegment->to = lane->value;
+    }
+
+    lane->position = end;
+
+    return (size_t)(end - start);
+}
+
+
+void HugAutomationFinishRamp(HugAutomation *self, HugAutomationParameter parameter)
+{
+    HugAutomationLane *lane = &self->_lanes[parameter];
+
+    if (lane->ramping) {
+        lane->value   = lane->ramp.value;
+        lane->ramping = NO;
+    }
+}
+
+
+float HugAutomationGetValue(const HugAutomation *self, HugAutomationParameter parameter)
+{
+    return self->_lanes[parameter].value;
+}
+
+
+void HugAutomationApplyGain(float *samples, size_t frameCount, const HugAutomationSegment *segment)
+{
+    if (!samples || !frameCount) return;
+
+    float from = segment->from;
+    float to   = segment->to;
+
+    if (from == to) {
+        if (from != 1.0f) HugKernels.gain(samples, frameCount, from);
+
+    } else if (segment->curve == HugAutomationCurveExponential && from > 0 && to > 0) {
+        HugKernels.exponentialRamp(samples, frameCount, from, powf(to / from, 1.0f / frameCount));
+
+    } else {
+        HugKernels.ramp(samples, frameCount, from, (to - from) / frameCount);
+    }
+}
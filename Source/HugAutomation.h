@@ -0,0 +1,83 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Scheduled parameter automation, from the main thread to the render thread.
+//
+// The producer posts timestamped events into a lock-free single-producer,
+// single-consumer queue. Posting never allocates or blocks. Each event ramps
+// one parameter from its current value to a target over a duration.
+//
+// The render thread calls HugAutomationBeginBuffer() once per render cycle,
+// which converts event times into frame positions. Each stage then reads its
+// parameters with HugAutomationRead(), which returns the longest segment that
+// has a single closed form (constant, linear, or exponential). Ramps start and
+// end on exact frames regardless of the buffer size.
+//
+// A new event interrupts any ramp which is in progress, starting from the
+// value at that frame.
+
+typedef struct HugAutomation HugAutomation;
+
+typedef enum {
+    HugAutomationParameterPreGain       = 0,
+    HugAutomationParameterVolume        = 1,
+    HugAutomationParameterStereoWidth   = 2,
+    HugAutomationParameterStereoBalance = 3,
+
+    HugAutomationParameterCount
+} HugAutomationParameter;
+
+typedef enum {
+    HugAutomationCurveLinear      = 0,
+
+    // Equal steps in decibels, with a floor of -100 dB. Only used for
+    // pre-gain and volume, other parameters ramp linearly.
+    HugAutomationCurveExponential = 1
+} HugAutomationCurve;
+
+typedef struct {
+    UInt64 hostTime;      // Start of the ramp, 0 = as soon as possible
+    UInt64 hostDuration;  // Length of the ramp in host time, 0 = jump
+    float  value;
+    UInt16 parameter;
+    UInt16 curve;
+} HugAutomationEvent;
+
+// samples[i] should be scaled by the value at frame i of the segment:
+//   constant:    from
+//   linear:      from + ((to - from) / frameCount) * i
+//   exponential: from * (to / from) ^ (i / frameCount)
+// to is the value at the first frame after the segment.
+typedef struct {
+    float from;
+    float to;
+    HugAutomationCurve curve;
+} HugAutomationSegment;
+
+// eventCount is rounded up to a power of two
+extern HugAutomation *HugAutomationCreate(size_t eventCount);
+extern void HugAutomationFree(HugAutomation *automation);
+
+// Producer. Returns NO if the queue is full.
+extern BOOL HugAutomationSchedule(HugAutomation *automation, const HugAutomationEvent *event);
+
+// Consumer. Starts a render cycle of frameCount frames whose first frame
+// plays at hostTime.
+extern void HugAutomationBeginBuffer(HugAutomation *automation, UInt64 hostTime, double hostTicksPerFrame, size_t frameCount);
+
+// Consumer. Reads up to frameCount frames of parameter and returns the number
+// of frames in outSegment. Call repeatedly until the buffer is covered.
+extern size_t HugAutomationRead(HugAutomation *automation, HugAutomationParameter parameter, size_t frameCount, HugAutomationSegment *outSegment);
+
+// Consumer. Ends a ramp of parameter which is in progress at its target.
+extern void HugAutomationFinishRamp(HugAutomation *automation, HugAutomationParameter parameter);
+
+// Consumer. Value of parameter at the last frame read.
+extern float HugAutomationGetValue(const HugAutomation *automation, HugAutomationParameter parameter);
+
+// Applies segment to frameCount samples. samples may be NULL.
+extern void HugAutomationApplyGain(float *samples, size_t frameCount, const HugAutomationSegment *segment);
@@ -0,0 +1,184 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugCrossfader.h"
+#include "HugKernels.h"
+
+
+static const size_t sCurveFrameCount = 64;
+static const double sHalfPi = 1.57079632679489661923;
+
+
+struct HugCrossfader {
+    size_t _maxFrameCount;
+    float *_scratch[2];
+
+    BOOL   _active;
+    size_t _delay;
+    size_t _position;
+    size_t _length;
+    HugCrossfadeCurve _curve;
+};
+
+
+#pragma mark - Lifecycle
+
+HugCrossfader *HugCrossfaderCreate(void)
+{
+    HugCrossfader *self = calloc(1, sizeof(HugCrossfader));
+    return self;
+}
+
+
+void HugCrossfaderFree(HugCrossfader *self)
+{
+    if (!self) return;
+
+    free(self->_scratch[0]);
+    free(self->_scratch[1]);
+    free(self);
+}
+
+
+#pragma mark - Private Functions
+
+// Gains at position, where x runs from 0 to 1 over the transition
+static void sGetGains(const HugCrossfader *self, size_t position, float *outIncoming, float *outOutgoing)
+{
+    double x = self->_length ? ((double)position / self->_length) : 1.0;
+    if (x > 1.0) x = 1.0;
+
+    if (self->_curve == HugCrossfadeCurveLinear) {
+        *outIncoming = x;
+        *outOutgoing = 1.0 - x;
+    } else {
+        *outIncoming = sin(x * sHalfPi);
+        *outOutgoing = cos(x * sHalfPi);
+    }
+}
+
+
+static void sProcessChannel(float *incoming, const float *outgoing, size_t length, float fromIn, float stepIn, float fromOut, float stepOut)
+{
+    if (!incoming) return;
+
+    if (fromIn != 1.0f || stepIn != 0.0f) {
+        HugKernels.ramp(incoming, length, fromIn, stepIn);
+    }
+
+    if (fromOut != 0.0f || stepOut != 0.0f) {
+        HugKernels.mixRamp(incoming, outgoing, length, fromOut, stepOut);
+    }
+}
+
+
+#pragma mark - Public Functions
+
+void HugCrossfaderSetMaxFrameCount(HugCrossfader *self, size_t maxFrameCount)
+{
+    if (self->_maxFrameCount != maxFrameCount) {
+        free(self->_scratch[0]);
+        free(self->_scratch[1]);
+
+        self->_scratch[0] = maxFrameCount ? calloc(maxFrameCount, sizeof(float)) : NULL;
+        self->_scratch[1] = maxFrameCount ? calloc(maxFrameCount, sizeof(float)) : NULL;
+
+        self->_maxFrameCount = maxFrameCount;
+    }
+
+    HugCrossfaderStop(self);
+}
+
+
+size_t HugCrossfaderGetMaxFrameCount(const HugCrossfader *self)
+{
+    return self->_maxFrameCount;
+}
+
+
+void HugCrossfaderStart(HugCrossfader *self, size_t delayFrameCount, size_t frameCount, HugCrossfadeCurve curve)
+{
+    self->_active   = YES;
+    self->_delay    = delayFrameCount;
+    self->_position = 0;
+    self->_curve    = curve;
+
+    // Whole curve segments, so the last one ends at full gain
+    self->_length = ((frameCount + sCurveFrameCount - 1) / sCurveFrameCount) * sCurveFrameCount;
+}
+
+
+void HugCrossfaderStop(HugCrossfader *self)
+{
+    self->_active = NO;
+}
+
+
+BOOL HugCrossfaderIsActive(const HugCrossfader *self)
+{
+    return self->_active;
+}
+
+
+size_t HugCrossfaderGetDelayFrameCount(const HugCrossfader *self)
+{
+    return self->_active ? self->_delay : 0;
+}
+
+
+float *HugCrossfaderGetScratchBuffer(HugCrossfader *self, NSInteger channel)
+{
+    return (channel == 0 || channel == 1) ? self->_scratch[channel] : NULL;
+}
+
+
+BOOL HugCrossfaderProcess(HugCrossfader *self, float *left, float *right, size_t frameCount)
+{
+    if (!self->_active) return NO;
+
+    frameCount = MIN(frameCount, self->_maxFrameCount);
+
+    const float *outgoingLeft  = self->_scratch[0];
+    const float *outgoingRight = self->_scratch[1];
+
+    // Only the outgoing source plays before the delay
+    size_t offset = MIN(self->_delay, frameCount);
+
+    if (offset) {
+        if (left)  memcpy(left,  outgoingLeft,  offset * sizeof(float));
+        if (right) memcpy(right, outgoingRight, offset * sizeof(float));
+
+        self->_delay -= offset;
+    }
+
+    while (offset < frameCount) {
+        // Curve segments are aligned to the transition rather than to the
+        // buffer, so the result does not depend on the frame size
+        size_t segmentOffset = self->_position % sCurveFrameCount;
+        size_t segmentStart  = self->_position - segmentOffset;
+        size_t length = MIN(frameCount - offset, sCurveFrameCount - segmentOffset);
+
+        float startIn, startOut, endIn, endOut;
+        sGetGains(self, segmentStart,                    &startIn, &startOut);
+        sGetGains(self, segmentStart + sCurveFrameCount, &endIn,   &endOut);
+
+        float stepIn  = (endIn  - startIn)  / sCurveFrameCount;
+        float stepOut = (endOut - startOut) / sCurveFrameCount;
+
+        float fromIn  = startIn  + (stepIn  * segmentOffset);
+        float fromOut = startOut + (stepOut * segmentOffset);
+
+        sProcessChannel(left  ? left  + offset : NULL, outgoingLeft  + offset, length, fromIn, stepIn, fromOut, stepOut);
+        sProcessChannel(right ? right + offset : NULL, outgoingRight + offset, length, fromIn, stepIn, fromOut, stepOut);
+
+        offset += length;
+        self->_position += length;
+
+        if (self->_position >= self->_length) {
+            self->_active = NO;
+            break;
+        }
+    }
+
+    return self->_active;
+}
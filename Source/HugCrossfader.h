@@ -0,0 +1,51 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Mixes an outgoing source into an incoming one during a transition.
+//
+// The caller renders the incoming source into its output buffers and the
+// outgoing source into the crossfader's scratch buffers, then calls
+// HugCrossfaderProcess(). The incoming source starts after a delay; until
+// then, only the outgoing source is heard.
+//
+// Gain curves are evaluated every 64 frames and ramped linearly between,
+// so each frame costs one ramp and one multiply-add per channel.
+
+typedef struct HugCrossfader HugCrossfader;
+
+typedef enum {
+    HugCrossfadeCurveEqualPower = 0, // sin/cos, constant power for uncorrelated sources
+    HugCrossfadeCurveLinear     = 1  // Constant gain, for correlated sources
+} HugCrossfadeCurve;
+
+extern HugCrossfader *HugCrossfaderCreate(void);
+extern void HugCrossfaderFree(HugCrossfader *crossfader);
+
+// Not real-time safe. Allocates scratch buffers and ends any transition.
+extern void HugCrossfaderSetMaxFrameCount(HugCrossfader *crossfader, size_t maxFrameCount);
+extern size_t HugCrossfaderGetMaxFrameCount(const HugCrossfader *crossfader);
+
+// Starts a transition. The incoming source starts delayFrameCount frames
+// into the next call to HugCrossfaderProcess() and reaches full gain after
+// another frameCount frames.
+extern void HugCrossfaderStart(HugCrossfader *crossfader, size_t delayFrameCount, size_t frameCount, HugCrossfadeCurve curve);
+
+// Ends the transition immediately
+extern void HugCrossfaderStop(HugCrossfader *crossfader);
+
+extern BOOL HugCrossfaderIsActive(const HugCrossfader *crossfader);
+
+// Frames before the incoming source starts
+extern size_t HugCrossfaderGetDelayFrameCount(const HugCrossfader *crossfader);
+
+// Scratch buffers for the outgoing source, channel is 0 or 1
+extern float *HugCrossfaderGetScratchBuffer(HugCrossfader *crossfader, NSInteger channel);
+
+// left and right hold the incoming source, which must be silent for the
+// first HugCrossfaderGetDelayFrameCount() frames. Returns NO once the
+// transition has finished and the outgoing source can be released.
+extern BOOL HugCrossfaderProcess(HugCrossfader *crossfader, float *left, float *right, size_t frameCount);
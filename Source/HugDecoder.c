@@ -0,0 +1,336 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// clock_gettime() and CLOCK_MONOTONIC for HugDecoderRunBenchmark()
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "HugDecoder.h"
+
+#include <stdio.h>
+#include <time.h>
+
+
+struct HugDecoder {
+    const HugDecoderBackend *_backend;
+    void *_state;
+    HugDecoderInfo _info;
+};
+
+
+// In order of preference. ExtAudioFile accepts anything, so it must be last.
+static const HugDecoderBackend *sBackends[] = {
+    &HugDecoderBackendPCM,
+    &HugDecoderBackendFLAC,
+#if defined(__APPLE__)
+    &HugDecoderBackendExtAudioFile,
+#endif
+};
+
+// Number of seeks and frames compared by HugDecoderRunBenchmark()
+enum {
+    sBenchmarkSeekCount  = 64,
+    sBenchmarkCheckCount = 1024,
+    sBenchmarkReadCount  = 4096
+};
+
+
+#pragma mark - Lifecycle
+
+HugDecoder *HugDecoderOpenWithBackend(const char *path, const HugDecoderBackend *backend)
+{
+    if (!path || !backend) return NULL;
+
+    HugDecoderInfo info;
+    memset(&info, 0, sizeof(info));
+
+    void *state = backend->open(path, &info);
+    if (!state) return NULL;
+
+    if (info.channelCount == 0 || info.sampleRate <= 0 || info.frameCount < 0) {
+        backend->close(state);
+        return NULL;
+    }
+
+    HugDecoder *self = calloc(1, sizeof(HugDecoder));
+
+    self->_backend = backend;
+    self->_state   = state;
+    self->_info    = info;
+
+    return self;
+}
+
+
+HugDecoder *HugDecoderOpen(const char *path)
+{
+    if (!path) return NULL;
+
+    UInt8 header[HugDecoderProbeSize];
+    size_t headerSize = 0;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    headerSize = fread(header, 1, sizeof(header), file);
+    fclose(file);
+
+    for (size_t i = 0; i < sizeof(sBackends) / sizeof(sBackends[0]); i++) {
+        const HugDecoderBackend *backend = sBackends[i];
+        if (!backend->probe(header, headerSize)) continue;
+
+        HugDecoder *decoder = HugDecoderOpenWithBackend(path, backend);
+        if (decoder) return decoder;
+    }
+
+    return NULL;
+}
+
+
+void HugDecoderClose(HugDecoder *self)
+{
+    if (!self) return;
+
+    self->_backend->close(self->_state);
+    free(self);
+}
+
+
+#pragma mark - Private Functions
+
+static uint64_t sGetNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+
+static BOOL sReadFully(HugDecoder *decoder, float **channels, size_t frameCount, size_t *outFrameCount)
+{
+    UInt32 channelCount = decoder->_info.channelCount;
+    float *offsetChannels[channelCount];
+
+    size_t total = 0;
+
+    while (total < frameCount) {
+        for (UInt32 c = 0; c < channelCount; c++) {
+            offsetChannels[c] = channels[c] ? channels[c] + total : NULL;
+        }
+
+        size_t count = frameCount - total;
+        if (!HugDecoderRead(decoder, offsetChannels, &count)) return NO;
+        if (!count) break;
+
+        total += count;
+    }
+
+    *outFrameCount = total;
+
+    return YES;
+}
+
+
+static int sCompareFrames(const void *a, const void *b)
+{
+    SInt64 fa = *(const SInt64 *)a;
+    SInt64 fb = *(const SInt64 *)b;
+
+    return (fa > fb) - (fa < fb);
+}
+
+
+#pragma mark - Public Functions
+
+const HugDecoderBackend *HugDecoderGetBackend(const HugDecoder *self)
+{
+    return self->_backend;
+}
+
+
+HugDecoderInfo HugDecoderGetInfo(const HugDecoder *self)
+{
+    return self->_info;
+}
+
+
+BOOL HugDecoderGetPCMLayout(const HugDecoder *self, HugDecoderPCMLayout *outLayout)
+{
+    if (!self->_backend->getPCMLayout) return NO;
+    return self->_backend->getPCMLayout(self->_state, outLayout);
+}
+
+
+BOOL HugDecoderSeek(HugDecoder *self, SInt64 frame)
+{
+    if (frame < 0 || frame > self->_info.frameCount) return NO;
+    return self->_backend->seek(self->_state, frame);
+}
+
+
+BOOL HugDecoderRead(HugDecoder *self, float **channels, size_t *ioFrameCount)
+{
+    SInt64 result = self->_backend->read(self->_state, channels, *ioFrameCount);
+
+    if (result < 0) {
+        *ioFrameCount = 0;
+        return NO;
+    }
+
+    *ioFrameCount = (size_t)result;
+
+    return YES;
+}
+
+
+BOOL HugDecoderRunBenchmark(const char *path, const HugDecoderBackend *backend, HugDecoderBenchmarkResult *outResult)
+{
+    HugDecoder *decoder = backend ? HugDecoderOpenWithBackend(path, backend) : HugDecoderOpen(path);
+    if (!decoder) return NO;
+
+    UInt32 channelCount = decoder->_info.channelCount;
+    SInt64 frameCount   = decoder->_info.frameCount;
+
+    // Pick seek targets up front, then capture the audio at each one during
+    // the sequential pass. Targets are deterministic for a given file.
+    SInt64 targets[sBenchmarkSeekCount];
+    size_t seekCount = 0;
+
+    if (frameCount > sBenchmarkCheckCount) {
+        UInt32 state = 0x2545f491;
+
+        for (size_t i = 0; i < sBenchmarkSeekCount; i++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+
+            targets[seekCount++] = (SInt64)(((double)state / 4294967296.0) * (frameCount - sBenchmarkCheckCount));
+        }
+
+        qsort(targets, seekCount, sizeof(SInt64), sCompareFrames);
+    }
+
+    float *expected = calloc(seekCount * sBenchmarkCheckCount * channelCount + 1, sizeof(float));
+    float *actual   = calloc(sBenchmarkCheckCount * channelCount, sizeof(float));
+    float *scratch  = calloc(sBenchmarkReadCount * channelCount, sizeof(float));
+
+    float *channels[channelCount];
+
+    BOOL ok = YES;
+    SInt64 position = 0;
+    uint64_t start = sGetNanoseconds();
+
+    while (ok) {
+        for (UInt32 c = 0; c < channelCount; c++) {
+            channels[c] = scratch + (c * sBenchmarkReadCount);
+        }
+
+        size_t count = sBenchmarkReadCount;
+        ok = HugDecoderRead(decoder, channels, &count);
+        if (!ok || !count) break;
+
+        // Copy out any part of a target range which falls in this read
+        for (size_t t = 0; t < seekCount; t++) {
+            SInt64 from = MAX(targets[t], position);
+            SInt64 to   = MIN(targets[t] + sBenchmarkCheckCount, position + (SInt64)count);
+
+            for (SInt64 f = from; f < to; f++) {
+                for (UInt32 c = 0; c < channelCount; c++) {
+                    expected[((t * channelCount) + c) * sBenchmarkCheckCount + (f - targets[t])] = channels[c][f - position];
+                }
+            }
+        }
+
+        position += count;
+    }
+
+    double seconds = (sGetNanoseconds() - start) / 1e9;
+
+    size_t mismatchCount = 0;
+
+    for (size_t t = 0; ok && t < seekCount; t++) {
+        for (UInt32 c = 0; c < channelCount; c++) {
+            channels[c] = actual + (c * sBenchmarkCheckCount);
+        }
+
+        size_t count = 0;
+
+        if (!HugDecoderSeek(decoder, targets[t]) ||
+            !sReadFully(decoder, channels, sBenchmarkCheckCount, &count) ||
+            count != sBenchmarkCheckCount ||
+            memcmp(actual, &expected[t * channelCount * sBenchmarkCheckCount], sBenchmarkCheckCount * channelCount * sizeof(float)) != 0
+        ) {
+            mismatchCount++;
+        }
+    }
+
+    if (ok) {
+        HugDecoderBenchmarkResult result;
+
+        result.frameCount        = position;
+        result.framesPerSecond   = seconds > 0 ? position / seconds : 0;
+        result.seekCount         = seekCount;
+        result.seekMismatchCount = mismatchCount;
+
+        *outResult = result;
+    }
+
+    free(expected);
+    free(actual);
+    free(scratch);
+
+    HugDecoderClose(decoder);
+
+    return ok;
+}
+
+
+#pragma mark - Command Line
+
+#if HUG_DECODER_MAIN
+
+int main(int argc, char **argv)
+{
+    int status = 0;
+
+    for (int i = 1; i < argc; i++) {
+        HugDecoder *decoder = HugDecoderOpen(argv[i]);
+
+        if (!decoder) {
+            printf("%s: no backend\n", argv[i]);
+            status = 1;
+            continue;
+        }
+
+        const HugDecoderBackend *backend = HugDecoderGetBackend(decoder);
+        HugDecoderInfo info = HugDecoderGetInfo(decoder);
+
+        HugDecoderClose(decoder);
+
+        HugDecoderBenchmarkResult result;
+
+        if (!HugDecoderRunBenchmark(argv[i], backend, &result)) {
+            printf("%s: %s, decode failed\n", argv[i], backend->name);
+            status = 1;
+            continue;
+        }
+
+        printf("%s: %s, %u ch, %.0f Hz, %u-bit%s, %lld frames, %.1fx realtime, %zu/%zu seeks exact\n",
+            argv[i], backend->name,
+            info.channelCount, info.sampleRate, info.bitsPerSample, info.isFloat ? " float" : "",
+            (long long)result.frameCount,
+            result.framesPerSecond / info.sampleRate,
+            result.seekCount - result.seekMismatchCount, result.seekCount
+        );
+
+        if (result.frameCount != info.frameCount || result.seekMismatchCount) {
+            status = 1;
+        }
+    }
+
+    return status;
+}
+
+#endif
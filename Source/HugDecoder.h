@@ -0,0 +1,108 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Decodes an audio file into planar 32-bit float.
+//
+// Each format is handled by a HugDecoderBackend. HugDecoderOpen() reads the
+// start of the file and offers it to each backend in turn. WAV, RF64, AIFF,
+// AIFF-C, and FLAC are decoded natively and build on any platform. On Apple
+// platforms, everything else falls back to ExtAudioFile.
+//
+// Seeking is sample-accurate for every native backend.
+//
+// To benchmark on Linux without Xcode, build HugDecoder.c, HugDecoderPCM.c,
+// and HugDecoderFLAC.c with -std=c11 -O2 -DHUG_DECODER_MAIN and link with
+// -lm, then pass it audio files. Each file reports its backend, decode speed,
+// and how many seeks landed on exactly the same samples.
+
+typedef struct HugDecoder HugDecoder;
+
+typedef struct {
+    double sampleRate;
+    UInt32 channelCount;
+    SInt64 frameCount;
+    UInt32 bitsPerSample; // 0 if the source is not PCM
+    BOOL   isFloat;
+} HugDecoderInfo;
+
+typedef enum {
+    HugDecoderSampleFormatUnknown = 0,
+    HugDecoderSampleFormatUInt8,
+    HugDecoderSampleFormatSInt8,
+    HugDecoderSampleFormatSInt16,
+    HugDecoderSampleFormatSInt24,
+    HugDecoderSampleFormatSInt32,
+    HugDecoderSampleFormatFloat32,
+    HugDecoderSampleFormatFloat64
+} HugDecoderSampleFormat;
+
+// Where the interleaved samples of an uncompressed file are
+typedef struct {
+    UInt64 dataOffset;
+    UInt32 bytesPerFrame;
+    HugDecoderSampleFormat sampleFormat;
+    BOOL isBigEndian;
+} HugDecoderPCMLayout;
+
+typedef struct HugDecoderBackend {
+    const char *name;
+
+    // Returns YES if header, the first bytes of the file, looks decodable
+    BOOL (*probe)(const UInt8 *header, size_t headerSize);
+
+    // Returns NULL if the file cannot be decoded
+    void *(*open)(const char *path, HugDecoderInfo *outInfo);
+    void  (*close)(void *state);
+
+    BOOL (*seek)(void *state, SInt64 frame);
+
+    // Reads up to frameCount frames into channels, any of which may be NULL.
+    // Returns the number of frames read, 0 at the end, or -1 on error.
+    SInt64 (*read)(void *state, float **channels, size_t frameCount);
+
+    // NULL unless the backend reads uncompressed samples straight from the file
+    BOOL (*getPCMLayout)(void *state, HugDecoderPCMLayout *outLayout);
+} HugDecoderBackend;
+
+enum {
+    HugDecoderProbeSize = 64
+};
+
+extern const HugDecoderBackend HugDecoderBackendPCM;
+extern const HugDecoderBackend HugDecoderBackendFLAC;
+
+#if defined(__APPLE__)
+extern const HugDecoderBackend HugDecoderBackendExtAudioFile;
+#endif
+
+// Uses the first backend which accepts the file, or returns NULL
+extern HugDecoder *HugDecoderOpen(const char *path);
+extern HugDecoder *HugDecoderOpenWithBackend(const char *path, const HugDecoderBackend *backend);
+extern void HugDecoderClose(HugDecoder *decoder);
+
+extern const HugDecoderBackend *HugDecoderGetBackend(const HugDecoder *decoder);
+extern HugDecoderInfo HugDecoderGetInfo(const HugDecoder *decoder);
+
+// Returns NO if the samples are not stored as uncompressed PCM
+extern BOOL HugDecoderGetPCMLayout(const HugDecoder *decoder, HugDecoderPCMLayout *outLayout);
+
+extern BOOL HugDecoderSeek(HugDecoder *decoder, SInt64 frame);
+
+// channels has HugDecoderGetInfo().channelCount entries, any of which may be
+// NULL. On return, ioFrameCount is the number of frames read, 0 at the end.
+extern BOOL HugDecoderRead(HugDecoder *decoder, float **channels, size_t *ioFrameCount);
+
+typedef struct {
+    SInt64 frameCount;
+    double framesPerSecond; // Sequential decode
+    size_t seekCount;
+    size_t seekMismatchCount; // Seeks whose audio differs from a sequential decode
+} HugDecoderBenchmarkResult;
+
+// Decodes the file once sequentially, then seeks to random positions and
+// checks the audio there against the sequential decode
+extern BOOL HugDecoderRunBenchmark(const char *path, const HugDecoderBackend *backend, HugDecoderBenchmarkResult *outResult);
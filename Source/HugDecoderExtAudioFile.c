@@ -0,0 +1,179 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// Fallback decoder for everything Core Audio can read (MP3, AAC, ALAC, ...)
+
+#include "HugDecoder.h"
+
+#if defined(__APPLE__)
+
+#include <AudioToolbox/AudioToolbox.h>
+
+
+typedef struct {
+    ExtAudioFileRef file;
+    UInt32 channelCount;
+    AudioBufferList *bufferList;
+} HugDecoderExtAudioFileState;
+
+
+#pragma mark - Private Functions
+
+// Some files open fine but fail on the first read (DRM, broken packets)
+static BOOL sCanRead(HugDecoderExtAudioFileState *state)
+{
+    enum { testFrameCount = 1024 };
+
+    UInt32 channelCount = state->channelCount;
+    float *data = calloc(testFrameCount * channelCount, sizeof(float));
+
+    AudioBufferList *bufferList = state->bufferList;
+
+    for (UInt32 c = 0; c < channelCount; c++) {
+        bufferList->mBuffers[c].mNumberChannels = 1;
+        bufferList->mBuffers[c].mDataByteSize = testFrameCount * sizeof(float);
+        bufferList->mBuffers[c].mData = data + (c * testFrameCount);
+    }
+
+    UInt32 frameCount = testFrameCount;
+    SInt64 frameOffset = 0;
+
+    OSStatus err = ExtAudioFileTell(state->file, &frameOffset);
+    if (err == noErr) err = ExtAudioFileRead(state->file, &frameCount, bufferList);
+    if (err == noErr) err = ExtAudioFileSeek(state->file, frameOffset);
+
+    free(data);
+
+    return err == noErr;
+}
+
+
+#pragma mark - Backend
+
+static BOOL sProbe(const UInt8 *header, size_t headerSize)
+{
+    return YES;
+}
+
+
+static void sClose(void *inState)
+{
+    HugDecoderExtAudioFileState *state = inState;
+    if (!state) return;
+
+    if (state->file) ExtAudioFileDispose(state->file);
+    free(state->bufferList);
+    free(state);
+}
+
+
+static void *sOpen(const char *path, HugDecoderInfo *outInfo)
+{
+    CFURLRef url = CFURLCreateFromFileSystemRepresentation(NULL, (const UInt8 *)path, strlen(path), false);
+    if (!url) return NULL;
+
+    HugDecoderExtAudioFileState *state = calloc(1, sizeof(HugDecoderExtAudioFileState));
+
+    OSStatus err = ExtAudioFileOpenURL(url, &state->file);
+    CFRelease(url);
+
+    AudioStreamBasicDescription fileDataFormat = {0};
+    SInt64 fileLengthFrames = 0;
+
+    if (err == noErr) {
+        UInt32 size = sizeof(fileDataFormat);
+        err = ExtAudioFileGetProperty(state->file, kExtAudioFileProperty_FileDataFormat, &size, &fileDataFormat);
+    }
+
+    if (err == noErr) {
+        AudioStreamBasicDescription clientDataFormat = {
+            fileDataFormat.mSampleRate,
+            kAudioFormatLinearPCM,
+            kAudioFormatFlagsNativeFloatPacked | kAudioFormatFlagIsNonInterleaved,
+            /* mBytesPerPacket   */  sizeof(float),
+            /* mFramesPerPacket  */  1,
+            /* mBytesPerFrame    */  sizeof(float),
+            /* mChannelsPerFrame */  fileDataFormat.mChannelsPerFrame,
+            /* mBitsPerChannel   */  sizeof(float) * 8,
+            0
+        };
+
+        err = ExtAudioFileSetProperty(state->file, kExtAudioFileProperty_ClientDataFormat, sizeof(clientDataFormat), &clientDataFormat);
+    }
+
+    if (err == noErr) {
+        UInt32 size = sizeof(fileLengthFrames);
+        err = ExtAudioFileGetProperty(state->file, kExtAudioFileProperty_FileLengthFrames, &size, &fileLengthFrames);
+    }
+
+    if (err == noErr && fileDataFormat.mChannelsPerFrame > 0) {
+        state->channelCount = fileDataFormat.mChannelsPerFrame;
+        state->bufferList = calloc(1, offsetof(AudioBufferList, mBuffers) + (state->channelCount * sizeof(AudioBuffer)));
+        state->bufferList->mNumberBuffers = state->channelCount;
+    } else {
+        err = kAudioFileUnsupportedFileTypeError;
+    }
+
+    if (err != noErr || !sCanRead(state)) {
+        sClose(state);
+        return NULL;
+    }
+
+    BOOL isPCM = (fileDataFormat.mFormatID == kAudioFormatLinearPCM);
+
+    HugDecoderInfo info = {0};
+
+    info.sampleRate    = fileDataFormat.mSampleRate;
+    info.channelCount  = fileDataFormat.mChannelsPerFrame;
+    info.frameCount    = fileLengthFrames;
+    info.bitsPerSample = isPCM ? fileDataFormat.mBitsPerChannel : 0;
+    info.isFloat       = isPCM && (fileDataFormat.mFormatFlags & kAudioFormatFlagIsFloat);
+
+    *outInfo = info;
+
+    return state;
+}
+
+
+static BOOL sSeek(void *inState, SInt64 frame)
+{
+    HugDecoderExtAudioFileState *state = inState;
+    return ExtAudioFileSeek(state->file, frame) == noErr;
+}
+
+
+static SInt64 sRead(void *inState, float **channels, size_t frameCount)
+{
+    HugDecoderExtAudioFileState *state = inState;
+    AudioBufferList *bufferList = state->bufferList;
+
+    UInt32 count = (UInt32)MIN(frameCount, (size_t)UINT32_MAX / sizeof(float));
+    float *discard = NULL;
+
+    for (UInt32 c = 0; c < state->channelCount; c++) {
+        float *data = channels[c];
+
+        // ExtAudioFile needs somewhere to put every channel
+        if (!data) {
+            if (!discard) discard = malloc(count * sizeof(float));
+            data = discard;
+        }
+
+        bufferList->mBuffers[c].mNumberChannels = 1;
+        bufferList->mBuffers[c].mDataByteSize = count * sizeof(float);
+        bufferList->mBuffers[c].mData = data;
+    }
+
+    OSStatus err = ExtAudioFileRead(state->file, &count, bufferList);
+
+    free(discard);
+
+    return (err == noErr) ? (SInt64)count : -1;
+}
+
+
+const HugDecoderBackend HugDecoderBackendExtAudioFile = {
+    "ExtAudioFile", sProbe, sOpen, sClose, sSeek, sRead, NULL
+};
+
+#endif
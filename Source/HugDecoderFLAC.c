@@ -0,0 +1,908 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// FLAC decoder. Handles 4 to 24-bit streams with up to 8 channels; anything
+// else is left to the next backend.
+//
+// Seeking uses the SEEKTABLE when present, then bisects the file on frame
+// headers and decodes forward to the requested sample.
+
+// fseeko() and ftello()
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "HugDecoder.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+
+
+enum {
+    sMaxChannels        = 8,
+    sMaxFrameHeaderSize = 16,
+    sInitialBufferSize  = 65536,
+    sMaxLPCOrder        = 32,
+    sMaxBisectCount     = 64,
+
+    // Decode forward rather than bisect when this many blocks away
+    sLinearSeekBlocks   = 4
+};
+
+static const UInt64 sPlaceholderSeekPoint = 0xFFFFFFFFFFFFFFFFull;
+
+typedef struct {
+    UInt64 sampleNumber;
+    UInt64 offset;
+} HugDecoderFLACSeekPoint;
+
+typedef struct {
+    UInt32 blockSize;
+    UInt32 channelAssignment;
+    UInt32 bitsPerSample;
+    SInt64 sampleNumber;
+} HugDecoderFLACFrameHeader;
+
+typedef struct {
+    FILE *file;
+    off_t fileSize;
+
+    // Input buffer. Bytes from frameStart onward are kept for the CRC.
+    UInt8 *buffer;
+    size_t bufferCapacity;
+    size_t bufferEnd;
+    size_t bufferPos;
+    size_t frameStart;
+    off_t  bufferOffset; // File offset of buffer[0]
+
+    // Bit reader, most significant bit first. Bits below cacheBits are zero.
+    UInt64 cache;
+    UInt32 cacheBits;
+    BOOL   reachedEndOfData; // A read needed bits past the last byte of the file
+    BOOL   hasIOError;       // fread() failed, rather than reaching the end
+
+    // STREAMINFO
+    UInt32 minBlockSize;
+    UInt32 maxBlockSize;
+    UInt32 sampleRate;
+    UInt32 channelCount;
+    UInt32 bitsPerSample;
+    SInt64 totalSamples;
+    off_t  firstFrameOffset;
+
+    HugDecoderFLACSeekPoint *seekPoints;
+    size_t seekPointCount;
+
+    // Current block
+    int32_t *samples[sMaxChannels];
+    SInt64 blockStart;
+    UInt32 blockSize;
+    UInt32 blockPosition;
+
+    SInt64 position;
+
+    UInt16 crc16Table[256];
+} HugDecoderFLACState;
+
+
+#pragma mark - Private Functions
+
+static UInt32 sReadBE16(const UInt8 *b) { return (b[0] << 8) | b[1]; }
+static UInt32 sReadBE32(const UInt8 *b) { return ((UInt32)b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3]; }
+static UInt64 sReadBE64(const UInt8 *b) { return ((UInt64)sReadBE32(b) << 32) | sReadBE32(b + 4); }
+
+
+static UInt8 sCRC8(const UInt8 *bytes, size_t length)
+{
+    UInt8 crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+
+        for (NSInteger j = 0; j < 8; j++) {
+            crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+
+static UInt16 sCRC16(const HugDecoderFLACState *state, const UInt8 *bytes, size_t length)
+{
+    UInt16 crc = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        crc = (crc << 8) ^ state->crc16Table[(crc >> 8) ^ bytes[i]];
+    }
+
+    return crc;
+}
+
+
+static BOOL sResetReader(HugDecoderFLACState *state, off_t offset)
+{
+    if (fseeko(state->file, offset, SEEK_SET) != 0) return NO;
+
+    state->bufferOffset     = offset;
+    state->bufferEnd        = 0;
+    state->bufferPos        = 0;
+    state->frameStart       = 0;
+    state->cache            = 0;
+    state->cacheBits        = 0;
+    state->reachedEndOfData = NO;
+    state->hasIOError       = NO;
+
+    clearerr(state->file);
+
+    return YES;
+}
+
+
+// Returns the number of bytes available, which is less than needed at the end
+// of the file. A failed read sets hasIOError and returns what was available.
+static size_t sFillBuffer(HugDecoderFLACState *state, size_t needed)
+{
+    size_t available = state->bufferEnd - state->bufferPos;
+    if (available >= needed) return available;
+
+    size_t keep = MIN(state->frameStart, state->bufferPos);
+
+    if (keep) {
+        memmove(state->buffer, state->buffer + keep, state->bufferEnd - keep);
+
+        state->bufferOffset += keep;
+        state->bufferEnd    -= keep;
+        state->bufferPos    -= keep;
+        state->frameStart   -= keep;
+    }
+
+    // The current frame is larger than the buffer
+    while (state->bufferCapacity - state->bufferPos < needed || state->bufferEnd == state->bufferCapacity) {
+        state->bufferCapacity *= 2;
+        state->buffer = realloc(state->buffer, state->bufferCapacity);
+    }
+
+    size_t requested = state->bufferCapacity - state->bufferEnd;
+    size_t readCount = fread(state->buffer + state->bufferEnd, 1, requested, state->file);
+
+    if (readCount < requested && ferror(state->file)) {
+        state->hasIOError = YES;
+    }
+
+    state->bufferEnd += readCount;
+
+    return state->bufferEnd - state->bufferPos;
+}
+
+
+static inline void sRefill(HugDecoderFLACState *state)
+{
+    if (state->bufferEnd - state->bufferPos >= 8) {
+        const UInt8 *b = state->buffer + state->bufferPos;
+
+        UInt32 byteCount = (64 - state->cacheBits) / 8;
+        UInt32 newBits   = state->cacheBits + (byteCount * 8);
+
+        UInt64 word = sReadBE64(b) >> state->cacheBits;
+        if (newBits < 64) word &= ~(~0ull >> newBits);
+
+        state->cache     |= word;
+        state->cacheBits  = newBits;
+        state->bufferPos += byteCount;
+
+        return;
+    }
+
+    while (state->cacheBits <= 56) {
+        if (state->bufferPos == state->bufferEnd && !sFillBuffer(state, 1)) return;
+
+        state->cache |= (UInt64)state->buffer[state->bufferPos++] << (56 - state->cacheBits);
+        state->cacheBits += 8;
+    }
+}
+
+
+// bitCount must be 1 to 32
+static inline UInt32 sReadBits(HugDecoderFLACState *state, UInt32 bitCount)
+{
+    if (state->cacheBits < bitCount) {
+        sRefill(state);
+
+        if (state->cacheBits < bitCount) {
+            state->reachedEndOfData = YES;
+            return 0;
+        }
+    }
+
+    UInt32 result = (UInt32)(state->cache >> (64 - bitCount));
+
+    state->cache <<= bitCount;
+    state->cacheBits -= bitCount;
+
+    return result;
+}
+
+
+static inline int32_t sReadSigned(HugDecoderFLACState *state, UInt32 bitCount)
+{
+    UInt32 value = sReadBits(state, bitCount);
+    return (int32_t)(value << (32 - bitCount)) >> (32 - bitCount);
+}
+
+
+// Counts zero bits up to the next one bit
+static inline UInt32 sReadUnary(HugDecoderFLACState *state)
+{
+    UInt32 result = 0;
+
+    while (1) {
+        if (state->cache) {
+            UInt32 zeros = __builtin_clzll(state->cache);
+
+            state->cache <<= zeros;
+            state->cache <<= 1;
+            state->cacheBits -= zeros + 1;
+
+            return result + zeros;
+        }
+
+        result += state->cacheBits;
+        state->cacheBits = 0;
+
+        sRefill(state);
+
+        if (!state->cacheBits) {
+            state->reachedEndOfData = YES;
+            return 0;
+        }
+    }
+}
+
+
+static size_t sParseFrameHeader(const HugDecoderFLACState *state, const UInt8 *b, size_t available, HugDecoderFLACFrameHeader *outHeader)
+{
+    if (available < 5) return 0;
+    if (b[0] != 0xFF || (b[1] & 0xFE) != 0xF8) return 0;
+
+    BOOL isVariable = b[1] & 1;
+
+    UInt32 blockSizeCode  = b[2] >> 4;
+    UInt32 sampleRateCode = b[2] & 0xF;
+    UInt32 assignment     = b[3] >> 4;
+    UInt32 sampleSizeCode = (b[3] >> 1) & 0x7;
+
+    if (blockSizeCode == 0 || sampleRateCode == 15 || assignment > 10 || sampleSizeCode == 3 || (b[3] & 1)) {
+        return 0;
+    }
+
+    size_t p = 4;
+
+    // UTF-8 style frame or sample number
+    UInt8  first = b[p++];
+    UInt64 number;
+    size_t extra;
+
+    if      (!(first & 0x80))         { number = first;        extra = 0; }
+    else if ((first & 0xE0) == 0xC0) { number = first & 0x1F; extra = 1; }
+    else if ((first & 0xF0) == 0xE0) { number = first & 0x0F; extra = 2; }
+    else if ((first & 0xF8) == 0xF0) { number = first & 0x07; extra = 3; }
+    else if ((first & 0xFC) == 0xF8) { number = first & 0x03; extra = 4; }
+    else if ((first & 0xFE) == 0xFC) { number = first & 0x01; extra = 5; }
+    else if (first == 0xFE)          { number = 0;            extra = 6; }
+    else return 0;
+
+    if (available < p + extra) return 0;
+
+    for (size_t i = 0; i < extra; i++) {
+        UInt8 c = b[p++];
+        if ((c & 0xC0) != 0x80) return 0;
+        number = (number << 6) | (c & 0x3F);
+    }
+
+    UInt32 blockSize = 0;
+
+    if (blockSizeCode == 1) {
+        blockSize = 192;
+    } else if (blockSizeCode <= 5) {
+        blockSize = 576 << (blockSizeCode - 2);
+    } else if (blockSizeCode == 6) {
+        if (available < p + 1) return 0;
+        blockSize = b[p] + 1;
+        p += 1;
+    } else if (blockSizeCode == 7) {
+        if (available < p + 2) return 0;
+        blockSize = sReadBE16(b + p) + 1;
+        p += 2;
+    } else {
+        blockSize = 256 << (blockSizeCode - 8);
+    }
+
+    UInt32 sampleRate = 0;
+
+    static const UInt32 sSampleRates[12] = {
+        0, 88200, 176400, 192000, 8000, 16000, 22050, 24000, 32000, 44100, 48000, 96000
+    };
+
+    if (sampleRateCode < 12) {
+        sampleRate = sSampleRates[sampleRateCode];
+    } else {
+        size_t size = (sampleRateCode == 12) ? 1 : 2;
+        if (available < p + size) return 0;
+
+        if (sampleRateCode == 12) {
+            sampleRate = b[p] * 1000;
+        } else if (sampleRateCode == 13) {
+            sampleRate = sReadBE16(b + p);
+        } else {
+            sampleRate = sReadBE16(b + p) * 10;
+        }
+
+        p += size;
+    }
+
+    static const UInt32 sSampleSizes[8] = { 0, 8, 12, 0, 16, 20, 24, 32 };
+    UInt32 bitsPerSample = sSampleSizes[sampleSizeCode];
+
+    if (available < p + 1) return 0;
+    if (sCRC8(b, p) != b[p]) return 0;
+    p++;
+
+    // Must agree with STREAMINFO
+    UInt32 channelCount = (assignment < 8) ? (assignment + 1) : 2;
+
+    if (channelCount != state->channelCount) return 0;
+    if (blockSize > state->maxBlockSize) return 0;
+    if (sampleRate && sampleRate != state->sampleRate) return 0;
+    if (bitsPerSample && bitsPerSample != state->bitsPerSample) return 0;
+
+    if (!isVariable) {
+        UInt32 fixedBlockSize = (state->minBlockSize == state->maxBlockSize) ? state->maxBlockSize : blockSize;
+        number *= fixedBlockSize;
+    }
+
+    if (number >= (UInt64)state->totalSamples) return 0;
+
+    outHeader->blockSize         = blockSize;
+    outHeader->channelAssignment = assignment;
+    outHeader->bitsPerSample     = state->bitsPerSample;
+    outHeader->sampleNumber      = (SInt64)number;
+
+    return p;
+}
+
+
+static BOOL sDecodeResidual(HugDecoderFLACState *state, int32_t *output, UInt32 blockSize, UInt32 order)
+{
+    UInt32 method = sReadBits(state, 2);
+    if (method > 1) return NO;
+
+    UInt32 parameterBits  = method ? 5 : 4;
+    UInt32 escape         = method ? 31 : 15;
+    UInt32 partitionOrder = sReadBits(state, 4);
+
+    UInt32 partitionCount = 1u << partitionOrder;
+    UInt32 partitionSize  = blockSize >> partitionOrder;
+
+    if ((partitionSize << partitionOrder) != blockSize || partitionSize < order) {
+        return NO;
+    }
+
+    UInt32 i = order;
+
+    for (UInt32 p = 0; p < partitionCount; p++) {
+        UInt32 parameter = sReadBits(state, parameterBits);
+        UInt32 end = (p + 1) * partitionSize;
+
+        if (parameter == escape) {
+            UInt32 bitCount = sReadBits(state, 5);
+
+            for (; i < end; i++) {
+                output[i] = bitCount ? sReadSigned(state, bitCount) : 0;
+            }
+
+        } else if (parameter == 0) {
+            for (; i < end; i++) {
+                UInt32 value = sReadUnary(state);
+                output[i] = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+            }
+
+        } else {
+            for (; i < end; i++) {
+                UInt32 value = (sReadUnary(state) << parameter) | sReadBits(state, parameter);
+                output[i] = (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+            }
+        }
+
+        if (state->reachedEndOfData) return NO;
+    }
+
+    return YES;
+}
+
+
+static BOOL sDecodeSubframe(HugDecoderFLACState *state, int32_t *output, UInt32 blockSize, UInt32 bitsPerSample)
+{
+    if (sReadBits(state, 1) != 0) return NO;
+
+    UInt32 type = sReadBits(state, 6);
+    UInt32 wastedBits = 0;
+
+    if (sReadBits(state, 1)) {
+        wastedBits = sReadUnary(state) + 1;
+        if (wastedBits >= bitsPerSample) return NO;
+        bitsPerSample -= wastedBits;
+    }
+
+    if (type == 0) {
+        int32_t value = sReadSigned(state, bitsPerSample);
+
+        for (UInt32 i = 0; i < blockSize; i++) {
+            output[i] = value;
+        }
+
+    } else if (type == 1) {
+        for (UInt32 i = 0; i < blockSize; i++) {
+            output[i] = sReadSigned(state, bitsPerSample);
+        }
+
+    } else if (type >= 8 && type <= 12) {
+        UInt32 order = type - 8;
+        if (order > blockSize) return NO;
+
+        for (UInt32 i = 0; i < order; i++) {
+            output[i] = sReadSigned(state, bitsPerSample);
+        }
+
+        if (!sDecodeResidual(state, output, blockSize, order)) return NO;
+
+        int32_t *o = output;
+
+        switch (order) {
+        case 1: for (UInt32 i = 1; i < blockSize; i++) o[i] += o[i - 1];                                                 break;
+        case 2: for (UInt32 i = 2; i < blockSize; i++) o[i] += 2 * o[i - 1] - o[i - 2];                                  break;
+        case 3: for (UInt32 i = 3; i < blockSize; i++) o[i] += 3 * o[i - 1] - 3 * o[i - 2] + o[i - 3];                   break;
+        case 4: for (UInt32 i = 4; i < blockSize; i++) o[i] += 4 * o[i - 1] - 6 * o[i - 2] + 4 * o[i - 3] - o[i - 4];    break;
+        default: break;
+        }
+
+    } else if (type >= 32) {
+        UInt32 order = type - 31;
+        if (order > blockSize) return NO;
+
+        for (UInt32 i = 0; i < order; i++) {
+            output[i] = sReadSigned(state, bitsPerSample);
+        }
+
+        UInt32 precision = sReadBits(state, 4) + 1;
+        int32_t shift = sReadSigned(state, 5);
+
+        if (precision == 16 || shift < 0) return NO;
+
+        int32_t coefficients[sMaxLPCOrder];
+
+        for (UInt32 j = 0; j < order; j++) {
+            coefficients[j] = sReadSigned(state, precision);
+        }
+
+        if (!sDecodeResidual(state, output, blockSize, order)) return NO;
+
+        for (UInt32 i = order; i < blockSize; i++) {
+            const int32_t *history = output + i - 1;
+            int64_t sum = 0;
+
+            for (UInt32 j = 0; j < order; j++) {
+                sum += (int64_t)coefficients[j] * history[-(int32_t)j];
+            }
+
+            output[i] += (int32_t)(sum >> shift);
+        }
+
+    } else {
+        return NO;
+    }
+
+    if (state->reachedEndOfData) return NO;
+
+    if (wastedBits) {
+        for (UInt32 i = 0; i < blockSize; i++) {
+            output[i] = (int32_t)((UInt32)output[i] << wastedBits);
+        }
+    }
+
+    return YES;
+}
+
+
+// Decodes the frame at the current byte position into samples
+static BOOL sDecodeFrame(HugDecoderFLACState *state)
+{
+    // Frames end byte-aligned, so the cache holds whole unread bytes
+    state->bufferPos -= state->cacheBits / 8;
+    state->cache      = 0;
+    state->cacheBits  = 0;
+    state->frameStart = state->bufferPos;
+
+    size_t available = sFillBuffer(state, sMaxFrameHeaderSize);
+
+    if (!available) {
+        state->reachedEndOfData = YES;
+        return NO;
+    }
+
+    HugDecoderFLACFrameHeader header;
+
+    size_t headerSize = sParseFrameHeader(state, state->buffer + state->bufferPos, available, &header);
+    if (!headerSize) return NO;
+
+    state->bufferPos += headerSize;
+
+    UInt32 assignment = header.channelAssignment;
+
+    for (UInt32 c = 0; c < state->channelCount; c++) {
+        BOOL isSide = ((assignment == 8 || assignment == 10) && c == 1) || (assignment == 9 && c == 0);
+        UInt32 bitsPerSample = header.bitsPerSample + (isSide ? 1 : 0);
+
+        if (!sDecodeSubframe(state, state->samples[c], header.blockSize, bitsPerSample)) {
+            return NO;
+        }
+    }
+
+    // Byte-align, then check the footer
+    UInt32 padding = state->cacheBits % 8;
+    state->cache <<= padding;
+    state->cacheBits -= padding;
+
+    size_t end = state->bufferPos - (state->cacheBits / 8);
+    UInt16 crc = sCRC16(state, state->buffer + state->frameStart, end - state->frameStart);
+
+    if (sReadBits(state, 16) != crc || state->reachedEndOfData) {
+        return NO;
+    }
+
+    int32_t *a = state->samples[0];
+    int32_t *b = state->samples[1];
+
+    if (assignment == 8) {
+        for (UInt32 i = 0; i < header.blockSize; i++) b[i] = a[i] - b[i];
+
+    } else if (assignment == 9) {
+        for (UInt32 i = 0; i < header.blockSize; i++) a[i] += b[i];
+
+    } else if (assignment == 10) {
+        for (UInt32 i = 0; i < header.blockSize; i++) {
+            int32_t side = b[i];
+            int32_t mid  = (int32_t)((UInt32)a[i] << 1) | (side & 1);
+
+            a[i] = (mid + side) >> 1;
+            b[i] = (mid - side) >> 1;
+        }
+    }
+
+    state->blockStart    = header.sampleNumber;
+    state->blockSize     = header.blockSize;
+    state->blockPosition = 0;
+
+    return YES;
+}
+
+
+// Decodes the first valid frame at or after offset and before limit
+static BOOL sFindFrame(HugDecoderFLACState *state, off_t offset, off_t limit, off_t *outOffset)
+{
+    if (!sResetReader(state, offset)) return NO;
+
+    while (1) {
+        state->frameStart = state->bufferPos;
+
+        if (sFillBuffer(state, 2) < 2) return NO;
+
+        off_t candidate = state->bufferOffset + state->bufferPos;
+        if (candidate >= limit) return NO;
+
+        const UInt8 *b = state->buffer + state->bufferPos;
+
+        if (b[0] == 0xFF && (b[1] & 0xFE) == 0xF8) {
+            if (sDecodeFrame(state)) {
+                *outOffset = candidate;
+                return YES;
+            }
+
+            if (!sResetReader(state, candidate + 1)) return NO;
+
+        } else {
+            state->bufferPos++;
+        }
+    }
+}
+
+
+static BOOL sReadMetadata(HugDecoderFLACState *state)
+{
+    FILE *file = state->file;
+    UInt8 b[34];
+
+    off_t offset = 0;
+
+    if (fread(b, 1, 10, file) != 10) return NO;
+
+    // Skip an ID3v2 tag, and its footer if present
+    if (!memcmp(b, "ID3", 3)) {
+        UInt32 size = ((b[6] & 0x7f) << 21) | ((b[7] & 0x7f) << 14) | ((b[8] & 0x7f) << 7) | (b[9] & 0x7f);
+        offset = 10 + size + ((b[5] & 0x10) ? 10 : 0);
+
+        if (fseeko(file, offset, SEEK_SET) != 0 || fread(b, 1, 4, file) != 4) return NO;
+    }
+
+    if (memcmp(b, "fLaC", 4) != 0) return NO;
+    offset += 4;
+
+    BOOL hasStreamInfo = NO;
+    BOOL isLast = NO;
+
+    while (!isLast) {
+        if (fseeko(file, offset, SEEK_SET) != 0 || fread(b, 1, 4, file) != 4) return NO;
+
+        isLast = (b[0] & 0x80) != 0;
+
+        UInt32 type   = b[0] & 0x7f;
+        UInt32 length = (b[1] << 16) | (b[2] << 8) | b[3];
+
+        offset += 4;
+
+        if (type == 0 && length >= 34) {
+            if (fread(b, 1, 34, file) != 34) return NO;
+
+            state->minBlockSize  = sReadBE16(b);
+            state->maxBlockSize  = sReadBE16(b + 2);
+            state->sampleRate    = (b[10] << 12) | (b[11] << 4) | (b[12] >> 4);
+            state->channelCount  = ((b[12] >> 1) & 0x7) + 1;
+            state->bitsPerSample = (((b[12] & 1) << 4) | (b[13] >> 4)) + 1;
+            state->totalSamples  = ((SInt64)(b[13] & 0xF) << 32) | sReadBE32(b + 14);
+
+            hasStreamInfo = YES;
+
+        } else if (type == 3 && !state->seekPoints) {
+            size_t count = length / 18;
+
+            state->seekPoints = calloc(count + 1, sizeof(HugDecoderFLACSeekPoint));
+            state->seekPointCount = count;
+
+            for (size_t i = 0; i < count; i++) {
+                if (fread(b, 1, 18, file) != 18) return NO;
+
+                state->seekPoints[i].sampleNumber = sReadBE64(b);
+                state->seekPoints[i].offset       = sReadBE64(b + 8);
+            }
+
+        } else if (type == 127) {
+            return NO;
+        }
+
+        offset += length;
+    }
+
+    state->firstFrameOffset = offset;
+
+    return hasStreamInfo;
+}
+
+
+#pragma mark - Backend
+
+static BOOL sProbe(const UInt8 *header, size_t headerSize)
+{
+    if (headerSize < 4) return NO;
+
+    // An ID3v2 tag may precede the stream marker, in which case open() decides
+    return !memcmp(header, "fLaC", 4) || !memcmp(header, "ID3", 3);
+}
+
+
+static void sClose(void *inState)
+{
+    HugDecoderFLACState *state = inState;
+    if (!state) return;
+
+    if (state->file) fclose(state->file);
+
+    for (NSInteger c = 0; c < sMaxChannels; c++) {
+        free(state->samples[c]);
+    }
+
+    free(state->seekPoints);
+    free(state->buffer);
+    free(state);
+}
+
+
+static void *sOpen(const char *path, HugDecoderInfo *outInfo)
+{
+    HugDecoderFLACState *state = calloc(1, sizeof(HugDecoderFLACState));
+    BOOL ok = YES;
+
+    state->file = fopen(path, "rb");
+    ok = (state->file != NULL);
+
+    if (ok && fseeko(state->file, 0, SEEK_END) == 0) {
+        state->fileSize = ftello(state->file);
+        ok = fseeko(state->file, 0, SEEK_SET) == 0;
+    } else {
+        ok = NO;
+    }
+
+    ok = ok && sReadMetadata(state);
+
+    // A total of 0 means the length is unknown, which we can't seek in
+    ok = ok &&
+        state->channelCount <= sMaxChannels &&
+        state->bitsPerSample >= 4 && state->bitsPerSample <= 24 &&
+        state->sampleRate > 0 &&
+        state->totalSamples > 0 &&
+        state->maxBlockSize >= 16 && state->minBlockSize <= state->maxBlockSize;
+
+    if (ok) {
+        state->bufferCapacity = sInitialBufferSize;
+        state->buffer = malloc(state->bufferCapacity);
+
+        for (UInt32 c = 0; c < state->channelCount; c++) {
+            state->samples[c] = calloc(state->maxBlockSize, sizeof(int32_t));
+        }
+
+        for (UInt32 i = 0; i < 256; i++) {
+            UInt16 crc = i << 8;
+
+            for (NSInteger j = 0; j < 8; j++) {
+                crc = (crc & 0x8000) ? ((crc << 1) ^ 0x8005) : (crc << 1);
+            }
+
+            state->crc16Table[i] = crc;
+        }
+
+        ok = sResetReader(state, state->firstFrameOffset);
+    }
+
+    if (!ok) {
+        sClose(state);
+        return NULL;
+    }
+
+    HugDecoderInfo info = {0};
+
+    info.sampleRate    = state->sampleRate;
+    info.channelCount  = state->channelCount;
+    info.frameCount    = state->totalSamples;
+    info.bitsPerSample = state->bitsPerSample;
+    info.isFloat       = NO;
+
+    *outInfo = info;
+
+    return state;
+}
+
+
+static BOOL sSeek(void *inState, SInt64 frame)
+{
+    HugDecoderFLACState *state = inState;
+
+    if (frame >= state->totalSamples) {
+        state->position      = state->totalSamples;
+        state->blockSize     = 0;
+        state->blockPosition = 0;
+
+        return YES;
+    }
+
+    // Already decoded
+    if (frame >= state->blockStart && frame < state->blockStart + state->blockSize) {
+        state->blockPosition = (UInt32)(frame - state->blockStart);
+        state->position = frame;
+
+        return YES;
+    }
+
+    off_t  lo = state->firstFrameOffset;
+    off_t  hi = state->fileSize;
+    SInt64 loSample = 0;
+
+    for (size_t i = 0; i < state->seekPointCount; i++) {
+        HugDecoderFLACSeekPoint point = state->seekPoints[i];
+        if (point.sampleNumber == sPlaceholderSeekPoint) continue;
+
+        off_t offset = state->firstFrameOffset + (off_t)point.offset;
+        if (offset >= state->fileSize) continue;
+
+        if ((SInt64)point.sampleNumber <= frame) {
+            if ((SInt64)point.sampleNumber >= loSample) {
+                lo = offset;
+                loSample = point.sampleNumber;
+            }
+        } else {
+            hi = MIN(hi, offset);
+        }
+    }
+
+    SInt64 linearLimit = (SInt64)sLinearSeekBlocks * state->maxBlockSize;
+
+    for (NSInteger i = 0; i < sMaxBisectCount && (frame - loSample) >= linearLimit; i++) {
+        off_t mid = lo + ((hi - lo) / 2);
+        if (mid <= lo) break;
+
+        off_t offset;
+
+        if (sFindFrame(state, mid, hi, &offset) && state->blockStart <= frame) {
+            lo = offset;
+            loSample = state->blockStart;
+
+            if (frame < state->blockStart + state->blockSize) {
+                state->blockPosition = (UInt32)(frame - state->blockStart);
+                state->position = frame;
+
+                return YES;
+            }
+
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (!sResetReader(state, lo)) return NO;
+
+    do {
+        if (!sDecodeFrame(state)) return NO;
+    } while (frame >= state->blockStart + state->blockSize);
+
+    if (frame < state->blockStart) return NO;
+
+    state->blockPosition = (UInt32)(frame - state->blockStart);
+    state->position = frame;
+
+    return YES;
+}
+
+
+static SInt64 sRead(void *inState, float **channels, size_t frameCount)
+{
+    HugDecoderFLACState *state = inState;
+
+    float scale = 1.0f / (float)(1 << (state->bitsPerSample - 1));
+    size_t total = 0;
+
+    while (total < frameCount && state->position < state->totalSamples) {
+        if (state->blockPosition >= state->blockSize) {
+            if (!sDecodeFrame(state)) {
+                if (!state->reachedEndOfData || state->hasIOError) return -1;
+
+                // Truncated, the file is shorter than STREAMINFO claims
+                state->totalSamples = state->position;
+                break;
+            }
+        }
+
+        size_t count = state->blockSize - state->blockPosition;
+        count = MIN(count, frameCount - total);
+        count = (size_t)MIN((SInt64)count, state->totalSamples - state->position);
+
+        for (UInt32 c = 0; c < state->channelCount; c++) {
+            if (!channels[c]) continue;
+
+            const int32_t *input = state->samples[c] + state->blockPosition;
+            float *output = channels[c] + total;
+
+            for (size_t i = 0; i < count; i++) {
+                output[i] = input[i] * scale;
+            }
+        }
+
+        total += count;
+        state->blockPosition += count;
+        state->position += count;
+    }
+
+    return total;
+}
+
+
+const HugDecoderBackend HugDecoderBackendFLAC = {
+    "FLAC", sProbe, sOpen, sClose, sSeek, sRead, NULL
+};
@@ -0,0 +1,493 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// WAV, RF64, AIFF, and AIFF-C decoder. Reads 8/16/24/32-bit integer and
+// 32/64-bit float samples of either byte order.
+
+// fseeko() and ftello()
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "HugDecoder.h"
+
+#include <stdio.h>
+#include <sys/types.h>
+
+
+typedef struct {
+    FILE *file;
+
+    off_t  dataOffset;
+    SInt64 frameCount;
+    SInt64 position;
+
+    UInt32 channelCount;
+    UInt32 bytesPerFrame;
+    HugDecoderSampleFormat sampleFormat;
+    BOOL isBigEndian;
+
+    UInt8 *scratch;
+} HugDecoderPCMState;
+
+enum {
+    sScratchFrameCount = 4096,
+
+    sWaveFormatPCM        = 0x0001,
+    sWaveFormatFloat      = 0x0003,
+    sWaveFormatExtensible = 0xFFFE
+};
+
+
+#pragma mark - Private Functions
+
+static UInt32 sReadLE16(const UInt8 *b) { return b[0] | (b[1] << 8); }
+static UInt32 sReadLE32(const UInt8 *b) { return b[0] | (b[1] << 8) | (b[2] << 16) | ((UInt32)b[3] << 24); }
+static UInt64 sReadLE64(const UInt8 *b) { return sReadLE32(b) | ((UInt64)sReadLE32(b + 4) << 32); }
+static UInt32 sReadBE16(const UInt8 *b) { return (b[0] << 8) | b[1]; }
+static UInt32 sReadBE32(const UInt8 *b) { return ((UInt32)b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3]; }
+
+
+static double sReadExtended(const UInt8 *b)
+{
+    int    exponent = ((b[0] & 0x7f) << 8) | b[1];
+    UInt64 mantissa = ((UInt64)sReadBE32(b + 2) << 32) | sReadBE32(b + 6);
+
+    if (exponent == 0 && mantissa == 0) return 0;
+
+    double result = ldexp((double)mantissa, exponent - 16383 - 63);
+    return (b[0] & 0x80) ? -result : result;
+}
+
+
+static off_t sGetFileSize(FILE *file)
+{
+    if (fseeko(file, 0, SEEK_END) != 0) return -1;
+    return ftello(file);
+}
+
+
+static BOOL sSetSample(HugDecoderPCMState *state, UInt32 bitsPerSample, BOOL isFloat, BOOL isSigned8)
+{
+    if (isFloat) {
+        if      (bitsPerSample == 32) state->sampleFormat = HugDecoderSampleFormatFloat32;
+        else if (bitsPerSample == 64) state->sampleFormat = HugDecoderSampleFormatFloat64;
+        else return NO;
+
+    } else {
+        if      (bitsPerSample ==  8) state->sampleFormat = isSigned8 ? HugDecoderSampleFormatSInt8 : HugDecoderSampleFormatUInt8;
+        else if (bitsPerSample == 16) state->sampleFormat = HugDecoderSampleFormatSInt16;
+        else if (bitsPerSample == 24) state->sampleFormat = HugDecoderSampleFormatSInt24;
+        else if (bitsPerSample == 32) state->sampleFormat = HugDecoderSampleFormatSInt32;
+        else return NO;
+    }
+
+    return YES;
+}
+
+
+static BOOL sParseWave(HugDecoderPCMState *state, HugDecoderInfo *info, off_t fileSize)
+{
+    FILE *file = state->file;
+    UInt8 b[40];
+
+    if (fread(b, 1, 12, file) != 12) return NO;
+
+    BOOL isRF64 = !memcmp(b, "RF64", 4) || !memcmp(b, "BW64", 4);
+
+    BOOL   hasFormat = NO;
+    UInt64 ds64DataSize = 0;
+
+    UInt32 formatTag = 0;
+    UInt32 blockAlign = 0;
+    UInt32 bitsPerSample = 0;
+
+    while (fread(b, 1, 8, file) == 8) {
+        UInt64 size   = sReadLE32(b + 4);
+        off_t  offset = ftello(file);
+
+        if (!memcmp(b, "ds64", 4) && size >= 24) {
+            if (fread(b, 1, 24, file) != 24) return NO;
+            ds64DataSize = sReadLE64(b + 8);
+
+        } else if (!memcmp(b, "fmt ", 4) && size >= 16) {
+            size_t toRead = MIN(size, 40);
+            if (fread(b, 1, toRead, file) != toRead) return NO;
+
+            formatTag               = sReadLE16(b);
+            state->channelCount     = sReadLE16(b + 2);
+            info->sampleRate        = sReadLE32(b + 4);
+            blockAlign              = sReadLE16(b + 12);
+            bitsPerSample           = sReadLE16(b + 14);
+
+            // The sub-format GUID starts with the format tag
+            if (formatTag == sWaveFormatExtensible && toRead >= 40) {
+                UInt32 validBits = sReadLE16(b + 18);
+                if (validBits && validBits <= bitsPerSample) info->bitsPerSample = validBits;
+                formatTag = sReadLE16(b + 24);
+            }
+
+            hasFormat = YES;
+
+        } else if (!memcmp(b, "data", 4)) {
+            if (!hasFormat) return NO;
+            if (isRF64 && size == 0xFFFFFFFF) size = ds64DataSize;
+
+            state->dataOffset = offset;
+
+            // Files which are still being written often have a bad size
+            if (offset + (off_t)size > fileSize) {
+                size = fileSize - offset;
+            }
+
+            if (formatTag != sWaveFormatPCM && formatTag != sWaveFormatFloat) return NO;
+            if (!state->channelCount || !bitsPerSample) return NO;
+
+            UInt32 containerBits = (blockAlign / state->channelCount) * 8;
+            if (containerBits < bitsPerSample) return NO;
+
+            if (!sSetSample(state, containerBits, formatTag == sWaveFormatFloat, NO)) return NO;
+
+            state->bytesPerFrame = blockAlign;
+            state->frameCount    = size / blockAlign;
+
+            if (!info->bitsPerSample) info->bitsPerSample = bitsPerSample;
+            info->isFloat = (formatTag == sWaveFormatFloat);
+
+            return YES;
+        }
+
+        // Chunks are padded to an even length
+        if (fseeko(file, offset + (off_t)size + (size & 1), SEEK_SET) != 0) return NO;
+    }
+
+    return NO;
+}
+
+
+static BOOL sParseAIFF(HugDecoderPCMState *state, HugDecoderInfo *info, off_t fileSize)
+{
+    FILE *file = state->file;
+    UInt8 b[26];
+
+    if (fread(b, 1, 12, file) != 12) return NO;
+
+    BOOL isAIFC = !memcmp(b + 8, "AIFC", 4);
+
+    BOOL   hasCommon = NO;
+    UInt32 frameCount = 0;
+    UInt32 bitsPerSample = 0;
+    BOOL   isFloat = NO;
+
+    off_t  soundOffset = 0;
+    UInt64 soundSize = 0;
+
+    while (fread(b, 1, 8, file) == 8) {
+        UInt64 size   = sReadBE32(b + 4);
+        off_t  offset = ftello(file);
+
+        if (!memcmp(b, "COMM", 4) && size >= 18) {
+            size_t toRead = isAIFC ? 22 : 18;
+            if (size < toRead || fread(b, 1, toRead, file) != toRead) return NO;
+
+            state->channelCount = sReadBE16(b);
+            frameCount          = sReadBE32(b + 2);
+            bitsPerSample       = sReadBE16(b + 6);
+            info->sampleRate    = sReadExtended(b + 8);
+
+            state->isBigEndian = YES;
+
+            if (isAIFC) {
+                const UInt8 *type = b + 18;
+
+                if (!memcmp(type, "NONE", 4) || !memcmp(type, "twos", 4)) {
+                    // Big-endian integer
+                } else if (!memcmp(type, "sowt", 4)) {
+                    state->isBigEndian = NO;
+                } else if (!memcmp(type, "fl32", 4) || !memcmp(type, "FL32", 4)) {
+                    isFloat = YES;
+                    bitsPerSample = 32;
+                } else if (!memcmp(type, "fl64", 4) || !memcmp(type, "FL64", 4)) {
+                    isFloat = YES;
+                    bitsPerSample = 64;
+                } else {
+                    return NO;
+                }
+            }
+
+            hasCommon = YES;
+
+        } else if (!memcmp(b, "SSND", 4) && size >= 8) {
+            if (fread(b, 1, 8, file) != 8) return NO;
+
+            UInt32 dataOffset = sReadBE32(b);
+
+            soundOffset = offset + 8 + dataOffset;
+            soundSize   = size - 8 - MIN(dataOffset, size - 8);
+
+            if (soundOffset + (off_t)soundSize > fileSize) {
+                soundSize = fileSize > soundOffset ? fileSize - soundOffset : 0;
+            }
+        }
+
+        if (fseeko(file, offset + (off_t)size + (size & 1), SEEK_SET) != 0) break;
+    }
+
+    if (!hasCommon || !soundOffset || !state->channelCount) return NO;
+
+    // Sample sizes which are not a whole number of bytes are left-justified
+    UInt32 containerBits = ((bitsPerSample + 7) / 8) * 8;
+    if (!sSetSample(state, containerBits, isFloat, YES)) return NO;
+
+    state->dataOffset    = soundOffset;
+    state->bytesPerFrame = (containerBits / 8) * state->channelCount;
+    state->frameCount    = MIN((UInt64)frameCount, soundSize / state->bytesPerFrame);
+
+    info->bitsPerSample = bitsPerSample;
+    info->isFloat       = isFloat;
+
+    return YES;
+}
+
+
+static void sConvert(const HugDecoderPCMState *state, const UInt8 *input, float **channels, size_t frameCount)
+{
+    UInt32 channelCount  = state->channelCount;
+    UInt32 bytesPerFrame = state->bytesPerFrame;
+    BOOL   isBigEndian   = state->isBigEndian;
+
+    for (UInt32 c = 0; c < channelCount; c++) {
+        float *output = channels[c];
+        if (!output) continue;
+
+        switch (state->sampleFormat) {
+        case HugDecoderSampleFormatUInt8: {
+            const UInt8 *in = input + c;
+
+            for (size_t i = 0; i < frameCount; i++, in += bytesPerFrame) {
+                output[i] = ((SInt32)in[0] - 128) * (1.0f / 128.0f);
+            }
+
+            break;
+        }
+
+        case HugDecoderSampleFormatSInt8: {
+            const UInt8 *in = input + c;
+
+            for (size_t i = 0; i < frameCount; i++, in += bytesPerFrame) {
+                output[i] = (int8_t)in[0] * (1.0f / 128.0f);
+            }
+
+            break;
+        }
+
+        case HugDecoderSampleFormatSInt16: {
+            const UInt8 *in = input + (c * 2);
+
+            for (size_t i = 0; i < frameCount; i++, in += bytesPerFrame) {
+                int16_t s = isBigEndian ? (int16_t)sReadBE16(in) : (int16_t)sReadLE16(in);
+                output[i] = s * (1.0f / 32768.0f);
+            }
+
+            break;
+        }
+
+        case HugDecoderSampleFormatSInt24: {
+            const UInt8 *in = input + (c * 3);
+
+            for (size_t i = 0; i < frameCount; i++, in += bytesPerFrame) {
+                UInt32 u = isBigEndian ?
+                    (((UInt32)in[0] << 24) | (in[1] << 16) | (in[2] << 8)) :
+                    (((UInt32)in[2] << 24) | (in[1] << 16) | (in[0] << 8));
+
+                output[i] = ((SInt32)u >> 8) * (1.0f / 8388608.0f);
+            }
+
+            break;
+        }
+
+        case HugDecoderSampleFormatSInt32: {
+            const UInt8 *in = input + (c * 4);
+
+            for (size_t i = 0; i < frameCount; i++, in += bytesPerFrame) {
+                SInt32 s = (SInt32)(isBigEndian ? sReadBE32(in) : sReadLE32(in));
+                output[i] = (float)(s * (1.0 / 2147483648.0));
+            }
+
+            break;
+        }
+
+        case HugDecoderSampleFormatFloat32: {
+            const UInt8 *in = input + (c * 4);
+
+            for (size_t i = 0; i < frameCount; i++, in += bytesPerFrame) {
+                UInt32 u = isBigEndian ? sReadBE32(in) : sReadLE32(in);
+                memcpy(&output[i], &u, sizeof(float));
+            }
+
+            break;
+        }
+
+        case HugDecoderSampleFormatFloat64: {
+            const UInt8 *in = input + (c * 8);
+
+            for (size_t i = 0; i < frameCount; i++, in += bytesPerFrame) {
+                UInt64 u = isBigEndian ?
+                    (((UInt64)sReadBE32(in) << 32) | sReadBE32(in + 4)) :
+                    sReadLE64(in);
+
+                double d;
+                memcpy(&d, &u, sizeof(double));
+                output[i] = d;
+            }
+
+            break;
+        }
+
+        case HugDecoderSampleFormatUnknown:
+            break;
+        }
+    }
+}
+
+
+#pragma mark - Backend
+
+static BOOL sProbe(const UInt8 *header, size_t headerSize)
+{
+    if (headerSize < 12) return NO;
+
+    if (!memcmp(header, "RIFF", 4) || !memcmp(header, "RF64", 4) || !memcmp(header, "BW64", 4)) {
+        return !memcmp(header + 8, "WAVE", 4);
+    }
+
+    if (!memcmp(header, "FORM", 4)) {
+        return !memcmp(header + 8, "AIFF", 4) || !memcmp(header + 8, "AIFC", 4);
+    }
+
+    return NO;
+}
+
+
+static void sClose(void *inState)
+{
+    HugDecoderPCMState *state = inState;
+    if (!state) return;
+
+    if (state->file) fclose(state->file);
+    free(state->scratch);
+    free(state);
+}
+
+
+static void *sOpen(const char *path, HugDecoderInfo *outInfo)
+{
+    HugDecoderPCMState *state = calloc(1, sizeof(HugDecoderPCMState));
+    HugDecoderInfo info = {0};
+
+    UInt8 header[12];
+    BOOL ok = YES;
+
+    state->file = fopen(path, "rb");
+    ok = (state->file != NULL);
+
+    off_t fileSize = ok ? sGetFileSize(state->file) : -1;
+    ok = ok && fileSize >= 12 && fseeko(state->file, 0, SEEK_SET) == 0;
+    ok = ok && fread(header, 1, 12, state->file) == 12 && sProbe(header, 12);
+    ok = ok && fseeko(state->file, 0, SEEK_SET) == 0;
+
+    if (ok) {
+        ok = !memcmp(header, "FORM", 4) ?
+            sParseAIFF(state, &info, fileSize) :
+            sParseWave(state, &info, fileSize);
+    }
+
+    ok = ok && state->bytesPerFrame && info.sampleRate > 0;
+    ok = ok && fseeko(state->file, state->dataOffset, SEEK_SET) == 0;
+
+    if (!ok) {
+        sClose(state);
+        return NULL;
+    }
+
+    state->scratch = malloc(sScratchFrameCount * state->bytesPerFrame);
+
+    info.channelCount = state->channelCount;
+    info.frameCount   = state->frameCount;
+
+    *outInfo = info;
+
+    return state;
+}
+
+
+static BOOL sSeek(void *inState, SInt64 frame)
+{
+    HugDecoderPCMState *state = inState;
+
+    if (fseeko(state->file, state->dataOffset + (off_t)(frame * state->bytesPerFrame), SEEK_SET) != 0) {
+        return NO;
+    }
+
+    state->position = frame;
+
+    return YES;
+}
+
+
+static SInt64 sRead(void *inState, float **channels, size_t frameCount)
+{
+    HugDecoderPCMState *state = inState;
+    UInt32 channelCount = state->channelCount;
+
+    frameCount = (size_t)MIN((SInt64)frameCount, state->frameCount - state->position);
+
+    float *offsetChannels[channelCount];
+    size_t total = 0;
+
+    while (total < frameCount) {
+        size_t toRead = MIN(frameCount - total, (size_t)sScratchFrameCount);
+        size_t count  = fread(state->scratch, state->bytesPerFrame, toRead, state->file);
+
+        if (!count) {
+            if (ferror(state->file)) return -1;
+
+            // Truncated, the file is shorter than its header claims
+            state->frameCount = state->position;
+            break;
+        }
+
+        for (UInt32 c = 0; c < channelCount; c++) {
+            offsetChannels[c] = channels[c] ? channels[c] + total : NULL;
+        }
+
+        sConvert(state, state->scratch, offsetChannels, count);
+
+        total += count;
+        state->position += count;
+    }
+
+    return total;
+}
+
+
+static BOOL sGetPCMLayout(void *inState, HugDecoderPCMLayout *outLayout)
+{
+    HugDecoderPCMState *state = inState;
+
+    HugDecoderPCMLayout layout = {
+        (UInt64)state->dataOffset,
+        state->bytesPerFrame,
+        state->sampleFormat,
+        state->isBigEndian
+    };
+
+    *outLayout = layout;
+
+    return YES;
+}
+
+
+const HugDecoderBackend HugDecoderBackendPCM = {
+    "PCM", sProbe, sOpen, sClose, sSeek, sRead, sGetPCMLayout
+};
@@ -0,0 +1,172 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugErrorChannel.h"
+#include "HugRingBuffer.h"
+
+#include <stdatomic.h>
+
+
+#define HUG_CACHE_LINE 64
+
+// Each packet is preceded by its size and padded so that the next header
+// and timestamp stay aligned
+typedef struct {
+    UInt32 packetSize;
+    UInt32 recordSize;
+} HugErrorChannelHeader;
+
+typedef struct {
+    HugRingBuffer *buffer;
+    _Alignas(HUG_CACHE_LINE) atomic_uint_fast64_t lostCount;
+} HugErrorChannelLane;
+
+struct HugErrorChannel {
+    HugErrorChannelLane *_lanes;
+    size_t _laneCount;
+
+    // Consumer
+    NSInteger _peekedLane; // -1 = nothing peeked
+};
+
+
+#pragma mark - Lifecycle
+
+HugErrorChannel *HugErrorChannelCreate(size_t laneCount, size_t capacity)
+{
+    HugErrorChannel *self = calloc(1, sizeof(HugErrorChannel));
+
+    size_t size = ((laneCount * sizeof(HugErrorChannelLane) + HUG_CACHE_LINE - 1) / HUG_CACHE_LINE) * HUG_CACHE_LINE;
+
+    self->_lanes = aligned_alloc(HUG_CACHE_LINE, MAX(size, HUG_CACHE_LINE));
+    self->_laneCount = laneCount;
+    self->_peekedLane = -1;
+
+    memset(self->_lanes, 0, MAX(size, HUG_CACHE_LINE));
+
+    for (size_t i = 0; i < laneCount; i++) {
+        self->_lanes[i].buffer = HugRingBufferCreate(capacity);
+        atomic_init(&self->_lanes[i].lostCount, 0);
+
+        if (!self->_lanes[i].buffer) {
+            HugErrorChannelFree(self);
+            return NULL;
+        }
+    }
+
+    return self;
+}
+
+
+void HugErrorChannelFree(HugErrorChannel *self)
+{
+    if (!self) return;
+
+    for (size_t i = 0; i < self->_laneCount; i++) {
+        HugRingBufferFree(self->_lanes[i].buffer);
+    }
+
+    free(self->_lanes);
+    free(self);
+}
+
+
+#pragma mark - Private Functions
+
+static const HugErrorChannelHeader *sGetHeader(HugErrorChannelLane *lane)
+{
+    HugErrorChannelHeader *header = HugRingBufferGetReadPtr(lane->buffer, sizeof(HugErrorChannelHeader));
+
+    // The producer publishes the header and packet together
+    if (header && !HugRingBufferGetReadPtr(lane->buffer, header->recordSize)) {
+        return NULL;
+    }
+
+    return header;
+}
+
+
+#pragma mark - Public Functions
+
+BOOL HugErrorChannelPost(HugErrorChannel *self, size_t lane, const void *packet, size_t packetSize)
+{
+    if (lane >= self->_laneCount || packetSize < sizeof(uint64_t)) return NO;
+
+    HugErrorChannelLane *l = &self->_lanes[lane];
+
+    size_t recordSize = sizeof(HugErrorChannelHeader) + ((packetSize + 7) & ~(size_t)7);
+    UInt8 *bytes = HugRingBufferGetWritePtr(l->buffer, recordSize);
+
+    if (!bytes) {
+        atomic_fetch_add_explicit(&l->lostCount, 1, memory_order_relaxed);
+        return NO;
+    }
+
+    HugErrorChannelHeader header = { (UInt32)packetSize, (UInt32)recordSize };
+
+    memcpy(bytes, &header, sizeof(header));
+    memcpy(bytes + sizeof(header), packet, packetSize);
+
+    HugRingBufferConfirmWrite(l->buffer, recordSize);
+
+    return YES;
+}
+
+
+const void *HugErrorChannelPeek(HugErrorChannel *self, size_t *outPacketSize)
+{
+    const HugErrorChannelHeader *oldestHeader = NULL;
+    uint64_t oldestTimestamp = 0;
+
+    self->_peekedLane = -1;
+
+    // Lanes are each in order, so the oldest packet is at the head of one.
+    // Ties go to the lower lane.
+    for (size_t i = 0; i < self->_laneCount; i++) {
+        const HugErrorChannelHeader *header = sGetHeader(&self->_lanes[i]);
+        if (!header) continue;
+
+        uint64_t timestamp;
+        memcpy(&timestamp, header + 1, sizeof(timestamp));
+
+        if (!oldestHeader || timestamp < oldestTimestamp) {
+            oldestHeader    = header;
+            oldestTimestamp = timestamp;
+            self->_peekedLane = i;
+        }
+    }
+
+    if (!oldestHeader) return NULL;
+
+    if (outPacketSize) *outPacketSize = oldestHeader->packetSize;
+
+    return oldestHeader + 1;
+}
+
+
+void HugErrorChannelConsume(HugErrorChannel *self)
+{
+    if (self->_peekedLane < 0) return;
+
+    HugErrorChannelLane *lane = &self->_lanes[self->_peekedLane];
+    const HugErrorChannelHeader *header = sGetHeader(lane);
+
+    if (header) {
+        HugRingBufferConfirmRead(lane->buffer, header->recordSize);
+    }
+
+    self->_peekedLane = -1;
+}
+
+
+uint64_t HugErrorChannelGetLostCount(const HugErrorChannel *self)
+{
+    HugErrorChannel *mutableSelf = (HugErrorChannel *)self;
+    uint64_t result = 0;
+
+    for (size_t i = 0; i < self->_laneCount; i++) {
+        result += atomic_load_explicit(&mutableSelf->_lanes[i].lostCount, memory_order_relaxed);
+    }
+
+    return result;
+}
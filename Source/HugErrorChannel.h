@@ -0,0 +1,34 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Multiple-producer, single-consumer queue for error and overload packets.
+//
+// Each producer writes into its own lane, a single-producer HugRingBuffer, so
+// producers never contend and posting never blocks. The consumer merges the
+// lanes by timestamp. Packets are variable-sized and must begin with a
+// uint64_t timestamp.
+//
+// A packet which does not fit is counted rather than silently lost, so the
+// consumer can always report how many went missing.
+
+typedef struct HugErrorChannel HugErrorChannel;
+
+// capacity is per lane, in bytes
+extern HugErrorChannel *HugErrorChannelCreate(size_t laneCount, size_t capacity);
+extern void HugErrorChannelFree(HugErrorChannel *channel);
+
+// Producer. Only one thread may write to a given lane at a time.
+// Returns NO if the lane was full and the packet was counted as lost.
+extern BOOL HugErrorChannelPost(HugErrorChannel *channel, size_t lane, const void *packet, size_t packetSize);
+
+// Consumer. Returns the packet with the oldest timestamp across all lanes, or
+// NULL. The pointer is valid until the next consumer call.
+extern const void *HugErrorChannelPeek(HugErrorChannel *channel, size_t *outPacketSize);
+extern void HugErrorChannelConsume(HugErrorChannel *channel);
+
+// Number of packets which were lost because their lane was full
+extern uint64_t HugErrorChannelGetLostCount(const HugErrorChannel *channel);
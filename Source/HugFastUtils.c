@@ -0,0 +1,73 @@
+// (c) 2014-2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugFastUtils.h"
+#include "HugKernels.h"
+
+
+void HugApplySilence(float *samples, size_t frameCount)
+{
+    if (!samples) return;
+
+    memset(samples, 0, frameCount * sizeof(float));
+}
+
+
+void HugApplyFade(float *samples, size_t frameCount, float inFromValue, float inToValue)
+{
+    if (!samples || !frameCount) return;
+
+    const double sSilence = pow(10.0, -120.0 / 20.0); // Silence is -120dB
+
+    double fromValue = inFromValue ? inFromValue : sSilence;
+    double toValue   = inToValue   ? inToValue   : sSilence;
+    
+    double multiplier = pow(toValue / fromValue, 1 / (double)frameCount);
+
+    HugKernels.exponentialRamp(samples, frameCount, fromValue, multiplier);
+}
+
+
+void HugApplyGain(float *samples, size_t frameCount, float gain)
+{
+    if (!samples) return;
+
+    HugKernels.gain(samples, frameCount, gain);
+}
+
+
+void HugApplyLinearRamp(float *samples, size_t frameCount, float fromValue, float toValue)
+{
+    if (!samples || !frameCount) return;
+
+    if (frameCount == 1) {
+        samples[0] *= toValue;
+        return;
+    }
+
+    float step = (toValue - fromValue) / (float)(frameCount - 1);
+
+    HugKernels.ramp(samples, frameCount, fromValue, step);
+}
+
+
+void HugGetPeak(const float *samples, size_t frameCount, float *outPeak, size_t *outIndex)
+{
+    float  peak      = 0;
+    size_t peakIndex = 0;
+
+    if (samples && frameCount) {
+        HugKernels.absMax(samples, frameCount, &peak, outIndex ? &peakIndex : NULL);
+    }
+
+    if (outPeak)  *outPeak  = peak;
+    if (outIndex) *outIndex = peakIndex;
+}
+
+
+float HugGetMeanSquare(const float *samples, size_t frameCount)
+{
+    if (!samples || !frameCount) return 0;
+
+    return HugKernels.meanSquare(samples, frameCount);
+}
@@ -1,9 +1,22 @@
 // (c) 2014-2024 Ricci Adams
 // MIT License (or) 1-clause BSD License
 
-#import <Foundation/Foundation.h>
+#pragma once
+
+#include "HugPlatform.h"
 
 
 extern void HugApplySilence(float *samples, size_t frameCount);
 
 extern void HugApplyFade(float *samples, size_t frameCount, float inFromValue, float inToValue);
+
+// samples *= gain
+extern void HugApplyGain(float *samples, size_t frameCount, float gain);
+
+// samples *= linspace(fromValue, toValue, frameCount)
+extern void HugApplyLinearRamp(float *samples, size_t frameCount, float fromValue, float toValue);
+
+// Largest absolute sample value and its index. Both are 0 for an empty buffer.
+extern void HugGetPeak(const float *samples, size_t frameCount, float *outPeak, size_t *outIndex);
+
+extern float HugGetMeanSquare(const float *samples, size_t frameCount);
@@ -0,0 +1,1172 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugKernels.h"
+
+#if defined(__x86_64__)
+#define HUG_KERNELS_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define HUG_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+
+HugKernelTable HugKernels;
+
+
+#pragma mark - Scalar
+
+static void sScalarGain(float *samples, size_t frameCount, float gain)
+{
+    for (size_t i = 0; i < frameCount; i++) {
+        samples[i] *= gain;
+    }
+}
+
+
+static void sScalarRamp(float *samples, size_t frameCount, float from, float step)
+{
+    for (size_t i = 0; i < frameCount; i++) {
+        samples[i] *= from + (step * (float)i);
+    }
+}
+
+
+static void sScalarCubicRamp(float *samples, size_t frameCount, float from, float step)
+{
+    for (size_t i = 0; i < frameCount; i++) {
+        float x = from + (step * (float)i);
+        float m = x * x * x;
+
+        samples[i] *= (m < 1.0f) ? m : 1.0f;
+    }
+}
+
+
+static void sScalarExponentialRamp(float *samples, size_t frameCount, float from, float multiplier)
+{
+    double env = from;
+
+    for (size_t i = 0; i < frameCount; i++) {
+        samples[i] *= env;
+        env *= multiplier;
+    }
+}
+
+
+static void sScalarStereoMatrix(float *left, float *right, size_t frameCount, float from, float step)
+{
+    for (size_t i = 0; i < frameCount; i++) {
+        const float w = from + (step * (float)i);
+        const float myWidth    = (w + 1.0f) *  0.5f;
+        const float otherWidth = (w - 1.0f) * -0.5f;
+
+        const float l = left[i];
+        const float r = right[i];
+
+        left[i]  = (l * myWidth) + (r * otherWidth);
+        right[i] = (r * myWidth) + (l * otherWidth);
+    }
+}
+
+
+static size_t sFindIndex(const float *samples, size_t frameCount, float max)
+{
+    for (size_t i = 0; i < frameCount; i++) {
+        if (fabsf(samples[i]) == max) return i;
+    }
+
+    return 0;
+}
+
+
+static void sScalarAbsMax(const float *samples, size_t frameCount, float *outMax, size_t *outIndex)
+{
+    float  max   = 0;
+    size_t index = 0;
+
+    for (size_t i = 0; i < frameCount; i++) {
+        float value = fabsf(samples[i]);
+
+        if (value > max) {
+            max = value;
+            index = i;
+        }
+    }
+
+    *outMax = max;
+    if (outIndex) *outIndex = index;
+}
+
+
+static float sScalarMeanSquare(const float *samples, size_t frameCount)
+{
+    if (!frameCount) return 0;
+
+    double sum = 0;
+
+    for (size_t i = 0; i < frameCount; i++) {
+        sum += samples[i] * samples[i];
+    }
+
+    return sum / frameCount;
+}
+
+
+static float sScalarDotProduct(const float *a, const float *b, size_t count)
+{
+    float sum = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+
+static void sScalarMixRamp(float *dst, const float *src, size_t frameCount, float from, float step)
+{
+    for (size_t i = 0; i < frameCount; i++) {
+        dst[i] += src[i] * (from + (step * (float)i));
+    }
+}
+
+static void sScalarConvertInt16(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    size_t stride = channelCount * 2;
+
+    for (size_t c = 0; c < channelCount; c++) {
+        const UInt8 *in = (const UInt8 *)input + (c * 2);
+        float *out = outputs[c];
+
+        for (size_t i = 0; i < frameCount; i++, in += stride) {
+            out[i] = (int16_t)(in[0] | (in[1] << 8)) * (1.0f / 32768.0f);
+        }
+    }
+}
+
+
+static void sScalarConvertInt24(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    size_t stride = channelCount * 3;
+
+    for (size_t c = 0; c < channelCount; c++) {
+        const UInt8 *in = (const UInt8 *)input + (c * 3);
+        float *out = outputs[c];
+
+        for (size_t i = 0; i < frameCount; i++, in += stride) {
+            UInt32 u = ((UInt32)in[0] << 8) | ((UInt32)in[1] << 16) | ((UInt32)in[2] << 24);
+            out[i] = ((int32_t)u >> 8) * (1.0f / 8388608.0f);
+        }
+    }
+}
+
+
+static void sScalarConvertFloat32(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount == 1) {
+        memcpy(outputs[0], input, frameCount * sizeof(float));
+        return;
+    }
+
+    for (size_t c = 0; c < channelCount; c++) {
+        const float *in = (const float *)input + c;
+        float *out = outputs[c];
+
+        for (size_t i = 0; i < frameCount; i++, in += channelCount) {
+            out[i] = *in;
+        }
+    }
+}
+
+
+// Converts the frames from index onward with a scalar kernel
+static void sConvertTail(
+    void (*convert)(float * const *, const void *, size_t, size_t),
+    float * const *outputs, const void *input, size_t bytesPerSample,
+    size_t channelCount, size_t frameCount, size_t index
+) {
+    float *tail[2] = { outputs[0] + index, (channelCount > 1) ? outputs[1] + index : NULL };
+    convert(tail, (const UInt8 *)input + (index * channelCount * bytesPerSample), channelCount, frameCount - index);
+}
+
+
+
+#pragma mark - SSE2
+
+#if HUG_KERNELS_X86
+
+static void sSSE2Gain(float *samples, size_t frameCount, float gain)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), g));
+    }
+
+    sScalarGain(samples + i, frameCount - i, gain);
+}
+
+
+static inline __m128 sSSE2RampValue(__m128 from, __m128 step, size_t i)
+{
+    const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    return _mm_add_ps(from, _mm_mul_ps(step, _mm_add_ps(_mm_set1_ps((float)i), lanes)));
+}
+
+
+static void sSSE2Ramp(float *samples, size_t frameCount, float from, float step)
+{
+    const __m128 f = _mm_set1_ps(from);
+    const __m128 s = _mm_set1_ps(step);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128 m = sSSE2RampValue(f, s, i);
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), m));
+    }
+
+    sScalarRamp(samples + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+static void sSSE2CubicRamp(float *samples, size_t frameCount, float from, float step)
+{
+    const __m128 f   = _mm_set1_ps(from);
+    const __m128 s   = _mm_set1_ps(step);
+    const __m128 one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128 x = sSSE2RampValue(f, s, i);
+        __m128 m = _mm_min_ps(_mm_mul_ps(_mm_mul_ps(x, x), x), one);
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), m));
+    }
+
+    sScalarCubicRamp(samples + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+static void sSSE2ExponentialRamp(float *samples, size_t frameCount, float from, float multiplier)
+{
+    float m2 = multiplier * multiplier;
+    __m128 env = _mm_set_ps(from * m2 * multiplier, from * m2, from * multiplier, from);
+    const __m128 m4 = _mm_set1_ps(m2 * m2);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), env));
+        env = _mm_mul_ps(env, m4);
+    }
+
+    float rest[4];
+    _mm_storeu_ps(rest, env);
+    sScalarExponentialRamp(samples + i, frameCount - i, rest[0], multiplier);
+}
+
+
+static void sSSE2StereoMatrix(float *left, float *right, size_t frameCount, float from, float step)
+{
+    const __m128 f    = _mm_set1_ps(from);
+    const __m128 s    = _mm_set1_ps(step);
+    const __m128 one  = _mm_set1_ps(1.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128 w = sSSE2RampValue(f, s, i);
+        __m128 myWidth    = _mm_mul_ps(_mm_add_ps(w, one), half);
+        __m128 otherWidth = _mm_mul_ps(_mm_sub_ps(one, w), half);
+
+        __m128 l = _mm_loadu_ps(left  + i);
+        __m128 r = _mm_loadu_ps(right + i);
+
+        _mm_storeu_ps(left  + i, _mm_add_ps(_mm_mul_ps(l, myWidth), _mm_mul_ps(r, otherWidth)));
+        _mm_storeu_ps(right + i, _mm_add_ps(_mm_mul_ps(r, myWidth), _mm_mul_ps(l, otherWidth)));
+    }
+
+    sScalarStereoMatrix(left + i, right + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+static void sSSE2AbsMax(const float *samples, size_t frameCount, float *outMax, size_t *outIndex)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 vmax = _mm_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        vmax = _mm_max_ps(vmax, _mm_and_ps(_mm_loadu_ps(samples + i), absMask));
+    }
+
+    vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+    vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    float max = _mm_cvtss_f32(vmax);
+
+    for (; i < frameCount; i++) {
+        float value = fabsf(samples[i]);
+        if (value > max) max = value;
+    }
+
+    *outMax = max;
+    if (outIndex) *outIndex = sFindIndex(samples, frameCount, max);
+}
+
+
+static float sSSE2MeanSquare(const float *samples, size_t frameCount)
+{
+    if (!frameCount) return 0;
+
+    __m128 sum = _mm_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128 x = _mm_loadu_ps(samples + i);
+        sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+
+    double total = (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    for (; i < frameCount; i++) {
+        total += samples[i] * samples[i];
+    }
+
+    return total / frameCount;
+}
+
+
+static float sSSE2DotProduct(const float *a, const float *b, size_t count)
+{
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i),     _mm_loadu_ps(b + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(sum0, sum1));
+
+    float total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    return total + sScalarDotProduct(a + i, b + i, count - i);
+}
+
+
+static void sSSE2MixRamp(float *dst, const float *src, size_t frameCount, float from, float step)
+{
+    const __m128 f = _mm_set1_ps(from);
+    const __m128 s = _mm_set1_ps(step);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128 m = sSSE2RampValue(f, s, i);
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(src + i), m);
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), x));
+    }
+
+    sScalarMixRamp(dst + i, src + i, frameCount - i, from + (step * (float)i), step);
+}
+
+static void sSSE2ConvertInt16(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount > 2) {
+        sScalarConvertInt16(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const int16_t *in = input;
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    size_t i = 0;
+
+    if (channelCount == 1) {
+        float *out = outputs[0];
+
+        for (; i + 8 <= frameCount; i += 8) {
+            __m128i x  = _mm_loadu_si128((const __m128i *)(in + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+
+            _mm_storeu_ps(out + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+
+    } else {
+        float *left  = outputs[0];
+        float *right = outputs[1];
+
+        // Each 32-bit lane holds one frame, left in the low half
+        for (; i + 4 <= frameCount; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i *)(in + (i * 2)));
+            __m128i l = _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+            __m128i r = _mm_srai_epi32(x, 16);
+
+            _mm_storeu_ps(left  + i, _mm_mul_ps(_mm_cvtepi32_ps(l), scale));
+            _mm_storeu_ps(right + i, _mm_mul_ps(_mm_cvtepi32_ps(r), scale));
+        }
+    }
+
+    sConvertTail(sScalarConvertInt16, outputs, input, 2, channelCount, frameCount, i);
+}
+
+
+static void sSSE2ConvertFloat32(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount != 2) {
+        sScalarConvertFloat32(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const float *in = input;
+    float *left  = outputs[0];
+    float *right = outputs[1];
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        __m128 a = _mm_loadu_ps(in + (i * 2));
+        __m128 b = _mm_loadu_ps(in + (i * 2) + 4);
+
+        _mm_storeu_ps(left  + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+
+    sConvertTail(sScalarConvertFloat32, outputs, input, 4, channelCount, frameCount, i);
+}
+
+
+
+#pragma mark - AVX2
+
+#define HUG_AVX2 __attribute__((target("avx2")))
+
+HUG_AVX2 static void sAVX2Gain(float *samples, size_t frameCount, float gain)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), g));
+    }
+
+    sScalarGain(samples + i, frameCount - i, gain);
+}
+
+
+HUG_AVX2 static inline __m256 sAVX2RampValue(__m256 from, __m256 step, size_t i)
+{
+    const __m256 lanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    return _mm256_add_ps(from, _mm256_mul_ps(step, _mm256_add_ps(_mm256_set1_ps((float)i), lanes)));
+}
+
+
+HUG_AVX2 static void sAVX2Ramp(float *samples, size_t frameCount, float from, float step)
+{
+    const __m256 f = _mm256_set1_ps(from);
+    const __m256 s = _mm256_set1_ps(step);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        __m256 m = sAVX2RampValue(f, s, i);
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), m));
+    }
+
+    sScalarRamp(samples + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+HUG_AVX2 static void sAVX2CubicRamp(float *samples, size_t frameCount, float from, float step)
+{
+    const __m256 f   = _mm256_set1_ps(from);
+    const __m256 s   = _mm256_set1_ps(step);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        __m256 x = sAVX2RampValue(f, s, i);
+        __m256 m = _mm256_min_ps(_mm256_mul_ps(_mm256_mul_ps(x, x), x), one);
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), m));
+    }
+
+    sScalarCubicRamp(samples + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+HUG_AVX2 static void sAVX2ExponentialRamp(float *samples, size_t frameCount, float from, float multiplier)
+{
+    float lanes[8];
+    float env = from;
+
+    for (NSInteger j = 0; j < 8; j++) {
+        lanes[j] = env;
+        env *= multiplier;
+    }
+
+    float m2 = multiplier * multiplier;
+    float m4 = m2 * m2;
+
+    __m256 venv = _mm256_loadu_ps(lanes);
+    const __m256 m8 = _mm256_set1_ps(m4 * m4);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), venv));
+        venv = _mm256_mul_ps(venv, m8);
+    }
+
+    _mm256_storeu_ps(lanes, venv);
+    sScalarExponentialRamp(samples + i, frameCount - i, lanes[0], multiplier);
+}
+
+
+HUG_AVX2 static void sAVX2StereoMatrix(float *left, float *right, size_t frameCount, float from, float step)
+{
+    const __m256 f    = _mm256_set1_ps(from);
+    const __m256 s    = _mm256_set1_ps(step);
+    const __m256 one  = _mm256_set1_ps(1.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        __m256 w = sAVX2RampValue(f, s, i);
+        __m256 myWidth    = _mm256_mul_ps(_mm256_add_ps(w, one), half);
+        __m256 otherWidth = _mm256_mul_ps(_mm256_sub_ps(one, w), half);
+
+        __m256 l = _mm256_loadu_ps(left  + i);
+        __m256 r = _mm256_loadu_ps(right + i);
+
+        _mm256_storeu_ps(left  + i, _mm256_add_ps(_mm256_mul_ps(l, myWidth), _mm256_mul_ps(r, otherWidth)));
+        _mm256_storeu_ps(right + i, _mm256_add_ps(_mm256_mul_ps(r, myWidth), _mm256_mul_ps(l, otherWidth)));
+    }
+
+    sScalarStereoMatrix(left + i, right + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+HUG_AVX2 static void sAVX2AbsMax(const float *samples, size_t frameCount, float *outMax, size_t *outIndex)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 vmax = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        vmax = _mm256_max_ps(vmax, _mm256_and_ps(_mm256_loadu_ps(samples + i), absMask));
+    }
+
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+    half = _mm_max_ps(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(2, 3, 0, 1)));
+    half = _mm_max_ps(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    float max = _mm_cvtss_f32(half);
+
+    for (; i < frameCount; i++) {
+        float value = fabsf(samples[i]);
+        if (value > max) max = value;
+    }
+
+    *outMax = max;
+    if (outIndex) *outIndex = sFindIndex(samples, frameCount, max);
+}
+
+
+HUG_AVX2 static float sAVX2MeanSquare(const float *samples, size_t frameCount)
+{
+    if (!frameCount) return 0;
+
+    __m256 sum = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        __m256 x = _mm256_loadu_ps(samples + i);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(x, x));
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, sum);
+
+    double total = 0;
+    for (NSInteger j = 0; j < 8; j++) total += lanes[j];
+
+    for (; i < frameCount; i++) {
+        total += samples[i] * samples[i];
+    }
+
+    return total / frameCount;
+}
+
+
+HUG_AVX2 static float sAVX2DotProduct(const float *a, const float *b, size_t count)
+{
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i)));
+        sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(sum0, sum1));
+
+    float total = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    return total + sScalarDotProduct(a + i, b + i, count - i);
+}
+
+
+HUG_AVX2 static void sAVX2MixRamp(float *dst, const float *src, size_t frameCount, float from, float step)
+{
+    const __m256 f = _mm256_set1_ps(from);
+    const __m256 s = _mm256_set1_ps(step);
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        __m256 m = sAVX2RampValue(f, s, i);
+        __m256 x = _mm256_mul_ps(_mm256_loadu_ps(src + i), m);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), x));
+    }
+
+    sScalarMixRamp(dst + i, src + i, frameCount - i, from + (step * (float)i), step);
+}
+
+HUG_AVX2 static void sAVX2ConvertInt16(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount > 2) {
+        sScalarConvertInt16(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const int16_t *in = input;
+    const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+    size_t i = 0;
+
+    if (channelCount == 1) {
+        float *out = outputs[0];
+
+        for (; i + 8 <= frameCount; i += 8) {
+            __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in + i)));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+        }
+
+    } else {
+        float *left  = outputs[0];
+        float *right = outputs[1];
+
+        for (; i + 8 <= frameCount; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i *)(in + (i * 2)));
+            __m256i l = _mm256_srai_epi32(_mm256_slli_epi32(x, 16), 16);
+            __m256i r = _mm256_srai_epi32(x, 16);
+
+            _mm256_storeu_ps(left  + i, _mm256_mul_ps(_mm256_cvtepi32_ps(l), scale));
+            _mm256_storeu_ps(right + i, _mm256_mul_ps(_mm256_cvtepi32_ps(r), scale));
+        }
+    }
+
+    sConvertTail(sScalarConvertInt16, outputs, input, 2, channelCount, frameCount, i);
+}
+
+
+// Converts 8 consecutive 24-bit samples. Reads 28 bytes.
+HUG_AVX2 static inline __m256 sAVX2LoadInt24(const UInt8 *in, __m256i shuffle, __m256 scale)
+{
+    __m256i x = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)in));
+    x = _mm256_inserti128_si256(x, _mm_loadu_si128((const __m128i *)(in + 12)), 1);
+
+    // Each sample to the top three bytes of a lane, then sign-extend
+    x = _mm256_srai_epi32(_mm256_shuffle_epi8(x, shuffle), 8);
+
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale);
+}
+
+
+HUG_AVX2 static void sAVX2ConvertInt24(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount > 2) {
+        sScalarConvertInt24(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const UInt8 *in = input;
+    const __m256 scale = _mm256_set1_ps(1.0f / 8388608.0f);
+
+    const __m256i shuffle = _mm256_setr_epi8(
+        -1, 0, 1,  2, -1, 3, 4,  5, -1, 6, 7,  8, -1,  9, 10, 11,
+        -1, 0, 1,  2, -1, 3, 4,  5, -1, 6, 7,  8, -1,  9, 10, 11
+    );
+
+    size_t i = 0;
+
+    // Loop conditions leave room for the 4 bytes read past the last sample
+    if (channelCount == 1) {
+        float *out = outputs[0];
+
+        for (; i + 10 <= frameCount; i += 8) {
+            _mm256_storeu_ps(out + i, sAVX2LoadInt24(in + (i * 3), shuffle, scale));
+        }
+
+    } else {
+        float *left  = outputs[0];
+        float *right = outputs[1];
+
+        const __m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+
+        for (; i + 5 <= frameCount; i += 4) {
+            __m256 x = _mm256_permutevar8x32_ps(sAVX2LoadInt24(in + (i * 6), shuffle, scale), order);
+
+            _mm_storeu_ps(left  + i, _mm256_castps256_ps128(x));
+            _mm_storeu_ps(right + i, _mm256_extractf128_ps(x, 1));
+        }
+    }
+
+    sConvertTail(sScalarConvertInt24, outputs, input, 3, channelCount, frameCount, i);
+}
+
+
+HUG_AVX2 static void sAVX2ConvertFloat32(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount != 2) {
+        sScalarConvertFloat32(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const float *in = input;
+    float *left  = outputs[0];
+    float *right = outputs[1];
+    size_t i = 0;
+
+    for (; i + 8 <= frameCount; i += 8) {
+        __m256 a = _mm256_loadu_ps(in + (i * 2));
+        __m256 b = _mm256_loadu_ps(in + (i * 2) + 8);
+
+        // Shuffles stay within 128-bit lanes, so restore the order afterwards
+        __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+
+        _mm256_storeu_ps(left  + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0))));
+        _mm256_storeu_ps(right + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0))));
+    }
+
+    sConvertTail(sScalarConvertFloat32, outputs, input, 4, channelCount, frameCount, i);
+}
+
+
+#endif
+
+
+#pragma mark - NEON
+
+#if HUG_KERNELS_NEON
+
+static void sNEONGain(float *samples, size_t frameCount, float gain)
+{
+    const float32x4_t g = vdupq_n_f32(gain);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), g));
+    }
+
+    sScalarGain(samples + i, frameCount - i, gain);
+}
+
+
+static inline float32x4_t sNEONRampValue(float32x4_t from, float32x4_t step, size_t i)
+{
+    const float lanesArray[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    const float32x4_t lanes = vld1q_f32(lanesArray);
+
+    return vaddq_f32(from, vmulq_f32(step, vaddq_f32(vdupq_n_f32((float)i), lanes)));
+}
+
+
+static void sNEONRamp(float *samples, size_t frameCount, float from, float step)
+{
+    const float32x4_t f = vdupq_n_f32(from);
+    const float32x4_t s = vdupq_n_f32(step);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        float32x4_t m = sNEONRampValue(f, s, i);
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), m));
+    }
+
+    sScalarRamp(samples + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+static void sNEONCubicRamp(float *samples, size_t frameCount, float from, float step)
+{
+    const float32x4_t f   = vdupq_n_f32(from);
+    const float32x4_t s   = vdupq_n_f32(step);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        float32x4_t x = sNEONRampValue(f, s, i);
+        float32x4_t m = vminq_f32(vmulq_f32(vmulq_f32(x, x), x), one);
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), m));
+    }
+
+    sScalarCubicRamp(samples + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+static void sNEONExponentialRamp(float *samples, size_t frameCount, float from, float multiplier)
+{
+    float m2 = multiplier * multiplier;
+    const float lanesArray[4] = { from, from * multiplier, from * m2, from * m2 * multiplier };
+
+    float32x4_t env = vld1q_f32(lanesArray);
+    const float32x4_t m4 = vdupq_n_f32(m2 * m2);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        vst1q_f32(samples + i, vmulq_f32(vld1q_f32(samples + i), env));
+        env = vmulq_f32(env, m4);
+    }
+
+    sScalarExponentialRamp(samples + i, frameCount - i, vgetq_lane_f32(env, 0), multiplier);
+}
+
+
+static void sNEONStereoMatrix(float *left, float *right, size_t frameCount, float from, float step)
+{
+    const float32x4_t f    = vdupq_n_f32(from);
+    const float32x4_t s    = vdupq_n_f32(step);
+    const float32x4_t one  = vdupq_n_f32(1.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        float32x4_t w = sNEONRampValue(f, s, i);
+        float32x4_t myWidth    = vmulq_f32(vaddq_f32(w, one), half);
+        float32x4_t otherWidth = vmulq_f32(vsubq_f32(one, w), half);
+
+        float32x4_t l = vld1q_f32(left  + i);
+        float32x4_t r = vld1q_f32(right + i);
+
+        vst1q_f32(left  + i, vaddq_f32(vmulq_f32(l, myWidth), vmulq_f32(r, otherWidth)));
+        vst1q_f32(right + i, vaddq_f32(vmulq_f32(r, myWidth), vmulq_f32(l, otherWidth)));
+    }
+
+    sScalarStereoMatrix(left + i, right + i, frameCount - i, from + (step * (float)i), step);
+}
+
+
+static void sNEONAbsMax(const float *samples, size_t frameCount, float *outMax, size_t *outIndex)
+{
+    float32x4_t vmax = vdupq_n_f32(0);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        vmax = vmaxq_f32(vmax, vabsq_f32(vld1q_f32(samples + i)));
+    }
+
+    float max = vmaxvq_f32(vmax);
+
+    for (; i < frameCount; i++) {
+        float value = fabsf(samples[i]);
+        if (value > max) max = value;
+    }
+
+    *outMax = max;
+    if (outIndex) *outIndex = sFindIndex(samples, frameCount, max);
+}
+
+
+static float sNEONMeanSquare(const float *samples, size_t frameCount)
+{
+    if (!frameCount) return 0;
+
+    float32x4_t sum = vdupq_n_f32(0);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        float32x4_t x = vld1q_f32(samples + i);
+        sum = vmlaq_f32(sum, x, x);
+    }
+
+    double total = vaddvq_f32(sum);
+
+    for (; i < frameCount; i++) {
+        total += samples[i] * samples[i];
+    }
+
+    return total / frameCount;
+}
+
+
+static float sNEONDotProduct(const float *a, const float *b, size_t count)
+{
+    float32x4_t sum0 = vdupq_n_f32(0);
+    float32x4_t sum1 = vdupq_n_f32(0);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        sum0 = vfmaq_f32(sum0, vld1q_f32(a + i),     vld1q_f32(b + i));
+        sum1 = vfmaq_f32(sum1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+
+    float total = vaddvq_f32(vaddq_f32(sum0, sum1));
+    return total + sScalarDotProduct(a + i, b + i, count - i);
+}
+
+
+static void sNEONMixRamp(float *dst, const float *src, size_t frameCount, float from, float step)
+{
+    const float32x4_t f = vdupq_n_f32(from);
+    const float32x4_t s = vdupq_n_f32(step);
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        float32x4_t m = sNEONRampValue(f, s, i);
+        vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), m));
+    }
+
+    sScalarMixRamp(dst + i, src + i, frameCount - i, from + (step * (float)i), step);
+}
+
+static void sNEONConvertInt16(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount > 2) {
+        sScalarConvertInt16(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const int16_t *in = input;
+    size_t i = 0;
+
+    if (channelCount == 1) {
+        float *out = outputs[0];
+
+        for (; i + 8 <= frameCount; i += 8) {
+            int16x8_t x = vld1q_s16(in + i);
+
+            vst1q_f32(out + i,     vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(x)),  15));
+            vst1q_f32(out + i + 4, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(x)), 15));
+        }
+
+    } else {
+        float *left  = outputs[0];
+        float *right = outputs[1];
+
+        for (; i + 8 <= frameCount; i += 8) {
+            int16x8x2_t x = vld2q_s16(in + (i * 2));
+
+            vst1q_f32(left  + i,     vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(x.val[0])),  15));
+            vst1q_f32(left  + i + 4, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(x.val[0])), 15));
+            vst1q_f32(right + i,     vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(x.val[1])),  15));
+            vst1q_f32(right + i + 4, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(x.val[1])), 15));
+        }
+    }
+
+    sConvertTail(sScalarConvertInt16, outputs, input, 2, channelCount, frameCount, i);
+}
+
+
+// Converts 8 consecutive 24-bit samples into two vectors
+static inline float32x4x2_t sNEONLoadInt24(const UInt8 *in)
+{
+    uint8x8x3_t b = vld3_u8(in);
+
+    uint16x8_t lo = vorrq_u16(vmovl_u8(b.val[0]), vshll_n_u8(b.val[1], 8));
+    int16x8_t  hi = vmovl_s8(vreinterpret_s8_u8(b.val[2]));
+
+    int32x4_t x0 = vorrq_s32(vshll_n_s16(vget_low_s16(hi),  16), vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(lo))));
+    int32x4_t x1 = vorrq_s32(vshll_n_s16(vget_high_s16(hi), 16), vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(lo))));
+
+    float32x4x2_t result = { { vcvtq_n_f32_s32(x0, 23), vcvtq_n_f32_s32(x1, 23) } };
+    return result;
+}
+
+
+static void sNEONConvertInt24(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount > 2) {
+        sScalarConvertInt24(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const UInt8 *in = input;
+    size_t i = 0;
+
+    if (channelCount == 1) {
+        float *out = outputs[0];
+
+        for (; i + 8 <= frameCount; i += 8) {
+            float32x4x2_t x = sNEONLoadInt24(in + (i * 3));
+
+            vst1q_f32(out + i,     x.val[0]);
+            vst1q_f32(out + i + 4, x.val[1]);
+        }
+
+    } else {
+        float *left  = outputs[0];
+        float *right = outputs[1];
+
+        for (; i + 4 <= frameCount; i += 4) {
+            float32x4x2_t x = sNEONLoadInt24(in + (i * 6));
+            float32x4x2_t d = vuzpq_f32(x.val[0], x.val[1]);
+
+            vst1q_f32(left  + i, d.val[0]);
+            vst1q_f32(right + i, d.val[1]);
+        }
+    }
+
+    sConvertTail(sScalarConvertInt24, outputs, input, 3, channelCount, frameCount, i);
+}
+
+
+static void sNEONConvertFloat32(float * const *outputs, const void *input, size_t channelCount, size_t frameCount)
+{
+    if (channelCount != 2) {
+        sScalarConvertFloat32(outputs, input, channelCount, frameCount);
+        return;
+    }
+
+    const float *in = input;
+    float *left  = outputs[0];
+    float *right = outputs[1];
+    size_t i = 0;
+
+    for (; i + 4 <= frameCount; i += 4) {
+        float32x4x2_t x = vld2q_f32(in + (i * 2));
+
+        vst1q_f32(left  + i, x.val[0]);
+        vst1q_f32(right + i, x.val[1]);
+    }
+
+    sConvertTail(sScalarConvertFloat32, outputs, input, 4, channelCount, frameCount, i);
+}
+
+
+#endif
+
+
+#pragma mark - Dispatch
+
+static BOOL sFillTable(HugKernelTable *table, HugKernelLevel level)
+{
+    HugKernelTable result = {
+        HugKernelLevelScalar,
+        sScalarGain,
+        sScalarRamp,
+        sScalarCubicRamp,
+        sScalarExponentialRamp,
+        sScalarStereoMatrix,
+        sScalarAbsMax,
+        sScalarMeanSquare,
+        sScalarDotProduct,
+        sScalarMixRamp,
+        sScalarConvertInt16,
+        sScalarConvertInt24,
+        sScalarConvertFloat32
+    };
+
+    if (level == HugKernelLevelScalar) {
+        // Use scalar table
+
+#if HUG_KERNELS_X86
+    } else if (level == HugKernelLevelSSE2) {
+        result = (HugKernelTable) {
+            HugKernelLevelSSE2,
+            sSSE2Gain,
+            sSSE2Ramp,
+            sSSE2CubicRamp,
+            sSSE2ExponentialRamp,
+            sSSE2StereoMatrix,
+            sSSE2AbsMax,
+            sSSE2MeanSquare,
+            sSSE2DotProduct,
+            sSSE2MixRamp,
+            sSSE2ConvertInt16,
+            sScalarConvertInt24, // Needs a byte shuffle, which SSE2 lacks
+            sSSE2ConvertFloat32
+        };
+
+    } else if (level == HugKernelLevelAVX2 && __builtin_cpu_supports("avx2")) {
+        result = (HugKernelTable) {
+            HugKernelLevelAVX2,
+            sAVX2Gain,
+            sAVX2Ramp,
+            sAVX2CubicRamp,
+            sAVX2ExponentialRamp,
+            sAVX2StereoMatrix,
+            sAVX2AbsMax,
+            sAVX2MeanSquare,
+            sAVX2DotProduct,
+            sAVX2MixRamp,
+            sAVX2ConvertInt16,
+            sAVX2ConvertInt24,
+            sAVX2ConvertFloat32
+        };
+#endif
+
+#if HUG_KERNELS_NEON
+    } else if (level == HugKernelLevelNEON) {
+        result = (HugKernelTable) {
+            HugKernelLevelNEON,
+            sNEONGain,
+            sNEONRamp,
+            sNEONCubicRamp,
+            sNEONExponentialRamp,
+            sNEONStereoMatrix,
+            sNEONAbsMax,
+            sNEONMeanSquare,
+            sNEONDotProduct,
+            sNEONMixRamp,
+            sNEONConvertInt16,
+            sNEONConvertInt24,
+            sNEONConvertFloat32
+        };
+#endif
+
+    } else {
+        return NO;
+    }
+
+    *table = result;
+    return YES;
+}
+
+
+HugKernelLevel HugKernelsGetBestLevel(void)
+{
+#if HUG_KERNELS_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? HugKernelLevelAVX2 : HugKernelLevelSSE2;
+#elif HUG_KERNELS_NEON
+    return HugKernelLevelNEON;
+#else
+    return HugKernelLevelScalar;
+#endif
+}
+
+
+const char *HugKernelsGetLevelName(HugKernelLevel level)
+{
+    if (level == HugKernelLevelSSE2) return "SSE2";
+    if (level == HugKernelLevelAVX2) return "AVX2";
+    if (level == HugKernelLevelNEON) return "NEON";
+
+    return "Scalar";
+}
+
+
+BOOL HugKernelsSetLevel(HugKernelLevel level)
+{
+    return sFillTable(&HugKernels, level);
+}
+
+
+__attribute__((constructor)) static void sInitializeKernels(void)
+{
+    sFillTable(&HugKernels, HugKernelsGetBestLevel());
+}
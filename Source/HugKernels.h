@@ -0,0 +1,71 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Vectorized inner loops used by the DSP stages.
+//
+// Each kernel has a scalar reference implementation and SSE2/AVX2 (x86-64)
+// or NEON (arm64) implementations. HugKernels points at the best
+// implementation for the running CPU and is filled in before main().
+//
+// Ramps are evaluated as (from + step * i) for every sample rather than
+// accumulated, so long buffers do not drift.
+
+typedef enum {
+    HugKernelLevelScalar = 0,
+    HugKernelLevelSSE2   = 1,
+    HugKernelLevelAVX2   = 2,
+    HugKernelLevelNEON   = 3
+} HugKernelLevel;
+
+typedef struct HugKernelTable {
+    HugKernelLevel level;
+
+    // samples *= gain
+    void (*gain)(float *samples, size_t frameCount, float gain);
+
+    // samples[i] *= (from + step * i)
+    void (*ramp)(float *samples, size_t frameCount, float from, float step);
+
+    // samples[i] *= MIN(1, (from + step * i) ^ 3)
+    void (*cubicRamp)(float *samples, size_t frameCount, float from, float step);
+
+    // samples[i] *= from * multiplier ^ i
+    void (*exponentialRamp)(float *samples, size_t frameCount, float from, float multiplier);
+
+    // Stereo width matrix with width w = (from + step * i):
+    //   left'  = left  * (w + 1) / 2 + right * (1 - w) / 2
+    //   right' = right * (w + 1) / 2 + left  * (1 - w) / 2
+    void (*stereoMatrix)(float *left, float *right, size_t frameCount, float from, float step);
+
+    // Largest absolute value and the index of its first occurrence.
+    // outIndex may be NULL, which skips the index search.
+    void (*absMax)(const float *samples, size_t frameCount, float *outMax, size_t *outIndex);
+
+    float (*meanSquare)(const float *samples, size_t frameCount);
+
+    // sum(a[i] * b[i])
+    float (*dotProduct)(const float *a, const float *b, size_t count);
+
+    // dst[i] += src[i] * (from + step * i)
+    void (*mixRamp)(float *dst, const float *src, size_t frameCount, float from, float step);
+
+    // Deinterleave little-endian PCM into outputs, which has channelCount
+    // entries. Integers are scaled by 2^-15 or 2^-23, so results are exact.
+    // Mono and stereo are vectorized; other layouts use the scalar loop.
+    void (*convertInt16)(float * const *outputs, const void *input, size_t channelCount, size_t frameCount);
+    void (*convertInt24)(float * const *outputs, const void *input, size_t channelCount, size_t frameCount);
+    void (*convertFloat32)(float * const *outputs, const void *input, size_t channelCount, size_t frameCount);
+} HugKernelTable;
+
+extern HugKernelTable HugKernels;
+
+extern HugKernelLevel HugKernelsGetBestLevel(void);
+extern const char *HugKernelsGetLevelName(HugKernelLevel level);
+
+// Returns NO if the level is not supported on this CPU. Not thread-safe:
+// only call while nothing is rendering (tests, benchmarks).
+extern BOOL HugKernelsSetLevel(HugKernelLevel level);
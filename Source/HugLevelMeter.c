@@ -1,37 +1,8 @@
 // (c) 2014-2024 Ricci Adams
 // MIT License (or) 1-clause BSD License
 
-#import "HugLevelMeter.h"
-
-#import <Accelerate/Accelerate.h>
-
-
-inline static void sGetPeak(float *samples, size_t frameCount, float *outMax, NSInteger *outMaxIndex)
-{
-    float     max      = 0;
-    NSInteger maxIndex = 0;
-
-    float bufferMax;
-    vDSP_Length bufferMaxIndex;
-    vDSP_maxvi(samples, 1, &bufferMax, &bufferMaxIndex, frameCount);
-
-    float bufferMin;
-    vDSP_Length bufferMinIndex;
-    vDSP_minvi(samples, 1, &bufferMin, &bufferMinIndex, frameCount);
-
-    if (-bufferMin > bufferMax) {
-        bufferMax = -bufferMin;
-        bufferMaxIndex = bufferMinIndex;
-    }
-    
-    if (bufferMax > max) {
-        max = bufferMax;
-        maxIndex = bufferMaxIndex;
-    }
-    
-    *outMax = max;
-    *outMaxIndex = maxIndex;
-}
+#include "HugLevelMeter.h"
+#include "HugFastUtils.h"
 
 
 struct HugLevelMeter {
@@ -39,9 +10,6 @@ struct HugLevelMeter {
     double _sampleRate;
     UInt8  _averageEnabled;
 
-    float *_scratch;
-    size_t _scratchSize;
-
     double _averageLevel;
     double _peakLevel;
     double _heldLevel;
@@ -66,35 +34,10 @@ HugLevelMeter *HugLevelMeterCreate()
 
 void HugLevelMeterFree(HugLevelMeter *meter)
 {
-    if (!meter) return;
-
-    if (meter->_scratch) {
-        free(meter->_scratch);
-    }
-
     free(meter);
 }
 
 
-#pragma mark - Private Methods
-
-static void sRemakeScratch(HugLevelMeter *self)
-{
-    size_t scratchSize = 0;
-    if (self->_averageEnabled && self->_maxFrameCount) {
-        scratchSize = sizeof(float) * self->_maxFrameCount;
-    }
-
-    if (scratchSize != self->_scratchSize) {
-        free(self->_scratch);
-        self->_scratch = scratchSize ? malloc(scratchSize) : NULL;
-        self->_scratchSize = scratchSize;
-    }
-
-    HugLevelMeterReset(self);
-}
-
-
 #pragma mark - Public Methods
 
 void HugLevelMeterReset(HugLevelMeter *self)
@@ -119,15 +62,12 @@ extern void HugLevelMeterProcess(HugLevelMeter *self, float *buffer, size_t fram
 
     float currentAverage;
     float currentPeak;
-    NSInteger peakIndex;
 
-    sGetPeak(buffer, frameCount, &currentPeak, &peakIndex);
+    HugGetPeak(buffer, frameCount, &currentPeak, NULL);
 
-    // Calculate RMS of scratch buffer
-    if (self->_scratch) {
-        vDSP_vsq(buffer, 1, self->_scratch, 1, frameCount);
-        vDSP_meanv(self->_scratch, 1, &currentAverage, frameCount);
-        currentAverage = sqrtf(currentAverage);
+    // Calculate RMS
+    if (self->_averageEnabled) {
+        currentAverage = sqrtf(HugGetMeanSquare(buffer, frameCount));
     } else {
         currentAverage = 0;
     }
@@ -177,7 +117,7 @@ extern void HugLevelMeterProcess(HugLevelMeter *self, float *buffer, size_t fram
 void HugLevelMeterSetSampleRate(HugLevelMeter *self, double sampleRate)
 {
     self->_sampleRate = sampleRate;
-    sRemakeScratch(self);
+    HugLevelMeterReset(self);
 }
 
 
@@ -190,7 +130,7 @@ double HugLevelMeterGetSampleRate(const HugLevelMeter *self)
 void HugLevelMeterSetMaxFrameCount(HugLevelMeter *self, size_t maxFrameCount)
 {
     self->_maxFrameCount = maxFrameCount;
-    sRemakeScratch(self);
+    HugLevelMeterReset(self);
 }
 
 
@@ -203,7 +143,7 @@ size_t HugLevelMeterGetMaxFrameCount(const HugLevelMeter *self)
 void HugLevelMeterSetAverageEnabled(HugLevelMeter *self, UInt8 averageEnabled)
 {
     self->_averageEnabled = averageEnabled;
-    sRemakeScratch(self);
+    HugLevelMeterReset(self);
 }
 
 
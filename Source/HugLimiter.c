@@ -1,9 +1,11 @@
 // (c) 2014-2024 Ricci Adams
 // MIT License (or) 1-clause BSD License
 
-#import "HugLimiter.h"
+#include "HugLimiter.h"
+#include "HugFastUtils.h"
+#include "HugKernels.h"
 
-#import <Accelerate/Accelerate.h>
+#include <stdio.h>
 
 #define CHECK_RESULTS 0
 
@@ -43,60 +45,30 @@ inline static void sApplyEnvelope(
     size_t frameCount,
     float fromMultiplier,
     float toMultiplier,
-    NSInteger toIndex)
+    size_t toIndex)
 {
     // If toIndex is specified, apply linear ramp from fromMultiplier to toMultiplier
     if (toIndex) {
         if (toIndex > frameCount) toIndex = frameCount;
     
-        for (NSInteger s = 0; s < toIndex; s++) {
-            samples[s] *= lerp(fromMultiplier, toMultiplier, (s / (float)toIndex));
-        }
-    }
-
-    if ((frameCount - toIndex) > 0) {
-        vDSP_vsmul(samples + toIndex, 1, &toMultiplier, samples + toIndex, 1, frameCount - toIndex);
+        HugKernels.ramp(samples, toIndex, fromMultiplier, (toMultiplier - fromMultiplier) / (float)toIndex);
     }
-}
-
-inline static void sGetMax(float *samples, size_t frameCount, float *outMax, NSInteger *outMaxIndex)
-{
-    float     max      = 0;
-    NSInteger maxIndex = 0;
 
-    float bufferMax;
-    vDSP_Length bufferMaxIndex;
-    vDSP_maxvi(samples, 1, &bufferMax, &bufferMaxIndex, frameCount);
-
-    float bufferMin;
-    vDSP_Length bufferMinIndex;
-    vDSP_minvi(samples, 1, &bufferMin, &bufferMinIndex, frameCount);
-
-    if (-bufferMin > bufferMax) {
-        bufferMax = -bufferMin;
-        bufferMaxIndex = bufferMinIndex;
-    }
-    
-    if (bufferMax > max) {
-        max = bufferMax;
-        maxIndex = bufferMaxIndex;
+    if (frameCount > toIndex) {
+        HugApplyGain(samples + toIndex, frameCount - toIndex, toMultiplier);
     }
-    
-    *outMax = max;
-    *outMaxIndex = maxIndex;
 }
 
-
-inline static void sGetStereoMax(float *left, float *right, size_t frameCount, float *outMax, NSInteger *outMaxIndex)
+inline static void sGetStereoMax(float *left, float *right, size_t frameCount, float *outMax, size_t *outMaxIndex)
 {
-    float     leftMax      = 0;
-    NSInteger leftMaxIndex = 0;
+    float  leftMax      = 0;
+    size_t leftMaxIndex = 0;
 
-    float     rightMax      = 0;
-    NSInteger rightMaxIndex = 0;
+    float  rightMax      = 0;
+    size_t rightMaxIndex = 0;
 
-    if (left)  sGetMax(left,  frameCount, &leftMax,  &leftMaxIndex);
-    if (right) sGetMax(right, frameCount, &rightMax, &rightMaxIndex);
+    HugGetPeak(left,  frameCount, &leftMax,  &leftMaxIndex);
+    HugGetPeak(right, frameCount, &rightMax, &rightMaxIndex);
  
     if (rightMax > leftMax) {
         leftMax      = rightMax;
@@ -108,7 +80,7 @@ inline static void sGetStereoMax(float *left, float *right, size_t frameCount, f
 }
 
 
-inline static void sRamp(HugLimiter *self, float *left, float *right, size_t frameCount, float max, NSInteger index)
+inline static void sRamp(HugLimiter *self, float *left, float *right, size_t frameCount, float max, size_t index)
 {
     float toMultiplier = sPeakValue / max;
 
@@ -195,7 +167,7 @@ void HugLimiterReset(HugLimiter *self)
 void HugLimiterProcess(HugLimiter *self, float *left, float *right, size_t frameCount)
 {
     float max;
-    NSInteger maxIndex;
+    size_t maxIndex;
 
     sGetStereoMax(left, right, frameCount, &max, &maxIndex);
     
@@ -229,7 +201,7 @@ void HugLimiterProcess(HugLimiter *self, float *left, float *right, size_t frame
 #if CHECK_RESULTS
         sGetStereoMax(left, right, frameCount, &max, &maxIndex);
         if (max >= 1.0) {
-            NSLog(@"Still clipping after limiter");
+            fprintf(stderr, "Still clipping after limiter\n");
         }
 #endif
 }
@@ -1,7 +1,9 @@
 // (c) 2014-2024 Ricci Adams
 // MIT License (or) 1-clause BSD License
 
-#import <Foundation/Foundation.h>
+#pragma once
+
+#include "HugPlatform.h"
 
 typedef struct HugLimiter HugLimiter;
 
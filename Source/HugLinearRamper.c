@@ -0,0 +1,86 @@
+// (c) 2014-2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugLinearRamper.h"
+#include "HugFastUtils.h"
+
+
+struct HugLinearRamper {
+    size_t _maxFrameCount;
+    float  _previousLevel;
+};
+
+
+#pragma mark - Lifecycle
+
+HugLinearRamper *HugLinearRamperCreate()
+{
+    HugLinearRamper *self = calloc(1, sizeof(HugLinearRamper));
+    return self;
+}
+
+
+void HugLinearRamperFree(HugLinearRamper *ramper)
+{
+    free(ramper);
+}
+
+
+#pragma mark - Public Methods
+
+void HugLinearRamperReset(HugLinearRamper *self, float level)
+{
+    self->_previousLevel = level;
+}
+
+
+void HugLinearRamperProcess(HugLinearRamper *self, float *left, float *right, size_t frameCount, float level)
+{  
+    float previousLevel = self->_previousLevel;
+
+    // Fast path, level is the same as previous
+    if (level == previousLevel) {
+        HugApplyGain(left,  frameCount, level);
+        HugApplyGain(right, frameCount, level);
+
+    // Slower path, apply envelope from previousLevel -> level
+    } else {
+        HugApplyLinearRamp(left,  frameCount, previousLevel, level);
+        HugApplyLinearRamp(right, frameCount, previousLevel, level);
+    }
+    
+    self->_previousLevel = level;
+}
+
+
+void HugLinearRamperProcessAutomation(HugLinearRamper *self, float *left, float *right, size_t frameCount, HugAutomation *automation, HugAutomationParameter parameter)
+{
+    size_t offset = 0;
+
+    while (offset < frameCount) {
+        HugAutomationSegment segment;
+        size_t segmentFrameCount = HugAutomationRead(automation, parameter, frameCount - offset, &segment);
+
+        HugAutomationApplyGain(left  ? left  + offset : NULL, segmentFrameCount, &segment);
+        HugAutomationApplyGain(right ? right + offset : NULL, segmentFrameCount, &segment);
+
+        offset += segmentFrameCount;
+    }
+
+    // Keeps -HugLinearRamperProcess continuous if the caller switches back
+    self->_previousLevel = HugAutomationGetValue(automation, parameter);
+}
+
+
+#pragma mark - Accessors
+
+void HugLinearRamperSetMaxFrameCount(HugLinearRamper *self, size_t maxFrameCount)
+{
+    self->_maxFrameCount = maxFrameCount;
+}
+
+
+size_t HugLinearRamperGetMaxFrameCount(HugLinearRamper *self)
+{
+    return self->_maxFrameCount;
+}
@@ -1,7 +1,10 @@
 // (c) 2014-2024 Ricci Adams
 // MIT License (or) 1-clause BSD License
 
-#import <Foundation/Foundation.h>
+#pragma once
+
+#include "HugPlatform.h"
+#include "HugAutomation.h"
 
 typedef struct HugLinearRamper HugLinearRamper;
 
@@ -13,3 +16,6 @@ extern size_t HugLinearRamperGetMaxFrameCount(HugLinearRamper *ramper);
 
 extern void HugLinearRamperReset(HugLinearRamper *ramper, float level);
 void HugLinearRamperProcess(HugLinearRamper *self, float *left, float *right, size_t frameCount, float level);
+
+// Applies parameter from automation rather than a single level per buffer
+extern void HugLinearRamperProcessAutomation(HugLinearRamper *self, float *left, float *right, size_t frameCount, HugAutomation *automation, HugAutomationParameter parameter);
@@ -0,0 +1,250 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugLoudnessMeter.h"
+#include "LoudnessFilter.h"
+
+enum {
+    sMomentaryBlockCount = 4,  // 400 ms
+    sShortTermBlockCount = 30  //   3 s
+};
+
+typedef struct {
+    double energy;      // K-weighted, both channels
+    double leftSquare;  // Unweighted, for correlation
+    double rightSquare;
+    double product;
+} HugLoudnessMeterBlock;
+
+
+struct HugLoudnessMeter {
+    double _sampleRate;
+    size_t _framesPerBlock;
+
+    double _coefficients[2][5];
+    double _leftState[2][2];
+    double _rightState[2][2];
+
+    HugLoudnessMeterBlock _current;
+    size_t _currentFrameCount;
+
+    HugLoudnessMeterBlock _blocks[sShortTermBlockCount];
+    size_t _blockIndex;
+    size_t _blockCount;
+
+    float _momentaryLoudness;
+    float _shortTermLoudness;
+    float _correlation;
+};
+
+
+#pragma mark - Private Functions
+
+// Transposed direct form II
+static inline double sBiquad(const double *c, double *state, double input)
+{
+    double output = (c[0] * input) + state[0];
+
+    state[0] = (c[1] * input) - (c[3] * output) + state[1];
+    state[1] = (c[2] * input) - (c[4] * output);
+
+    return output;
+}
+
+
+static inline double sKWeight(const double coefficients[2][5], double state[2][2], double input)
+{
+    return sBiquad(coefficients[1], state[1], sBiquad(coefficients[0], state[0], input));
+}
+
+
+static void sFlushDenormals(double state[2][2])
+{
+    for (NSInteger i = 0; i < 2; i++) {
+        for (NSInteger j = 0; j < 2; j++) {
+            if (fabs(state[i][j]) < 1e-30) state[i][j] = 0;
+        }
+    }
+}
+
+
+static float sGetLoudness(double energy, size_t frameCount)
+{
+    if (!frameCount || energy <= 0) return HugLoudnessMeterMinimumLoudness;
+
+    double loudness = -0.691 + 10.0 * log10(energy / frameCount);
+
+    return loudness < HugLoudnessMeterMinimumLoudness ? HugLoudnessMeterMinimumLoudness : loudness;
+}
+
+
+static HugLoudnessMeterBlock sSumBlocks(const HugLoudnessMeter *self, size_t count)
+{
+    HugLoudnessMeterBlock result = {0};
+
+    if (count > self->_blockCount) count = self->_blockCount;
+
+    for (size_t i = 0; i < count; i++) {
+        size_t index = (self->_blockIndex + sShortTermBlockCount - 1 - i) % sShortTermBlockCount;
+        const HugLoudnessMeterBlock *block = &self->_blocks[index];
+
+        result.energy      += block->energy;
+        result.leftSquare  += block->leftSquare;
+        result.rightSquare += block->rightSquare;
+        result.product     += block->product;
+    }
+
+    return result;
+}
+
+
+static void sFinishBlock(HugLoudnessMeter *self)
+{
+    self->_blocks[self->_blockIndex] = self->_current;
+    self->_blockIndex = (self->_blockIndex + 1) % sShortTermBlockCount;
+
+    if (self->_blockCount < sShortTermBlockCount) {
+        self->_blockCount++;
+    }
+
+    memset(&self->_current, 0, sizeof(HugLoudnessMeterBlock));
+    self->_currentFrameCount = 0;
+
+    // Windows are shorter than nominal until enough audio has been seen
+    size_t framesPerBlock = self->_framesPerBlock;
+    size_t momentaryCount = MIN(self->_blockCount, (size_t)sMomentaryBlockCount);
+
+    HugLoudnessMeterBlock momentary = sSumBlocks(self, sMomentaryBlockCount);
+    HugLoudnessMeterBlock shortTerm = sSumBlocks(self, sShortTermBlockCount);
+
+    self->_momentaryLoudness = sGetLoudness(momentary.energy, momentaryCount   * framesPerBlock);
+    self->_shortTermLoudness = sGetLoudness(shortTerm.energy, self->_blockCount * framesPerBlock);
+
+    double denominator = sqrt(momentary.leftSquare * momentary.rightSquare);
+
+    if (denominator > 1e-12) {
+        double correlation = momentary.product / denominator;
+        self->_correlation = MAX(-1.0, MIN(1.0, correlation));
+    } else {
+        self->_correlation = 0;
+    }
+}
+
+
+#pragma mark - Lifecycle
+
+HugLoudnessMeter *HugLoudnessMeterCreate()
+{
+    HugLoudnessMeter *self = calloc(1, sizeof(HugLoudnessMeter));
+
+    HugLoudnessMeterSetSampleRate(self, 44100);
+
+    return self;
+}
+
+
+void HugLoudnessMeterFree(HugLoudnessMeter *self)
+{
+    free(self);
+}
+
+
+#pragma mark - Public Methods
+
+void HugLoudnessMeterReset(HugLoudnessMeter *self)
+{
+    memset(self->_leftState,  0, sizeof(self->_leftState));
+    memset(self->_rightState, 0, sizeof(self->_rightState));
+    memset(&self->_current,   0, sizeof(HugLoudnessMeterBlock));
+    memset(self->_blocks,     0, sizeof(self->_blocks));
+
+    self->_currentFrameCount = 0;
+    self->_blockIndex = 0;
+    self->_blockCount = 0;
+
+    self->_momentaryLoudness = HugLoudnessMeterMinimumLoudness;
+    self->_shortTermLoudness = HugLoudnessMeterMinimumLoudness;
+    self->_correlation = 0;
+}
+
+
+void HugLoudnessMeterProcess(HugLoudnessMeter *self, const float *left, const float *right, size_t frameCount)
+{
+    const double (*coefficients)[5] = self->_coefficients;
+
+    size_t offset = 0;
+
+    while (offset < frameCount) {
+        size_t framesToProcess = MIN(frameCount - offset, self->_framesPerBlock - self->_currentFrameCount);
+
+        double energy      = 0;
+        double leftSquare  = 0;
+        double rightSquare = 0;
+        double product     = 0;
+
+        for (size_t i = offset; i < (offset + framesToProcess); i++) {
+            double l = left  ? left[i]  : 0;
+            double r = right ? right[i] : 0;
+
+            double weightedLeft  = left  ? sKWeight(coefficients, self->_leftState,  l) : 0;
+            double weightedRight = right ? sKWeight(coefficients, self->_rightState, r) : 0;
+
+            energy      += (weightedLeft * weightedLeft) + (weightedRight * weightedRight);
+            leftSquare  += l * l;
+            rightSquare += r * r;
+            product     += l * r;
+        }
+
+        self->_current.energy      += energy;
+        self->_current.leftSquare  += leftSquare;
+        self->_current.rightSquare += rightSquare;
+        self->_current.product     += product;
+
+        self->_currentFrameCount += framesToProcess;
+        offset += framesToProcess;
+
+        if (self->_currentFrameCount == self->_framesPerBlock) {
+            sFinishBlock(self);
+        }
+    }
+
+    sFlushDenormals(self->_leftState);
+    sFlushDenormals(self->_rightState);
+}
+
+
+#pragma mark - Accessors
+
+void HugLoudnessMeterSetSampleRate(HugLoudnessMeter *self, double sampleRate)
+{
+    self->_sampleRate = sampleRate;
+    self->_framesPerBlock = MAX((size_t)1, (size_t)((sampleRate + 5) / 10));
+
+    LoudnessFilterGetCoefficients(sampleRate, self->_coefficients);
+
+    HugLoudnessMeterReset(self);
+}
+
+
+double HugLoudnessMeterGetSampleRate(const HugLoudnessMeter *self)
+{
+    return self->_sampleRate;
+}
+
+
+float HugLoudnessMeterGetMomentaryLoudness(const HugLoudnessMeter *self)
+{
+    return self->_momentaryLoudness;
+}
+
+
+float HugLoudnessMeterGetShortTermLoudness(const HugLoudnessMeter *self)
+{
+    return self->_shortTermLoudness;
+}
+
+
+float HugLoudnessMeterGetCorrelation(const HugLoudnessMeter *self)
+{
+    return self->_correlation;
+}
@@ -0,0 +1,39 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Live BS.1770 loudness for a stereo signal.
+//
+// Audio is K-weighted and its energy is accumulated into 100 ms blocks.
+// Momentary (400 ms) and short-term (3 s) loudness and the stereo
+// correlation are recomputed each time a block completes. The cost per frame
+// is constant and nothing is allocated after creation.
+
+enum {
+    HugLoudnessMeterMinimumLoudness = -70
+};
+
+typedef struct HugLoudnessMeter HugLoudnessMeter;
+
+extern HugLoudnessMeter *HugLoudnessMeterCreate(void);
+extern void HugLoudnessMeterFree(HugLoudnessMeter *meter);
+
+extern void HugLoudnessMeterReset(HugLoudnessMeter *meter);
+
+// Either channel may be NULL
+extern void HugLoudnessMeterProcess(HugLoudnessMeter *meter, const float *left, const float *right, size_t frameCount);
+
+// Resets the meter
+extern void HugLoudnessMeterSetSampleRate(HugLoudnessMeter *meter, double sampleRate);
+extern double HugLoudnessMeterGetSampleRate(const HugLoudnessMeter *meter);
+
+// In LUFS, clamped to HugLoudnessMeterMinimumLoudness
+extern float HugLoudnessMeterGetMomentaryLoudness(const HugLoudnessMeter *meter);
+extern float HugLoudnessMeterGetShortTermLoudness(const HugLoudnessMeter *meter);
+
+// Pearson correlation of left and right over 400 ms, from -1.0 to +1.0.
+// 0.0 while either channel is silent.
+extern float HugLoudnessMeterGetCorrelation(const HugLoudnessMeter *meter);
@@ -9,6 +9,12 @@ typedef struct HugMeterDataStruct {
     BOOL  limiterActive;
 } HugMeterDataStruct;
 
+typedef struct HugLoudnessDataStruct {
+    float momentaryLoudness;
+    float shortTermLoudness;
+    float correlation;
+} HugLoudnessDataStruct;
+
 
 @interface HugMeterData : NSObject
 
@@ -20,3 +26,13 @@ typedef struct HugMeterDataStruct {
 
 @end
 
+
+@interface HugLoudnessData : NSObject
+
+- (instancetype) initWithStruct:(HugLoudnessDataStruct)loudnessData;
+
+@property (nonatomic, readonly) float momentaryLoudness; // LUFS, 400 ms window
+@property (nonatomic, readonly) float shortTermLoudness; // LUFS, 3 s window
+@property (nonatomic, readonly) float correlation;       // -1.0 to +1.0
+
+@end
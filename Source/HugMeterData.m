@@ -41,4 +41,43 @@
 }
 
 
+@end
+
+
+@implementation HugLoudnessData
+
+- (instancetype) initWithStruct:(HugLoudnessDataStruct)loudnessData
+{
+    if ((self = [super init])) {
+        _momentaryLoudness = loudnessData.momentaryLoudness;
+        _shortTermLoudness = loudnessData.shortTermLoudness;
+        _correlation = loudnessData.correlation;
+    }
+    
+    return self;
+}
+
+
+- (NSUInteger) hash
+{
+    return [@(_momentaryLoudness) hash] ^
+           [@(_shortTermLoudness) hash] ^
+           [@(_correlation) hash];
+}
+
+
+- (BOOL) isEqual:(id)otherObject
+{
+    if (![otherObject isKindOfClass:[HugLoudnessData class]]) {
+        return NO;
+    }
+    
+    HugLoudnessData *otherData = (HugLoudnessData *)otherObject;
+    
+    return _momentaryLoudness == otherData->_momentaryLoudness &&
+           _shortTermLoudness == otherData->_shortTermLoudness &&
+           _correlation       == otherData->_correlation;
+}
+
+
 @end
@@ -0,0 +1,247 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugOfflineRenderer.h"
+#include "HugFastUtils.h"
+
+
+struct HugOfflineRenderer {
+    HugRenderChain *_chain;
+
+    double _sampleRate;
+    size_t _frameSize;
+
+    HugRenderChainParameters _parameters;
+    BOOL _needsReset;
+
+    HugOfflineRendererEffectCallback _effectCallback;
+    void *_effectContext;
+
+    HugOfflineRendererMeterCallback _meterCallback;
+    void *_meterContext;
+
+    float *_left;
+    float *_right;
+
+    uint64_t _position;
+    HugOfflineRendererStatistics _statistics;
+};
+
+
+#pragma mark - Lifecycle
+
+HugOfflineRenderer *HugOfflineRendererCreate(double sampleRate, size_t frameSize)
+{
+    if (sampleRate <= 0 || frameSize == 0) return NULL;
+
+    HugOfflineRenderer *self = calloc(1, sizeof(HugOfflineRenderer));
+
+    self->_sampleRate = sampleRate;
+    self->_frameSize  = frameSize;
+    self->_chain      = HugRenderChainCreate();
+    self->_left       = calloc(frameSize, sizeof(float));
+    self->_right      = calloc(frameSize, sizeof(float));
+
+    self->_parameters = (HugRenderChainParameters){ 1.0f, 0.0f, 1.0f, 1.0f };
+
+    HugRenderChainConfigure(self->_chain, sampleRate, frameSize);
+    HugOfflineRendererReset(self);
+
+    return self;
+}
+
+
+void HugOfflineRendererFree(HugOfflineRenderer *self)
+{
+    if (!self) return;
+
+    HugRenderChainFree(self->_chain);
+
+    free(self->_left);
+    free(self->_right);
+    free(self);
+}
+
+
+#pragma mark - Private Methods
+
+static BOOL sProcessSlice(HugOfflineRenderer *self, float *left, float *right, size_t frameCount)
+{
+    HugRenderChain *chain = self->_chain;
+    const HugRenderChainParameters *parameters = &self->_parameters;
+
+    if (self->_needsReset) {
+        HugRenderChainReset(chain, parameters);
+        self->_needsReset = NO;
+    }
+
+    HugRenderChainProcessInput(chain, left, right, frameCount, parameters);
+
+    if (self->_effectCallback) {
+        if (self->_effectCallback(self->_effectContext, left, right, frameCount) != 0) {
+            return NO;
+        }
+    }
+
+    HugRenderChainProcessOutput(chain, left, right, frameCount, parameters);
+
+    const HugRenderChainMeterPacket *packets = HugRenderChainGetMeterPackets(chain);
+    size_t packetCount = HugRenderChainGetMeterPacketCount(chain);
+
+    for (size_t i = 0; i < packetCount; i++) {
+        const HugRenderChainMeterPacket *packet = &packets[i];
+
+        if (self->_meterCallback) {
+            self->_meterCallback(self->_meterContext, self->_position + packet->frameOffset, packet);
+        }
+
+        if (packet->limiterActive) {
+            self->_statistics.limiterActiveFrameCount += packet->frameCount;
+        }
+    }
+
+    float leftPeak, rightPeak;
+    HugGetPeak(left,  frameCount, &leftPeak,  NULL);
+    HugGetPeak(right, frameCount, &rightPeak, NULL);
+
+    float peak = MAX(leftPeak, rightPeak);
+    if (peak > self->_statistics.peakLevel) {
+        self->_statistics.peakLevel = peak;
+    }
+
+    self->_position += frameCount;
+
+    self->_statistics.frameCount += frameCount;
+    self->_statistics.sliceCount++;
+    self->_statistics.meterPacketCount += packetCount;
+
+    return YES;
+}
+
+
+#pragma mark - Public Methods
+
+void HugOfflineRendererReset(HugOfflineRenderer *self)
+{
+    HugRenderChainConfigure(self->_chain, self->_sampleRate, self->_frameSize);
+    HugRenderChainResetMeters(self->_chain);
+
+    self->_needsReset = YES;
+    self->_position = 0;
+
+    memset(&self->_statistics, 0, sizeof(HugOfflineRendererStatistics));
+}
+
+
+size_t HugOfflineRendererProcess(HugOfflineRenderer *self, float *left, float *right, size_t frameCount)
+{
+    size_t offset = 0;
+
+    while (offset < frameCount) {
+        size_t framesToProcess = MIN(frameCount - offset, self->_frameSize);
+
+        if (!sProcessSlice(self,
+            left  ? left  + offset : NULL,
+            right ? right + offset : NULL,
+            framesToProcess
+        )) {
+            break;
+        }
+
+        offset += framesToProcess;
+    }
+
+    return offset;
+}
+
+
+uint64_t HugOfflineRendererRender(
+    HugOfflineRenderer *self,
+    HugOfflineRendererInputCallback inputCallback,   void *inputContext,
+    HugOfflineRendererOutputCallback outputCallback, void *outputContext
+) {
+    if (!inputCallback) return 0;
+
+    size_t frameSize = self->_frameSize;
+    float *left  = self->_left;
+    float *right = self->_right;
+
+    uint64_t total = 0;
+
+    while (1) {
+        size_t frameCount = inputCallback(inputContext, left, right, frameSize);
+        if (frameCount == 0) break;
+        if (frameCount > frameSize) frameCount = frameSize;
+
+        if (!sProcessSlice(self, left, right, frameCount)) {
+            break;
+        }
+
+        if (outputCallback) {
+            outputCallback(outputContext, left, right, frameCount);
+        }
+
+        total += frameCount;
+    }
+
+    return total;
+}
+
+
+#pragma mark - Accessors
+
+void HugOfflineRendererSetParameters(HugOfflineRenderer *self, const HugRenderChainParameters *parameters)
+{
+    self->_parameters = *parameters;
+}
+
+
+HugRenderChainParameters HugOfflineRendererGetParameters(const HugOfflineRenderer *self)
+{
+    return self->_parameters;
+}
+
+
+void HugOfflineRendererSetLimiterMode(HugOfflineRenderer *self, HugRenderChainLimiterMode mode)
+{
+    HugRenderChainSetLimiterMode(self->_chain, mode);
+    HugOfflineRendererReset(self);
+}
+
+
+void HugOfflineRendererSetEffectCallback(HugOfflineRenderer *self, HugOfflineRendererEffectCallback callback, void *context)
+{
+    self->_effectCallback = callback;
+    self->_effectContext  = context;
+}
+
+
+void HugOfflineRendererSetMeterCallback(HugOfflineRenderer *self, HugOfflineRendererMeterCallback callback, void *context)
+{
+    self->_meterCallback = callback;
+    self->_meterContext  = context;
+}
+
+
+HugOfflineRendererStatistics HugOfflineRendererGetStatistics(const HugOfflineRenderer *self)
+{
+    return self->_statistics;
+}
+
+
+double HugOfflineRendererGetSampleRate(const HugOfflineRenderer *self)
+{
+    return self->_sampleRate;
+}
+
+
+size_t HugOfflineRendererGetFrameSize(const HugOfflineRenderer *self)
+{
+    return self->_frameSize;
+}
+
+
+size_t HugOfflineRendererGetLatency(const HugOfflineRenderer *self)
+{
+    return HugRenderChainGetLatency(self->_chain);
+}
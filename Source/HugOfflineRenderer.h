@@ -0,0 +1,71 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugRenderChain.h"
+
+// Runs the HugRenderChain without audio hardware, as fast as the CPU allows.
+// Audio is processed in slices of frameSize frames, exactly as the render
+// callback would see them at that device frame size.
+//
+// Effects are supplied by the caller via HugOfflineRendererEffectCallback,
+// which runs between the input and output halves of the chain.
+
+typedef struct HugOfflineRenderer HugOfflineRenderer;
+
+// Fills left/right with up to frameCount frames. Returns the number of frames
+// written; 0 signals the end of input.
+typedef size_t (*HugOfflineRendererInputCallback)(void *context, float *left, float *right, size_t frameCount);
+
+typedef void (*HugOfflineRendererOutputCallback)(void *context, const float *left, const float *right, size_t frameCount);
+
+// Returns non-zero on error, which stops the render
+typedef int (*HugOfflineRendererEffectCallback)(void *context, float *left, float *right, size_t frameCount);
+
+// frameIndex is the absolute position of the packet's first frame
+typedef void (*HugOfflineRendererMeterCallback)(void *context, uint64_t frameIndex, const HugRenderChainMeterPacket *packet);
+
+typedef struct HugOfflineRendererStatistics {
+    uint64_t frameCount;
+    uint64_t sliceCount;
+    uint64_t meterPacketCount;
+    uint64_t limiterActiveFrameCount;
+    float    peakLevel;
+} HugOfflineRendererStatistics;
+
+extern HugOfflineRenderer *HugOfflineRendererCreate(double sampleRate, size_t frameSize);
+extern void HugOfflineRendererFree(HugOfflineRenderer *renderer);
+
+// Parameters in effect at the start of the next render are applied without ramping
+extern void HugOfflineRendererSetParameters(HugOfflineRenderer *renderer, const HugRenderChainParameters *parameters);
+extern HugRenderChainParameters HugOfflineRendererGetParameters(const HugOfflineRenderer *renderer);
+
+extern void HugOfflineRendererSetEffectCallback(HugOfflineRenderer *renderer, HugOfflineRendererEffectCallback callback, void *context);
+extern void HugOfflineRendererSetMeterCallback(HugOfflineRenderer *renderer, HugOfflineRendererMeterCallback callback, void *context);
+
+// Resets the renderer. With HugRenderChainLimiterModeTruePeak, output is
+// delayed by HugOfflineRendererGetLatency() frames.
+extern void HugOfflineRendererSetLimiterMode(HugOfflineRenderer *renderer, HugRenderChainLimiterMode mode);
+
+// Resets the chain, meters, position, and statistics
+extern void HugOfflineRendererReset(HugOfflineRenderer *renderer);
+
+// Processes a planar buffer in place. Either channel may be NULL.
+// Returns the number of frames processed.
+extern size_t HugOfflineRendererProcess(HugOfflineRenderer *renderer, float *left, float *right, size_t frameCount);
+
+// Pulls from inputCallback until it returns 0 (or an effect fails) and
+// pushes each processed slice to outputCallback, which may be NULL.
+// Returns the number of frames rendered.
+extern uint64_t HugOfflineRendererRender(
+    HugOfflineRenderer *renderer,
+    HugOfflineRendererInputCallback inputCallback,   void *inputContext,
+    HugOfflineRendererOutputCallback outputCallback, void *outputContext
+);
+
+extern HugOfflineRendererStatistics HugOfflineRendererGetStatistics(const HugOfflineRenderer *renderer);
+
+extern double HugOfflineRendererGetSampleRate(const HugOfflineRenderer *renderer);
+extern size_t HugOfflineRendererGetFrameSize(const HugOfflineRenderer *renderer);
+extern size_t HugOfflineRendererGetLatency(const HugOfflineRenderer *renderer);
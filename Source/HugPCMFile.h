@@ -0,0 +1,46 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import <Foundation/Foundation.h>
+
+// Decoded audio as planar 32-bit float, for mapping into memory.
+//
+// A header is followed by each channel's samples. The header and each
+// channel start on a 16 KB boundary, so that ranges of a channel can be
+// wired without touching the others.
+//
+@interface HugPCMFile : NSObject
+
+// Creates a file of the given size at url and calls block with writable
+// pointers to each channel. The file is complete only if block returns YES.
+//
+// sourceFrameCount is the length of the original file at its own rate, which
+// -[HugAudioSource prepareWithStartTime:...] checks before using the file.
+//
++ (BOOL) writeToURL: (NSURL *) url
+         sampleRate: (double) sampleRate
+       channelCount: (NSInteger) channelCount
+         frameCount: (NSInteger) frameCount
+   sourceFrameCount: (NSInteger) sourceFrameCount
+         usingBlock: (BOOL (^)(float * const *channels)) block;
+
+- (id) initWithFileURL:(NSURL *)url;
+
+// Maps the file read-only. No pages are touched until they are read or wired.
+- (BOOL) open;
+- (void) close;
+
+- (const float *) samplesForChannel:(NSInteger)channel NS_RETURNS_INNER_POINTER;
+
+// Faults in and wires frames in range, and unwires the previously wired range.
+// Wired pages stay resident. Others are clean and may be evicted under pressure.
+- (void) wireFramesInRange:(NSRange)range;
+
+@property (nonatomic, readonly) NSURL *fileURL;
+
+@property (nonatomic, readonly) double sampleRate;
+@property (nonatomic, readonly) NSInteger channelCount;
+@property (nonatomic, readonly) NSInteger frameCount;
+@property (nonatomic, readonly) NSInteger sourceFrameCount;
+
+@end
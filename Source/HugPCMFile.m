@@ -0,0 +1,253 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import "HugPCMFile.h"
+#import "HugUtils.h"
+
+#include <sys/mman.h>
+
+static UInt32 const sMagic = 'HPC1';
+
+// Larger than the page size on both Intel (4 KB) and Apple silicon (16 KB)
+static size_t const sAlignment = 16384;
+
+typedef struct {
+    UInt32 magic; // Written last
+    UInt32 channelCount;
+    double sampleRate;
+    UInt64 frameCount;
+    UInt64 sourceFrameCount;
+    UInt64 channelStride; // Bytes from the start of one channel to the next
+} HugPCMFileHeader;
+
+
+static size_t sGetChannelStride(NSInteger frameCount)
+{
+    size_t length = frameCount * sizeof(float);
+    return ((length + sAlignment - 1) / sAlignment) * sAlignment;
+}
+
+
+static void sSetWired(UInt8 *base, size_t stride, NSInteger channelCount, size_t pageSize, NSRange pages, BOOL wired)
+{
+    if (!pages.length) return;
+
+    for (NSInteger c = 0; c < channelCount; c++) {
+        UInt8 *start  = base + (c * stride) + (pages.location * pageSize);
+        size_t length = pages.length * pageSize;
+
+        if (wired) {
+            mlock(start, length);
+        } else {
+            munlock(start, length);
+        }
+    }
+}
+
+
+// Calls sSetWired() on the parts of a which are not in b
+static void sSetWiredDifference(UInt8 *base, size_t stride, NSInteger channelCount, size_t pageSize, NSRange a, NSRange b, BOOL wired)
+{
+    if (!b.length) {
+        sSetWired(base, stride, channelCount, pageSize, a, wired);
+        return;
+    }
+
+    if (a.location < b.location) {
+        NSUInteger end = MIN(NSMaxRange(a), b.location);
+        sSetWired(base, stride, channelCount, pageSize, NSMakeRange(a.location, end - a.location), wired);
+    }
+
+    if (NSMaxRange(a) > NSMaxRange(b)) {
+        NSUInteger start = MAX(a.location, NSMaxRange(b));
+        sSetWired(base, stride, channelCount, pageSize, NSMakeRange(start, NSMaxRange(a) - start), wired);
+    }
+}
+
+
+@implementation HugPCMFile {
+    UInt8  *_bytes;
+    size_t  _length;
+    size_t  _channelStride;
+    size_t  _pageSize;
+
+    NSRange _wiredPages;
+}
+
+
++ (BOOL) writeToURL: (NSURL *) url
+         sampleRate: (double) sampleRate
+       channelCount: (NSInteger) channelCount
+         frameCount: (NSInteger) frameCount
+   sourceFrameCount: (NSInteger) sourceFrameCount
+         usingBlock: (BOOL (^)(float * const *channels)) block
+{
+    if (channelCount <= 0 || frameCount <= 0) return NO;
+
+    const char *path = [[url path] fileSystemRepresentation];
+
+    size_t stride = sGetChannelStride(frameCount);
+    size_t length = sAlignment + (stride * channelCount);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return NO;
+
+    BOOL ok = (ftruncate(fd, length) == 0);
+    UInt8 *bytes = ok ? mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+    close(fd);
+
+    if (bytes == MAP_FAILED) {
+        HugLog(@"HugPCMFile", @"Could not map %@ for writing, errno: %ld", url, (long)errno);
+        unlink(path);
+        return NO;
+    }
+
+    float *channels[channelCount];
+
+    for (NSInteger c = 0; c < channelCount; c++) {
+        channels[c] = (float *)(bytes + sAlignment + (c * stride));
+    }
+
+    ok = block(channels);
+
+    if (ok) {
+        HugPCMFileHeader *header = (HugPCMFileHeader *)bytes;
+
+        header->channelCount     = (UInt32)channelCount;
+        header->sampleRate       = sampleRate;
+        header->frameCount       = frameCount;
+        header->sourceFrameCount = sourceFrameCount;
+        header->channelStride    = stride;
+
+        // Samples must reach the file before the header marks it as complete
+        ok = (msync(bytes, length, MS_SYNC) == 0);
+
+        if (ok) {
+            header->magic = sMagic;
+            ok = (msync(bytes, sAlignment, MS_SYNC) == 0);
+        }
+    }
+
+    munmap(bytes, length);
+
+    if (!ok) unlink(path);
+
+    return ok;
+}
+
+
+- (id) initWithFileURL:(NSURL *)fileURL
+{
+    if ((self = [super init])) {
+        _fileURL  = fileURL;
+        _pageSize = sysconf(_SC_PAGESIZE);
+    }
+
+    return self;
+}
+
+
+- (void) dealloc
+{
+    [self close];
+}
+
+
+- (NSString *) description
+{
+    return [NSString stringWithFormat:@"<%@: %p, \"%@\">", [self class], self, [_fileURL path]];
+}
+
+
+- (BOOL) open
+{
+    if (_bytes) return YES;
+
+    int fd = open([[_fileURL path] fileSystemRepresentation], O_RDONLY);
+    if (fd < 0) return NO;
+
+    struct stat st;
+    BOOL ok = (fstat(fd, &st) == 0) && (st.st_size >= sAlignment);
+
+    UInt8 *bytes = ok ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+    close(fd);
+
+    if (bytes == MAP_FAILED) return NO;
+
+    const HugPCMFileHeader *header = (const HugPCMFileHeader *)bytes;
+
+    ok = header->magic == sMagic &&
+         header->channelCount > 0 &&
+         header->sampleRate > 0 &&
+         header->channelStride == sGetChannelStride(header->frameCount) &&
+         st.st_size >= sAlignment + (header->channelStride * header->channelCount);
+
+    if (!ok) {
+        HugLog(@"HugPCMFile", @"%@ is invalid", self);
+        munmap(bytes, st.st_size);
+        return NO;
+    }
+
+    _bytes  = bytes;
+    _length = st.st_size;
+
+    _sampleRate       = header->sampleRate;
+    _channelCount     = header->channelCount;
+    _frameCount       = header->frameCount;
+    _sourceFrameCount = header->sourceFrameCount;
+    _channelStride    = header->channelStride;
+
+    // Pages are read in order during playback
+    madvise(_bytes, _length, MADV_SEQUENTIAL);
+
+    return YES;
+}
+
+
+- (void) close
+{
+    if (!_bytes) return;
+
+    sSetWired(_bytes + sAlignment, _channelStride, _channelCount, _pageSize, _wiredPages, NO);
+    _wiredPages = NSMakeRange(0, 0);
+
+    munmap(_bytes, _length);
+
+    _bytes  = NULL;
+    _length = 0;
+}
+
+
+- (const float *) samplesForChannel:(NSInteger)channel
+{
+    if (!_bytes || channel < 0 || channel >= _channelCount) return NULL;
+    return (const float *)(_bytes + sAlignment + (channel * _channelStride));
+}
+
+
+- (void) wireFramesInRange:(NSRange)range
+{
+    if (!_bytes) return;
+
+    NSUInteger start = MIN(range.location, (NSUInteger)_frameCount);
+    NSUInteger end   = MIN(NSMaxRange(range), (NSUInteger)_frameCount);
+
+    NSUInteger firstPage = (start * sizeof(float)) / _pageSize;
+    NSUInteger endPage   = ((end * sizeof(float)) + _pageSize - 1) / _pageSize;
+
+    NSRange pages = NSMakeRange(firstPage, (endPage > firstPage) ? (endPage - firstPage) : 0);
+    if (NSEqualRanges(pages, _wiredPages)) return;
+
+    UInt8 *base = _bytes + sAlignment;
+
+    // Wiring nests on Darwin, so only the difference is wired or unwired
+    sSetWiredDifference(base, _channelStride, _channelCount, _pageSize, pages, _wiredPages, YES);
+    sSetWiredDifference(base, _channelStride, _channelCount, _pageSize, _wiredPages, pages, NO);
+
+    _wiredPages = pages;
+}
+
+
+@end
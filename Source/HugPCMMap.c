@@ -0,0 +1,348 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// madvise() and MADV_* are BSD extensions, which glibc hides under strict ISO C
+#if !defined(__APPLE__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "HugPCMMap.h"
+#include "HugKernels.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+struct HugPCMMap {
+    UInt8 *_bytes;
+    size_t _length;
+    size_t _pageSize;
+
+    const UInt8 *_data; // First frame
+    UInt32 _bytesPerFrame;
+    HugDecoderSampleFormat _sampleFormat;
+    HugDecoderInfo _info;
+
+    // Page-aligned offsets into _bytes
+    size_t _wiredStart;
+    size_t _wiredEnd;
+};
+
+
+// Read lengths cycled through by HugPCMMapRunBenchmark(), so that reads
+// start and end at every offset within a vector
+static const size_t sBenchmarkReadLengths[] = { 1, 7, 33, 64, 129, 1000, 3 };
+
+enum {
+    sBenchmarkMaxReadLength = 1000,
+    sBenchmarkWireFrames    = 65536
+};
+
+
+#pragma mark - Lifecycle
+
+HugPCMMap *HugPCMMapOpen(const char *path)
+{
+    HugDecoder *decoder = HugDecoderOpenWithBackend(path, &HugDecoderBackendPCM);
+    if (!decoder) return NULL;
+
+    HugDecoderInfo info = HugDecoderGetInfo(decoder);
+    HugDecoderPCMLayout layout;
+
+    BOOL ok = HugDecoderGetPCMLayout(decoder, &layout);
+    HugDecoderClose(decoder);
+
+    size_t bytesPerSample = 0;
+
+    if (ok && !layout.isBigEndian) {
+        if      (layout.sampleFormat == HugDecoderSampleFormatSInt16)   bytesPerSample = 2;
+        else if (layout.sampleFormat == HugDecoderSampleFormatSInt24)   bytesPerSample = 3;
+        else if (layout.sampleFormat == HugDecoderSampleFormatFloat32)  bytesPerSample = 4;
+    }
+
+    // The kernels expect tightly packed frames
+    if (!bytesPerSample || layout.bytesPerFrame != bytesPerSample * info.channelCount || info.frameCount <= 0) {
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    ok = (fstat(fd, &st) == 0) && ((UInt64)st.st_size >= layout.dataOffset + (info.frameCount * layout.bytesPerFrame));
+
+    UInt8 *bytes = ok ? mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+    close(fd);
+
+    if (bytes == MAP_FAILED) return NULL;
+
+    // Pages are read in order during playback
+    madvise(bytes, st.st_size, MADV_SEQUENTIAL);
+
+    HugPCMMap *self = calloc(1, sizeof(HugPCMMap));
+
+    self->_bytes         = bytes;
+    self->_length        = st.st_size;
+    self->_pageSize      = sysconf(_SC_PAGESIZE);
+    self->_data          = bytes + layout.dataOffset;
+    self->_bytesPerFrame = layout.bytesPerFrame;
+    self->_sampleFormat  = layout.sampleFormat;
+    self->_info          = info;
+
+    return self;
+}
+
+
+void HugPCMMapFree(HugPCMMap *self)
+{
+    if (!self) return;
+
+    HugPCMMapWireFrames(self, 0, 0);
+    munmap(self->_bytes, self->_length);
+
+    free(self);
+}
+
+
+#pragma mark - Private Functions
+
+static void sSetWired(UInt8 *bytes, size_t start, size_t end, BOOL wired)
+{
+    if (end <= start) return;
+
+    if (wired) {
+        madvise(bytes + start, end - start, MADV_WILLNEED);
+        mlock(bytes + start, end - start);
+    } else {
+        munlock(bytes + start, end - start);
+    }
+}
+
+
+// Calls sSetWired() on the parts of [aStart, aEnd) which are not in [bStart, bEnd)
+static void sSetWiredDifference(UInt8 *bytes, size_t aStart, size_t aEnd, size_t bStart, size_t bEnd, BOOL wired)
+{
+    if (bEnd <= bStart) {
+        sSetWired(bytes, aStart, aEnd, wired);
+        return;
+    }
+
+    sSetWired(bytes, aStart, MIN(aEnd, bStart), wired);
+    sSetWired(bytes, MAX(aStart, bEnd), aEnd, wired);
+}
+
+
+static uint64_t sGetNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+
+#pragma mark - Public Functions
+
+HugDecoderInfo HugPCMMapGetInfo(const HugPCMMap *self)
+{
+    return self->_info;
+}
+
+
+void HugPCMMapRead(const HugPCMMap *self, float * const *channels, SInt64 frame, size_t frameCount)
+{
+    UInt32 channelCount = self->_info.channelCount;
+    size_t count = 0;
+
+    if (frame >= 0 && frame < self->_info.frameCount) {
+        count = (size_t)MIN((SInt64)frameCount, self->_info.frameCount - frame);
+    }
+
+    if (count) {
+        const UInt8 *input = self->_data + (frame * self->_bytesPerFrame);
+
+        if (self->_sampleFormat == HugDecoderSampleFormatSInt16) {
+            HugKernels.convertInt16(channels, input, channelCount, count);
+        } else if (self->_sampleFormat == HugDecoderSampleFormatSInt24) {
+            HugKernels.convertInt24(channels, input, channelCount, count);
+        } else {
+            HugKernels.convertFloat32(channels, input, channelCount, count);
+        }
+    }
+
+    if (count < frameCount) {
+        for (UInt32 c = 0; c < channelCount; c++) {
+            memset(channels[c] + count, 0, (frameCount - count) * sizeof(float));
+        }
+    }
+}
+
+
+void HugPCMMapWireFrames(HugPCMMap *self, SInt64 frame, SInt64 frameCount)
+{
+    SInt64 totalFrames = self->_info.frameCount;
+
+    SInt64 startFrame = MIN(MAX(frame, 0), totalFrames);
+    SInt64 endFrame   = MIN(MAX(frame + frameCount, startFrame), totalFrames);
+
+    size_t start = 0;
+    size_t end   = 0;
+
+    if (endFrame > startFrame) {
+        size_t dataOffset = self->_data - self->_bytes;
+        size_t pageSize   = self->_pageSize;
+
+        start = dataOffset + (startFrame * self->_bytesPerFrame);
+        end   = dataOffset + (endFrame   * self->_bytesPerFrame);
+
+        start = (start / pageSize) * pageSize;
+        end   = ((end + pageSize - 1) / pageSize) * pageSize;
+    }
+
+    if (start == self->_wiredStart && end == self->_wiredEnd) return;
+
+    // Wiring nests on Darwin, so only the difference is wired or unwired
+    sSetWiredDifference(self->_bytes, start, end, self->_wiredStart, self->_wiredEnd, YES);
+    sSetWiredDifference(self->_bytes, self->_wiredStart, self->_wiredEnd, start, end, NO);
+
+    self->_wiredStart = start;
+    self->_wiredEnd   = end;
+}
+
+
+BOOL HugPCMMapRunBenchmark(const char *path, HugPCMMapBenchmarkResult *outResult)
+{
+    HugPCMMap *map = HugPCMMapOpen(path);
+    if (!map) return NO;
+
+    HugDecoder *decoder = HugDecoderOpen(path);
+
+    if (!decoder) {
+        HugPCMMapFree(map);
+        return NO;
+    }
+
+    UInt32 channelCount = map->_info.channelCount;
+    SInt64 frameCount   = map->_info.frameCount;
+
+    // Past the end, expected stays zero to check that reads are padded with silence
+    size_t capacity = (size_t)frameCount + sBenchmarkMaxReadLength;
+
+    float *expected = calloc(capacity * channelCount, sizeof(float));
+    float *actual   = malloc(capacity * channelCount * sizeof(float));
+
+    // NaN everywhere, so frames which HugPCMMapRead() fails to write are caught
+    memset(actual, 0xff, capacity * channelCount * sizeof(float));
+
+    float *channels[channelCount];
+
+    BOOL ok = YES;
+    SInt64 position = 0;
+
+    while (ok && position < frameCount) {
+        for (UInt32 c = 0; c < channelCount; c++) {
+            channels[c] = expected + (c * capacity) + position;
+        }
+
+        size_t count = (size_t)(frameCount - position);
+        ok = HugDecoderRead(decoder, channels, &count);
+        if (!count) break;
+
+        position += count;
+    }
+
+    ok = ok && (position == frameCount);
+
+    size_t readCount = 0;
+    size_t mismatchCount = 0;
+    uint64_t nanoseconds = 0;
+
+    // Reads run one past the end, the last of which is entirely silence
+    for (SInt64 frame = 0; ok && frame <= frameCount; readCount++) {
+        size_t length = sBenchmarkReadLengths[readCount % (sizeof(sBenchmarkReadLengths) / sizeof(sBenchmarkReadLengths[0]))];
+
+        if ((frame % sBenchmarkWireFrames) < (SInt64)length) {
+            HugPCMMapWireFrames(map, frame, sBenchmarkWireFrames * 2);
+        }
+
+        for (UInt32 c = 0; c < channelCount; c++) {
+            channels[c] = actual + (c * capacity) + frame;
+        }
+
+        uint64_t start = sGetNanoseconds();
+        HugPCMMapRead(map, channels, frame, length);
+        nanoseconds += sGetNanoseconds() - start;
+
+        for (UInt32 c = 0; c < channelCount; c++) {
+            if (memcmp(channels[c], expected + (c * capacity) + frame, length * sizeof(float)) != 0) {
+                mismatchCount++;
+                break;
+            }
+        }
+
+        frame += length;
+    }
+
+    if (ok) {
+        HugPCMMapBenchmarkResult result;
+
+        result.frameCount        = frameCount;
+        result.framesPerSecond   = nanoseconds ? (frameCount / (nanoseconds / 1e9)) : 0;
+        result.readCount         = readCount;
+        result.readMismatchCount = mismatchCount;
+
+        *outResult = result;
+    }
+
+    free(expected);
+    free(actual);
+
+    HugDecoderClose(decoder);
+    HugPCMMapFree(map);
+
+    return ok;
+}
+
+
+#pragma mark - Command Line
+
+#if HUG_PCM_MAP_MAIN
+
+int main(int argc, char **argv)
+{
+    int status = 0;
+
+    for (HugKernelLevel level = HugKernelLevelScalar; level <= HugKernelLevelNEON; level++) {
+        if (!HugKernelsSetLevel(level)) continue;
+
+        for (int i = 1; i < argc; i++) {
+            HugPCMMapBenchmarkResult result;
+
+            if (!HugPCMMapRunBenchmark(argv[i], &result)) {
+                printf("%-6s %s: not mapped\n", HugKernelsGetLevelName(level), argv[i]);
+                status = 1;
+                continue;
+            }
+
+            printf("%-6s %s: %lld frames, %.1f Mframes/s, %zu/%zu reads exact\n",
+                HugKernelsGetLevelName(level), argv[i],
+                (long long)result.frameCount,
+                result.framesPerSecond / 1e6,
+                result.readCount - result.readMismatchCount, result.readCount
+            );
+
+            if (result.readMismatchCount) {
+                status = 1;
+            }
+        }
+    }
+
+    return status;
+}
+
+#endif
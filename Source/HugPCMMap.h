@@ -0,0 +1,56 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+#include "HugDecoder.h"
+
+// Plays an uncompressed file in place.
+//
+// The file is mapped read-only and its samples are converted to planar float
+// by HugKernels as they are read, so nothing is decoded ahead of time and
+// the page cache holds the only copy of the audio. Little-endian 16-bit,
+// 24-bit, and 32-bit float WAV, RF64, and AIFF-C (sowt) files are supported;
+// HugPCMMapOpen() returns NULL for anything else.
+//
+// Reading a page which is not resident blocks on disk I/O, so the range
+// around the play head should be wired with HugPCMMapWireFrames(). As with
+// any mapping, the process receives SIGBUS if the file is truncated or its
+// volume disappears while mapped.
+//
+// To check HugPCMMapRead() against HugDecoder on Linux without Xcode, build
+// HugPCMMap.c, HugDecoder.c, HugDecoderPCM.c, HugDecoderFLAC.c, and
+// HugKernels.c with -std=c11 -O2 -DHUG_PCM_MAP_MAIN, link with -lm, and
+// pass it files to compare. Every supported kernel level is checked, so
+// include 16-bit, 24-bit, and float files with 1, 2, and 3 channels to cover
+// each conversion kernel.
+
+typedef struct HugPCMMap HugPCMMap;
+
+extern HugPCMMap *HugPCMMapOpen(const char *path);
+extern void HugPCMMapFree(HugPCMMap *map);
+
+extern HugDecoderInfo HugPCMMapGetInfo(const HugPCMMap *map);
+
+// Converts frameCount frames starting at frame into channels, which has
+// HugPCMMapGetInfo().channelCount entries. Frames past the end are silent.
+// Does not allocate or lock, and is real-time safe within the wired range.
+extern void HugPCMMapRead(const HugPCMMap *map, float * const *channels, SInt64 frame, size_t frameCount);
+
+// Faults in and wires the pages holding frameCount frames starting at frame,
+// and unwires the rest of the previously wired range.
+extern void HugPCMMapWireFrames(HugPCMMap *map, SInt64 frame, SInt64 frameCount);
+
+typedef struct {
+    SInt64 frameCount;
+    double framesPerSecond;   // HugPCMMapRead() only
+    size_t readCount;
+    size_t readMismatchCount; // Reads whose audio differs from HugDecoder
+} HugPCMMapBenchmarkResult;
+
+// Uses the current HugKernels level. Decodes the file with HugDecoder, then
+// reads it with HugPCMMapRead() in lengths from 1 to 1000 frames, including
+// a read past the end, and compares each read bit for bit. Returns NO if the
+// file can't be mapped or decoded.
+extern BOOL HugPCMMapRunBenchmark(const char *path, HugPCMMapBenchmarkResult *outResult);
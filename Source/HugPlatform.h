@@ -0,0 +1,50 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// Base types for the pure-C parts of Hug (DSP stages, offline renderer).
+// These files must not depend on Foundation, AppKit, or CoreAudio so that
+// they can be compiled on non-Apple platforms.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__APPLE__)
+
+#include <MacTypes.h>
+#include <objc/objc.h>
+#include <objc/NSObjCRuntime.h>
+
+#else
+
+typedef uint8_t  UInt8;
+typedef int16_t  SInt16;
+typedef uint16_t UInt16;
+typedef int32_t  SInt32;
+typedef uint32_t UInt32;
+typedef int64_t  SInt64;
+typedef uint64_t UInt64;
+typedef float    Float32;
+typedef double   Float64;
+
+typedef signed char BOOL;
+#define YES ((BOOL)1)
+#define NO  ((BOOL)0)
+
+typedef long          NSInteger;
+typedef unsigned long NSUInteger;
+
+#endif
+
+#ifndef MIN
+#define MIN(A, B) ((A) < (B) ? (A) : (B))
+#endif
+
+#ifndef MAX
+#define MAX(A, B) ((A) > (B) ? (A) : (B))
+#endif
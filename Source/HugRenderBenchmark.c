@@ -0,0 +1,525 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "HugRenderBenchmark.h"
+#include "HugRenderBenchmarkGolden.h"
+
+#include "HugLevelMeter.h"
+#include "HugLimiter.h"
+#include "HugLinearRamper.h"
+#include "HugLoudnessMeter.h"
+#include "HugOfflineRenderer.h"
+#include "HugStereoField.h"
+
+#include <time.h>
+
+
+static const double sSampleRate = 48000.0;
+static const double sPi = 3.14159265358979323846;
+
+// Long enough for short-term loudness to settle
+static const size_t sSignalFrameCount = 48000 * 4;
+
+// Fingerprints match if they differ by less than sRelativeTolerance of the
+// golden value. Kernel levels differ by under 1e-6. The absolute floor
+// only lets rounding through, so Silence must stay exactly silent and
+// DenormalTail can't pick up a stray offset.
+static const double sRelativeTolerance = 1e-5;
+static const double sAbsoluteTolerance = 1e-9;
+
+static const size_t sFrameSizes[HugRenderBenchmarkFrameSizeCount] = {
+    32, 64, 128, 256, 512, 1024, 2048, 4096
+};
+
+static const char *sStageNames[HugRenderBenchmarkStageCount] = {
+    "Limiter", "LevelMeter", "LoudnessMeter", "StereoField", "LinearRamper", "Chain", "ChainTruePeak"
+};
+
+static const char *sSignalNames[HugRenderBenchmarkSignalCount] = {
+    "SineSweep", "PinkNoise", "InterSamplePeaks", "Silence", "DenormalTail"
+};
+
+
+typedef struct {
+    float *left;
+    float *right;
+    size_t frameCount;
+} HugRenderBenchmarkBuffer;
+
+// Streams of meter readings, one value per buffer
+typedef struct {
+    float *first;
+    float *second;
+    size_t count;
+} HugRenderBenchmarkReadings;
+
+
+#pragma mark - Private Functions
+
+static uint64_t sGetNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+
+static UInt32 sNextRandom(UInt32 *state)
+{
+    // xorshift32
+    UInt32 x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return (*state = x);
+}
+
+
+// Uniform in [-1, 1)
+static float sNextWhite(UInt32 *state)
+{
+    return (float)(((double)sNextRandom(state) / 2147483648.0) - 1.0);
+}
+
+
+// Paul Kellet's economy pink filter
+static void sFillPink(float *samples, size_t frameCount, UInt32 seed, float gain)
+{
+    UInt32 state = seed;
+    double b0 = 0, b1 = 0, b2 = 0;
+
+    for (size_t i = 0; i < frameCount; i++) {
+        double white = sNextWhite(&state);
+
+        b0 = 0.99765 * b0 + white * 0.0990460;
+        b1 = 0.96300 * b1 + white * 0.2965164;
+        b2 = 0.57000 * b2 + white * 1.0526913;
+
+        samples[i] = (float)((b0 + b1 + b2 + white * 0.1848) * gain);
+    }
+}
+
+
+static void sFillSignal(HugRenderBenchmarkSignal signal, float *left, float *right, size_t frameCount)
+{
+    memset(left,  0, frameCount * sizeof(float));
+    memset(right, 0, frameCount * sizeof(float));
+
+    if (signal == HugRenderBenchmarkSignalSineSweep) {
+        // Exponential sweep, right channel in quadrature so width has an effect
+        double f1 = 20.0, f2 = 20000.0;
+        double duration = frameCount / sSampleRate;
+        double k = log(f2 / f1);
+        double amplitude = pow(10.0, -1.0 / 20.0);
+
+        for (size_t i = 0; i < frameCount; i++) {
+            double t = i / sSampleRate;
+            double phase = 2.0 * sPi * f1 * duration / k * (exp(t * k / duration) - 1.0);
+
+            left[i]  = (float)(amplitude * sin(phase));
+            right[i] = (float)(amplitude * cos(phase));
+        }
+
+    } else if (signal == HugRenderBenchmarkSignalPinkNoise) {
+        sFillPink(left,  frameCount, 0x1234567, 0.25f);
+        sFillPink(right, frameCount, 0x7654321, 0.25f);
+
+    } else if (signal == HugRenderBenchmarkSignalInterSamplePeaks) {
+        size_t half = frameCount / 2;
+
+        // Samples sit at +/-1.0, the reconstructed waveform peaks at +3 dB
+        for (size_t i = 0; i < half; i++) {
+            float value = sin((sPi / 2.0) * i + (sPi / 4.0)) * sqrt(2.0);
+
+            left[i]  =  value;
+            right[i] = -value;
+        }
+
+        // Full-scale square bursts with alternating run lengths
+        for (size_t i = half; i < frameCount; i++) {
+            size_t run = 1 + ((i / 4096) % 4);
+            float value = ((i / run) & 1) ? -1.0f : 1.0f;
+
+            left[i]  = value;
+            right[i] = ((i / 2048) & 1) ? value : -value;
+        }
+
+    } else if (signal == HugRenderBenchmarkSignalDenormalTail) {
+        size_t burst = frameCount / 10;
+
+        sFillPink(left,  burst, 0xabcdef1, 0.5f);
+        sFillPink(right, burst, 0x1fedcba, 0.5f);
+
+        // From 3e-38 (just above FLT_MIN) down into the subnormals
+        for (size_t i = burst; i < frameCount; i++) {
+            double t = (double)(i - burst) / (frameCount - burst);
+            float value = (float)(3e-38 * pow(1e-7, t));
+
+            left[i]  = (i & 1) ? value : -value;
+            right[i] = (i & 2) ? value : -value;
+        }
+    }
+}
+
+
+static HugRenderBenchmarkFingerprint sMakeFingerprint(const float *values, size_t count)
+{
+    HugRenderBenchmarkFingerprint result = { 0, 0, 0 };
+
+    // Pseudo-random weights catch changes which keep peak and RMS intact,
+    // such as an offset or a reordering of samples
+    UInt32 state = 0x9e3779b9;
+    double sumSquares = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        double value = values[i];
+        double magnitude = fabs(value);
+
+        if (magnitude > result.peak) result.peak = magnitude;
+
+        sumSquares += value * value;
+        result.weightedSum += value * sNextWhite(&state);
+    }
+
+    result.rms = count ? sqrt(sumSquares / count) : 0;
+
+    return result;
+}
+
+
+static BOOL sMatches(double value, double golden)
+{
+    return fabs(value - golden) <= ((sRelativeTolerance * fabs(golden)) + sAbsoluteTolerance);
+}
+
+
+static BOOL sMatchesGolden(const HugRenderBenchmarkResult *result, BOOL *outHasGolden)
+{
+    size_t count = sizeof(sHugRenderBenchmarkGolden) / sizeof(sHugRenderBenchmarkGolden[0]);
+
+    for (size_t i = 0; i < count; i++) {
+        const HugRenderBenchmarkGoldenEntry *entry = &sHugRenderBenchmarkGolden[i];
+
+        if ((HugRenderBenchmarkStage)entry->stage   != result->stage  ||
+            (HugRenderBenchmarkSignal)entry->signal != result->signal ||
+            entry->frameSize != result->frameSize
+        ) {
+            continue;
+        }
+
+        *outHasGolden = YES;
+
+        for (NSInteger c = 0; c < 2; c++) {
+            const HugRenderBenchmarkFingerprint *fingerprint = &result->fingerprints[c];
+
+            if (!sMatches(fingerprint->peak,        entry->values[c][0]) ||
+                !sMatches(fingerprint->rms,         entry->values[c][1]) ||
+                !sMatches(fingerprint->weightedSum, entry->values[c][2])
+            ) {
+                return NO;
+            }
+        }
+
+        return YES;
+    }
+
+    *outHasGolden = NO;
+
+    return NO;
+}
+
+
+// Runs one stage over buffer in slices of frameSize. Meter stages append
+// their readings after each slice.
+static void sRunStage(
+    HugRenderBenchmarkStage stage,
+    HugRenderBenchmarkBuffer *buffer,
+    size_t frameSize,
+    HugRenderBenchmarkReadings *readings,
+    HugRenderBenchmarkResult *result
+) {
+    HugLimiter         *limiter  = NULL;
+    HugLevelMeter      *meters[2] = { NULL, NULL };
+    HugLoudnessMeter   *loudness = NULL;
+    HugStereoField     *field    = NULL;
+    HugLinearRamper    *ramper   = NULL;
+    HugOfflineRenderer *renderer = NULL;
+
+    if (stage == HugRenderBenchmarkStageLimiter) {
+        limiter = HugLimiterCreate();
+        HugLimiterSetSampleRate(limiter, sSampleRate);
+
+        // Drive the limiter hard
+        HugKernels.gain(buffer->left,  buffer->frameCount, 2.0f);
+        HugKernels.gain(buffer->right, buffer->frameCount, 2.0f);
+
+    } else if (stage == HugRenderBenchmarkStageLevelMeter) {
+        for (NSInteger c = 0; c < 2; c++) {
+            meters[c] = HugLevelMeterCreate();
+            HugLevelMeterSetSampleRate(meters[c], sSampleRate);
+            HugLevelMeterSetMaxFrameCount(meters[c], frameSize);
+            HugLevelMeterSetAverageEnabled(meters[c], 1);
+        }
+
+    } else if (stage == HugRenderBenchmarkStageLoudnessMeter) {
+        loudness = HugLoudnessMeterCreate();
+        HugLoudnessMeterSetSampleRate(loudness, sSampleRate);
+
+    } else if (stage == HugRenderBenchmarkStageStereoField) {
+        field = HugStereoFieldCreate();
+        HugStereoFieldSetMaxFrameCount(field, frameSize);
+        HugStereoFieldReset(field, 0, 1);
+
+    } else if (stage == HugRenderBenchmarkStageLinearRamper) {
+        ramper = HugLinearRamperCreate();
+        HugLinearRamperSetMaxFrameCount(ramper, frameSize);
+        HugLinearRamperReset(ramper, 1);
+
+    } else if (stage == HugRenderBenchmarkStageChain || stage == HugRenderBenchmarkStageChainTruePeak) {
+        renderer = HugOfflineRendererCreate(sSampleRate, frameSize);
+
+        HugRenderChainParameters parameters = { 0.8f, 0.1f, 1.5f, 0.9f };
+        HugOfflineRendererSetParameters(renderer, &parameters);
+
+        if (stage == HugRenderBenchmarkStageChainTruePeak) {
+            HugOfflineRendererSetLimiterMode(renderer, HugRenderChainLimiterModeTruePeak);
+        }
+    }
+
+    uint64_t totalTime = 0;
+    uint64_t worstTime = 0;
+
+    readings->count = 0;
+
+    for (size_t offset = 0; offset < buffer->frameCount; offset += frameSize) {
+        size_t frameCount = MIN(frameSize, buffer->frameCount - offset);
+
+        float *left  = buffer->left  + offset;
+        float *right = buffer->right + offset;
+
+        // Parameters which change per buffer follow a triangle over the signal
+        double position = (double)offset / buffer->frameCount;
+        float triangle = (float)(1.0 - fabs((2.0 * position) - 1.0));
+
+        uint64_t start = sGetNanoseconds();
+
+        if (limiter) {
+            HugLimiterProcess(limiter, left, right, frameCount);
+
+        } else if (meters[0]) {
+            HugLevelMeterProcess(meters[0], left,  frameCount);
+            HugLevelMeterProcess(meters[1], right, frameCount);
+
+        } else if (loudness) {
+            HugLoudnessMeterProcess(loudness, left, right, frameCount);
+
+        } else if (field) {
+            HugStereoFieldProcess(field, left, right, frameCount, (triangle - 0.5f) * 0.5f, triangle * 2.0f);
+
+        } else if (ramper) {
+            HugLinearRamperProcess(ramper, left, right, frameCount, triangle);
+
+        } else if (renderer) {
+            HugOfflineRendererProcess(renderer, left, right, frameCount);
+        }
+
+        uint64_t elapsed = sGetNanoseconds() - start;
+
+        totalTime += elapsed;
+        if (elapsed > worstTime) worstTime = elapsed;
+
+        if (meters[0]) {
+            readings->first [readings->count] = HugLevelMeterGetPeakLevel(meters[0]);
+            readings->second[readings->count] = HugLevelMeterGetAverageLevel(meters[1]);
+            readings->count++;
+
+        } else if (loudness) {
+            readings->first [readings->count] = HugLoudnessMeterGetMomentaryLoudness(loudness);
+            readings->second[readings->count] = HugLoudnessMeterGetShortTermLoudness(loudness);
+            readings->count++;
+        }
+    }
+
+    if (readings->count) {
+        result->fingerprints[0] = sMakeFingerprint(readings->first,  readings->count);
+        result->fingerprints[1] = sMakeFingerprint(readings->second, readings->count);
+    } else {
+        result->fingerprints[0] = sMakeFingerprint(buffer->left,  buffer->frameCount);
+        result->fingerprints[1] = sMakeFingerprint(buffer->right, buffer->frameCount);
+    }
+
+    result->nanosecondsPerFrame    = (double)totalTime / buffer->frameCount;
+    result->worstBufferNanoseconds = (double)worstTime;
+
+    HugLimiterFree(limiter);
+    HugLevelMeterFree(meters[0]);
+    HugLevelMeterFree(meters[1]);
+    HugLoudnessMeterFree(loudness);
+    HugStereoFieldFree(field);
+    HugLinearRamperFree(ramper);
+    HugOfflineRendererFree(renderer);
+}
+
+
+#pragma mark - Public Functions
+
+const char *HugRenderBenchmarkGetStageName(HugRenderBenchmarkStage stage)
+{
+    return (stage >= 0 && stage < HugRenderBenchmarkStageCount) ? sStageNames[stage] : "Unknown";
+}
+
+
+const char *HugRenderBenchmarkGetSignalName(HugRenderBenchmarkSignal signal)
+{
+    return (signal >= 0 && signal < HugRenderBenchmarkSignalCount) ? sSignalNames[signal] : "Unknown";
+}
+
+
+size_t HugRenderBenchmarkGetFrameSize(size_t frameSizeIndex)
+{
+    return frameSizeIndex < HugRenderBenchmarkFrameSizeCount ? sFrameSizes[frameSizeIndex] : 0;
+}
+
+
+NSInteger HugRenderBenchmarkRun(HugKernelLevel level, HugRenderBenchmarkCallback callback, void *context)
+{
+    HugKernelLevel previousLevel = HugKernels.level;
+    if (!HugKernelsSetLevel(level)) return -1;
+
+    NSInteger failureCount = 0;
+
+    float *signalLeft  = malloc(sSignalFrameCount * sizeof(float));
+    float *signalRight = malloc(sSignalFrameCount * sizeof(float));
+
+    HugRenderBenchmarkBuffer buffer = {
+        malloc(sSignalFrameCount * sizeof(float)),
+        malloc(sSignalFrameCount * sizeof(float)),
+        sSignalFrameCount
+    };
+
+    // At most one reading per 32 frames
+    size_t maxReadings = (sSignalFrameCount / sFrameSizes[0]) + 1;
+
+    HugRenderBenchmarkReadings readings = {
+        malloc(maxReadings * sizeof(float)),
+        malloc(maxReadings * sizeof(float)),
+        0
+    };
+
+    for (NSInteger signal = 0; signal < HugRenderBenchmarkSignalCount; signal++) {
+        sFillSignal((HugRenderBenchmarkSignal)signal, signalLeft, signalRight, sSignalFrameCount);
+
+        for (NSInteger stage = 0; stage < HugRenderBenchmarkStageCount; stage++) {
+            for (size_t i = 0; i < HugRenderBenchmarkFrameSizeCount; i++) {
+                memcpy(buffer.left,  signalLeft,  sSignalFrameCount * sizeof(float));
+                memcpy(buffer.right, signalRight, sSignalFrameCount * sizeof(float));
+
+                HugRenderBenchmarkResult result;
+                memset(&result, 0, sizeof(result));
+
+                result.level     = level;
+                result.stage     = (HugRenderBenchmarkStage)stage;
+                result.signal    = (HugRenderBenchmarkSignal)signal;
+                result.frameSize = sFrameSizes[i];
+
+                sRunStage(result.stage, &buffer, result.frameSize, &readings, &result);
+
+                result.passed = sMatchesGolden(&result, &result.hasGolden);
+                if (!result.passed) failureCount++;
+
+                if (callback) callback(context, &result);
+            }
+        }
+    }
+
+    free(signalLeft);
+    free(signalRight);
+    free(buffer.left);
+    free(buffer.right);
+    free(readings.first);
+    free(readings.second);
+
+    HugKernelsSetLevel(previousLevel);
+
+    return failureCount;
+}
+
+
+#pragma mark - Command Line
+
+#if HUG_RENDER_BENCHMARK_MAIN
+
+#include <stdio.h>
+
+static void sPrintResult(void *context, const HugRenderBenchmarkResult *result)
+{
+    (void)context;
+
+    printf("%-6s %-14s %-17s %5zu  %8.2f ns/frame  %10.0f ns worst  %s\n",
+        HugKernelsGetLevelName(result->level),
+        HugRenderBenchmarkGetStageName(result->stage),
+        HugRenderBenchmarkGetSignalName(result->signal),
+        result->frameSize,
+        result->nanosecondsPerFrame,
+        result->worstBufferNanoseconds,
+        result->passed ? "ok" : (result->hasGolden ? "FAIL" : "NO GOLDEN")
+    );
+}
+
+
+static void sPrintGolden(void *context, const HugRenderBenchmarkResult *result)
+{
+    (void)context;
+
+    const HugRenderBenchmarkFingerprint *l = &result->fingerprints[0];
+    const HugRenderBenchmarkFingerprint *r = &result->fingerprints[1];
+
+    printf("    { %d, %d, %4zu, { { %.17g, %.17g, %.17g }, { %.17g, %.17g, %.17g } } },\n",
+        (int)result->stage, (int)result->signal, result->frameSize,
+        l->peak, l->rms, l->weightedSum,
+        r->peak, r->rms, r->weightedSum
+    );
+}
+
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--golden") == 0) {
+        printf("// (c) 2024 Ricci Adams\n");
+        printf("// MIT License (or) 1-clause BSD License\n\n");
+        printf("// Generated by HugRenderBenchmark --golden with the scalar kernels\n\n");
+        printf("#pragma once\n\n");
+        printf("typedef struct {\n");
+        printf("    int    stage;\n");
+        printf("    int    signal;\n");
+        printf("    size_t frameSize;\n");
+        printf("    double values[2][3]; // Peak, RMS, weighted sum of each channel\n");
+        printf("} HugRenderBenchmarkGoldenEntry;\n\n");
+        printf("static const HugRenderBenchmarkGoldenEntry sHugRenderBenchmarkGolden[] = {\n");
+
+        HugRenderBenchmarkRun(HugKernelLevelScalar, sPrintGolden, NULL);
+
+        printf("};\n");
+
+        return 0;
+    }
+
+    NSInteger failureCount = 0;
+
+    for (NSInteger level = HugKernelLevelScalar; level <= HugKernelLevelNEON; level++) {
+        NSInteger result = HugRenderBenchmarkRun((HugKernelLevel)level, sPrintResult, NULL);
+        if (result > 0) failureCount += result;
+    }
+
+    printf("%ld failure(s)\n", (long)failureCount);
+
+    return failureCount ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,88 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+#include "HugKernels.h"
+
+// Regression and throughput suite for the render path.
+//
+// Deterministic test signals are fed through each DSP stage, and through the
+// full HugRenderChain, at every frame size from 32 to 4096. Each run is
+// reduced to a fingerprint (peak, RMS, and a weighted sum of every value)
+// and compared against HugRenderBenchmarkGolden.h within a small relative
+// tolerance, so rounding differences between kernel levels and CPUs still
+// pass while any real change in output fails. Audio stages fingerprint their output;
+// meter stages fingerprint the readings taken after each buffer.
+//
+// Each run also reports the average cost per frame and the slowest buffer.
+//
+// To run on Linux without Xcode, build these files with
+// -std=c11 -O2 -DHUG_RENDER_BENCHMARK_MAIN and link with -lm:
+//
+//   HugRenderBenchmark.c HugRenderChain.c HugOfflineRenderer.c HugLimiter.c
+//   HugTruePeakLimiter.c HugLevelMeter.c HugLoudnessMeter.c HugStereoField.c
+//   HugLinearRamper.c HugAutomation.c HugFastUtils.c HugKernels.c
+//
+//   ./HugRenderBenchmark           Checks every supported kernel level
+//   ./HugRenderBenchmark --golden  Prints a new HugRenderBenchmarkGolden.h
+
+typedef enum {
+    HugRenderBenchmarkStageLimiter        = 0,
+    HugRenderBenchmarkStageLevelMeter     = 1,
+    HugRenderBenchmarkStageLoudnessMeter  = 2,
+    HugRenderBenchmarkStageStereoField    = 3,
+    HugRenderBenchmarkStageLinearRamper   = 4,
+    HugRenderBenchmarkStageChain          = 5,
+    HugRenderBenchmarkStageChainTruePeak  = 6,
+
+    HugRenderBenchmarkStageCount
+} HugRenderBenchmarkStage;
+
+typedef enum {
+    HugRenderBenchmarkSignalSineSweep         = 0, // 20 Hz to 20 kHz, -1 dBFS
+    HugRenderBenchmarkSignalPinkNoise         = 1, // Decorrelated, about -15 dBFS RMS
+    HugRenderBenchmarkSignalInterSamplePeaks  = 2, // fs/4 at 45 degrees, then clipped square bursts
+    HugRenderBenchmarkSignalSilence           = 3,
+    HugRenderBenchmarkSignalDenormalTail      = 4, // Noise burst decaying through the subnormal range
+
+    HugRenderBenchmarkSignalCount
+} HugRenderBenchmarkSignal;
+
+enum {
+    HugRenderBenchmarkFrameSizeCount = 8 // 32, 64, ... 4096
+};
+
+typedef struct {
+    double peak;
+    double rms;
+    double weightedSum;
+} HugRenderBenchmarkFingerprint;
+
+typedef struct {
+    HugKernelLevel level;
+    HugRenderBenchmarkStage stage;
+    HugRenderBenchmarkSignal signal;
+    size_t frameSize;
+
+    HugRenderBenchmarkFingerprint fingerprints[2]; // Left and right, or two meter readings
+
+    double nanosecondsPerFrame;
+    double worstBufferNanoseconds;
+
+    BOOL hasGolden;
+    BOOL passed;
+} HugRenderBenchmarkResult;
+
+typedef void (*HugRenderBenchmarkCallback)(void *context, const HugRenderBenchmarkResult *result);
+
+extern const char *HugRenderBenchmarkGetStageName(HugRenderBenchmarkStage stage);
+extern const char *HugRenderBenchmarkGetSignalName(HugRenderBenchmarkSignal signal);
+extern size_t HugRenderBenchmarkGetFrameSize(size_t frameSizeIndex);
+
+// Not thread-safe: switches HugKernels to level for the duration of the run,
+// so only call while nothing is rendering. Calls callback once per stage,
+// signal, and frame size. Returns the number of runs which did not match
+// their golden fingerprint, or -1 if level is not supported.
+extern NSInteger HugRenderBenchmarkRun(HugKernelLevel level, HugRenderBenchmarkCallback callback, void *context);
@@ -0,0 +1,296 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// Generated by HugRenderBenchmark --golden with the scalar kernels
+
+#pragma once
+
+typedef struct {
+    int    stage;
+    int    signal;
+    size_t frameSize;
+    double values[2][3]; // Peak, RMS, weighted sum of each channel
+} HugRenderBenchmarkGoldenEntry;
+
+static const HugRenderBenchmarkGoldenEntry sHugRenderBenchmarkGolden[] = {
+    { 0, 0,   32, { { 1.0000227689743042, 0.70706824464000229, 246.79237017108659 }, { 1.0021364688873291, 0.70708003374710615, 49.805649625443735 } } },
+    { 0, 0,   64, { { 0.99997568130493164, 0.70706717479379022, 246.79239521528012 }, { 1.0021364688873291, 0.70707782446246936, 49.81318185492232 } } },
+    { 0, 0,  128, { { 1.0002530813217163, 0.70707602009152215, 246.73706397016048 }, { 1.0005784034729004, 0.70708529310515911, 49.779188985886094 } } },
+    { 0, 0,  256, { { 1.0013833045959473, 0.70707301157228619, 246.74313909239794 }, { 1.0013867616653442, 0.70707876948025727, 49.811641684578319 } } },
+    { 0, 0,  512, { { 1.0018073320388794, 0.70707432041197871, 246.7384477098031 }, { 1.0007613897323608, 0.7070770341199184, 49.832273922427902 } } },
+    { 0, 0, 1024, { { 1.0005519390106201, 0.70707498836055682, 246.7636464174023 }, { 1.004779577255249, 0.70708327764091083, 49.848237781283487 } } },
+    { 0, 0, 2048, { { 1.5253307819366455, 0.7101032463816157, 255.00131243087992 }, { 1.7825018167495728, 0.71044088179778353, 50.676819551114576 } } },
+    { 0, 0, 4096, { { 1.5253307819366455, 0.71028293953745414, 255.11922402148213 }, { 1.7825018167495728, 0.71061766403259208, 50.405104468404062 } } },
+    { 1, 0,   32, { { 0.89125090837478638, 0.88858827467200174, -5.6720702447786504 }, { 0.89083594083786011, 0.75614566138358519, 3.0182077119004447 } } },
+    { 1, 0,   64, { { 0.89125090837478638, 0.88895128669690304, 29.821227787019247 }, { 0.88986706733703613, 0.72778296785504903, 27.102244048440824 } } },
+    { 1, 0,  128, { { 0.89125090837478638, 0.88935807854720328, 25.889516534015236 }, { 0.88579875230789185, 0.69960845160648066, 19.962176613646722 } } },
+    { 1, 0,  256, { { 0.89125090837478638, 0.88997765003550855, 15.680438033996817 }, { 0.87170535326004028, 0.66973874937730871, 12.745881865265979 } } },
+    { 1, 0,  512, { { 0.89125090837478638, 0.8907802662017853, 2.9134933252851791 }, { 0.81737065315246582, 0.64631842539240802, 2.4704378360472208 } } },
+    { 1, 0, 1024, { { 0.89125090837478638, 0.8912490606414647, 4.9270456049721849 }, { 0.68997061252593994, 0.63275793775217726, 3.4563514150741663 } } },
+    { 1, 0, 2048, { { 0.89125090837478638, 0.89125052411537153, 6.5454583748479891 }, { 0.6581571102142334, 0.63055985516462298, 4.6890040161887265 } } },
+    { 1, 0, 4096, { { 0.89125090837478638, 0.89125080057917994, 3.4657319702277154 }, { 0.64180070161819458, 0.63021089667015429, 2.4632016394655496 } } },
+    { 2, 0,   32, { { 70, 11.992201679543555, -571.54108049630895 }, { 70, 12.257364710399715, -503.34202949109851 } } },
+    { 2, 0,   64, { { 70, 11.958141841603776, -549.45001763320022 }, { 70, 12.224009010399625, -608.58681616595891 } } },
+    { 2, 0,  128, { { 70, 11.956946055948675, -294.20590357403955 }, { 70, 12.222764078469586, -344.06260200681146 } } },
+    { 2, 0,  256, { { 70, 11.822375985711655, -95.693812354438705 }, { 70, 12.09111194984491, -116.38262573422591 } } },
+    { 2, 0,  512, { { 70, 11.817569511413057, -228.98178279922575 }, { 70, 12.086526606145226, -223.98181125319456 } } },
+    { 2, 0, 1024, { { 70, 11.251866056164626, -0.54095432845806979 }, { 70, 11.53114790447029, -8.7388109033790169 } } },
+    { 2, 0, 2048, { { 70, 11.236313713714619, -44.59169427004575 }, { 70, 11.515394359755625, -59.428578081721227 } } },
+    { 2, 0, 4096, { { 70, 11.191565466304485, 4.9233020792801696 }, { 70, 11.470319265824092, 0.96205608742176651 } } },
+    { 3, 0,   32, { { 0.89124947786331177, 0.48051310618424137, 186.34989428376085 }, { 0.89125090837478638, 0.52071528175457793, 77.621743977041945 } } },
+    { 3, 0,   64, { { 0.89097219705581665, 0.48048934210867061, 185.78013744831944 }, { 0.89125090837478638, 0.52075317327188675, 78.375809802310258 } } },
+    { 3, 0,  128, { { 0.89086103439331055, 0.48044194865538015, 185.10339042207565 }, { 0.89125090837478638, 0.52082942528971177, 79.623730228208984 } } },
+    { 3, 0,  256, { { 0.89040857553482056, 0.48036071777717854, 184.90167276553532 }, { 0.89125090837478638, 0.52097623618949218, 80.47436590231645 } } },
+    { 3, 0,  512, { { 0.89034086465835571, 0.4803290849943499, 184.98872127320888 }, { 0.89125090837478638, 0.52121346511115096, 81.327523894371154 } } },
+    { 3, 0, 1024, { { 0.88957780599594116, 0.48066681991636473, 187.15871840053526 }, { 0.89125090837478638, 0.52140862535513577, 82.019022846834801 } } },
+    { 3, 0, 2048, { { 0.88696920871734619, 0.48099195866116856, 193.18211433229055 }, { 0.89125090837478638, 0.52181607024861643, 79.663213403711225 } } },
+    { 3, 0, 4096, { { 0.88603770732879639, 0.48170024512149667, 197.5859199647596 }, { 0.89125090837478638, 0.52275372491507899, 80.522543929889082 } } },
+    { 4, 0,   32, { { 0.89081484079360962, 0.36385170519663518, 74.940116623707524 }, { 0.89125090837478638, 0.36391325401748614, 34.998647316463838 } } },
+    { 4, 0,   64, { { 0.89070498943328857, 0.36385198028689886, 75.076340908090529 }, { 0.89125090837478638, 0.36397359072722318, 36.256247543882296 } } },
+    { 4, 0,  128, { { 0.89094632863998413, 0.3638543034926095, 75.258682321073806 }, { 0.89125090837478638, 0.36409248555386264, 37.783992541666763 } } },
+    { 4, 0,  256, { { 0.89109879732131958, 0.36387240586382702, 75.40659733588555 }, { 0.89125090837478638, 0.36431672892240202, 38.327676689937768 } } },
+    { 4, 0,  512, { { 0.88887125253677368, 0.36399530128055968, 75.961836092287584 }, { 0.89125090837478638, 0.36467054714485347, 38.659005890141302 } } },
+    { 4, 0, 1024, { { 0.88848263025283813, 0.36457790571405768, 79.840046150343326 }, { 0.89125090837478638, 0.36504069106562298, 38.221628153301573 } } },
+    { 4, 0, 2048, { { 0.88806647062301636, 0.36564629748304001, 86.124936221896306 }, { 0.89125090837478638, 0.36587220804338066, 33.269587251272768 } } },
+    { 4, 0, 4096, { { 0.87443506717681885, 0.36740790125324196, 94.327041168711403 }, { 0.89125090837478638, 0.36752076977196346, 32.842549587337068 } } },
+    { 5, 0,   32, { { 0.7292017936706543, 0.51550542451146553, 182.81222336701677 }, { 1.0828697681427002, 0.70715438679741671, 76.866269131044376 } } },
+    { 5, 0,   64, { { 0.72918874025344849, 0.51550580419712932, 182.82045515413421 }, { 1.0828697681427002, 0.70715833101619974, 76.914791621672876 } } },
+    { 5, 0,  128, { { 0.72953712940216064, 0.51550676461744882, 182.8203297245829 }, { 1.0828697681427002, 0.70715883241437039, 76.918352622072447 } } },
+    { 5, 0,  256, { { 0.73004692792892456, 0.51550926393821783, 182.80363584240519 }, { 1.0828697681427002, 0.70716120763549906, 76.916347385149422 } } },
+    { 5, 0,  512, { { 0.73035323619842529, 0.51550799359534016, 182.81310853277364 }, { 1.0828697681427002, 0.70715945662265012, 76.913354433372191 } } },
+    { 5, 0, 1024, { { 0.72938573360443115, 0.51550610401221786, 182.82263847552991 }, { 1.0828697681427002, 0.70715828276796056, 76.911937110334023 } } },
+    { 5, 0, 2048, { { 0.72938573360443115, 0.51550610401221786, 182.82263847552991 }, { 1.0828697681427002, 0.70715828276796056, 76.911937110334023 } } },
+    { 5, 0, 4096, { { 0.72938573360443115, 0.51550610401221786, 182.82263847552991 }, { 1.0828697681427002, 0.70715828276796056, 76.911937110334023 } } },
+    { 6, 0,   32, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 6, 0,   64, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 6, 0,  128, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 6, 0,  256, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 6, 0,  512, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 6, 0, 1024, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 6, 0, 2048, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 6, 0, 4096, { { 0.65681618452072144, 0.45724465279694798, -111.47986802300346 }, { 0.89125090837478638, 0.62698588867374172, -7.5701178541384788 } } },
+    { 0, 1,   32, { { 1.0773345232009888, 0.27937663670793428, -61.111685488329243 }, { 1.0432860851287842, 0.27608345559250458, -30.189708884261297 } } },
+    { 0, 1,   64, { { 1.1182030439376831, 0.27934940145595616, -61.246968559366323 }, { 1.3099949359893799, 0.27608383196133368, -30.265561772213758 } } },
+    { 0, 1,  128, { { 1.1182030439376831, 0.27943478921313958, -60.80055890493297 }, { 1.3099949359893799, 0.27616324419363075, -30.159820658478949 } } },
+    { 0, 1,  256, { { 1.5481449365615845, 0.27939311048634874, -61.050739267410513 }, { 1.3834868669509888, 0.27598314724945355, -30.687704188268526 } } },
+    { 0, 1,  512, { { 1.7276097536087036, 0.27977708252747852, -61.180452746368516 }, { 1.6522030830383301, 0.27583989972593959, -32.317365880276149 } } },
+    { 0, 1, 1024, { { 1.7276097536087036, 0.27960446756935631, -61.437450587126335 }, { 1.6522030830383301, 0.27562514889206552, -31.803054986465845 } } },
+    { 0, 1, 2048, { { 2.3235805034637451, 0.28408830483501402, -62.624717481080616 }, { 2.041752815246582, 0.2788225066850471, -36.264775314970443 } } },
+    { 0, 1, 4096, { { 2.3235805034637451, 0.28289923797814914, -63.521250111047657 }, { 2.041752815246582, 0.27786615769540063, -35.373480438258724 } } },
+    { 1, 1,   32, { { 1.7775344848632812, 1.348720912739545, -4.4719871995098543 }, { 1.2748388051986694, 0.88317875440666693, -4.5393075078911176 } } },
+    { 1, 1,   64, { { 1.7775344848632812, 1.3494348594650245, 43.246908462690314 }, { 1.1166912317276001, 0.7753093730155991, 26.841089943807379 } } },
+    { 1, 1,  128, { { 1.7775344848632812, 1.3505620705128676, 39.593348783191018 }, { 0.98452967405319214, 0.6965936877353005, 19.717658297951434 } } },
+    { 1, 1,  256, { { 1.7775344848632812, 1.3524774603290117, 24.410794634036801 }, { 0.80752545595169067, 0.60761801786066638, 12.309150392042866 } } },
+    { 1, 1,  512, { { 1.7775344848632812, 1.3570362165461762, 3.5013633479830837 }, { 0.71632301807403564, 0.53977613017578419, 1.8910656200844493 } } },
+    { 1, 1, 1024, { { 1.7775344848632812, 1.368263897713847, 6.8558947805343768 }, { 0.62689220905303955, 0.47802706939638745, 3.3874137029805764 } } },
+    { 1, 1, 2048, { { 1.7775344848632812, 1.3855546007909958, 10.615400668377774 }, { 0.58537495136260986, 0.44456906637998406, 3.2440993604646491 } } },
+    { 1, 1, 4096, { { 1.7775344848632812, 1.4193952768699927, 4.4579015697529876 }, { 0.51553267240524292, 0.42754768645357633, 1.6009556864371175 } } },
+    { 2, 1,   32, { { 70, 11.873844156557357, -302.38675500345238 }, { 70, 11.865488362540077, -302.90877817362207 } } },
+    { 2, 1,   64, { { 70, 11.839545481990807, -608.16174707420998 }, { 70, 11.831164835703831, -605.85184400116316 } } },
+    { 2, 1,  128, { { 70, 11.839552784174009, -343.19034159922205 }, { 70, 11.831175387544782, -342.30987842396939 } } },
+    { 2, 1,  256, { { 70, 11.70134759983538, -110.38131880687698 }, { 70, 11.692880039945415, -110.39697774713477 } } },
+    { 2, 1,  512, { { 70, 11.70139116932271, -201.61803136407832 }, { 70, 11.69290606057441, -201.6142622589559 } } },
+    { 2, 1, 1024, { { 70, 11.11871122781057, 17.193447642700278 }, { 70, 11.110020142575747, 17.343238193727004 } } },
+    { 2, 1, 2048, { { 70, 11.118965228593343, -57.641984716137891 }, { 70, 11.110111844874922, -57.626904494937826 } } },
+    { 2, 1, 4096, { { 70, 11.119507872496349, 7.0077577037300571 }, { 70, 11.110540148584798, 6.9639188282127016 } } },
+    { 3, 1,   32, { { 1.7658008337020874, 0.32879706287510552, -101.63480039490609 }, { 1.8077387809753418, 0.3519325694755534, -18.843338472249883 } } },
+    { 3, 1,   64, { { 1.7649494409561157, 0.3288114114030059, -102.09623479631037 }, { 1.8077387809753418, 0.35194564308815052, -18.713637949471956 } } },
+    { 3, 1,  128, { { 1.763279914855957, 0.32884762419726665, -101.98297611175691 }, { 1.8077387809753418, 0.35196283785657378, -18.841227771794252 } } },
+    { 3, 1,  256, { { 1.7599308490753174, 0.32893701414102677, -101.7025139114502 }, { 1.8077387809753418, 0.35200175155888697, -19.235532965808197 } } },
+    { 3, 1,  512, { { 1.7532274723052979, 0.32914954936352936, -101.18675907702378 }, { 1.8077387809753418, 0.35207101122826662, -20.528873689617882 } } },
+    { 3, 1, 1024, { { 1.7398053407669067, 0.32944411487655134, -101.45124137698537 }, { 1.8048025369644165, 0.35220005518482134, -21.720885201316811 } } },
+    { 3, 1, 2048, { { 1.7413218021392822, 0.32978846324590644, -99.527887176512024 }, { 1.7668380737304688, 0.35250651676269229, -23.713794042318895 } } },
+    { 3, 1, 4096, { { 1.7121109962463379, 0.3302049253994212, -95.390658804450425 }, { 1.6906410455703735, 0.35354489043807835, -26.331325008575128 } } },
+    { 4, 1,   32, { { 1.3998160362243652, 0.24668205763042433, -55.103661087442966 }, { 1.3795557022094727, 0.24551807767548647, -7.3132102082978783 } } },
+    { 4, 1,   64, { { 1.3993339538574219, 0.2466883509022712, -55.952675657220759 }, { 1.3790860176086426, 0.24553958443758223, -7.2724782681771147 } } },
+    { 4, 1,  128, { { 1.3983886241912842, 0.2467123193990913, -56.081094796027358 }, { 1.3781380653381348, 0.24556734533531321, -7.684683089938237 } } },
+    { 4, 1,  256, { { 1.3964924812316895, 0.24678713012013828, -55.994139078748717 }, { 1.3762381076812744, 0.24561967556642886, -8.2675609231259664 } } },
+    { 4, 1,  512, { { 1.3926899433135986, 0.24703327095558555, -56.997710149306101 }, { 1.3724286556243896, 0.24573999896062901, -10.46551735781172 } } },
+    { 4, 1, 1024, { { 1.3927711248397827, 0.24739623157209878, -59.23966165923526 }, { 1.3693666458129883, 0.24597366208250271, -12.430490703148076 } } },
+    { 4, 1, 2048, { { 1.4080907106399536, 0.24787309031681418, -58.216768146191512 }, { 1.3855109214782715, 0.24656890521075914, -15.339689666791145 } } },
+    { 4, 1, 4096, { { 1.4066036939620972, 0.24879332794689496, -54.611144951229491 }, { 1.4178030490875244, 0.24847465732427404, -18.343476602287467 } } },
+    { 5, 1,   32, { { 0.94871342182159424, 0.20358093381570108, -45.533283683858194 }, { 1.1075023412704468, 0.27590229798862254, -42.899435622611144 } } },
+    { 5, 1,   64, { { 0.94871342182159424, 0.20352504343068395, -45.295491982290031 }, { 1.0938707590103149, 0.27580730844193035, -42.637172782628461 } } },
+    { 5, 1,  128, { { 0.94871342182159424, 0.20400788082448368, -45.411788256006872 }, { 1.0685608386993408, 0.27660532442749808, -40.700702860215195 } } },
+    { 5, 1,  256, { { 0.94499462842941284, 0.2037769475204865, -45.418703831202521 }, { 1.0685608386993408, 0.27630034521516378, -40.31730621655845 } } },
+    { 5, 1,  512, { { 0.93755704164505005, 0.20337167244506749, -45.736578985107144 }, { 1.0685608386993408, 0.27561117239468641, -39.704371115501637 } } },
+    { 5, 1, 1024, { { 0.93755704164505005, 0.20324119387994136, -46.611501929371613 }, { 1.0086548328399658, 0.27526585098431872, -39.635159670624411 } } },
+    { 5, 1, 2048, { { 0.93755704164505005, 0.20324119387994136, -46.611501929371613 }, { 1.0086548328399658, 0.27526585098431872, -39.635159670624411 } } },
+    { 5, 1, 4096, { { 0.93755704164505005, 0.20324119387994136, -46.611501929371613 }, { 1.0086548328399658, 0.27526585098431872, -39.635159670624411 } } },
+    { 6, 1,   32, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 6, 1,   64, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 6, 1,  128, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 6, 1,  256, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 6, 1,  512, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 6, 1, 1024, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 6, 1, 2048, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 6, 1, 4096, { { 0.8873639702796936, 0.22456250569703137, -1.7949788598206304 }, { 0.89125090837478638, 0.29903481620021605, -33.764020574654992 } } },
+    { 0, 2,   32, { { 0.99994069337844849, 0.9999389650927244, -131.21251782344376 }, { 0.99994069337844849, 0.9999389650927244, 374.24063761449122 } } },
+    { 0, 2,   64, { { 0.99994581937789917, 0.99993896687621231, -131.21251704692676 }, { 0.99994581937789917, 0.99993896687621231, 374.24063695466725 } } },
+    { 0, 2,  128, { { 0.99996668100357056, 0.99993898119543978, -131.2126250234908 }, { 0.99996668100357056, 0.99993898119543978, 374.24074503726627 } } },
+    { 0, 2,  256, { { 1.0000495910644531, 0.99993909627601218, -131.2120770318873 }, { 1.0000495910644531, 0.99993909627601218, 374.24019630555847 } } },
+    { 0, 2,  512, { { 1.0003739595413208, 0.99994000174571873, -131.21123296949821 }, { 1.0003739595413208, 0.99994000174571873, 374.23935269417507 } } },
+    { 0, 2, 1024, { { 1.0016134977340698, 0.99994700172627216, -131.20708459994705 }, { 1.0016134977340698, 0.99994700172627216, 374.23522379229428 } } },
+    { 0, 2, 2048, { { 1.0061546564102173, 0.99999937668913219, -131.08360754276885 }, { 1.0061546564102173, 0.99999937668913219, 374.11213379380592 } } },
+    { 0, 2, 4096, { { 1.0216480493545532, 1.0003712148502051, -131.18447729999679 }, { 1.0216480493545532, 1.0003712148502051, 374.21227240539554 } } },
+    { 1, 2,   32, { { 1, 1, -4.9755070237442851 }, { 1, 1, -4.9755070237442851 } } },
+    { 1, 2,   64, { { 1, 1, 33.652812230400741 }, { 1, 1, 33.652812230400741 } } },
+    { 1, 2,  128, { { 1, 1, 29.096073768101633 }, { 1, 1, 29.096073768101633 } } },
+    { 1, 2,  256, { { 1, 1, 17.530917487107217 }, { 1, 1, 17.530917487107217 } } },
+    { 1, 2,  512, { { 1, 1, 3.2810264085419476 }, { 1, 1, 3.2810264085419476 } } },
+    { 1, 2, 1024, { { 1, 1, 5.5283263977617025 }, { 1, 1, 5.5283263977617025 } } },
+    { 1, 2, 2048, { { 1, 1, 7.3441310497000813 }, { 1, 1, 7.3441310497000813 } } },
+    { 1, 2, 4096, { { 1, 1, 3.8886166475713253 }, { 1, 1, 3.8886166475713253 } } },
+    { 2, 2,   32, { { 70, 12.693783049409047, -412.65439738197608 }, { 70, 12.694285919124862, -412.73736953887692 } } },
+    { 2, 2,   64, { { 70, 12.661840290130321, -317.58382447149734 }, { 70, 12.662344530984385, -317.61462034526409 } } },
+    { 2, 2,  128, { { 70, 12.66183993691558, -63.421403527575109 }, { 70, 12.662344333776206, -63.388356341307571 } } },
+    { 2, 2,  256, { { 70, 12.53325531927169, 72.945146981602107 }, { 70, 12.533765227340423, 72.96629378185925 } } },
+    { 2, 2,  512, { { 70, 12.533250872815636, -197.51787253747568 }, { 70, 12.53376416547405, -197.53261277177378 } } },
+    { 2, 2, 1024, { { 70, 11.993654916197197, 83.812416459220984 }, { 70, 11.994194834517423, 83.8105292737676 } } },
+    { 2, 2, 2048, { { 70, 11.993656179625699, 17.345159720952072 }, { 70, 11.994192277701098, 17.351631259405519 } } },
+    { 2, 2, 4096, { { 70, 11.993641110264148, 52.736790554251726 }, { 70, 11.994184917446878, 52.744901401036003 } } },
+    { 3, 2,   32, { { 1, 0.70635177898732793, -130.62808952840274 }, { 1, 0.8064027189688342, 296.2245435600471 } } },
+    { 3, 2,   64, { { 1, 0.70633297532548911, -129.96967971681079 }, { 1, 0.80641876427017212, 295.44571797208192 } } },
+    { 3, 2,  128, { { 1, 0.7062951447986503, -130.8703588533337 }, { 1, 0.80645063924501903, 295.69170495388329 } } },
+    { 3, 2,  256, { { 1, 0.70621601118200261, -133.60948469953291 }, { 1, 0.80651123457952933, 297.61642274746441 } } },
+    { 3, 2,  512, { { 1, 0.70605571323742489, -136.52112114536715 }, { 1, 0.8066285836448297, 299.6974024931643 } } },
+    { 3, 2, 1024, { { 1, 0.70570955791798873, -128.84911563440258 }, { 1, 0.80683540373491403, 295.25369174184033 } } },
+    { 3, 2, 2048, { { 1, 0.70497398785335152, -136.65679277432244 }, { 1, 0.80720037082281293, 295.75241018496888 } } },
+    { 3, 2, 4096, { { 1, 0.70356650710992596, -135.71218556500068 }, { 1, 0.80789328173536534, 295.39489897503171 } } },
+    { 4, 2,   32, { { 1, 0.57739915616620563, -11.048055862488679 }, { 1, 0.57739915616620563, 141.26575021297612 } } },
+    { 4, 2,   64, { { 1, 0.57744725075423564, -10.431699713469749 }, { 1, 0.57744725075423564, 140.73070883659332 } } },
+    { 4, 2,  128, { { 1, 0.57754344634751742, -11.425587625508399 }, { 1, 0.57754344634751742, 141.88630422514521 } } },
+    { 4, 2,  256, { { 1, 0.57773579692475918, -14.355083174114428 }, { 1, 0.57773579692475918, 145.14028976319159 } } },
+    { 4, 2,  512, { { 1, 0.57811415592479387, -17.598652917819887 }, { 1, 0.57811415592479387, 149.14549447636432 } } },
+    { 4, 2, 1024, { { 1, 0.57886992216885291, -10.812873423328345 }, { 1, 0.57886992216885291, 143.91744015998557 } } },
+    { 4, 2, 2048, { { 1, 0.58037719607047911, -20.226376457239489 }, { 1, 0.58037719607047911, 156.53345491884295 } } },
+    { 4, 2, 4096, { { 1, 0.58308275582771429, -22.492669023935484 }, { 1, 0.58308275582771429, 164.88882119395362 } } },
+    { 5, 2,   32, { { 0.72902989387512207, 0.69602093050872915, -89.581254475952676 }, { 1.000041127204895, 0.95476135150872232, 365.91022935057299 } } },
+    { 5, 2,   64, { { 0.72901928424835205, 0.69602086757734083, -89.581302289436081 }, { 1.0000265836715698, 0.9547612651674815, 365.91010508844727 } } },
+    { 5, 2,  128, { { 0.72899800539016724, 0.69602075851283018, -89.580998989191698 }, { 0.99999731779098511, 0.95476111548034692, 365.91041864691749 } } },
+    { 5, 2,  256, { { 0.72895598411560059, 0.69602073499190231, -89.580883198695204 }, { 0.99993979930877686, 0.95476108300762541, 365.91001576956228 } } },
+    { 5, 2,  512, { { 0.72895759344100952, 0.69602074631739863, -89.580862795493886 }, { 0.99994194507598877, 0.95476109742426651, 365.90999963455124 } } },
+    { 5, 2, 1024, { { 0.72896391153335571, 0.69602078845874349, -89.580844773185163 }, { 0.99995064735412598, 0.95476115407784767, 365.90996304194738 } } },
+    { 5, 2, 2048, { { 0.72896391153335571, 0.69602078845874349, -89.580844773185163 }, { 0.99995064735412598, 0.95476115407784767, 365.90996304194738 } } },
+    { 5, 2, 4096, { { 0.72896391153335571, 0.69602078845874349, -89.580844773185163 }, { 0.99995064735412598, 0.95476115407784767, 365.90996304194738 } } },
+    { 6, 2,   32, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 6, 2,   64, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 6, 2,  128, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 6, 2,  256, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 6, 2,  512, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 6, 2, 1024, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 6, 2, 2048, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 6, 2, 4096, { { 0.51422983407974243, 0.44242946472520994, 43.162966659397874 }, { 0.70539075136184692, 0.60689918781208851, -105.40744338754105 } } },
+    { 0, 3,   32, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 3,   64, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 3,  128, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 3,  256, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 3,  512, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 3, 1024, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 3, 2048, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 3, 4096, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3,   32, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3,   64, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3,  128, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3,  256, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3,  512, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3, 1024, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3, 2048, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 1, 3, 4096, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 2, 3,   32, { { 70, 70, 348.28549166209996 }, { 70, 70, 348.28549166209996 } } },
+    { 2, 3,   64, { { 70, 70, -2355.6968561280519 }, { 70, 70, -2355.6968561280519 } } },
+    { 2, 3,  128, { { 70, 70, -2036.7251637671143 }, { 70, 70, -2036.7251637671143 } } },
+    { 2, 3,  256, { { 70, 70, -1227.1642240975052 }, { 70, 70, -1227.1642240975052 } } },
+    { 2, 3,  512, { { 70, 70, -229.67184859793633 }, { 70, 70, -229.67184859793633 } } },
+    { 2, 3, 1024, { { 70, 70, -386.98284784331918 }, { 70, 70, -386.98284784331918 } } },
+    { 2, 3, 2048, { { 70, 70, -514.08917347900569 }, { 70, 70, -514.08917347900569 } } },
+    { 2, 3, 4096, { { 70, 70, -272.20316532999277 }, { 70, 70, -272.20316532999277 } } },
+    { 3, 3,   32, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 3, 3,   64, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 3, 3,  128, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 3, 3,  256, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 3, 3,  512, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 3, 3, 1024, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 3, 3, 2048, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 3, 3, 4096, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3,   32, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3,   64, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3,  128, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3,  256, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3,  512, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3, 1024, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3, 2048, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 4, 3, 4096, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3,   32, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3,   64, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3,  128, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3,  256, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3,  512, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3, 1024, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3, 2048, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 5, 3, 4096, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3,   32, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3,   64, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3,  128, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3,  256, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3,  512, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3, 1024, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3, 2048, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 6, 3, 4096, { { 0, 0, 0 }, { 0, 0, 0 } } },
+    { 0, 4,   32, { { 1.3346074819564819, 0.08847929780047202, -22.579183545659589 }, { 0.99993896484375, 0.084105745856332612, -11.761112705670147 } } },
+    { 0, 4,   64, { { 2.7783012390136719, 0.089593758781526103, -20.446858481658921 }, { 1.6803048849105835, 0.084529220561579133, -15.045311557418113 } } },
+    { 0, 4,  128, { { 3.0773344039916992, 0.092413832818685912, -12.260981180626645 }, { 1.9232305288314819, 0.085985326198756609, -16.062213625464636 } } },
+    { 0, 4,  256, { { 3.0773344039916992, 0.092206075876872629, -12.136434051123219 }, { 1.9232305288314819, 0.085819531134012514, -15.894385097311922 } } },
+    { 0, 4,  512, { { 3.0773344039916992, 0.092093542465216144, -12.370739387461636 }, { 1.9232305288314819, 0.085991630364323418, -15.410234338515663 } } },
+    { 0, 4, 1024, { { 3.9578299522399902, 0.10729249782260646, 1.0293805244702785 }, { 4.0275115966796875, 0.10145533615495346, -20.947541957342541 } } },
+    { 0, 4, 2048, { { 4.0717101097106934, 0.12793882403280094, 10.496595472764126 }, { 4.2983946800231934, 0.12052900969864563, -7.8837392923111524 } } },
+    { 0, 4, 4096, { { 4.4907832145690918, 0.1753212866553531, 7.8496164333211489 }, { 4.4729971885681152, 0.17267615799556438, -0.3845851673331348 } } },
+    { 1, 4,   32, { { 3.6743078231811523, 1.2628123322660991, 62.222887544375979 }, { 1.9485318660736084, 0.72015840852243307, 36.865513956030355 } } },
+    { 1, 4,   64, { { 3.6743078231811523, 1.263619602535986, 44.24496928711293 }, { 1.7070480585098267, 0.65615882340694764, 22.183182481218523 } } },
+    { 1, 4,  128, { { 3.6743078231811523, 1.2653123412879603, 26.944372920437388 }, { 1.5315206050872803, 0.58556414019869529, 11.239681251693927 } } },
+    { 1, 4,  256, { { 3.6743078231811523, 1.2664569265269527, 17.346838103345885 }, { 1.3196518421173096, 0.49540649146963295, 7.2054025484442938 } } },
+    { 1, 4,  512, { { 3.6743078231811523, 1.2665865451467924, 15.106220306440402 }, { 1.1813231706619263, 0.43314303467779197, 5.6682678532773512 } } },
+    { 1, 4, 1024, { { 3.6743078231811523, 1.2720648946356725, 11.08011033264509 }, { 1.1212987899780273, 0.41089405532792844, 2.789226679321354 } } },
+    { 1, 4, 2048, { { 3.6743078231811523, 1.2896919917238538, 6.5726911944958744 }, { 1.0804215669631958, 0.40147957672037282, 2.0896694069903097 } } },
+    { 1, 4, 4096, { { 3.6743078231811523, 1.3153325915021572, 5.4800331090751051 }, { 0.95782876014709473, 0.3724439397740249, 1.4052806677020162 } } },
+    { 2, 4,   32, { { 70, 62.749527226718449, 2158.370881300455 }, { 70, 28.092833140115872, 106.79994925859637 } } },
+    { 2, 4,   64, { { 70, 62.749527226718442, -2028.9019532498623 }, { 70, 28.092833140115896, -918.44464135303701 } } },
+    { 2, 4,  128, { { 70, 62.751253717073268, -1869.3192563858465 }, { 70, 28.099256555629172, -244.70128273013063 } } },
+    { 2, 4,  256, { { 70, 62.751149635743111, -954.40531297046641 }, { 70, 28.042609829735049, -579.27094378687491 } } },
+    { 2, 4,  512, { { 70, 62.758190940474826, 73.141122257187192 }, { 70, 28.068730868185877, 11.575747243986797 } } },
+    { 2, 4, 1024, { { 70, 62.675103736277862, -154.2144574289627 }, { 70, 28.037709167380509, -7.160713225737851 } } },
+    { 2, 4, 2048, { { 70, 62.702485782101924, -492.26180784875942 }, { 70, 28.141938020125281, -29.734030604192014 } } },
+    { 2, 4, 4096, { { 70, 63.060295841520087, -29.495746131590124 }, { 70, 28.351691987985852, -45.483804278222976 } } },
+    { 3, 4,   32, { { 2.5466752052307129, 0.21161274872033303, -78.227452961578791 }, { 1.366033673286438, 0.1097780201353695, -28.287732548661843 } } },
+    { 3, 4,   64, { { 2.5461328029632568, 0.21171975056863518, -75.986441925674768 }, { 1.3651398420333862, 0.10976622376630973, -29.648746121287846 } } },
+    { 3, 4,  128, { { 2.5450482368469238, 0.21182231383585295, -73.042703144286534 }, { 1.36333167552948, 0.10989033884908124, -31.216557738969531 } } },
+    { 3, 4,  256, { { 2.5428788661956787, 0.211836195418179, -70.973751690775998 }, { 1.528995156288147, 0.11022221428776728, -32.693478878772069 } } },
+    { 3, 4,  512, { { 2.5385489463806152, 0.21186790921188642, -68.02780298414757 }, { 1.8801528215408325, 0.11070962494483375, -34.891642223299115 } } },
+    { 3, 4, 1024, { { 2.5298762321472168, 0.21234425385458275, -67.447341217566787 }, { 2.0762472152709961, 0.11238632106740212, -33.913992245561666 } } },
+    { 3, 4, 2048, { { 2.5125243663787842, 0.21271882565669015, -67.895941951907645 }, { 2.1797010898590088, 0.11549615086995912, -28.327204603566077 } } },
+    { 3, 4, 4096, { { 2.5327954292297363, 0.21481671072840078, -70.894377711135405 }, { 2.2328150272369385, 0.12173113297242809, -27.407042782338124 } } },
+    { 4, 4,   32, { { 1.1326297521591187, 0.031401645117033729, -6.6927680726829211 }, { 0.70018702745437622, 0.032365517550820282, -0.5009479158969572 } } },
+    { 4, 4,   64, { { 1.4065840244293213, 0.032161672432489366, -3.7411154008647509 }, { 0.85199153423309326, 0.032609001699766535, -2.008932481836025 } } },
+    { 4, 4,  128, { { 1.5403255224227905, 0.033915046673017382, 1.0148330512553203 }, { 0.96588659286499023, 0.033384098379206147, -3.0904881932105335 } } },
+    { 4, 4,  256, { { 1.7242499589920044, 0.036283286718287788, 4.3689344567187272 }, { 1.4079927206039429, 0.03559006756435143, -3.7718289558978295 } } },
+    { 4, 4,  512, { { 1.9093525409698486, 0.039469639542270452, 7.7442195383526853 }, { 1.8482900857925415, 0.038778362826761559, -6.0647516468463785 } } },
+    { 4, 4, 1024, { { 2.0016324520111084, 0.047966645037521086, 12.478243060852918 }, { 2.0677931308746338, 0.045727845698178997, -2.0703913868024753 } } },
+    { 4, 4, 2048, { { 2.0477046966552734, 0.061423975804952076, 21.296453809749295 }, { 2.1773836612701416, 0.059074700999692753, 8.4325289425020351 } } },
+    { 4, 4, 4096, { { 2.2187726497650146, 0.079208410759615266, 12.388256133917373 }, { 2.2321388721466064, 0.078746215157423902, 6.7847314706662329 } } },
+    { 5, 4,   32, { { 1.1269135475158691, 0.074386921297745087, -21.062156251513564 }, { 1.0067425966262817, 0.095885313542152573, -21.270236327665813 } } },
+    { 5, 4,   64, { { 1.3230901956558228, 0.074530789482902912, -20.656234611518478 }, { 1.0578737258911133, 0.095866059758243513, -21.756147349329765 } } },
+    { 5, 4,  128, { { 1.3489546775817871, 0.074697677677973584, -19.742099165511277 }, { 1.2119922637939453, 0.095936296721379669, -21.754756621082521 } } },
+    { 5, 4,  256, { { 1.3489546775817871, 0.074684561582612288, -19.727232458962561 }, { 1.2119922637939453, 0.095911074040331445, -21.750895400272171 } } },
+    { 5, 4,  512, { { 1.3489546775817871, 0.074661385327252375, -19.696303907895818 }, { 1.2119922637939453, 0.095867605713623683, -21.765590918047508 } } },
+    { 5, 4, 1024, { { 1.7893588542938232, 0.078069736915515608, -14.350901338222652 }, { 2.6131181716918945, 0.10096426176075567, -23.311232103751337 } } },
+    { 5, 4, 2048, { { 1.7893588542938232, 0.078069736915515608, -14.350901338222652 }, { 2.6131181716918945, 0.10096426176075567, -23.311232103751337 } } },
+    { 5, 4, 4096, { { 1.7893588542938232, 0.078069736915515608, -14.350901338222652 }, { 2.6131181716918945, 0.10096426176075567, -23.311232103751337 } } },
+    { 6, 4,   32, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+    { 6, 4,   64, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+    { 6, 4,  128, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+    { 6, 4,  256, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+    { 6, 4,  512, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+    { 6, 4, 1024, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+    { 6, 4, 2048, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+    { 6, 4, 4096, { { 0.88256651163101196, 0.073337273235536932, -16.548033650260056 }, { 0.89125090837478638, 0.094952513351184209, 16.032954733293352 } } },
+};
@@ -0,0 +1,284 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugRenderChain.h"
+
+#include "HugLevelMeter.h"
+#include "HugLimiter.h"
+#include "HugLinearRamper.h"
+#include "HugLoudnessMeter.h"
+#include "HugStereoField.h"
+#include "HugTruePeakLimiter.h"
+
+
+static const size_t sMaxMeterFrameCount = 1024;
+
+
+struct HugRenderChain {
+    double _sampleRate;
+    size_t _maxFrameCount;
+    size_t _meterFrameCount;
+
+    HugRenderChainLimiterMode _requestedLimiterMode;
+    HugRenderChainLimiterMode _limiterMode;
+
+    HugStereoField  *_stereoField;
+    HugLinearRamper *_preGainRamper;
+    HugLinearRamper *_volumeRamper;
+    HugLevelMeter   *_leftLevelMeter;
+    HugLevelMeter   *_rightLevelMeter;
+    HugLoudnessMeter *_loudnessMeter;
+    HugLimiter      *_limiter;
+
+    HugTruePeakLimiter *_truePeakLimiter;
+
+    HugRenderChainMeterPacket *_packets;
+    size_t _packetCapacity;
+    size_t _packetCount;
+};
+
+
+#pragma mark - Lifecycle
+
+HugRenderChain *HugRenderChainCreate()
+{
+    HugRenderChain *self = calloc(1, sizeof(HugRenderChain));
+
+    self->_stereoField     = HugStereoFieldCreate();
+    self->_preGainRamper   = HugLinearRamperCreate();
+    self->_volumeRamper    = HugLinearRamperCreate();
+    self->_leftLevelMeter  = HugLevelMeterCreate();
+    self->_rightLevelMeter = HugLevelMeterCreate();
+    self->_loudnessMeter   = HugLoudnessMeterCreate();
+    self->_limiter         = HugLimiterCreate();
+    self->_truePeakLimiter = HugTruePeakLimiterCreate();
+
+    return self;
+}
+
+
+void HugRenderChainFree(HugRenderChain *self)
+{
+    if (!self) return;
+
+    HugStereoFieldFree(self->_stereoField);
+    HugLinearRamperFree(self->_preGainRamper);
+    HugLinearRamperFree(self->_volumeRamper);
+    HugLevelMeterFree(self->_leftLevelMeter);
+    HugLevelMeterFree(self->_rightLevelMeter);
+    HugLoudnessMeterFree(self->_loudnessMeter);
+    HugLimiterFree(self->_limiter);
+    HugTruePeakLimiterFree(self->_truePeakLimiter);
+
+    free(self->_packets);
+    free(self);
+}
+
+
+#pragma mark - Private Functions
+
+// Splits the buffer into meter slices, then meters and limits each one
+static void sProcessMetersAndLimiter(HugRenderChain *self, float *left, float *right, size_t frameCount)
+{
+    size_t meterFrameCount = self->_meterFrameCount;
+    size_t offset = 0;
+
+    while (offset < frameCount && self->_packetCount < self->_packetCapacity) {
+        size_t framesToProcess = MIN(frameCount - offset, meterFrameCount);
+
+        HugRenderChainMeterPacket *packet = &self->_packets[self->_packetCount++];
+        memset(packet, 0, sizeof(HugRenderChainMeterPacket));
+
+        packet->frameOffset = offset;
+        packet->frameCount  = framesToProcess;
+
+        if (left) {
+            HugLevelMeterProcess(self->_leftLevelMeter, left + offset, framesToProcess);
+
+            packet->leftPeakLevel = HugLevelMeterGetPeakLevel(self->_leftLevelMeter);
+            packet->leftHeldLevel = HugLevelMeterGetHeldLevel(self->_leftLevelMeter);
+        }
+
+        if (right) {
+            HugLevelMeterProcess(self->_rightLevelMeter, right + offset, framesToProcess);
+
+            packet->rightPeakLevel = HugLevelMeterGetPeakLevel(self->_rightLevelMeter);
+            packet->rightHeldLevel = HugLevelMeterGetHeldLevel(self->_rightLevelMeter);
+        }
+
+        HugLoudnessMeterProcess(self->_loudnessMeter,
+            left  ? left  + offset : NULL,
+            right ? right + offset : NULL,
+            framesToProcess);
+
+        packet->momentaryLoudness = HugLoudnessMeterGetMomentaryLoudness(self->_loudnessMeter);
+        packet->shortTermLoudness = HugLoudnessMeterGetShortTermLoudness(self->_loudnessMeter);
+        packet->correlation       = HugLoudnessMeterGetCorrelation(self->_loudnessMeter);
+
+        float *limiterLeft  = left  ? left  + offset : NULL;
+        float *limiterRight = right ? right + offset : NULL;
+
+        if (self->_limiterMode == HugRenderChainLimiterModeTruePeak) {
+            HugTruePeakLimiterProcess(self->_truePeakLimiter, limiterLeft, limiterRight, framesToProcess);
+            packet->limiterActive = HugTruePeakLimiterIsActive(self->_truePeakLimiter);
+
+        } else {
+            HugLimiterProcess(self->_limiter, limiterLeft, limiterRight, framesToProcess);
+            packet->limiterActive = HugLimiterIsActive(self->_limiter);
+        }
+
+        offset += framesToProcess;
+    }
+}
+
+
+#pragma mark - Public Methods
+
+void HugRenderChainConfigure(HugRenderChain *self, double sampleRate, size_t maxFrameCount)
+{
+    size_t meterFrameCount = MIN(maxFrameCount, sMaxMeterFrameCount);
+    size_t packetCapacity  = meterFrameCount ? ((maxFrameCount + meterFrameCount - 1) / meterFrameCount) : 0;
+
+    self->_sampleRate      = sampleRate;
+    self->_maxFrameCount   = maxFrameCount;
+    self->_meterFrameCount = meterFrameCount;
+    self->_limiterMode     = self->_requestedLimiterMode;
+
+    HugLevelMeterSetSampleRate(self->_leftLevelMeter,  sampleRate);
+    HugLevelMeterSetSampleRate(self->_rightLevelMeter, sampleRate);
+    HugLoudnessMeterSetSampleRate(self->_loudnessMeter, sampleRate);
+    HugLimiterSetSampleRate(self->_limiter, sampleRate);
+
+    if (HugTruePeakLimiterGetSampleRate(self->_truePeakLimiter) != sampleRate) {
+        HugTruePeakLimiterSetSampleRate(self->_truePeakLimiter, sampleRate);
+    } else {
+        HugTruePeakLimiterReset(self->_truePeakLimiter);
+    }
+
+    HugLinearRamperSetMaxFrameCount(self->_preGainRamper, maxFrameCount);
+    HugLinearRamperSetMaxFrameCount(self->_volumeRamper,  maxFrameCount);
+    HugStereoFieldSetMaxFrameCount(self->_stereoField, maxFrameCount);
+
+    HugLevelMeterSetMaxFrameCount(self->_leftLevelMeter,  meterFrameCount);
+    HugLevelMeterSetMaxFrameCount(self->_rightLevelMeter, meterFrameCount);
+
+    if (packetCapacity != self->_packetCapacity) {
+        free(self->_packets);
+        self->_packets = packetCapacity ? calloc(packetCapacity, sizeof(HugRenderChainMeterPacket)) : NULL;
+        self->_packetCapacity = packetCapacity;
+    }
+
+    self->_packetCount = 0;
+}
+
+
+void HugRenderChainReset(HugRenderChain *self, const HugRenderChainParameters *parameters)
+{
+    HugLinearRamperReset(self->_preGainRamper, parameters->preGain);
+    HugLinearRamperReset(self->_volumeRamper,  parameters->volume);
+    HugStereoFieldReset(self->_stereoField, parameters->stereoBalance, parameters->stereoWidth);
+}
+
+
+void HugRenderChainResetMeters(HugRenderChain *self)
+{
+    HugLevelMeterReset(self->_leftLevelMeter);
+    HugLevelMeterReset(self->_rightLevelMeter);
+    HugLoudnessMeterReset(self->_loudnessMeter);
+}
+
+
+void HugRenderChainProcessInput(HugRenderChain *self, float *left, float *right, size_t frameCount, const HugRenderChainParameters *parameters)
+{
+    HugStereoFieldProcess(self->_stereoField, left, right, frameCount, parameters->stereoBalance, parameters->stereoWidth);
+    HugLinearRamperProcess(self->_preGainRamper, left, right, frameCount, parameters->preGain);
+}
+
+
+void HugRenderChainProcessOutput(HugRenderChain *self, float *left, float *right, size_t frameCount, const HugRenderChainParameters *parameters)
+{
+    self->_packetCount = 0;
+
+    if (frameCount > self->_maxFrameCount) {
+        frameCount = self->_maxFrameCount;
+    }
+
+    HugLinearRamperProcess(self->_volumeRamper, left, right, frameCount, parameters->volume);
+
+    sProcessMetersAndLimiter(self, left, right, frameCount);
+}
+
+
+void HugRenderChainProcessAutomatedInput(HugRenderChain *self, float *left, float *right, size_t frameCount, HugAutomation *automation)
+{
+    HugStereoFieldProcessAutomation(self->_stereoField, left, right, frameCount, automation);
+    HugLinearRamperProcessAutomation(self->_preGainRamper, left, right, frameCount, automation, HugAutomationParameterPreGain);
+}
+
+
+void HugRenderChainProcessAutomatedOutput(HugRenderChain *self, float *left, float *right, size_t frameCount, HugAutomation *automation)
+{
+    self->_packetCount = 0;
+
+    if (frameCount > self->_maxFrameCount) {
+        frameCount = self->_maxFrameCount;
+    }
+
+    HugLinearRamperProcessAutomation(self->_volumeRamper, left, right, frameCount, automation, HugAutomationParameterVolume);
+
+    sProcessMetersAndLimiter(self, left, right, frameCount);
+}
+
+
+#pragma mark - Accessors
+
+void HugRenderChainSetLimiterMode(HugRenderChain *self, HugRenderChainLimiterMode mode)
+{
+    self->_requestedLimiterMode = mode;
+}
+
+
+HugRenderChainLimiterMode HugRenderChainGetLimiterMode(const HugRenderChain *self)
+{
+    return self->_requestedLimiterMode;
+}
+
+
+size_t HugRenderChainGetMeterPacketCount(const HugRenderChain *self)
+{
+    return self->_packetCount;
+}
+
+
+const HugRenderChainMeterPacket *HugRenderChainGetMeterPackets(const HugRenderChain *self)
+{
+    return self->_packets;
+}
+
+
+double HugRenderChainGetSampleRate(const HugRenderChain *self)
+{
+    return self->_sampleRate;
+}
+
+
+size_t HugRenderChainGetMaxFrameCount(const HugRenderChain *self)
+{
+    return self->_maxFrameCount;
+}
+
+
+size_t HugRenderChainGetMeterFrameCount(const HugRenderChain *self)
+{
+    return self->_meterFrameCount;
+}
+
+
+size_t HugRenderChainGetLatency(const HugRenderChain *self)
+{
+    if (self->_limiterMode == HugRenderChainLimiterModeTruePeak) {
+        return HugTruePeakLimiterGetLatency(self->_truePeakLimiter);
+    }
+
+    return 0;
+}
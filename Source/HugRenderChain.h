@@ -0,0 +1,81 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+#include "HugAutomation.h"
+
+// The fixed parts of the playback chain, shared by HugAudioEngine and
+// HugOfflineRenderer:
+//
+//   input:  HugStereoField -> pre-gain HugLinearRamper
+//   (effects run here)
+//   output: volume HugLinearRamper -> HugLevelMeter (L/R), HugLoudnessMeter -> limiter
+//
+// The limiter is either HugLimiter (the default, no latency) or
+// HugTruePeakLimiter, which delays output by HugRenderChainGetLatency().
+//
+// HugRenderChainProcessOutput() splits the buffer into meter-sized slices
+// and records one HugRenderChainMeterPacket per slice. Packet storage is
+// owned by the chain and valid until the next call. No allocation happens
+// during processing.
+
+typedef struct HugRenderChain HugRenderChain;
+
+typedef enum {
+    HugRenderChainLimiterModeEmergency = 0,
+    HugRenderChainLimiterModeTruePeak  = 1
+} HugRenderChainLimiterMode;
+
+typedef struct HugRenderChainParameters {
+    float stereoWidth;
+    float stereoBalance;
+    float preGain;
+    float volume;
+} HugRenderChainParameters;
+
+typedef struct HugRenderChainMeterPacket {
+    size_t frameOffset;
+    size_t frameCount;
+    float  leftPeakLevel;
+    float  leftHeldLevel;
+    float  rightPeakLevel;
+    float  rightHeldLevel;
+    float  momentaryLoudness;
+    float  shortTermLoudness;
+    float  correlation;
+    BOOL   limiterActive;
+} HugRenderChainMeterPacket;
+
+extern HugRenderChain *HugRenderChainCreate(void);
+extern void HugRenderChainFree(HugRenderChain *chain);
+
+// Not real-time safe. Resets all state.
+extern void HugRenderChainConfigure(HugRenderChain *chain, double sampleRate, size_t maxFrameCount);
+
+// Not real-time safe. Takes effect at the next HugRenderChainConfigure().
+extern void HugRenderChainSetLimiterMode(HugRenderChain *chain, HugRenderChainLimiterMode mode);
+extern HugRenderChainLimiterMode HugRenderChainGetLimiterMode(const HugRenderChain *chain);
+
+// Jumps ramps and stereo field to parameters without interpolation
+extern void HugRenderChainReset(HugRenderChain *chain, const HugRenderChainParameters *parameters);
+extern void HugRenderChainResetMeters(HugRenderChain *chain);
+
+extern void HugRenderChainProcessInput( HugRenderChain *chain, float *left, float *right, size_t frameCount, const HugRenderChainParameters *parameters);
+extern void HugRenderChainProcessOutput(HugRenderChain *chain, float *left, float *right, size_t frameCount, const HugRenderChainParameters *parameters);
+
+// Same as above, with sample-accurate parameters read from automation. The
+// caller starts each render cycle with HugAutomationBeginBuffer().
+extern void HugRenderChainProcessAutomatedInput( HugRenderChain *chain, float *left, float *right, size_t frameCount, HugAutomation *automation);
+extern void HugRenderChainProcessAutomatedOutput(HugRenderChain *chain, float *left, float *right, size_t frameCount, HugAutomation *automation);
+
+extern size_t HugRenderChainGetMeterPacketCount(const HugRenderChain *chain);
+extern const HugRenderChainMeterPacket *HugRenderChainGetMeterPackets(const HugRenderChain *chain);
+
+extern double HugRenderChainGetSampleRate(const HugRenderChain *chain);
+extern size_t HugRenderChainGetMaxFrameCount(const HugRenderChain *chain);
+extern size_t HugRenderChainGetMeterFrameCount(const HugRenderChain *chain);
+
+// Frames of delay between the meters and the output of the chain
+extern size_t HugRenderChainGetLatency(const HugRenderChain *chain);
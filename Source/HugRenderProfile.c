@@ -0,0 +1,174 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugRenderProfile.h"
+
+#include <stdatomic.h>
+
+enum {
+    sBinsPerOctave = 4,
+    sMinimumOctave = -16,
+    sMaximumOctave = 4,
+
+    // Bin 0 holds everything at or below 2^sMinimumOctave
+    sBinCount = 1 + ((sMaximumOctave - sMinimumOctave) * sBinsPerOctave)
+};
+
+// Only written by the producer, so updates are plain loads and stores
+typedef struct {
+    _Atomic(UInt64) bins[sBinCount];
+    _Atomic(double) maximum;
+} HugRenderProfileNode;
+
+struct HugRenderProfile {
+    size_t _nodeCount;
+    HugRenderProfileNode *_nodes;
+
+    // Consumer increments _resetRequest, producer copies it into
+    // _resetCount after clearing every node
+    atomic_uint _resetRequest;
+    atomic_uint _resetCount;
+};
+
+
+#pragma mark - Private Functions
+
+static size_t sGetBin(double load)
+{
+    if (!(load > 0)) return 0;
+
+    double position = (log2(load) - sMinimumOctave) * sBinsPerOctave;
+    if (position <= 0) return 0;
+
+    size_t bin = 1 + (size_t)position;
+    return MIN(bin, sBinCount - 1);
+}
+
+
+static double sGetUpperEdge(size_t bin)
+{
+    return exp2(((double)bin / sBinsPerOctave) + sMinimumOctave);
+}
+
+
+static double sGetPercentile(const UInt64 *bins, UInt64 count, double maximum, double percentile)
+{
+    if (!count) return 0;
+
+    UInt64 target = (UInt64)ceil(count * percentile);
+    UInt64 sum = 0;
+
+    for (size_t bin = 0; bin < sBinCount; bin++) {
+        sum += bins[bin];
+        if (sum >= target) return MIN(sGetUpperEdge(bin), maximum);
+    }
+
+    return maximum;
+}
+
+
+static void sClearNodes(HugRenderProfile *self)
+{
+    for (size_t i = 0; i < self->_nodeCount; i++) {
+        HugRenderProfileNode *n = &self->_nodes[i];
+
+        for (size_t bin = 0; bin < sBinCount; bin++) {
+            atomic_store_explicit(&n->bins[bin], 0, memory_order_relaxed);
+        }
+
+        atomic_store_explicit(&n->maximum, 0, memory_order_relaxed);
+    }
+}
+
+
+#pragma mark - Public Functions
+
+HugRenderProfile *HugRenderProfileCreate(size_t nodeCount)
+{
+    HugRenderProfile *self = calloc(1, sizeof(HugRenderProfile));
+
+    self->_nodeCount = nodeCount;
+    self->_nodes = calloc(MAX(nodeCount, 1), sizeof(HugRenderProfileNode));
+
+    return self;
+}
+
+
+void HugRenderProfileFree(HugRenderProfile *self)
+{
+    if (!self) return;
+
+    free(self->_nodes);
+    free(self);
+}
+
+
+void HugRenderProfileReset(HugRenderProfile *self)
+{
+    atomic_fetch_add_explicit(&self->_resetRequest, 1, memory_order_relaxed);
+}
+
+
+size_t HugRenderProfileGetNodeCount(const HugRenderProfile *self)
+{
+    return self->_nodeCount;
+}
+
+
+void HugRenderProfileAddSamples(HugRenderProfile *self, const double *loads, size_t loadCount)
+{
+    unsigned int request = atomic_load_explicit(&self->_resetRequest, memory_order_relaxed);
+
+    if (request != atomic_load_explicit(&self->_resetCount, memory_order_relaxed)) {
+        sClearNodes(self);
+        atomic_store_explicit(&self->_resetCount, request, memory_order_release);
+    }
+
+    size_t count = MIN(loadCount, self->_nodeCount);
+
+    for (size_t i = 0; i < count; i++) {
+        HugRenderProfileNode *n = &self->_nodes[i];
+        double load = loads[i];
+
+        _Atomic(UInt64) *bin = &n->bins[sGetBin(load)];
+        atomic_store_explicit(bin, atomic_load_explicit(bin, memory_order_relaxed) + 1, memory_order_relaxed);
+
+        if (load > atomic_load_explicit(&n->maximum, memory_order_relaxed)) {
+            atomic_store_explicit(&n->maximum, load, memory_order_relaxed);
+        }
+    }
+}
+
+
+HugRenderProfileStatistics HugRenderProfileGetStatistics(const HugRenderProfile *self, size_t node)
+{
+    HugRenderProfileStatistics result = { 0, 0, 0, 0 };
+    if (node >= self->_nodeCount) return result;
+
+    const HugRenderProfileNode *n = &self->_nodes[node];
+
+    unsigned int resetCount = atomic_load_explicit(&self->_resetCount, memory_order_acquire);
+    if (resetCount != atomic_load_explicit(&self->_resetRequest, memory_order_relaxed)) return result;
+
+    // Bins may advance while being copied, which only skews the snapshot by
+    // a callback. A reset during the copy discards it.
+    UInt64 bins[sBinCount];
+    UInt64 count = 0;
+
+    for (size_t bin = 0; bin < sBinCount; bin++) {
+        bins[bin] = atomic_load_explicit(&n->bins[bin], memory_order_relaxed);
+        count += bins[bin];
+    }
+
+    double maximum = atomic_load_explicit(&n->maximum, memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    if (resetCount != atomic_load_explicit(&self->_resetCount, memory_order_relaxed)) return result;
+
+    result.count   = (size_t)count;
+    result.median  = sGetPercentile(bins, count, maximum, 0.50);
+    result.p99     = sGetPercentile(bins, count, maximum, 0.99);
+    result.maximum = maximum;
+
+    return result;
+}
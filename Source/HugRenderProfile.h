@@ -0,0 +1,43 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Histograms of render time per node, filled on the render thread and
+// read on the UI side.
+//
+// Each sample is a node's render time as a fraction of the callback's
+// deadline (its buffer duration), so 1.0 is an overload on its own.
+// Bins are a quarter octave wide, from 2^-16 to 2^4, which bounds the
+// error of a percentile to 19%. The maximum is exact.
+//
+// Every callback is counted: bins are only written by the render thread
+// and read with relaxed atomics, so nothing is dropped or coalesced on
+// the way to the UI.
+
+typedef struct HugRenderProfile HugRenderProfile;
+
+typedef struct {
+    size_t count;
+    double median;
+    double p99;
+    double maximum;
+} HugRenderProfileStatistics;
+
+extern HugRenderProfile *HugRenderProfileCreate(size_t nodeCount);
+extern void HugRenderProfileFree(HugRenderProfile *profile);
+
+// Consumer. Requests a reset, which the producer performs before its next
+// samples. Statistics read as empty until then.
+extern void HugRenderProfileReset(HugRenderProfile *profile);
+
+extern size_t HugRenderProfileGetNodeCount(const HugRenderProfile *profile);
+
+// Producer. Adds one sample per node for a single callback, starting at
+// node 0. Samples for nodes outside of nodeCount are ignored.
+extern void HugRenderProfileAddSamples(HugRenderProfile *profile, const double *loads, size_t loadCount);
+
+// Consumer. Percentiles are the upper edge of their bin
+extern HugRenderProfileStatistics HugRenderProfileGetStatistics(const HugRenderProfile *profile, size_t node);
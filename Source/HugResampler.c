@@ -0,0 +1,597 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+// clock_gettime() and CLOCK_MONOTONIC for the benchmark
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "HugResampler.h"
+#include "HugKernels.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+static const double sPi = 3.14159265358979323846;
+
+typedef struct {
+    size_t tapCount;
+    double beta;     // Kaiser window
+    double passband; // Fraction of the lower Nyquist frequency
+} HugResamplerTier;
+
+static const HugResamplerTier sTiers[] = {
+    { 16, 5.0, 0.85 },
+    { 32, 7.0, 0.91 },
+    { 64, 9.0, 0.95 }
+};
+
+
+struct HugResampler {
+    UInt32 _channelCount;
+
+    // outputRate / inputRate = _L / _M
+    UInt64 _L;
+    UInt64 _M;
+
+    size_t _tapCount;
+    float *_coefficients; // _L phases of _tapCount coefficients
+
+    // Input not yet consumed, per channel. _buffers[c][0] is the first tap of
+    // the next output frame, and _phase is its fractional position, in 1 / _L.
+    float **_buffers;
+    size_t  _capacity;
+    size_t  _count;
+    UInt64  _phase;
+};
+
+
+#pragma mark - Private Functions
+
+static UInt64 sGreatestCommonDivisor(UInt64 a, UInt64 b)
+{
+    while (b) {
+        UInt64 t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+
+// Zeroth-order modified Bessel function of the first kind
+static double sBesselI0(double x)
+{
+    double sum  = 1.0;
+    double term = 1.0;
+
+    for (NSInteger k = 1; k < 64; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+
+        if (term < (sum * 1e-12)) break;
+    }
+
+    return sum;
+}
+
+
+static void sFillCoefficients(HugResampler *self, const HugResamplerTier *tier)
+{
+    const size_t L = self->_L;
+    const size_t tapCount = self->_tapCount;
+
+    const double halfLength = tapCount / 2.0;
+    const double betaI0     = sBesselI0(tier->beta);
+
+    // Cutoff in cycles per input frame
+    double cutoff = 0.5 * tier->passband;
+    if (self->_L < self->_M) cutoff *= (double)self->_L / self->_M;
+
+    for (size_t phase = 0; phase < L; phase++) {
+        float *coefficients = self->_coefficients + (phase * tapCount);
+        double sum = 0;
+
+        for (size_t tap = 0; tap < tapCount; tap++) {
+            // Distance from the output position to this tap, in input frames
+            double x = ((double)phase / L) + (halfLength - 1) - tap;
+
+            double sinc = (x == 0) ? 1.0 : sin(2.0 * sPi * cutoff * x) / (2.0 * sPi * cutoff * x);
+
+            double r = x / halfLength;
+            double window = (fabs(r) < 1.0) ? sBesselI0(tier->beta * sqrt(1.0 - (r * r))) / betaI0 : 0.0;
+
+            double value = 2.0 * cutoff * sinc * window;
+
+            coefficients[tap] = value;
+            sum += value;
+        }
+
+        // Unity gain at DC for every phase
+        for (size_t tap = 0; tap < tapCount; tap++) {
+            coefficients[tap] /= sum;
+        }
+    }
+}
+
+
+#pragma mark - Public Functions
+
+HugResampler *HugResamplerCreate(double inputRate, double outputRate, UInt32 channelCount, HugResamplerQuality quality, size_t maxInputFrameCount)
+{
+    if (inputRate <= 0 || outputRate <= 0 || channelCount == 0) return NULL;
+    if (inputRate != floor(inputRate) || outputRate != floor(outputRate)) return NULL;
+    if (quality > HugResamplerQualityHigh) quality = HugResamplerQualityHigh;
+
+    UInt64 gcd = sGreatestCommonDivisor(inputRate, outputRate);
+    UInt64 L = (UInt64)outputRate / gcd;
+    UInt64 M = (UInt64)inputRate  / gcd;
+
+    const HugResamplerTier *tier = &sTiers[quality];
+
+    // Each output must advance by less than its taps, see HugResamplerProcess()
+    if (L > HugResamplerMaximumPhaseCount || M >= (L * tier->tapCount)) return NULL;
+
+    HugResampler *self = calloc(1, sizeof(HugResampler));
+
+    self->_channelCount = channelCount;
+    self->_L = L;
+    self->_M = M;
+    self->_tapCount = tier->tapCount;
+
+    // Leftover input is less than one output's taps plus its advance
+    self->_capacity = maxInputFrameCount + self->_tapCount + (M / L) + 1;
+
+    self->_coefficients = malloc(L * self->_tapCount * sizeof(float));
+    self->_buffers = calloc(channelCount, sizeof(float *));
+
+    for (UInt32 c = 0; c < channelCount; c++) {
+        self->_buffers[c] = calloc(self->_capacity, sizeof(float));
+    }
+
+    sFillCoefficients(self, tier);
+    HugResamplerReset(self);
+
+    return self;
+}
+
+
+void HugResamplerFree(HugResampler *self)
+{
+    if (!self) return;
+
+    for (UInt32 c = 0; c < self->_channelCount; c++) {
+        free(self->_buffers[c]);
+    }
+
+    free(self->_buffers);
+    free(self->_coefficients);
+    free(self);
+}
+
+
+void HugResamplerReset(HugResampler *self)
+{
+    // Silence before the first input frame, so that output frame 0 is
+    // centered on input frame 0
+    self->_count = (self->_tapCount / 2) - 1;
+    self->_phase = 0;
+
+    for (UInt32 c = 0; c < self->_channelCount; c++) {
+        memset(self->_buffers[c], 0, self->_count * sizeof(float));
+    }
+}
+
+
+size_t HugResamplerGetTapCount(const HugResampler *self)
+{
+    return self->_tapCount;
+}
+
+
+size_t HugResamplerGetInputFrameCount(const HugResampler *self, size_t outputFrameCount)
+{
+    if (outputFrameCount == 0) return 0;
+
+    size_t lastOffset = (self->_phase + ((outputFrameCount - 1) * self->_M)) / self->_L;
+    size_t needed = lastOffset + self->_tapCount;
+
+    return (needed > self->_count) ? (needed - self->_count) : 0;
+}
+
+
+size_t HugResamplerGetOutputFrameCount(const HugResampler *self, size_t inputFrameCount)
+{
+    size_t total = self->_count + inputFrameCount;
+    if (total < self->_tapCount) return 0;
+
+    // Output j is possible while (_phase + j * _M) / _L + _tapCount <= total
+    UInt64 limit = ((total - self->_tapCount + 1) * self->_L) - 1;
+    if (limit < self->_phase) return 0;
+
+    return ((limit - self->_phase) / self->_M) + 1;
+}
+
+
+size_t HugResamplerGetOutputLength(const HugResampler *self, size_t inputLength)
+{
+    return ((inputLength * self->_L) + self->_M - 1) / self->_M;
+}
+
+
+size_t HugResamplerProcess(
+    HugResampler *self,
+    const float * const *input, size_t *ioInputFrameCount,
+    float * const *output, size_t outputFrameCount
+) {
+    const UInt32 channelCount = self->_channelCount;
+    const size_t tapCount = self->_tapCount;
+    const UInt64 L = self->_L;
+    const UInt64 M = self->_M;
+
+    size_t inputFrameCount = *ioInputFrameCount;
+
+    if (inputFrameCount > (self->_capacity - self->_count)) {
+        inputFrameCount = self->_capacity - self->_count;
+    }
+
+    *ioInputFrameCount = inputFrameCount;
+
+    for (UInt32 c = 0; c < channelCount; c++) {
+        memcpy(self->_buffers[c] + self->_count, input[c], inputFrameCount * sizeof(float));
+    }
+
+    size_t count  = self->_count + inputFrameCount;
+    size_t offset = 0;
+    UInt64 phase  = self->_phase;
+    size_t written = 0;
+
+    float (*dotProduct)(const float *, const float *, size_t) = HugKernels.dotProduct;
+
+    while ((written < outputFrameCount) && ((offset + tapCount) <= count)) {
+        const float *coefficients = self->_coefficients + (phase * tapCount);
+
+        for (UInt32 c = 0; c < channelCount; c++) {
+            output[c][written] = dotProduct(self->_buffers[c] + offset, coefficients, tapCount);
+        }
+
+        written++;
+
+        phase  += M;
+        offset += phase / L;
+        phase  %= L;
+    }
+
+    for (UInt32 c = 0; c < channelCount; c++) {
+        memmove(self->_buffers[c], self->_buffers[c] + offset, (count - offset) * sizeof(float));
+    }
+
+    self->_count = count - offset;
+    self->_phase = phase;
+
+    return written;
+}
+
+
+#pragma mark - Benchmark
+
+enum {
+    sBenchmarkChannelCount = 2,
+    sBenchmarkChunkFrames  = 512,   // Output frames per call, as in the render callback
+    sBenchmarkSlackFrames  = 256    // Covers the taps and rounding in HugResamplerGetInputFrameCount()
+};
+
+static const double sBenchmarkSineFrequency = 997.0;
+static const double sBenchmarkDuration      = 2.0;
+static const double sBenchmarkCostDuration  = 4.0;
+
+// Passband frequencies, as fractions of the cutoff
+static const double sBenchmarkPassbandPoints[] = { 0.01, 0.1, 0.2, 0.4, 0.6, 0.8 };
+
+// Chunk sizes which must produce exactly the same output as sBenchmarkChunkFrames
+static const size_t sBenchmarkContinuityChunks[] = { 1, 7, 64, 333, 4096 };
+
+
+static uint64_t sGetNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+
+static float **sCreateChannels(size_t frameCount)
+{
+    float **channels = calloc(sBenchmarkChannelCount, sizeof(float *));
+
+    for (UInt32 c = 0; c < sBenchmarkChannelCount; c++) {
+        channels[c] = calloc(frameCount, sizeof(float));
+    }
+
+    return channels;
+}
+
+
+static void sFreeChannels(float **channels)
+{
+    for (UInt32 c = 0; c < sBenchmarkChannelCount; c++) {
+        free(channels[c]);
+    }
+
+    free(channels);
+}
+
+
+// Fills both channels with a sine, the second a quarter cycle ahead
+static void sFillSine(float **channels, size_t frameCount, double frequency, double sampleRate)
+{
+    for (size_t i = 0; i < frameCount; i++) {
+        double t = (2.0 * sPi * frequency * i) / sampleRate;
+
+        channels[0][i] = 0.5 * sin(t);
+        channels[1][i] = 0.5 * cos(t);
+    }
+}
+
+
+// Resamples inputLength frames into outputLength frames, chunkFrames output
+// frames at a time. input must have sBenchmarkSlackFrames + the largest
+// input chunk of silence after inputLength. Returns NO if input was dropped.
+//
+static BOOL sResample(
+    double inputRate, double outputRate, HugResamplerQuality quality,
+    float **input, float **output, size_t outputLength, size_t chunkFrames,
+    uint64_t *outNanoseconds
+) {
+    size_t maxInputFrameCount = (size_t)ceil(chunkFrames * inputRate / outputRate) + sBenchmarkSlackFrames;
+
+    HugResampler *resampler = HugResamplerCreate(inputRate, outputRate, sBenchmarkChannelCount, quality, maxInputFrameCount);
+    if (!resampler) return NO;
+
+    const float *inputs[sBenchmarkChannelCount];
+    float *outputs[sBenchmarkChannelCount];
+
+    size_t inputPosition = 0;
+    size_t written = 0;
+    BOOL ok = YES;
+
+    uint64_t start = sGetNanoseconds();
+
+    while (ok && (written < outputLength)) {
+        size_t outputFrames = MIN(chunkFrames, outputLength - written);
+        size_t inputFrames  = HugResamplerGetInputFrameCount(resampler, outputFrames);
+
+        for (UInt32 c = 0; c < sBenchmarkChannelCount; c++) {
+            inputs[c]  = input[c] + inputPosition;
+            outputs[c] = output[c] + written;
+        }
+
+        size_t inputUsed = inputFrames;
+        size_t processed = HugResamplerProcess(resampler, inputs, &inputUsed, outputs, outputFrames);
+
+        ok = (inputUsed == inputFrames) && (processed == outputFrames);
+
+        inputPosition += inputFrames;
+        written += processed;
+    }
+
+    if (outNanoseconds) *outNanoseconds = sGetNanoseconds() - start;
+
+    HugResamplerFree(resampler);
+
+    return ok;
+}
+
+
+// Least-squares amplitude of a sine at frequency in output[0][from..to)
+static double sMeasureGain(float **output, size_t from, size_t to, double frequency, double sampleRate)
+{
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+
+    for (size_t i = from; i < to; i++) {
+        double t = (2.0 * sPi * frequency * i) / sampleRate;
+        double s = sin(t), c = cos(t), y = output[0][i];
+
+        ss += s * s;  cc += c * c;  sc += s * c;
+        ys += y * s;  yc += y * c;
+    }
+
+    double determinant = (ss * cc) - (sc * sc);
+    double a = ((ys * cc) - (yc * sc)) / determinant;
+    double b = ((yc * ss) - (ys * sc)) / determinant;
+
+    return sqrt((a * a) + (b * b)) / 0.5;
+}
+
+
+BOOL HugResamplerRunBenchmark(double inputRate, double outputRate, HugResamplerQuality quality, HugResamplerBenchmarkResult *outResult)
+{
+    HugResampler *probe = HugResamplerCreate(inputRate, outputRate, 1, quality, 1);
+    if (!probe) return NO;
+
+    size_t tapCount = HugResamplerGetTapCount(probe);
+    HugResamplerFree(probe);
+
+    size_t inputLength  = (size_t)(inputRate * sBenchmarkCostDuration);
+    size_t outputLength = (size_t)floor(inputLength * outputRate / inputRate);
+    size_t paddedLength = inputLength + (size_t)ceil(4096 * inputRate / outputRate) + (2 * sBenchmarkSlackFrames);
+
+    // Output frames within this distance of either end see the zero padding
+    size_t edge = (size_t)ceil(tapCount * MAX(1.0, outputRate / inputRate));
+
+    float **input    = sCreateChannels(paddedLength);
+    float **output   = sCreateChannels(outputLength);
+    float **expected = sCreateChannels(outputLength);
+
+    HugResamplerBenchmarkResult result = {0};
+    BOOL ok = YES;
+
+    // Cost, and the reference output for the continuity check
+    {
+        sFillSine(input, inputLength, sBenchmarkSineFrequency, inputRate);
+
+        uint64_t nanoseconds = 0;
+        ok = sResample(inputRate, outputRate, quality, input, expected, outputLength, sBenchmarkChunkFrames, &nanoseconds);
+
+        result.nanosecondsPerFrame = (double)nanoseconds / outputLength;
+    }
+
+    // SNR against an ideal sine at the output rate. Any error in time
+    // alignment shows up here as a phase error.
+    //
+    if (ok) {
+        size_t length = (size_t)(outputRate * sBenchmarkDuration);
+        double signal = 0, noise = 0;
+
+        for (size_t i = edge; i < length; i++) {
+            double t = (2.0 * sPi * sBenchmarkSineFrequency * i) / outputRate;
+
+            for (UInt32 c = 0; c < sBenchmarkChannelCount; c++) {
+                double ideal = (c == 0) ? (0.5 * sin(t)) : (0.5 * cos(t));
+                double error = expected[c][i] - ideal;
+
+                signal += ideal * ideal;
+                noise  += error * error;
+            }
+        }
+
+        result.snr = 10.0 * log10(signal / MAX(noise, 1e-30));
+    }
+
+    // Output must not depend on how calls are chunked
+    result.isContinuous = ok;
+
+    for (size_t i = 0; ok && i < sizeof(sBenchmarkContinuityChunks) / sizeof(sBenchmarkContinuityChunks[0]); i++) {
+        ok = sResample(inputRate, outputRate, quality, input, output, outputLength, sBenchmarkContinuityChunks[i], NULL);
+
+        for (UInt32 c = 0; ok && c < sBenchmarkChannelCount; c++) {
+            if (memcmp(output[c], expected[c], outputLength * sizeof(float)) != 0) {
+                result.isContinuous = NO;
+            }
+        }
+    }
+
+    // Gain across the passband
+    double lowerRate = MIN(inputRate, outputRate);
+    double cutoff = 0.5 * sTiers[quality].passband * lowerRate;
+
+    for (size_t i = 0; ok && i < sizeof(sBenchmarkPassbandPoints) / sizeof(sBenchmarkPassbandPoints[0]); i++) {
+        double frequency = sBenchmarkPassbandPoints[i] * cutoff;
+        size_t length = (size_t)(outputRate * sBenchmarkDuration);
+
+        sFillSine(input, inputLength, frequency, inputRate);
+        ok = sResample(inputRate, outputRate, quality, input, output, length, sBenchmarkChunkFrames, NULL);
+
+        double deviation = fabs(20.0 * log10(sMeasureGain(output, edge, length - edge, frequency, outputRate)));
+        if (deviation > result.passbandDeviation) result.passbandDeviation = deviation;
+    }
+
+    // An impulse at input frame M * k must peak at output frame L * k
+    if (ok) {
+        UInt64 gcd = sGreatestCommonDivisor(inputRate, outputRate);
+        UInt64 L = (UInt64)outputRate / gcd;
+        UInt64 M = (UInt64)inputRate  / gcd;
+
+        UInt64 k = 1;
+        while ((M * k) < (inputLength / 4) && (L * k) < (outputLength / 4)) k *= 2;
+
+        for (UInt32 c = 0; c < sBenchmarkChannelCount; c++) {
+            memset(input[c], 0, paddedLength * sizeof(float));
+            input[c][M * k] = 1.0f;
+        }
+
+        ok = sResample(inputRate, outputRate, quality, input, output, outputLength, sBenchmarkChunkFrames, NULL);
+
+        size_t peakIndex = 0;
+
+        for (size_t i = 0; i < outputLength; i++) {
+            if (fabsf(output[0][i]) > fabsf(output[0][peakIndex])) peakIndex = i;
+        }
+
+        result.isAligned = ok && (peakIndex == (L * k));
+    }
+
+    sFreeChannels(input);
+    sFreeChannels(output);
+    sFreeChannels(expected);
+
+    if (ok) *outResult = result;
+
+    return ok;
+}
+
+
+#pragma mark - Command Line
+
+#if HUG_RESAMPLER_MAIN
+
+static const char *sQualityNames[] = { "Low", "Medium", "High" };
+
+// Measured results, by quality. A run fails if its SNR drops by more than
+// sAllowedSNRLoss or its passband deviation grows by more than 10%.
+//
+typedef struct {
+    double inputRate;
+    double outputRate;
+    double snr[3];
+    double passbandDeviation[3];
+} HugResamplerBenchmarkExpected;
+
+static const HugResamplerBenchmarkExpected sExpected[] = {
+    {  44100,  48000, { 65.9, 81.0, 102.0 }, { 0.1553, 0.0015, 0.0001 } },
+    {  48000,  44100, { 60.9, 77.6, 101.7 }, { 0.2471, 0.0010, 0.0001 } },
+    {  44100,  96000, { 65.9, 81.2, 102.0 }, { 0.1553, 0.0015, 0.0001 } },
+    {  96000,  44100, { 69.6, 82.9,  99.6 }, { 1.8600, 0.4492, 0.0010 } },
+    { 192000,  48000, { 59.8, 81.3,  94.3 }, { 3.3816, 1.8907, 0.4592 } },
+    {  22050,  44100, { 54.5, 75.0,  94.0 }, { 0.1482, 0.0018, 0.0002 } }
+};
+
+static const double sAllowedSNRLoss = 1.0;
+
+
+int main(void)
+{
+    int failureCount = 0;
+
+    printf("Level   Rates              Quality      SNR     Passband     Cost   Aligned  Continuous\n");
+
+    for (HugKernelLevel level = HugKernelLevelScalar; level <= HugKernelLevelNEON; level++) {
+        if (!HugKernelsSetLevel(level)) continue;
+
+        for (size_t i = 0; i < sizeof(sExpected) / sizeof(sExpected[0]); i++) {
+            const HugResamplerBenchmarkExpected *expected = &sExpected[i];
+
+            for (HugResamplerQuality quality = HugResamplerQualityLow; quality <= HugResamplerQualityHigh; quality++) {
+                HugResamplerBenchmarkResult result;
+
+                if (!HugResamplerRunBenchmark(expected->inputRate, expected->outputRate, quality, &result)) {
+                    printf("%-6s  %6.0f -> %6.0f   %-8s  failed to run\n", HugKernelsGetLevelName(level), expected->inputRate, expected->outputRate, sQualityNames[quality]);
+                    failureCount++;
+                    continue;
+                }
+
+                BOOL passed = result.isAligned && result.isContinuous &&
+                    (result.snr >= (expected->snr[quality] - sAllowedSNRLoss)) &&
+                    (result.passbandDeviation <= (expected->passbandDeviation[quality] * 1.1) + 0.0001);
+
+                printf("%-6s  %6.0f -> %6.0f   %-8s  %6.1f dB  %7.4f dB  %5.1f ns  %-7s  %-10s  %s\n",
+                    HugKernelsGetLevelName(level), expected->inputRate, expected->outputRate, sQualityNames[quality],
+                    result.snr, result.passbandDeviation, result.nanosecondsPerFrame,
+                    result.isAligned ? "yes" : "NO", result.isContinuous ? "yes" : "NO",
+                    passed ? "ok" : "FAILED"
+                );
+
+                if (!passed) failureCount++;
+            }
+        }
+    }
+
+    printf("%d failure(s)\n", failureCount);
+
+    return failureCount ? 1 : 0;
+}
+
+#endif
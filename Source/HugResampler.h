@@ -0,0 +1,96 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Polyphase windowed-sinc sample rate converter.
+//
+// The conversion ratio is reduced to outputRate / inputRate = L / M and a
+// table of L filter phases is computed at creation, so each output sample is
+// one dot product (HugKernels.dotProduct) per channel. Both rates must be
+// whole numbers with L <= HugResamplerMaximumPhaseCount, which covers all
+// standard rates between 8 kHz and 384 kHz. HugResamplerCreate() returns
+// NULL otherwise.
+//
+// Output is time-aligned with input: output frame 0 is input frame 0.
+// Each output frame needs HugResamplerGetTapCount() / 2 frames of lookahead,
+// which HugResamplerGetInputFrameCount() accounts for.
+//
+// Processing never allocates.
+
+typedef enum {
+    HugResamplerQualityLow    = 0, // 16 taps, Kaiser beta 5, 85% passband
+    HugResamplerQualityMedium = 1, // 32 taps, Kaiser beta 7, 91% passband
+    HugResamplerQualityHigh   = 2  // 64 taps, Kaiser beta 9, 95% passband
+} HugResamplerQuality;
+
+// Measured by HugResamplerRunBenchmark() with a 997 Hz sine, 44.1 to 48 kHz,
+// stereo, 512 frame buffers, on an x86-64 Xeon. Cost is per output frame:
+//
+//             SNR       Scalar    SSE2     AVX2
+//   Low       66 dB      38 ns    24 ns    25 ns
+//   Medium    81 dB      45 ns    32 ns    28 ns
+//   High     102 dB     134 ns    47 ns    37 ns
+//
+// At 48 kHz, 37 ns per frame is under 0.2% of a core.
+//
+// The tap count does not grow with the ratio, so when downsampling by 2:1 or
+// more, Low and Medium droop near the cutoff (up to 3.4 dB from 192 to 48 kHz).
+// High stays within 0.5 dB.
+//
+// To check these on Linux without Xcode, build HugResampler.c and
+// HugKernels.c with -std=c11 -O2 -DHUG_RESAMPLER_MAIN and link with -lm.
+// It runs every quality and supported kernel level over common rate pairs
+// and fails if any result regresses.
+
+enum {
+    HugResamplerMaximumPhaseCount = 1024
+};
+
+typedef struct HugResampler HugResampler;
+
+// maxInputFrameCount is the largest inputFrameCount passed to HugResamplerProcess()
+extern HugResampler *HugResamplerCreate(double inputRate, double outputRate, UInt32 channelCount, HugResamplerQuality quality, size_t maxInputFrameCount);
+extern void HugResamplerFree(HugResampler *resampler);
+
+extern void HugResamplerReset(HugResampler *resampler);
+
+extern size_t HugResamplerGetTapCount(const HugResampler *resampler);
+
+// Input frames to pass to HugResamplerProcess() to produce exactly outputFrameCount frames
+extern size_t HugResamplerGetInputFrameCount(const HugResampler *resampler, size_t outputFrameCount);
+
+// Output frames which HugResamplerProcess() can produce after appending inputFrameCount frames
+extern size_t HugResamplerGetOutputFrameCount(const HugResampler *resampler, size_t inputFrameCount);
+
+// Length of the output for an input of inputLength frames
+extern size_t HugResamplerGetOutputLength(const HugResampler *resampler, size_t inputLength);
+
+// Appends up to *ioInputFrameCount frames of input, then writes up to
+// outputFrameCount frames of output. Input which isn't consumed is kept for
+// the next call. Returns the number of frames written.
+//
+// On return, *ioInputFrameCount is the number of input frames appended. This
+// is less than requested only when more than maxInputFrameCount frames would
+// be pending, which can't happen when callers pass at most
+// HugResamplerGetInputFrameCount() frames and accept all of the output.
+//
+extern size_t HugResamplerProcess(
+    HugResampler *resampler,
+    const float * const *input, size_t *ioInputFrameCount,
+    float * const *output, size_t outputFrameCount
+);
+
+typedef struct {
+    double snr;                 // dB, 997 Hz sine against the ideal output
+    double passbandDeviation;   // dB, largest gain error up to 80% of the cutoff
+    double nanosecondsPerFrame; // Per output frame, stereo, 512 frame buffers
+    BOOL   isAligned;           // An impulse peaks on the expected output frame
+    BOOL   isContinuous;        // Output is identical for any buffer size
+} HugResamplerBenchmarkResult;
+
+// Uses the current HugKernels level. Returns NO if the rates are unsupported
+// or the resampler dropped input.
+extern BOOL HugResamplerRunBenchmark(double inputRate, double outputRate, HugResamplerQuality quality, HugResamplerBenchmarkResult *outResult);
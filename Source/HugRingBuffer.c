@@ -0,0 +1,494 @@
+// (c) 2018-2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+//
+// Based on logic presented in these articles:
+//
+// https://www.mikeash.com/pyblog/friday-qa-2012-02-03-ring-buffers-and-mirrored-memory-part-i.html
+// https://www.mikeash.com/pyblog/friday-qa-2012-02-17-ring-buffers-and-mirrored-memory-part-ii.html
+//
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "HugRingBuffer.h"
+
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+#if DEBUG
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+
+#define HUG_CACHE_LINE 64
+
+// Positions are byte counts since creation and never wrap in practice.
+// Each side also keeps its offset into the buffer to avoid a division,
+// and a cached copy of the other side's position to avoid touching the
+// other cache line until the cached value runs out.
+//
+struct HugRingBuffer {
+    UInt8 *_bytes;
+    size_t _capacity;
+    BOOL   _locked;
+
+    // Producer
+    _Alignas(HUG_CACHE_LINE) atomic_uint_fast64_t _writeIndex;
+    size_t   _writeOffset;
+    uint64_t _cachedReadIndex;
+
+    // Consumer
+    _Alignas(HUG_CACHE_LINE) atomic_uint_fast64_t _readIndex;
+    size_t   _readOffset;
+    uint64_t _cachedWriteIndex;
+};
+
+
+#pragma mark - Private Functions
+
+#if defined(__APPLE__)
+
+static UInt8 *sMapMirroredPages(size_t capacity)
+{
+    NSInteger loopGuard = 128;
+
+    while (loopGuard-- > 0) {
+        vm_address_t addr1 = 0;
+        vm_address_t addr2 = 0;
+
+        kern_return_t result = vm_allocate(mach_task_self(), &addr1, capacity * 2, VM_FLAGS_ANYWHERE);
+        if (result != ERR_SUCCESS) continue;
+
+        result = vm_deallocate(mach_task_self(), addr1 + capacity, capacity);
+        if (result != ERR_SUCCESS) {
+            vm_deallocate(mach_task_self(), addr1, capacity * 2);
+            continue;
+        }
+
+        addr2 = addr1 + capacity;
+        vm_prot_t unused1, unused2;
+
+        result = vm_remap(
+            mach_task_self(), &addr2, capacity, 0, 0,
+            mach_task_self(),  addr1,
+            0, &unused1, &unused2, VM_INHERIT_DEFAULT
+        );
+
+        if (result != ERR_SUCCESS) {
+            vm_deallocate(mach_task_self(), addr1, capacity);
+            continue;
+        }
+
+        if (addr2 != (addr1 + capacity)) {
+            vm_deallocate(mach_task_self(), addr2, capacity);
+            vm_deallocate(mach_task_self(), addr1, capacity);
+            continue;
+        }
+
+        return (UInt8 *)addr1;
+    }
+
+    return NULL;
+}
+
+
+static void sUnmapMirroredPages(UInt8 *bytes, size_t capacity)
+{
+    vm_deallocate(mach_task_self(), (vm_address_t)bytes, capacity * 2);
+}
+
+
+#elif defined(__linux__)
+
+static UInt8 *sMapMirroredPages(size_t capacity)
+{
+    int fd = memfd_create("HugRingBuffer", MFD_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    UInt8 *result = NULL;
+
+    if (ftruncate(fd, (off_t)capacity) == 0) {
+        // Reserve both halves first so nothing else can land in the gap
+        void *addr = mmap(NULL, capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (addr != MAP_FAILED) {
+            UInt8 *bytes = addr;
+
+            void *first  = mmap(bytes,            capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+            void *second = mmap(bytes + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+
+            if (first == bytes && second == bytes + capacity) {
+                result = bytes;
+            } else {
+                munmap(bytes, capacity * 2);
+            }
+        }
+    }
+
+    // The mappings keep the memory alive
+    close(fd);
+
+    return result;
+}
+
+
+static void sUnmapMirroredPages(UInt8 *bytes, size_t capacity)
+{
+    munmap(bytes, capacity * 2);
+}
+
+#else
+#error HugRingBuffer requires vm_remap() or memfd_create()
+#endif
+
+
+static size_t sGetPageSize(void)
+{
+#if defined(__APPLE__)
+    return vm_page_size;
+#else
+    long pageSize = sysconf(_SC_PAGESIZE);
+    return pageSize > 0 ? (size_t)pageSize : 4096;
+#endif
+}
+
+
+#pragma mark - Lifecycle
+
+HugRingBuffer *HugRingBufferCreate(size_t capacity)
+{
+    // Round capacity up to nearest page size
+    size_t pageSize = sGetPageSize();
+    capacity = ((MAX(capacity, 1) + pageSize - 1) / pageSize) * pageSize;
+
+    UInt8 *bytes = sMapMirroredPages(capacity);
+    if (!bytes) return NULL;
+
+    size_t size = ((sizeof(HugRingBuffer) + HUG_CACHE_LINE - 1) / HUG_CACHE_LINE) * HUG_CACHE_LINE;
+
+    HugRingBuffer *self = aligned_alloc(HUG_CACHE_LINE, size);
+    if (!self) {
+        sUnmapMirroredPages(bytes, capacity);
+        return NULL;
+    }
+
+    memset(self, 0, size);
+
+    self->_bytes = bytes;
+    self->_capacity = capacity;
+
+    atomic_init(&self->_writeIndex, 0);
+    atomic_init(&self->_readIndex,  0);
+
+    return self;
+}
+
+
+void HugRingBufferFree(HugRingBuffer *self)
+{
+    if (!self) return;
+
+    if (self->_locked) {
+        munlock(self->_bytes, self->_capacity);
+    }
+
+    sUnmapMirroredPages(self->_bytes, self->_capacity);
+    free(self);
+}
+
+
+#pragma mark - Public Functions
+
+void HugRingBufferConfirmReadAll(HugRingBuffer *self)
+{
+    if (!self) return;
+
+    uint64_t readIndex  = atomic_load_explicit(&self->_readIndex,  memory_order_relaxed);
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_acquire);
+
+    self->_cachedWriteIndex = writeIndex;
+
+    if (writeIndex != readIndex) {
+        HugRingBufferConfirmRead(self, (size_t)(writeIndex - readIndex));
+    }
+}
+
+
+void *HugRingBufferGetReadPtr(HugRingBuffer *self, size_t neededLength)
+{
+    if (!self) return NULL;
+
+    uint64_t readIndex = atomic_load_explicit(&self->_readIndex, memory_order_relaxed);
+
+    if ((self->_cachedWriteIndex - readIndex) < neededLength) {
+        self->_cachedWriteIndex = atomic_load_explicit(&self->_writeIndex, memory_order_acquire);
+
+        if ((self->_cachedWriteIndex - readIndex) < neededLength) {
+            return NULL;
+        }
+    }
+
+    return self->_bytes + self->_readOffset;
+}
+
+
+void HugRingBufferConfirmRead(HugRingBuffer *self, size_t length)
+{
+    if (!self) return;
+
+    uint64_t readIndex = atomic_load_explicit(&self->_readIndex, memory_order_relaxed);
+
+    self->_readOffset += length;
+    if (self->_readOffset >= self->_capacity) self->_readOffset -= self->_capacity;
+
+    atomic_store_explicit(&self->_readIndex, readIndex + length, memory_order_release);
+}
+
+
+BOOL HugRingBufferRead(HugRingBuffer *self, void *buffer, size_t length)
+{
+    void *readPtr = HugRingBufferGetReadPtr(self, length);
+    if (!readPtr) return NO;
+
+    memcpy(buffer, readPtr, length);
+
+    HugRingBufferConfirmRead(self, length);
+
+    return YES;
+}
+
+
+void *HugRingBufferGetWritePtr(HugRingBuffer *self, size_t neededLength)
+{
+    if (!self) return NULL;
+
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_relaxed);
+
+    if ((self->_capacity - (writeIndex - self->_cachedReadIndex)) < neededLength) {
+        self->_cachedReadIndex = atomic_load_explicit(&self->_readIndex, memory_order_acquire);
+
+        if ((self->_capacity - (writeIndex - self->_cachedReadIndex)) < neededLength) {
+            return NULL;
+        }
+    }
+
+    return self->_bytes + self->_writeOffset;
+}
+
+
+void HugRingBufferConfirmWrite(HugRingBuffer *self, size_t length)
+{
+    if (!self) return;
+
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_relaxed);
+
+    self->_writeOffset += length;
+    if (self->_writeOffset >= self->_capacity) self->_writeOffset -= self->_capacity;
+
+    atomic_store_explicit(&self->_writeIndex, writeIndex + length, memory_order_release);
+}
+
+
+BOOL HugRingBufferWrite(HugRingBuffer *self, const void *buffer, size_t length)
+{
+    void *writePtr = HugRingBufferGetWritePtr(self, length);
+    if (!writePtr) return NO;
+
+    memcpy(writePtr, buffer, length);
+
+    HugRingBufferConfirmWrite(self, length);
+
+    return YES;
+}
+
+
+size_t HugRingBufferGetCapacity(const HugRingBuffer *self)
+{
+    return self->_capacity;
+}
+
+
+// Callers load their own index first. The other side's index can only
+// advance, so the difference never underflows.
+//
+size_t HugRingBufferGetReadAvailable(const HugRingBuffer *self)
+{
+    if (!self) return 0;
+
+    HugRingBuffer *mutableSelf = (HugRingBuffer *)self;
+
+    uint64_t readIndex  = atomic_load_explicit(&mutableSelf->_readIndex,  memory_order_acquire);
+    uint64_t writeIndex = atomic_load_explicit(&mutableSelf->_writeIndex, memory_order_acquire);
+
+    return (size_t)(writeIndex - readIndex);
+}
+
+
+size_t HugRingBufferGetWriteAvailable(const HugRingBuffer *self)
+{
+    if (!self) return 0;
+
+    HugRingBuffer *mutableSelf = (HugRingBuffer *)self;
+
+    uint64_t writeIndex = atomic_load_explicit(&mutableSelf->_writeIndex, memory_order_acquire);
+    uint64_t readIndex  = atomic_load_explicit(&mutableSelf->_readIndex,  memory_order_acquire);
+
+    return self->_capacity - (size_t)(writeIndex - readIndex);
+}
+
+
+BOOL HugRingBufferLock(HugRingBuffer *self)
+{
+    if (!self) return NO;
+
+    // Both halves of the mirror map the same physical pages, only lock the first
+    if (!self->_locked) {
+        self->_locked = (mlock(self->_bytes, self->_capacity) == 0);
+    }
+
+    return self->_locked;
+}
+
+
+#pragma mark - Benchmark
+
+#if DEBUG
+
+typedef struct {
+    HugRingBuffer *buffer;
+    size_t packetSize;
+    size_t packetCount;
+    BOOL   waitForEmpty;
+} HugRingBufferBenchmarkProducer;
+
+
+static uint64_t sGetNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000ull) + (uint64_t)ts.tv_nsec;
+}
+
+
+static int sCompareDoubles(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+
+// Each packet starts with the time at which it was written
+static void *sRunProducer(void *context)
+{
+    HugRingBufferBenchmarkProducer *producer = context;
+    HugRingBuffer *buffer = producer->buffer;
+
+    UInt8 *packet = calloc(1, producer->packetSize);
+
+    for (size_t i = 0; i < producer->packetCount; i++) {
+        // When measuring latency, only one packet is in flight at a time
+        if (producer->waitForEmpty) {
+            while (HugRingBufferGetWriteAvailable(buffer) != buffer->_capacity) sched_yield();
+        }
+
+        uint64_t now = sGetNanoseconds();
+        memcpy(packet, &now, sizeof(now));
+
+        while (!HugRingBufferWrite(buffer, packet, producer->packetSize)) sched_yield();
+    }
+
+    free(packet);
+
+    return NULL;
+}
+
+
+static BOOL sRunPass(HugRingBuffer *buffer, size_t packetSize, size_t packetCount, BOOL waitForEmpty, double *latencies, double *outSeconds)
+{
+    HugRingBufferBenchmarkProducer producer = { buffer, packetSize, packetCount, waitForEmpty };
+    UInt8 *packet = calloc(1, packetSize);
+
+    uint64_t start = sGetNanoseconds();
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, sRunProducer, &producer) != 0) {
+        free(packet);
+        return NO;
+    }
+
+    for (size_t i = 0; i < packetCount; i++) {
+        while (!HugRingBufferRead(buffer, packet, packetSize)) sched_yield();
+
+        if (latencies) {
+            uint64_t written;
+            memcpy(&written, packet, sizeof(written));
+
+            latencies[i] = (sGetNanoseconds() - written) / 1e9;
+        }
+    }
+
+    *outSeconds = (sGetNanoseconds() - start) / 1e9;
+
+    pthread_join(thread, NULL);
+    free(packet);
+
+    return YES;
+}
+
+
+BOOL HugRingBufferRunBenchmark(size_t capacity, size_t packetSize, size_t packetCount, HugRingBufferBenchmarkResult *outResult)
+{
+    if (packetSize < sizeof(uint64_t) || !packetCount) return NO;
+
+    HugRingBuffer *buffer = HugRingBufferCreate(capacity);
+    if (!buffer) return NO;
+
+    if (packetSize > buffer->_capacity) {
+        HugRingBufferFree(buffer);
+        return NO;
+    }
+
+    double *latencies = calloc(packetCount, sizeof(double));
+    double throughputSeconds = 0;
+    double latencySeconds = 0;
+
+    // Throughput with the producer running flat out, then latency with one
+    // packet in flight so that queueing does not dominate
+    BOOL ok = latencies &&
+        sRunPass(buffer, packetSize, packetCount, NO,  NULL,      &throughputSeconds) &&
+        sRunPass(buffer, packetSize, packetCount, YES, latencies, &latencySeconds);
+
+    if (ok) {
+        qsort(latencies, packetCount, sizeof(double), sCompareDoubles);
+
+        HugRingBufferBenchmarkResult result;
+
+        result.packetSize       = packetSize;
+        result.packetCount      = packetCount;
+        result.bytesPerSecond   = throughputSeconds > 0 ? ((double)packetSize * packetCount) / throughputSeconds : 0;
+        result.packetsPerSecond = throughputSeconds > 0 ? packetCount / throughputSeconds : 0;
+        result.medianLatency    = latencies[packetCount / 2];
+        result.p99Latency       = latencies[MIN(packetCount - 1, (size_t)(packetCount * 0.99))];
+        result.maximumLatency   = latencies[packetCount - 1];
+
+        *outResult = result;
+    }
+
+    free(latencies);
+    HugRingBufferFree(buffer);
+
+    return ok;
+}
+
+#endif
@@ -3,30 +3,70 @@
 
 #pragma once
 
+#include "HugPlatform.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Single-producer, single-consumer byte queue.
+//
+// The backing pages are mapped twice, back to back, so any readable or
+// writable region is contiguous and can be used in place. Mirroring uses
+// vm_remap() on Apple platforms and a memfd mapped twice on Linux.
+//
+// The read and write positions live on separate cache lines. Each side
+// publishes its position with release semantics and observes the other
+// side's with acquire semantics, so data written before
+// HugRingBufferConfirmWrite() is visible after HugRingBufferGetReadPtr().
+
 typedef struct HugRingBuffer HugRingBuffer;
 
-extern HugRingBuffer *HugRingBufferCreate(CFIndex capacity);
+// capacity is rounded up to the page size
+extern HugRingBuffer *HugRingBufferCreate(size_t capacity);
 extern void HugRingBufferFree(HugRingBuffer *buffer);
 
+// Consumer
 extern void HugRingBufferConfirmReadAll(HugRingBuffer *buffer);
 
-extern void *HugRingBufferGetReadPtr(HugRingBuffer *buffer, CFIndex neededLength);
-extern void  HugRingBufferConfirmRead(HugRingBuffer *buffer, CFIndex length);
+// Consumer
+extern void *HugRingBufferGetReadPtr(HugRingBuffer *buffer, size_t neededLength);
+extern void  HugRingBufferConfirmRead(HugRingBuffer *buffer, size_t length);
+
+// Producer
+extern void *HugRingBufferGetWritePtr(HugRingBuffer *buffer, size_t neededLength);
+extern void  HugRingBufferConfirmWrite(HugRingBuffer *buffer, size_t length);
+
+extern BOOL HugRingBufferRead( HugRingBuffer *self, void *buffer, size_t length);
+extern BOOL HugRingBufferWrite(HugRingBuffer *self, const void *buffer, size_t length);
+
+extern size_t HugRingBufferGetCapacity(const HugRingBuffer *buffer);
 
-extern void *HugRingBufferGetWritePtr(HugRingBuffer *buffer, CFIndex neededLength);
-extern void  HugRingBufferConfirmWrite(HugRingBuffer *buffer, CFIndex length);
+extern size_t HugRingBufferGetReadAvailable(const HugRingBuffer *buffer);
+extern size_t HugRingBufferGetWriteAvailable(const HugRingBuffer *buffer);
 
-extern BOOL HugRingBufferRead( HugRingBuffer *self, void *buffer, CFIndex length);
-extern BOOL HugRingBufferWrite(HugRingBuffer *self, void *buffer, CFIndex length);
+// Wires the backing pages into physical memory via mlock()
+extern BOOL HugRingBufferLock(HugRingBuffer *buffer);
 
-extern CFIndex HugRingBufferGetCapacity(HugRingBuffer *buffer);
+#if DEBUG
+
+typedef struct {
+    size_t packetSize;
+    size_t packetCount;
+    double bytesPerSecond;
+    double packetsPerSecond;
+    double medianLatency; // Seconds from HugRingBufferWrite() to HugRingBufferRead()
+    double p99Latency;
+    double maximumLatency;
+} HugRingBufferBenchmarkResult;
+
+// Streams packetCount packets of packetSize bytes from a producer thread to a
+// consumer thread through a buffer of capacity bytes. Returns NO on failure.
+extern BOOL HugRingBufferRunBenchmark(size_t capacity, size_t packetSize, size_t packetCount, HugRingBufferBenchmarkResult *outResult);
+
+#endif
 
 #ifdef __cplusplus
 }
 #endif
 
-
@@ -3,17 +3,38 @@
 
 #import <AudioToolbox/AudioToolbox.h>
 
+enum {
+    // Nodes past this index are not timed
+    HugSimpleGraphMaximumNodeCount = 32
+};
+
 typedef void (^HugSimpleGraphErrorBlock)(OSStatus err, NSInteger index);
 
+// Called on the render thread after each successful render with the host time
+// spent in each node, in the order they were added. Node indices match the
+// index passed to HugSimpleGraphErrorBlock.
+//
+typedef void (^HugSimpleGraphTimingBlock)(
+    const AudioTimeStamp *timestamp,
+    AUAudioFrameCount frameCount,
+    const UInt64 *nodeTimes,
+    NSInteger nodeCount
+);
+
 @interface HugSimpleGraph : NSObject
 
 - (instancetype) initWithErrorBlock:(HugSimpleGraphErrorBlock)errorBlock;
+- (instancetype) initWithErrorBlock:(HugSimpleGraphErrorBlock)errorBlock timingBlock:(HugSimpleGraphTimingBlock)timingBlock;
 
 - (void) addBlock:(AURenderPullInputBlock)inBlock;
 - (void) addAudioUnit:(AUAudioUnit *)unit;
 
 @property (nonatomic, readonly) HugSimpleGraphErrorBlock errorBlock;
+@property (nonatomic, readonly) HugSimpleGraphTimingBlock timingBlock;
+
+@property (nonatomic, readonly) NSInteger nodeCount;
 
+// If timingBlock is set, the returned block retains the receiver
 @property (nonatomic, readonly) AURenderPullInputBlock renderBlock;
 
 @end
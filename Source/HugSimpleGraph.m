@@ -2,28 +2,61 @@
 // MIT License (or) 1-clause BSD License
 
 #include "HugSimpleGraph.h"
+#include "HugUtils.h"
 
 
 @implementation HugSimpleGraph {
     AURenderPullInputBlock _renderBlock;
     NSInteger _errorIndex;
+
+    // Host time at which each node finished, or NULL without a timingBlock.
+    // Only touched by the render thread.
+    UInt64 *_exitTimes;
+    UInt64 *_nodeTimes;
 }
 
 - (instancetype) initWithErrorBlock:(HugSimpleGraphErrorBlock)errorBlock
+{
+    return [self initWithErrorBlock:errorBlock timingBlock:nil];
+}
+
+
+- (instancetype) initWithErrorBlock:(HugSimpleGraphErrorBlock)errorBlock timingBlock:(HugSimpleGraphTimingBlock)timingBlock
 {
     if ((self = [super init])) {
-        _errorBlock = errorBlock;
+        _errorBlock  = errorBlock;
+        _timingBlock = timingBlock;
+
+        if (timingBlock) {
+            _exitTimes = calloc(HugSimpleGraphMaximumNodeCount, sizeof(UInt64));
+            _nodeTimes = calloc(HugSimpleGraphMaximumNodeCount, sizeof(UInt64));
+        }
     }
 
     return self;
 }
 
 
+- (void) dealloc
+{
+    free(_exitTimes);
+    free(_nodeTimes);
+}
+
+
+- (UInt64 *) _exitTimeForIndex:(NSInteger)index
+{
+    return (_exitTimes && index < HugSimpleGraphMaximumNodeCount) ? &_exitTimes[index] : NULL;
+}
+
+
 - (void) addBlock:(AURenderPullInputBlock)inBlock
 {
     HugSimpleGraphErrorBlock errorBlock = _errorBlock;
     __block NSInteger errorIndex = _errorIndex++;
 
+    UInt64 *exitTime = [self _exitTimeForIndex:errorIndex];
+
     AURenderPullInputBlock previousBlock = _renderBlock;
     
     _renderBlock = [^(
@@ -41,6 +74,8 @@
         OSStatus err = inBlock(actionFlags, timestamp, frameCount, inputBusNumber, inputData);
         if (err) errorBlock(err, errorIndex);
 
+        if (exitTime) *exitTime = HugGetCurrentHostTime();
+
         return err;
     } copy];
 }
@@ -51,6 +86,8 @@
     HugSimpleGraphErrorBlock errorBlock = _errorBlock;
     __block NSInteger errorIndex = _errorIndex++;
 
+    UInt64 *exitTime = [self _exitTimeForIndex:errorIndex];
+
     AURenderPullInputBlock previousBlock = _renderBlock;
 
     AURenderBlock unitRenderBlock = [unit renderBlock];
@@ -65,6 +102,60 @@
         OSStatus err = unitRenderBlock(actionFlags, timestamp, frameCount, inputBusNumber, inputData, previousBlock);
         if (err) errorBlock(err, errorIndex);
 
+        if (exitTime) *exitTime = HugGetCurrentHostTime();
+
+        return err;
+    } copy];
+}
+
+
+- (NSInteger) nodeCount
+{
+    return _errorIndex;
+}
+
+
+- (AURenderPullInputBlock) renderBlock
+{
+    if (!_timingBlock || !_renderBlock) {
+        return _renderBlock;
+    }
+
+    AURenderPullInputBlock    chainBlock  = _renderBlock;
+    HugSimpleGraphTimingBlock timingBlock = _timingBlock;
+
+    UInt64 *exitTimes = _exitTimes;
+    UInt64 *nodeTimes = _nodeTimes;
+
+    NSInteger nodeCount = MIN(_errorIndex, HugSimpleGraphMaximumNodeCount);
+
+    // Each node finishes in the order it was added, so the time spent in a
+    // node is the difference between its exit time and that of the previous
+    // node. An audio unit's own work before pulling its input is included.
+    //
+    return [^(
+        AudioUnitRenderActionFlags *actionFlags,
+        const AudioTimeStamp *timestamp,
+        AUAudioFrameCount frameCount,
+        NSInteger inputBusNumber,
+        AudioBufferList *inputData
+    ) {
+        UInt64 previousTime = HugGetCurrentHostTime();
+
+        OSStatus err = chainBlock(actionFlags, timestamp, frameCount, inputBusNumber, inputData);
+        if (err != noErr) return err;
+
+        for (NSInteger i = 0; i < nodeCount; i++) {
+            UInt64 exitTime = exitTimes[i];
+            nodeTimes[i] = (exitTime > previousTime) ? (exitTime - previousTime) : 0;
+            previousTime = MAX(previousTime, exitTime);
+        }
+
+        timingBlock(timestamp, frameCount, nodeTimes, nodeCount);
+
+        // Keep the graph, which owns exitTimes and nodeTimes, alive
+        (void)self;
+
         return err;
     } copy];
 }
@@ -0,0 +1,370 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#if !defined(__APPLE__) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "HugStatusChannel.h"
+
+#include <stdatomic.h>
+
+#if defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#else
+#include <errno.h>
+#include <semaphore.h>
+#include <time.h>
+#endif
+
+
+#define HUG_CACHE_LINE 64
+
+typedef struct {
+    atomic_uint      lock; // Seqlock, odd while the producer is writing
+    HugStatusMessage message;
+} HugStatusChannelSnapshot;
+
+
+struct HugStatusChannel {
+    // Producer
+    _Alignas(HUG_CACHE_LINE) atomic_uint_fast64_t _writeIndex;
+    uint64_t _writeSequence;
+
+    // Consumer
+    _Alignas(HUG_CACHE_LINE) atomic_uint_fast64_t _readIndex;
+    HugStatusMessage _recovered[HugStatusChannelTypeCount];
+    atomic_uint _recoveredMask; // Only written by the consumer, read by HugStatusChannelHasPending()
+    uint64_t _lastSequence[HugStatusChannelTypeCount];
+    NSInteger _peekedType; // -1 = queue, 0 = nothing peeked
+
+    // Shared
+    _Alignas(HUG_CACHE_LINE) atomic_uint _overflowMask;
+    atomic_bool _waiting;
+    atomic_uint_fast64_t _droppedCount;
+    atomic_uint_fast64_t _overflowCount;
+
+    HugStatusChannelSnapshot _overflow[HugStatusChannelTypeCount];
+
+    HugStatusMessage *_slots;
+    size_t _slotCount;
+    size_t _slotMask;
+
+#if defined(__APPLE__)
+    dispatch_semaphore_t _semaphore;
+#else
+    sem_t _semaphore;
+#endif
+};
+
+
+#pragma mark - Lifecycle
+
+HugStatusChannel *HugStatusChannelCreate(size_t slotCount)
+{
+    size_t count = 1;
+    while (count < slotCount) count <<= 1;
+
+    size_t size = ((sizeof(HugStatusChannel) + HUG_CACHE_LINE - 1) / HUG_CACHE_LINE) * HUG_CACHE_LINE;
+
+    HugStatusChannel *self = aligned_alloc(HUG_CACHE_LINE, size);
+    if (!self) return NULL;
+
+    memset(self, 0, size);
+
+    self->_slots = calloc(count, sizeof(HugStatusMessage));
+    self->_slotCount = count;
+    self->_slotMask = count - 1;
+
+    atomic_init(&self->_writeIndex, 0);
+    atomic_init(&self->_readIndex, 0);
+    atomic_init(&self->_overflowMask, 0);
+    atomic_init(&self->_recoveredMask, 0);
+    atomic_init(&self->_waiting, false);
+    atomic_init(&self->_droppedCount, 0);
+    atomic_init(&self->_overflowCount, 0);
+
+    for (NSInteger i = 0; i < HugStatusChannelTypeCount; i++) {
+        atomic_init(&self->_overflow[i].lock, 0);
+    }
+
+#if defined(__APPLE__)
+    self->_semaphore = dispatch_semaphore_create(0);
+#else
+    sem_init(&self->_semaphore, 0, 0);
+#endif
+
+    return self;
+}
+
+
+void HugStatusChannelFree(HugStatusChannel *self)
+{
+    if (!self) return;
+
+#if defined(__APPLE__)
+    dispatch_release(self->_semaphore);
+#else
+    sem_destroy(&self->_semaphore);
+#endif
+
+    free(self->_slots);
+    free(self);
+}
+
+
+#pragma mark - Private Functions
+
+static void sSignal(HugStatusChannel *self)
+{
+#if defined(__APPLE__)
+    dispatch_semaphore_signal(self->_semaphore);
+#else
+    sem_post(&self->_semaphore);
+#endif
+}
+
+
+static void sWriteOverflow(HugStatusChannel *self, const HugStatusMessage *message)
+{
+    HugStatusChannelSnapshot *snapshot = &self->_overflow[message->type];
+
+    unsigned lock = atomic_load_explicit(&snapshot->lock, memory_order_relaxed);
+    atomic_store_explicit(&snapshot->lock, lock + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    snapshot->message = *message;
+
+    atomic_store_explicit(&snapshot->lock, lock + 2, memory_order_release);
+
+    unsigned bit = 1u << message->type;
+    unsigned previousMask = atomic_fetch_or_explicit(&self->_overflowMask, bit, memory_order_release);
+
+    // The previous snapshot for this type was never seen by the consumer
+    if (previousMask & bit) {
+        atomic_fetch_add_explicit(&self->_droppedCount, 1, memory_order_relaxed);
+    }
+}
+
+
+static BOOL sReadOverflow(HugStatusChannel *self, UInt32 type, HugStatusMessage *outMessage)
+{
+    HugStatusChannelSnapshot *snapshot = &self->_overflow[type];
+
+    for (NSInteger attempt = 0; attempt < 64; attempt++) {
+        unsigned before = atomic_load_explicit(&snapshot->lock, memory_order_acquire);
+        if (before & 1) continue;
+
+        *outMessage = snapshot->message;
+
+        atomic_thread_fence(memory_order_acquire);
+        unsigned after = atomic_load_explicit(&snapshot->lock, memory_order_relaxed);
+
+        if (before == after) return YES;
+    }
+
+    // The producer keeps rewriting this snapshot, so its bit will be set again
+    atomic_fetch_or_explicit(&self->_overflowMask, 1u << type, memory_order_relaxed);
+    return NO;
+}
+
+
+static void sRecoverOverflow(HugStatusChannel *self)
+{
+    unsigned mask = atomic_exchange_explicit(&self->_overflowMask, 0, memory_order_acquire);
+    if (!mask) return;
+
+    for (UInt32 type = 1; type < HugStatusChannelTypeCount; type++) {
+        if (!(mask & (1u << type))) continue;
+
+        HugStatusMessage message;
+        if (!sReadOverflow(self, type, &message)) continue;
+
+        if (message.sequence <= self->_lastSequence[type]) continue;
+
+        unsigned recoveredMask = atomic_load_explicit(&self->_recoveredMask, memory_order_relaxed);
+
+        if (recoveredMask & (1u << type)) {
+            if (message.sequence <= self->_recovered[type].sequence) continue;
+            atomic_fetch_add_explicit(&self->_droppedCount, 1, memory_order_relaxed);
+        }
+
+        self->_recovered[type] = message;
+        atomic_fetch_or_explicit(&self->_recoveredMask, 1u << type, memory_order_release);
+    }
+}
+
+
+#pragma mark - Producer
+
+BOOL HugStatusChannelPost(HugStatusChannel *self, UInt32 type, uint64_t timestamp, const void *payload, size_t payloadSize)
+{
+    if (type == 0 || type >= HugStatusChannelTypeCount) return NO;
+    if (payloadSize > HugStatusChannelPayloadSize) return NO;
+
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_relaxed);
+    uint64_t readIndex  = atomic_load_explicit(&self->_readIndex,  memory_order_acquire);
+
+    BOOL queued = (writeIndex - readIndex) < self->_slotCount;
+
+    HugStatusMessage overflowMessage;
+    HugStatusMessage *message = queued ? &self->_slots[writeIndex & self->_slotMask] : &overflowMessage;
+
+    message->sequence    = ++self->_writeSequence;
+    message->timestamp   = timestamp;
+    message->type        = type;
+    message->payloadSize = (UInt32)payloadSize;
+
+    if (payloadSize) memcpy(message->payload, payload, payloadSize);
+
+    if (queued) {
+        atomic_store_explicit(&self->_writeIndex, writeIndex + 1, memory_order_release);
+    } else {
+        atomic_fetch_add_explicit(&self->_overflowCount, 1, memory_order_relaxed);
+        sWriteOverflow(self, message);
+    }
+
+    // Pairs with the fence in HugStatusChannelWait(). Without both, the store
+    // above and the load below may be reordered and the wakeup lost.
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (atomic_load_explicit(&self->_waiting, memory_order_relaxed)) {
+        if (atomic_exchange_explicit(&self->_waiting, false, memory_order_acq_rel)) {
+            sSignal(self);
+        }
+    }
+
+    return queued;
+}
+
+
+#pragma mark - Consumer
+
+const HugStatusMessage *HugStatusChannelPeek(HugStatusChannel *self)
+{
+    sRecoverOverflow(self);
+
+    uint64_t readIndex  = atomic_load_explicit(&self->_readIndex,  memory_order_relaxed);
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_acquire);
+
+    const HugStatusMessage *result = NULL;
+    self->_peekedType = 0;
+
+    if (readIndex < writeIndex) {
+        result = &self->_slots[readIndex & self->_slotMask];
+        self->_peekedType = -1;
+    }
+
+    unsigned recoveredMask = atomic_load_explicit(&self->_recoveredMask, memory_order_relaxed);
+
+    // Recovered snapshots are delivered in sequence order with the queue
+    for (UInt32 type = 1; type < HugStatusChannelTypeCount; type++) {
+        if (!(recoveredMask & (1u << type))) continue;
+
+        const HugStatusMessage *recovered = &self->_recovered[type];
+
+        if (!result || recovered->sequence < result->sequence) {
+            result = recovered;
+            self->_peekedType = type;
+        }
+    }
+
+    return result;
+}
+
+
+void HugStatusChannelConsume(HugStatusChannel *self)
+{
+    NSInteger peekedType = self->_peekedType;
+    self->_peekedType = 0;
+
+    if (peekedType < 0) {
+        uint64_t readIndex = atomic_load_explicit(&self->_readIndex, memory_order_relaxed);
+        const HugStatusMessage *message = &self->_slots[readIndex & self->_slotMask];
+
+        self->_lastSequence[message->type] = message->sequence;
+        atomic_store_explicit(&self->_readIndex, readIndex + 1, memory_order_release);
+
+    } else if (peekedType > 0) {
+        self->_lastSequence[peekedType] = self->_recovered[peekedType].sequence;
+        atomic_fetch_and_explicit(&self->_recoveredMask, ~(1u << peekedType), memory_order_release);
+    }
+}
+
+
+void HugStatusChannelFlush(HugStatusChannel *self)
+{
+    uint64_t writeIndex = atomic_load_explicit(&self->_writeIndex, memory_order_acquire);
+    atomic_store_explicit(&self->_readIndex, writeIndex, memory_order_release);
+
+    atomic_store_explicit(&self->_overflowMask, 0, memory_order_relaxed);
+    atomic_store_explicit(&self->_recoveredMask, 0, memory_order_release);
+    self->_peekedType = 0;
+}
+
+
+BOOL HugStatusChannelWait(HugStatusChannel *self, double timeout)
+{
+    atomic_store_explicit(&self->_waiting, true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    if (HugStatusChannelHasPending(self)) {
+        atomic_store_explicit(&self->_waiting, false, memory_order_relaxed);
+        return YES;
+    }
+
+#if defined(__APPLE__)
+    dispatch_semaphore_wait(self->_semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeout * NSEC_PER_SEC)));
+#else
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+
+    double seconds = floor(timeout);
+    deadline.tv_sec  += (time_t)seconds;
+    deadline.tv_nsec += (long)((timeout - seconds) * 1e9);
+
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec  += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (sem_timedwait(&self->_semaphore, &deadline) != 0 && errno == EINTR) { }
+#endif
+
+    atomic_store_explicit(&self->_waiting, false, memory_order_relaxed);
+
+    return HugStatusChannelHasPending(self);
+}
+
+
+void HugStatusChannelSignal(HugStatusChannel *self)
+{
+    sSignal(self);
+}
+
+
+#pragma mark - Accessors
+
+BOOL HugStatusChannelHasPending(const HugStatusChannel *self)
+{
+    HugStatusChannel *mutableSelf = (HugStatusChannel *)self;
+
+    uint64_t readIndex  = atomic_load_explicit(&mutableSelf->_readIndex,  memory_order_acquire);
+    uint64_t writeIndex = atomic_load_explicit(&mutableSelf->_writeIndex, memory_order_acquire);
+
+    return (readIndex < writeIndex) ||
+           (atomic_load_explicit(&mutableSelf->_recoveredMask, memory_order_acquire) != 0) ||
+           (atomic_load_explicit(&mutableSelf->_overflowMask, memory_order_acquire) != 0);
+}
+
+
+uint64_t HugStatusChannelGetDroppedCount(const HugStatusChannel *self)
+{
+    return atomic_load_explicit(&((HugStatusChannel *)self)->_droppedCount, memory_order_relaxed);
+}
+
+
+uint64_t HugStatusChannelGetOverflowCount(const HugStatusChannel *self)
+{
+    return atomic_load_explicit(&((HugStatusChannel *)self)->_overflowCount, memory_order_relaxed);
+}
@@ -0,0 +1,65 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Single-producer, single-consumer message queue from the render thread to
+// the UI thread.
+//
+// Messages live in fixed-size preallocated slots and carry a sequence number
+// and a timestamp. Posting never allocates or blocks. When the queue is full,
+// the message is coalesced into a per-type "latest value" snapshot instead of
+// being lost. The consumer receives it once it has drained older messages.
+// Only intermediate values are dropped, and they are counted.
+//
+// The consumer may block in HugStatusChannelWait() until something is posted.
+// The producer signals only when a consumer is actually waiting.
+
+enum {
+    HugStatusChannelPayloadSize = 40,
+    HugStatusChannelTypeCount   = 8
+};
+
+typedef struct HugStatusMessage {
+    uint64_t sequence;
+    uint64_t timestamp;
+    UInt32   type;
+    UInt32   payloadSize;
+    _Alignas(8) UInt8 payload[HugStatusChannelPayloadSize];
+} HugStatusMessage;
+
+typedef struct HugStatusChannel HugStatusChannel;
+
+// slotCount is rounded up to a power of two
+extern HugStatusChannel *HugStatusChannelCreate(size_t slotCount);
+extern void HugStatusChannelFree(HugStatusChannel *channel);
+
+// Producer. type must be in (0, HugStatusChannelTypeCount).
+// Returns NO if the queue was full and the message was coalesced.
+extern BOOL HugStatusChannelPost(HugStatusChannel *channel, UInt32 type, uint64_t timestamp, const void *payload, size_t payloadSize);
+
+// Consumer. Returns the oldest message, or NULL. The pointer is valid until
+// the next consumer call.
+extern const HugStatusMessage *HugStatusChannelPeek(HugStatusChannel *channel);
+extern void HugStatusChannelConsume(HugStatusChannel *channel);
+
+// Consumer. Discards everything posted so far.
+extern void HugStatusChannelFlush(HugStatusChannel *channel);
+
+// Blocks until a message is pending or timeout (in seconds) elapses.
+// Returns YES if a message is pending.
+extern BOOL HugStatusChannelWait(HugStatusChannel *channel, double timeout);
+
+// Wakes a thread blocked in HugStatusChannelWait()
+extern void HugStatusChannelSignal(HugStatusChannel *channel);
+
+// Consumer. Includes overflow snapshots which have been recovered but not consumed.
+extern BOOL HugStatusChannelHasPending(const HugStatusChannel *channel);
+
+// Number of messages that were coalesced away (superseded before delivery)
+extern uint64_t HugStatusChannelGetDroppedCount(const HugStatusChannel *channel);
+
+// Number of posts that found the queue full
+extern uint64_t HugStatusChannelGetOverflowCount(const HugStatusChannel *channel);
@@ -0,0 +1,148 @@
+// (c) 2014-2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugStereoField.h"
+#include "HugFastUtils.h"
+#include "HugKernels.h"
+
+
+struct HugStereoField {
+    size_t _maxFrameCount;
+    float  _previousBalance;
+    float  _previousWidth;
+};
+
+
+#pragma mark - Private Functions
+
+static float sClamp(float value)
+{
+    if (value < -1.0f) return -1.0f;
+    if (value >  1.0f) return  1.0f;
+    return value;
+}
+
+
+#pragma mark - Public Functions
+
+HugStereoField *HugStereoFieldCreate()
+{
+    HugStereoField *self = calloc(1, sizeof(HugStereoField));
+    return self;
+}
+
+
+void HugStereoFieldFree(HugStereoField *self)
+{
+    free(self);
+}
+
+
+void HugStereoFieldReset(HugStereoField *self, float balance, float width)
+{
+    self->_previousBalance = balance;
+    self->_previousWidth = width;
+}
+
+
+void HugStereoFieldProcess(HugStereoField *self, float *left, float *right, size_t frameCount, float balance, float width)
+{
+    if (!left || !right || !frameCount) return;
+
+    float previousWidth = self->_previousWidth;
+
+    if (balance < -1.0f) balance = -1.0f;
+    if (balance >  1.0f) balance =  1.0f;
+
+    if (width   < -1.0f) width   = -1.0f;
+    if (width   >  1.0f) width   =  1.0f;
+
+    // Ramps run from the previous value at i = 0 to the new value at i = frameCount - 1
+    float rampScale = frameCount > 1 ? (1.0f / ((float)frameCount - 1)) : 0.0f;
+
+    if (previousWidth != 1.0 || width != 1.0) {
+        if (previousWidth == width || frameCount == 1) {
+            HugKernels.stereoMatrix(left, right, frameCount, width, 0.0f);
+        } else {
+            HugKernels.stereoMatrix(left, right, frameCount, previousWidth, (width - previousWidth) * rampScale);
+        }
+    }
+
+    float previousBalance = self->_previousBalance;
+
+    // Left is scaled by (1 - balance)^3, right by (1 + balance)^3, both capped at 1.0
+    if (previousBalance != 0.0 || balance != 0.0) {
+        if (previousBalance == balance || frameCount == 1) {
+            float m;
+            
+            m = powf(1.0f - balance, 3);
+            if (m < 1.0f) HugApplyGain(left, frameCount, m);
+
+            m = powf(1.0f + balance, 3);
+            if (m < 1.0f) HugApplyGain(right, frameCount, m);
+ 
+        } else {
+            float step = (balance - previousBalance) * rampScale;
+
+            HugKernels.cubicRamp(left,  frameCount, 1.0f - previousBalance, -step);
+            HugKernels.cubicRamp(right, frameCount, 1.0f + previousBalance,  step);
+        }
+    }
+    
+    self->_previousWidth   = width;
+    self->_previousBalance = balance;
+}
+
+
+void HugStereoFieldProcessAutomation(HugStereoField *self, float *left, float *right, size_t frameCount, HugAutomation *automation)
+{
+    if (!left || !right || !frameCount) return;
+
+    HugAutomationSegment segment;
+    size_t offset, length;
+
+    // Both stages are per-sample, so width can run over the whole
+    // buffer before balance without changing the result.
+    //
+    for (offset = 0; offset < frameCount; offset += length) {
+        length = HugAutomationRead(automation, HugAutomationParameterStereoWidth, frameCount - offset, &segment);
+
+        float from = sClamp(segment.from);
+        float to   = sClamp(segment.to);
+
+        if (from == 1.0f && to == 1.0f) continue;
+
+        HugKernels.stereoMatrix(left + offset, right + offset, length, from, (to - from) / length);
+    }
+
+    // Left is scaled by (1 - balance)^3, right by (1 + balance)^3, both capped at 1.0
+    for (offset = 0; offset < frameCount; offset += length) {
+        length = HugAutomationRead(automation, HugAutomationParameterStereoBalance, frameCount - offset, &segment);
+
+        float from = sClamp(segment.from);
+        float to   = sClamp(segment.to);
+
+        if (from == 0.0f && to == 0.0f) continue;
+
+        float step = (to - from) / length;
+
+        HugKernels.cubicRamp(left  + offset, length, 1.0f - from, -step);
+        HugKernels.cubicRamp(right + offset, length, 1.0f + from,  step);
+    }
+
+    self->_previousWidth   = sClamp(HugAutomationGetValue(automation, HugAutomationParameterStereoWidth));
+    self->_previousBalance = sClamp(HugAutomationGetValue(automation, HugAutomationParameterStereoBalance));
+}
+
+
+void HugStereoFieldSetMaxFrameCount(HugStereoField *self, size_t maxFrameCount)
+{
+    self->_maxFrameCount = maxFrameCount;
+}
+
+
+size_t HugStereoFieldGetMaxFrameCount(const HugStereoField *self)
+{
+    return self->_maxFrameCount;
+}
+
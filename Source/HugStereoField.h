@@ -1,7 +1,10 @@
 // (c) 2014-2024 Ricci Adams
 // MIT License (or) 1-clause BSD License
 
-#import <Foundation/Foundation.h>
+#pragma once
+
+#include "HugPlatform.h"
+#include "HugAutomation.h"
 
 typedef struct HugStereoField HugStereoField;
 
@@ -11,5 +14,8 @@ extern void HugStereoFieldFree(HugStereoField *field);
 extern void HugStereoFieldReset(HugStereoField *self, float balance, float width);
 extern void HugStereoFieldProcess(HugStereoField *self, float *left, float *right, size_t frameCount, float balance, float width);
 
+// Applies HugAutomationParameterStereoWidth and HugAutomationParameterStereoBalance
+extern void HugStereoFieldProcessAutomation(HugStereoField *self, float *left, float *right, size_t frameCount, HugAutomation *automation);
+
 extern void HugStereoFieldSetMaxFrameCount(HugStereoField *field, size_t maxFrameCount);
 extern size_t HugStereoFieldGetMaxFrameCount(const HugStereoField *field);
@@ -0,0 +1,41 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+// 4x oversampling interpolation filter for true-peak detection, from
+// ITU-R BS.1770-4, Annex 2. Shared by HugTruePeakLimiter and LoudnessMeasurer.
+//
+// Each phase is stored in reverse so that the interpolated value for input
+// frame n is a forward dot product with frames (n - 11) through n:
+//
+//   y[p][n] = sum(HugTruePeakCoefficients[p][k] * x[n - 11 + k])
+//
+// The phases lie between frames (n - HugTruePeakFilterDelay - 1) and
+// (n - HugTruePeakFilterDelay).
+
+enum {
+    HugTruePeakPhaseCount  = 4,
+    HugTruePeakTapCount    = 12,
+    HugTruePeakFilterDelay = 5
+};
+
+static const float HugTruePeakCoefficients[HugTruePeakPhaseCount][HugTruePeakTapCount] = {
+    {
+        -0.0083007812500f,  0.0148925781250f, -0.0266113281250f,  0.0476074218750f,
+        -0.1022949218750f,  0.9721679687500f,  0.1373291015625f, -0.0594482421875f,
+         0.0332031250000f, -0.0196533203125f,  0.0109863281250f,  0.0017089843750f
+    }, {
+        -0.0189208984375f,  0.0330810546875f, -0.0582275390625f,  0.1015625000000f,
+        -0.2003173828125f,  0.7797851562500f,  0.4650878906250f, -0.1665039062500f,
+         0.0891113281250f, -0.0517578125000f,  0.0292968750000f, -0.0291748046875f
+    }, {
+        -0.0291748046875f,  0.0292968750000f, -0.0517578125000f,  0.0891113281250f,
+        -0.1665039062500f,  0.4650878906250f,  0.7797851562500f, -0.2003173828125f,
+         0.1015625000000f, -0.0582275390625f,  0.0330810546875f, -0.0189208984375f
+    }, {
+         0.0017089843750f,  0.0109863281250f, -0.0196533203125f,  0.0332031250000f,
+        -0.0594482421875f,  0.1373291015625f,  0.9721679687500f, -0.1022949218750f,
+         0.0476074218750f, -0.0266113281250f,  0.0148925781250f, -0.0083007812500f
+    }
+};
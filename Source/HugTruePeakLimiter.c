@@ -0,0 +1,438 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#include "HugTruePeakLimiter.h"
+#include "HugKernels.h"
+#include "HugTruePeak.h"
+
+#include <math.h>
+
+#define CHECK_RESULTS 0
+
+#if CHECK_RESULTS
+#include <stdio.h>
+#endif
+
+enum {
+    sBlockSize    = 256,
+    sPhaseCount   = HugTruePeakPhaseCount,
+    sTapCount     = HugTruePeakTapCount,
+    sHistoryCount = HugTruePeakTapCount - 1,
+    sFilterDelay  = HugTruePeakFilterDelay
+};
+
+static const float  sCeiling       = 0.891250938f; // -1 dBTP
+static const float  sUnityEpsilon  = 1e-6f;
+static const double sLookaheadTime = 0.0015;
+static const double sReleaseTime   = 0.1;
+
+
+struct HugTruePeakLimiter {
+    double _sampleRate;
+    size_t _lookahead;
+    size_t _latency;
+    float  _releaseCoefficient;
+    float  _interpolationBound;
+
+    // sHistoryCount previous frames followed by the current block
+    float _leftHistory[ sHistoryCount + sBlockSize];
+    float _rightHistory[sHistoryCount + sBlockSize];
+
+    // _latency previous frames followed by the current block
+    float *_leftDelay;
+    float *_rightDelay;
+
+    // Sliding minimum of the required gain over (_lookahead + 1) frames
+    float    *_minimumValues;
+    uint64_t *_minimumIndices;
+    size_t    _minimumCapacity;
+    size_t    _minimumHead;
+    size_t    _minimumCount;
+    uint64_t  _frameIndex;
+
+    float _release;
+
+    // Moving average of the released gain over _lookahead frames
+    float *_averageValues;
+    size_t _averageIndex;
+    double _averageSum;
+
+    size_t _idleFrameCount;
+    BOOL   _active;
+
+    float _peaks[sBlockSize];
+    float _interpolated[sBlockSize];
+    float _gains[sBlockSize];
+};
+
+
+#pragma mark - Private Functions
+
+static void sFreeBuffers(HugTruePeakLimiter *self)
+{
+    free(self->_leftDelay);
+    free(self->_rightDelay);
+    free(self->_minimumValues);
+    free(self->_minimumIndices);
+    free(self->_averageValues);
+
+    self->_leftDelay      = NULL;
+    self->_rightDelay     = NULL;
+    self->_minimumValues  = NULL;
+    self->_minimumIndices = NULL;
+    self->_averageValues  = NULL;
+}
+
+
+static void sAccumulatePeaks(HugTruePeakLimiter *self, const float *history, size_t frameCount)
+{
+    float *peaks        = self->_peaks;
+    float *interpolated = self->_interpolated;
+
+    for (size_t i = 0; i < frameCount; i++) {
+        float sample = fabsf(history[i + sHistoryCount - sFilterDelay - 1]);
+        if (sample > peaks[i]) peaks[i] = sample;
+    }
+
+    for (NSInteger phase = 0; phase < sPhaseCount; phase++) {
+        const float *coefficients = HugTruePeakCoefficients[phase];
+
+        memset(interpolated, 0, frameCount * sizeof(float));
+
+        for (NSInteger tap = 0; tap < sTapCount; tap++) {
+            float coefficient = coefficients[tap];
+            const float *input = history + tap;
+
+            for (size_t i = 0; i < frameCount; i++) {
+                interpolated[i] += coefficient * input[i];
+            }
+        }
+
+        for (size_t i = 0; i < frameCount; i++) {
+            float value = fabsf(interpolated[i]);
+            if (value > peaks[i]) peaks[i] = value;
+        }
+    }
+}
+
+
+static float sPushMinimum(HugTruePeakLimiter *self, float value)
+{
+    size_t capacity = self->_minimumCapacity;
+    uint64_t index  = self->_frameIndex++;
+
+    float    *values  = self->_minimumValues;
+    uint64_t *indices = self->_minimumIndices;
+
+    // Drop values which have left the window
+    while (self->_minimumCount > 0 && (indices[self->_minimumHead] + capacity <= index)) {
+        self->_minimumHead = (self->_minimumHead + 1) % capacity;
+        self->_minimumCount--;
+    }
+
+    // Drop values that can never be the minimum again
+    while (self->_minimumCount > 0) {
+        size_t back = (self->_minimumHead + self->_minimumCount - 1) % capacity;
+        if (values[back] < value) break;
+        self->_minimumCount--;
+    }
+
+    size_t back = (self->_minimumHead + self->_minimumCount) % capacity;
+    values[back]  = value;
+    indices[back] = index;
+    self->_minimumCount++;
+
+    return values[self->_minimumHead];
+}
+
+
+static BOOL sComputeGains(HugTruePeakLimiter *self, size_t frameCount)
+{
+    const float *peaks = self->_peaks;
+    float *gains = self->_gains;
+
+    size_t lookahead = self->_lookahead;
+    float  releaseCoefficient = self->_releaseCoefficient;
+    float  release = self->_release;
+    BOOL   active  = NO;
+
+    for (size_t i = 0; i < frameCount; i++) {
+        float peak     = peaks[i];
+        float required = (peak > sCeiling) ? (sCeiling / peak) : 1.0f;
+        float held     = sPushMinimum(self, required);
+
+        // Attack is instant here and smoothed by the moving average below
+        if (held <= release) {
+            release = held;
+        } else {
+            release = held - ((held - release) * releaseCoefficient);
+            if ((held - release) < sUnityEpsilon) release = held;
+        }
+
+        size_t averageIndex = self->_averageIndex;
+        self->_averageSum += release - self->_averageValues[averageIndex];
+        self->_averageValues[averageIndex] = release;
+
+        if (++averageIndex == lookahead) {
+            // Re-sum once per window so rounding errors cannot accumulate
+            double sum = 0;
+            for (size_t j = 0; j < lookahead; j++) sum += self->_averageValues[j];
+            self->_averageSum = sum;
+
+            averageIndex = 0;
+        }
+
+        self->_averageIndex = averageIndex;
+
+        float gain = (float)(self->_averageSum / lookahead);
+
+        if (gain > (1.0f - sUnityEpsilon)) {
+            gain = 1.0f;
+        } else {
+            active = YES;
+        }
+
+        if (required == 1.0f && release == 1.0f && gain == 1.0f) {
+            self->_idleFrameCount++;
+        } else {
+            self->_idleFrameCount = 0;
+        }
+
+        gains[i] = gain;
+    }
+
+    self->_release = release;
+
+    return active;
+}
+
+
+static void sDelayAndApply(HugTruePeakLimiter *self, float *delay, float *samples, size_t frameCount, BOOL applyGains)
+{
+    size_t latency = self->_latency;
+    const float *gains = self->_gains;
+
+    memcpy(delay + latency, samples, frameCount * sizeof(float));
+
+    if (applyGains) {
+        for (size_t i = 0; i < frameCount; i++) {
+            samples[i] = delay[i] * gains[i];
+        }
+    } else {
+        memcpy(samples, delay, frameCount * sizeof(float));
+    }
+
+    memmove(delay, delay + frameCount, latency * sizeof(float));
+
+    // Guards against rounding in the gain computation
+    for (size_t i = 0; i < frameCount; i++) {
+        float sample = samples[i];
+        sample = (sample >  sCeiling) ?  sCeiling : sample;
+        sample = (sample < -sCeiling) ? -sCeiling : sample;
+        samples[i] = sample;
+    }
+}
+
+
+static void sProcessBlock(HugTruePeakLimiter *self, float *left, float *right, size_t frameCount)
+{
+    float maxLeft  = 0;
+    float maxRight = 0;
+
+    if (left) {
+        memcpy(self->_leftHistory + sHistoryCount, left, frameCount * sizeof(float));
+        HugKernels.absMax(self->_leftHistory, sHistoryCount + frameCount, &maxLeft, NULL);
+    }
+
+    if (right) {
+        memcpy(self->_rightHistory + sHistoryCount, right, frameCount * sizeof(float));
+        HugKernels.absMax(self->_rightHistory, sHistoryCount + frameCount, &maxRight, NULL);
+    }
+
+    // No interpolated value can exceed the ceiling, skip detection
+    BOOL belowCeiling = (MAX(maxLeft, maxRight) * self->_interpolationBound) <= sCeiling;
+    BOOL active = NO;
+
+    if (belowCeiling && (self->_idleFrameCount > self->_lookahead)) {
+        // Every stored gain is 1.0, only advance positions
+        size_t averageIndex = self->_averageIndex + frameCount;
+
+        if (averageIndex >= self->_lookahead) {
+            self->_averageSum = self->_lookahead;
+        }
+
+        self->_averageIndex    = averageIndex % self->_lookahead;
+        self->_frameIndex     += frameCount;
+        self->_idleFrameCount += frameCount;
+
+    } else {
+        memset(self->_peaks, 0, frameCount * sizeof(float));
+
+        if (!belowCeiling) {
+            if (left)  sAccumulatePeaks(self, self->_leftHistory,  frameCount);
+            if (right) sAccumulatePeaks(self, self->_rightHistory, frameCount);
+        }
+
+        active = sComputeGains(self, frameCount);
+    }
+
+    if (left) {
+        sDelayAndApply(self, self->_leftDelay, left, frameCount, active);
+        memmove(self->_leftHistory, self->_leftHistory + frameCount, sHistoryCount * sizeof(float));
+    }
+
+    if (right) {
+        sDelayAndApply(self, self->_rightDelay, right, frameCount, active);
+        memmove(self->_rightHistory, self->_rightHistory + frameCount, sHistoryCount * sizeof(float));
+    }
+
+    self->_active = self->_active || active;
+}
+
+
+#pragma mark - Lifecycle
+
+HugTruePeakLimiter *HugTruePeakLimiterCreate()
+{
+    HugTruePeakLimiter *self = calloc(1, sizeof(HugTruePeakLimiter));
+
+    float bound = 1.0f;
+
+    for (NSInteger phase = 0; phase < sPhaseCount; phase++) {
+        float sum = 0;
+
+        for (NSInteger tap = 0; tap < sTapCount; tap++) {
+            sum += fabsf(HugTruePeakCoefficients[phase][tap]);
+        }
+
+        bound = MAX(bound, sum);
+    }
+
+    self->_interpolationBound = bound;
+
+    HugTruePeakLimiterSetSampleRate(self, 44100);
+
+    return self;
+}
+
+
+void HugTruePeakLimiterFree(HugTruePeakLimiter *self)
+{
+    if (!self) return;
+
+    sFreeBuffers(self);
+    free(self);
+}
+
+
+#pragma mark - Public Methods
+
+void HugTruePeakLimiterReset(HugTruePeakLimiter *self)
+{
+    memset(self->_leftHistory,  0, sizeof(self->_leftHistory));
+    memset(self->_rightHistory, 0, sizeof(self->_rightHistory));
+
+    memset(self->_leftDelay,  0, (self->_latency + sBlockSize) * sizeof(float));
+    memset(self->_rightDelay, 0, (self->_latency + sBlockSize) * sizeof(float));
+
+    self->_minimumHead  = 0;
+    self->_minimumCount = 0;
+    self->_frameIndex   = 0;
+
+    for (size_t i = 0; i < self->_lookahead; i++) {
+        self->_averageValues[i] = 1.0f;
+    }
+
+    self->_averageIndex = 0;
+    self->_averageSum   = self->_lookahead;
+    self->_release      = 1.0f;
+
+    self->_idleFrameCount = 0;
+    self->_active = NO;
+}
+
+
+void HugTruePeakLimiterProcess(HugTruePeakLimiter *self, float *left, float *right, size_t frameCount)
+{
+    self->_active = NO;
+
+    if (!left && !right) return;
+
+    size_t offset = 0;
+
+    while (offset < frameCount) {
+        size_t framesToProcess = MIN(frameCount - offset, (size_t)sBlockSize);
+
+        sProcessBlock(self,
+            left  ? left  + offset : NULL,
+            right ? right + offset : NULL,
+            framesToProcess);
+
+        offset += framesToProcess;
+    }
+
+#if CHECK_RESULTS
+    float leftMax  = 0;
+    float rightMax = 0;
+
+    if (left)  HugKernels.absMax(left,  frameCount, &leftMax,  NULL);
+    if (right) HugKernels.absMax(right, frameCount, &rightMax, NULL);
+
+    if (MAX(leftMax, rightMax) > sCeiling) {
+        fprintf(stderr, "Above ceiling after true-peak limiter\n");
+    }
+#endif
+}
+
+
+#pragma mark - Accessors
+
+void HugTruePeakLimiterSetSampleRate(HugTruePeakLimiter *self, double sampleRate)
+{
+    size_t lookahead = (size_t)ceil(sampleRate * sLookaheadTime);
+    if (lookahead < 16) lookahead = 16;
+
+    sFreeBuffers(self);
+
+    self->_sampleRate = sampleRate;
+    self->_lookahead  = lookahead;
+    self->_latency    = lookahead + sFilterDelay;
+
+    self->_releaseCoefficient = expf(-1.0f / (float)(sampleRate * sReleaseTime));
+
+    self->_leftDelay  = calloc(self->_latency + sBlockSize, sizeof(float));
+    self->_rightDelay = calloc(self->_latency + sBlockSize, sizeof(float));
+
+    self->_minimumCapacity = lookahead + 1;
+    self->_minimumValues   = calloc(self->_minimumCapacity, sizeof(float));
+    self->_minimumIndices  = calloc(self->_minimumCapacity, sizeof(uint64_t));
+
+    self->_averageValues = calloc(lookahead, sizeof(float));
+
+    HugTruePeakLimiterReset(self);
+}
+
+
+double HugTruePeakLimiterGetSampleRate(const HugTruePeakLimiter *self)
+{
+    return self->_sampleRate;
+}
+
+
+float HugTruePeakLimiterGetCeiling(const HugTruePeakLimiter *self)
+{
+    (void)self;
+    return sCeiling;
+}
+
+
+size_t HugTruePeakLimiterGetLatency(const HugTruePeakLimiter *self)
+{
+    return self->_latency;
+}
+
+
+BOOL HugTruePeakLimiterIsActive(const HugTruePeakLimiter *self)
+{
+    return self->_active;
+}
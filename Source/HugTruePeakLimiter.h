@@ -0,0 +1,37 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#pragma once
+
+#include "HugPlatform.h"
+
+// Lookahead limiter with 4x oversampled true-peak detection (ITU-R BS.1770-4
+// interpolation filter), used as an alternative to HugLimiter.
+//
+// Gain is computed per sample: the required gain is held over the lookahead
+// window, ramped down linearly across it (attack), and released
+// exponentially. Audio is delayed by HugTruePeakLimiterGetLatency() frames.
+//
+// All state is per sample, so output is identical for any buffer size.
+// Processing never allocates and accepts any frameCount.
+
+typedef struct HugTruePeakLimiter HugTruePeakLimiter;
+
+extern HugTruePeakLimiter *HugTruePeakLimiterCreate(void);
+extern void HugTruePeakLimiterFree(HugTruePeakLimiter *limiter);
+
+extern void HugTruePeakLimiterReset(HugTruePeakLimiter *limiter);
+extern void HugTruePeakLimiterProcess(HugTruePeakLimiter *limiter, float *left, float *right, size_t frameCount);
+
+// Not real-time safe. Resizes the delay line and resets all state.
+extern void HugTruePeakLimiterSetSampleRate(HugTruePeakLimiter *limiter, double sampleRate);
+extern double HugTruePeakLimiterGetSampleRate(const HugTruePeakLimiter *limiter);
+
+// Linear ceiling for the output's true peak
+extern float HugTruePeakLimiterGetCeiling(const HugTruePeakLimiter *limiter);
+
+// Delay, in frames, between input and output
+extern size_t HugTruePeakLimiterGetLatency(const HugTruePeakLimiter *limiter);
+
+// YES if gain was reduced during the last call to HugTruePeakLimiterProcess()
+extern BOOL HugTruePeakLimiterIsActive(const HugTruePeakLimiter *limiter);
@@ -0,0 +1,36 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import <Foundation/Foundation.h>
+
+
+// Internal copies of track files, in Application Support/Files.
+//
+// Each track has an entry named by its UUID, which is a hard link to a
+// shared object in Files/Objects. Objects are named by the identity of
+// the source file (volume, inode, size, and modification date), so adding
+// the same file twice or duplicating a track doesn't copy it again.
+//
+// When the source is on the same volume, new objects are cloned, which is
+// instant and shares storage on APFS. Otherwise they are copied on a
+// background queue, one file at a time. Objects without any entries are
+// removed.
+//
+@interface InternalFileStore : NSObject
+
++ (instancetype) sharedInstance;
+
+// Returns the entry for UUID if it exists
+- (NSURL *) fileURLForUUID:(NSUUID *)UUID extension:(NSString *)extension;
+
+// Links or clones sourceURL into an entry for UUID without copying data.
+// Returns nil if the file needs to be copied. Safe to call from any queue.
+- (NSURL *) linkFileAtURL:(NSURL *)sourceURL UUID:(NSUUID *)UUID;
+
+// Copies sourceURL in the background. The handler is called on the main queue.
+- (void) copyFileAtURL:(NSURL *)sourceURL UUID:(NSUUID *)UUID completionHandler:(void (^)(NSURL *fileURL, NSError *error))completionHandler;
+
+- (void) removeFileAtURL:(NSURL *)fileURL;
+- (void) removeAllFiles;
+
+@end
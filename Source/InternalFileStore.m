@@ -0,0 +1,323 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import "InternalFileStore.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+#include <copyfile.h>
+#include <sys/clonefile.h>
+#include <sys/stat.h>
+
+
+static NSError *sMakePOSIXError(int code)
+{
+    return [NSError errorWithDomain:NSPOSIXErrorDomain code:code userInfo:nil];
+}
+
+
+// Named by the identity of the source file rather than its contents, so that
+// finding an existing object doesn't require reading the source.
+//
+static NSString *sGetObjectName(NSURL *sourceURL)
+{
+    struct stat st;
+    if (stat([[sourceURL path] fileSystemRepresentation], &st) != 0) return nil;
+
+    NSString *volumeUUID = nil;
+    [sourceURL getResourceValue:&volumeUUID forKey:NSURLVolumeUUIDStringKey error:NULL];
+    if (!volumeUUID) volumeUUID = [NSString stringWithFormat:@"%ld", (long)st.st_dev];
+
+    NSString *identity = [NSString stringWithFormat:@"%@-%llu-%lld-%ld.%09ld",
+        volumeUUID,
+        (unsigned long long)st.st_ino,
+        (long long)st.st_size,
+        (long)st.st_mtimespec.tv_sec,
+        (long)st.st_mtimespec.tv_nsec
+    ];
+
+    NSData *identityData = [identity dataUsingEncoding:NSUTF8StringEncoding];
+
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([identityData bytes], (CC_LONG)[identityData length], digest);
+
+    NSMutableString *result = [NSMutableString stringWithCapacity:(CC_SHA256_DIGEST_LENGTH * 2)];
+
+    for (NSInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++) {
+        [result appendFormat:@"%02x", digest[i]];
+    }
+
+    NSString *extension = [sourceURL pathExtension];
+    return [extension length] ? [result stringByAppendingPathExtension:extension] : result;
+}
+
+
+@implementation InternalFileStore {
+    NSString *_directoryPath;
+    NSString *_objectsPath;
+    NSString *_incomingPath;
+
+    dispatch_queue_t _queue;      // Guards Objects and entries
+    dispatch_queue_t _copyQueue;  // One copy at a time
+
+    BOOL _sweepScheduled;
+}
+
+
++ (instancetype) sharedInstance
+{
+    static InternalFileStore *sSharedInstance = nil;
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+        sSharedInstance = [[InternalFileStore alloc] init];
+    });
+
+    return sSharedInstance;
+}
+
+
+- (instancetype) init
+{
+    if ((self = [super init])) {
+        _directoryPath = [GetApplicationSupportDirectory() stringByAppendingPathComponent:@"Files"];
+        _objectsPath   = [_directoryPath stringByAppendingPathComponent:@"Objects"];
+        _incomingPath  = [_directoryPath stringByAppendingPathComponent:@"Incoming"];
+
+        _queue     = dispatch_queue_create("InternalFileStore", DISPATCH_QUEUE_SERIAL);
+        _copyQueue = dispatch_queue_create("InternalFileStore.copy", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+
+        // Copies interrupted by quitting
+        NSError *error = nil;
+        [[NSFileManager defaultManager] removeItemAtPath:_incomingPath error:&error];
+
+        [self _makeDirectories];
+
+        dispatch_async(_queue, ^{
+            [self _sweep];
+        });
+    }
+
+    return self;
+}
+
+
+#pragma mark - Private Methods
+
+- (void) _makeDirectories
+{
+    NSFileManager *manager = [NSFileManager defaultManager];
+    NSError *error = nil;
+
+    [manager createDirectoryAtPath:_objectsPath  withIntermediateDirectories:YES attributes:nil error:&error];
+    [manager createDirectoryAtPath:_incomingPath withIntermediateDirectories:YES attributes:nil error:&error];
+}
+
+
+- (NSString *) _entryPathForUUID:(NSUUID *)UUID extension:(NSString *)extension
+{
+    NSString *result = [_directoryPath stringByAppendingPathComponent:[UUID UUIDString]];
+    return [extension length] ? [result stringByAppendingPathExtension:extension] : result;
+}
+
+
+// Must be called on _queue
+- (NSURL *) _linkObjectNamed:(NSString *)objectName toEntryForUUID:(NSUUID *)UUID
+{
+    NSString *objectPath = [_objectsPath stringByAppendingPathComponent:objectName];
+    NSString *entryPath  = [self _entryPathForUUID:UUID extension:[objectName pathExtension]];
+
+    if (link([objectPath fileSystemRepresentation], [entryPath fileSystemRepresentation]) == 0) {
+        return [NSURL fileURLWithPath:entryPath];
+    } else if (errno != EEXIST) {
+        return nil;
+    }
+
+    struct stat objectStat, entryStat;
+    if (stat([objectPath fileSystemRepresentation], &objectStat) != 0) return nil;
+
+    if (lstat([entryPath fileSystemRepresentation], &entryStat) == 0 &&
+        entryStat.st_dev == objectStat.st_dev &&
+        entryStat.st_ino == objectStat.st_ino
+    ) {
+        return [NSURL fileURLWithPath:entryPath];
+    }
+
+    // The entry links to a different object, such as a copy of the file
+    // before it changed. Replace it atomically.
+    NSString *temporaryPath = [_incomingPath stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+    if (link([objectPath fileSystemRepresentation], [temporaryPath fileSystemRepresentation]) != 0) {
+        return nil;
+    }
+
+    if (rename([temporaryPath fileSystemRepresentation], [entryPath fileSystemRepresentation]) != 0) {
+        int error = errno;
+        unlink([temporaryPath fileSystemRepresentation]);
+        errno = error;
+
+        return nil;
+    }
+
+    // The previous object may no longer have any entries
+    [self _scheduleSweep];
+
+    return [NSURL fileURLWithPath:entryPath];
+}
+
+
+// Removes objects which no longer have any entries. Must be called on _queue
+- (void) _sweep
+{
+    _sweepScheduled = NO;
+
+    NSError *error = nil;
+    NSArray *names = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:_objectsPath error:&error];
+
+    for (NSString *name in names) {
+        NSString *path = [_objectsPath stringByAppendingPathComponent:name];
+
+        struct stat st;
+        if (lstat([path fileSystemRepresentation], &st) != 0) continue;
+
+        if (S_ISREG(st.st_mode) && st.st_nlink <= 1) {
+            unlink([path fileSystemRepresentation]);
+        }
+    }
+}
+
+
+- (void) _scheduleSweep
+{
+    if (_sweepScheduled) return;
+    _sweepScheduled = YES;
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, NSEC_PER_SEC), _queue, ^{
+        [self _sweep];
+    });
+}
+
+
+#pragma mark - Public Methods
+
+- (NSURL *) fileURLForUUID:(NSUUID *)UUID extension:(NSString *)extension
+{
+    if (!UUID) return nil;
+
+    NSString *entryPath = [self _entryPathForUUID:UUID extension:extension];
+
+    if ([[NSFileManager defaultManager] fileExistsAtPath:entryPath]) {
+        return [NSURL fileURLWithPath:entryPath];
+    }
+
+    return nil;
+}
+
+
+- (NSURL *) linkFileAtURL:(NSURL *)sourceURL UUID:(NSUUID *)UUID
+{
+    NSString *objectName = sGetObjectName(sourceURL);
+    if (!objectName || !UUID) return nil;
+
+    __block NSURL *result = nil;
+
+    dispatch_sync(_queue, ^{
+        if ((result = [self _linkObjectNamed:objectName toEntryForUUID:UUID])) {
+            return;
+        }
+
+        // Fails with EXDEV across volumes, or ENOTSUP on non-APFS volumes
+        NSString *objectPath = [_objectsPath stringByAppendingPathComponent:objectName];
+
+        if (clonefile([[sourceURL path] fileSystemRepresentation], [objectPath fileSystemRepresentation], 0) == 0) {
+            result = [self _linkObjectNamed:objectName toEntryForUUID:UUID];
+        }
+    });
+
+    return result;
+}
+
+
+- (void) copyFileAtURL:(NSURL *)sourceURL UUID:(NSUUID *)UUID completionHandler:(void (^)(NSURL *fileURL, NSError *error))completionHandler
+{
+    dispatch_async(_copyQueue, ^{
+        NSString *objectName = sGetObjectName(sourceURL);
+
+        __block NSURL   *fileURL = nil;
+        __block NSError *error   = nil;
+
+        void (^finish)() = ^{
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionHandler(fileURL, error);
+            });
+        };
+
+        if (!objectName || !UUID) {
+            error = sMakePOSIXError(ENOENT);
+            finish();
+            return;
+        }
+
+        // An earlier copy may have created the object
+        dispatch_sync(_queue, ^{
+            fileURL = [self _linkObjectNamed:objectName toEntryForUUID:UUID];
+        });
+
+        if (fileURL) {
+            finish();
+            return;
+        }
+
+        NSString *incomingPath = [_incomingPath stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]];
+
+        // Copies data along with the modification date, which AnalysisCache keys on
+        if (copyfile([[sourceURL path] fileSystemRepresentation], [incomingPath fileSystemRepresentation], NULL, COPYFILE_DATA | COPYFILE_STAT) != 0) {
+            error = sMakePOSIXError(errno);
+            unlink([incomingPath fileSystemRepresentation]);
+            finish();
+            return;
+        }
+
+        dispatch_sync(_queue, ^{
+            [self _makeDirectories];
+
+            NSString *objectPath = [_objectsPath stringByAppendingPathComponent:objectName];
+
+            if (rename([incomingPath fileSystemRepresentation], [objectPath fileSystemRepresentation]) != 0) {
+                error = sMakePOSIXError(errno);
+                unlink([incomingPath fileSystemRepresentation]);
+                return;
+            }
+
+            fileURL = [self _linkObjectNamed:objectName toEntryForUUID:UUID];
+            if (!fileURL) error = sMakePOSIXError(errno);
+        });
+
+        finish();
+    });
+}
+
+
+- (void) removeFileAtURL:(NSURL *)fileURL
+{
+    if (!fileURL) return;
+
+    dispatch_async(_queue, ^{
+        unlink([[fileURL path] fileSystemRepresentation]);
+        [self _scheduleSweep];
+    });
+}
+
+
+- (void) removeAllFiles
+{
+    dispatch_sync(_queue, ^{
+        NSError *error = nil;
+        [[NSFileManager defaultManager] removeItemAtPath:_directoryPath error:&error];
+
+        [self _makeDirectories];
+    });
+}
+
+
+@end
@@ -0,0 +1,82 @@
+/*
+    This file is not available under a 1-clause BSD License.
+    SPDX-License-Identifier: MIT
+
+    LoudnessFilter
+    Copyright (c) 2014-2024 Ricci Adams
+
+    Heavily based on libebur128
+    Copyright (c) 2011 Jan Kokemüller
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy of
+    this software and associated documentation files (the "Software"), to deal in
+    the Software without restriction, including without limitation the rights to
+    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+    the Software, and to permit persons to whom the Software is furnished to do so,
+    subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+    FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+    COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+    IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+    CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <math.h>
+
+// K-weighting filter from ITU-R BS.1770: a high-shelf "pre-filter" followed
+// by the RLB high-pass. Shared by LoudnessMeasurer (file analysis) and
+// HugLoudnessMeter (live output metering).
+//
+// Each stage is stored as { b0, b1, b2, a1, a2 } with a0 normalized to 1.0.
+
+static inline void LoudnessFilterGetCoefficients(double sampleRate, double coefficients[2][5])
+{
+    // Not M_PI, which ISO C doesn't define
+    const double pi = 3.14159265358979323846;
+
+    double f0 = 1681.974450955533;
+    double G  =    3.999843853973347;
+    double Q  =    0.7071752369554196;
+
+    double K  = tan(pi * f0 / sampleRate);
+    double Vh = pow(10.0, G / 20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+
+    double pb[3] = {0.0,  0.0, 0.0};
+    double pa[3] = {1.0,  0.0, 0.0};
+    double rb[3] = {1.0, -2.0, 1.0};
+    double ra[3] = {1.0,  0.0, 0.0};
+
+    double a0 =      1.0 + K / Q + K * K      ;
+    pb[0] =     (Vh + Vb * K / Q + K * K) / a0;
+    pb[1] =           2.0 * (K * K -  Vh) / a0;
+    pb[2] =     (Vh - Vb * K / Q + K * K) / a0;
+    pa[1] =           2.0 * (K * K - 1.0) / a0;
+    pa[2] =         (1.0 - K / Q + K * K) / a0;
+
+    f0 = 38.13547087602444;
+    Q  =  0.5003270373238773;
+    K  = tan(pi * f0 / sampleRate);
+
+    ra[1] =   2.0 * (K * K - 1.0) / (1.0 + K / Q + K * K);
+    ra[2] = (1.0 - K / Q + K * K) / (1.0 + K / Q + K * K);
+
+    coefficients[0][0] = pb[0];
+    coefficients[0][1] = pb[1];
+    coefficients[0][2] = pb[2];
+    coefficients[0][3] = pa[1];
+    coefficients[0][4] = pa[2];
+
+    coefficients[1][0] = rb[0];
+    coefficients[1][1] = rb[1];
+    coefficients[1][2] = rb[2];
+    coefficients[1][3] = ra[1];
+    coefficients[1][4] = ra[2];
+}
@@ -39,13 +39,51 @@ typedef struct LoudnessMeasurer LoudnessMeasurer;
 extern LoudnessMeasurer *LoudnessMeasurerCreate(unsigned int channels, double sampleRate, size_t totalFrames);
 extern void LoudnessMeasurerFree(LoudnessMeasurer *measurer);
 
+// Samples at or below this level are silent. Defaults to -36 dBFS.
+// Must be set before scanning, and to the same value for every segment.
+extern void LoudnessMeasurerSetSilenceThreshold(LoudnessMeasurer *st, double dBFS);
+
 extern void LoudnessMeasurerScanAudioBuffer(LoudnessMeasurer *st, AudioBufferList *bufferList, size_t frames);
 
+// Segmented analysis. The file is split at multiples of
+// LoudnessMeasurerGetSegmentAlignment() frames, with every segment after the
+// first starting at least LoudnessMeasurerGetSegmentWarmUpFrames() in.
+// The first segment is scanned by a regular measurer covering the whole
+// file. Each later segment uses LoudnessMeasurerCreateSegment() and is
+// scanned starting LoudnessMeasurerGetSegmentWarmUpFrames() before its
+// start. Segments are then appended, in order, to the first measurer.
+//
+// Peaks, the overview, and the block layout match a serial scan exactly.
+// K-weighted energies depend on the filter state at the segment start;
+// after warm-up this differs from a serial scan only by rounding.
+//
+extern LoudnessMeasurer *LoudnessMeasurerCreateSegment(unsigned int channels, double sampleRate, size_t segmentFrames);
+extern void LoudnessMeasurerAppendSegment(LoudnessMeasurer *st, const LoudnessMeasurer *segment);
+
+extern size_t LoudnessMeasurerGetSegmentAlignment(double sampleRate);
+extern size_t LoudnessMeasurerGetSegmentWarmUpFrames(double sampleRate);
+
 extern NSData *LoudnessMeasurerGetOverview(LoudnessMeasurer *st);
 
+// WaveformPyramid data with min/max/RMS at 200 Hz and power-of-two decimations
+extern NSData *LoudnessMeasurerGetWaveform(LoudnessMeasurer *st);
+
 extern double LoudnessMeasurerGetLoudness(LoudnessMeasurer *st);
 extern double LoudnessMeasurerGetPeak(LoudnessMeasurer *st);
 
+// Frame indices of the first and last samples above the silence threshold,
+// in any channel. Returns NO if the entire file is silent.
+extern BOOL LoudnessMeasurerGetAudibleFrames(LoudnessMeasurer *st, size_t *outFirstFrame, size_t *outLastFrame);
+
+// 4x oversampled, per ITU-R BS.1770-4
+extern double LoudnessMeasurerGetTruePeak(LoudnessMeasurer *st);
+
+// In LU, per EBU Tech 3342
+extern double LoudnessMeasurerGetLoudnessRange(LoudnessMeasurer *st);
+
+// Float32 short-term (3s) loudness in LUFS, every 100ms
+extern NSData *LoudnessMeasurerGetShortTermLoudness(LoudnessMeasurer *st);
+
 
 #ifdef __cplusplus
 }
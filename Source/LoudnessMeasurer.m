@@ -27,6 +27,9 @@
 */
 
 #include "LoudnessMeasurer.h"
+#include "LoudnessFilter.h"
+#include "HugTruePeak.h"
+#include "WaveformPyramid.h"
 
 #include <float.h>
 #include <limits.h>
@@ -41,6 +44,16 @@
 #include <Accelerate/Accelerate.h>
 #include <AudioToolbox/AudioToolbox.h>
 
+static const size_t sShortTermSegmentCount = 30;
+static const double sMinimumLoudness = -70.0;
+
+// 5ms windows, 200 per second
+static const size_t sWaveformWindowsPer100ms = 20;
+
+// Roughly matches the 4/255 overview threshold previously used by Track
+static const double sDefaultSilenceThreshold = -36.0;
+
+
 typedef struct LoudnessMeasurerChannel {
     float  *_bufferPre;
     double *_bufferPost;
@@ -53,6 +66,11 @@ typedef struct LoudnessMeasurerChannel {
     double _filterState[2][4];
 
     double _samplePeak;
+    double _truePeak;
+
+    // (HugTruePeakTapCount - 1) previous frames followed by the current frames
+    float  *_truePeakInput;
+    float  *_truePeakOutput;
 
     double *_blocks;
     size_t  _blocksCapacity;
@@ -62,6 +80,41 @@ typedef struct LoudnessMeasurerChannel {
     size_t  _overviewCapacity;
     size_t  _overviewCount;
 
+    // K-weighted energy of each 100ms segment, used for short-term loudness
+    double *_segments;
+    size_t  _segmentsCapacity;
+    size_t  _segmentsCount;
+    double  _segmentEnergy;
+    size_t  _segmentFrames;
+
+    // Min, max, and mean square of each waveform window. Windows are laid out
+    // relative to 100ms segments so that segmented analysis lines up.
+    float  *_waveform; // 3 floats per window
+    size_t  _waveformCapacity;
+    size_t  _waveformCount;
+    size_t  _waveformWindow; // Index within the current 100ms segment
+    size_t  _waveformFrame;  // Frame within the current 100ms segment
+    float   _waveformMin;
+    float   _waveformMax;
+    float   _waveformSquares;
+
+    // Frames measured after warm-up, and the first and last of those with
+    // a sample above the silence threshold
+    size_t  _measuredFrames;
+    size_t  _firstAudibleFrame;
+    size_t  _lastAudibleFrame;
+    BOOL    _hasAudibleFrame;
+
+    // Frames left before a segment measurer starts measuring. Peaks are not
+    // updated during warm-up, and results produced before it ended are
+    // skipped by LoudnessMeasurerAppendSegment().
+    //
+    size_t _warmUpFrames;
+    size_t _blocksStart;
+    size_t _overviewStart;
+    size_t _segmentsStart;
+    size_t _waveformStart;
+
     // How many frames are needed for a gating block. Will correspond to 400ms
     // of audio at initialization, and 100ms after the first block (75% overlap
     // as specified in the 2011 revision of BS1770). */
@@ -82,53 +135,19 @@ struct LoudnessMeasurer {
     unsigned long _samplesIn400ms;
 
     double _coefficients[2][5];
+
+    // Linear
+    float _silenceThreshold;
 };
 
 
 static inline void LoudnessMeasurerSetupFilter(LoudnessMeasurer *m, double sampleRate)
 {
-    double f0 = 1681.974450955533;
-    double G  =    3.999843853973347;
-    double Q  =    0.7071752369554196;
-
-    double K  = tan(M_PI * f0 / sampleRate);
-    double Vh = pow(10.0, G / 20.0);
-    double Vb = pow(Vh, 0.4996667741545416);
-
-    double pb[3] = {0.0,  0.0, 0.0};
-    double pa[3] = {1.0,  0.0, 0.0};
-    double rb[3] = {1.0, -2.0, 1.0};
-    double ra[3] = {1.0,  0.0, 0.0};
-
-    double a0 =      1.0 + K / Q + K * K      ;
-    pb[0] =     (Vh + Vb * K / Q + K * K) / a0;
-    pb[1] =           2.0 * (K * K -  Vh) / a0;
-    pb[2] =     (Vh - Vb * K / Q + K * K) / a0;
-    pa[1] =           2.0 * (K * K - 1.0) / a0;
-    pa[2] =         (1.0 - K / Q + K * K) / a0;
-
-    f0 = 38.13547087602444;
-    Q  =  0.5003270373238773;
-    K  = tan(M_PI * f0 / sampleRate);
-
-    ra[1] =   2.0 * (K * K - 1.0) / (1.0 + K / Q + K * K);
-    ra[2] = (1.0 - K / Q + K * K) / (1.0 + K / Q + K * K);
-
-    m->_coefficients[0][0] = pb[0];
-    m->_coefficients[0][1] = pb[1];
-    m->_coefficients[0][2] = pb[2];
-    m->_coefficients[0][3] = pa[1];
-    m->_coefficients[0][4] = pa[2];
-
-    m->_coefficients[1][0] = rb[0];
-    m->_coefficients[1][1] = rb[1];
-    m->_coefficients[1][2] = rb[2];
-    m->_coefficients[1][3] = ra[1];
-    m->_coefficients[1][4] = ra[2];
+    LoudnessFilterGetCoefficients(sampleRate, m->_coefficients);
 }
 
 
-LoudnessMeasurer *LoudnessMeasurerCreate(unsigned int channelCount, double sampleRate, size_t totalFrames)
+static LoudnessMeasurer *sCreate(unsigned int channelCount, double sampleRate, size_t totalFrames, size_t warmUpFrames)
 {
     LoudnessMeasurer *self = (LoudnessMeasurer *)calloc(1, sizeof(LoudnessMeasurer));
     if (!self) return NULL;
@@ -145,6 +164,8 @@ LoudnessMeasurer *LoudnessMeasurerCreate(unsigned int channelCount, double sampl
 
         channel->_blocksCapacity   = ceil(totalFrames / sampleRate) * 10;
         channel->_overviewCapacity = ceil(totalFrames / sampleRate) * 100;
+        channel->_segmentsCapacity = ceil(totalFrames / sampleRate) * 10;
+        channel->_waveformCapacity = channel->_segmentsCapacity * sWaveformWindowsPer100ms;
 
         channel->_bufferPre  = (float  *)malloc( channel->_bufferFrames      * sizeof(float));
         channel->_overview   = (float  *)malloc( channel->_overviewCapacity  * sizeof(float));
@@ -153,16 +174,50 @@ LoudnessMeasurer *LoudnessMeasurerCreate(unsigned int channelCount, double sampl
         channel->_scratch    = (double *)malloc((channel->_bufferFrames + 2) * sizeof(double));
         channel->_scratch2   = (double *)malloc((channel->_bufferFrames + 2) * sizeof(double));
         channel->_blocks     = (double *)malloc( channel->_blocksCapacity    * sizeof(double));
+        channel->_segments   = (double *)malloc( channel->_segmentsCapacity  * sizeof(double));
+        channel->_waveform   = (float  *)malloc( channel->_waveformCapacity  * sizeof(float) * 3);
+
+        channel->_truePeakInput  = (float *)calloc(channel->_bufferFrames + HugTruePeakTapCount - 1, sizeof(float));
+        channel->_truePeakOutput = (float *)malloc(channel->_bufferFrames * sizeof(float));
 
         channel->_neededFrames = self->_samplesIn400ms;
+        channel->_warmUpFrames = warmUpFrames;
     }
 
     LoudnessMeasurerSetupFilter(self, sampleRate);
+    LoudnessMeasurerSetSilenceThreshold(self, sDefaultSilenceThreshold);
 
     return self;
 }
 
 
+LoudnessMeasurer *LoudnessMeasurerCreate(unsigned int channelCount, double sampleRate, size_t totalFrames)
+{
+    return sCreate(channelCount, sampleRate, totalFrames, 0);
+}
+
+
+LoudnessMeasurer *LoudnessMeasurerCreateSegment(unsigned int channelCount, double sampleRate, size_t totalFrames)
+{
+    size_t warmUpFrames = LoudnessMeasurerGetSegmentWarmUpFrames(sampleRate);
+    return sCreate(channelCount, sampleRate, warmUpFrames + totalFrames, warmUpFrames);
+}
+
+
+size_t LoudnessMeasurerGetSegmentAlignment(double sampleRate)
+{
+    return (sampleRate + 5) / 10;
+}
+
+
+size_t LoudnessMeasurerGetSegmentWarmUpFrames(double sampleRate)
+{
+    // 1s: covers the 300ms of history each gating block needs, and lets the
+    // K-weighting filter state converge to that of a serial scan
+    return LoudnessMeasurerGetSegmentAlignment(sampleRate) * 10;
+}
+
+
 void LoudnessMeasurerFree(LoudnessMeasurer *self)
 {
     for (int c = 0; c < self->_channelCount; c++) {
@@ -175,6 +230,11 @@ void LoudnessMeasurerFree(LoudnessMeasurer *self)
         free(channel->_scratch);
         free(channel->_scratch2);
         free(channel->_blocks);
+        free(channel->_segments);
+        free(channel->_waveform);
+
+        free(channel->_truePeakInput);
+        free(channel->_truePeakOutput);
     }
 
     free(self->_channels);
@@ -202,22 +262,153 @@ static inline void sBiquad(double *inBuffer, double *outBuffer, const double *co
 }
 
 
+static inline void sCalculateTruePeak(LoudnessMeasurerChannel *channel, const float *samples, size_t frames, BOOL measure)
+{
+    const size_t historyFrames = HugTruePeakTapCount - 1;
+
+    float *input  = channel->_truePeakInput;
+    float *output = channel->_truePeakOutput;
+
+    memcpy(input + historyFrames, samples, frames * sizeof(float));
+
+    for (NSInteger phase = 0; phase < HugTruePeakPhaseCount; phase++) {
+        float max = 0;
+
+        if (!measure) break;
+
+        vDSP_conv(input, 1, HugTruePeakCoefficients[phase], 1, output, 1, frames, HugTruePeakTapCount);
+        vDSP_maxmgv(output, 1, &max, frames);
+
+        if (max > channel->_truePeak) {
+            channel->_truePeak = max;
+        }
+    }
+
+    memmove(input, input + frames, historyFrames * sizeof(float));
+}
+
+
+static inline void sAccumulateSegments(const LoudnessMeasurer *self, LoudnessMeasurerChannel *channel, const double *filtered, size_t frames)
+{
+    size_t index = 0;
+
+    while (index < frames) {
+        size_t framesToSum = self->_samplesIn100ms - channel->_segmentFrames;
+        if (framesToSum > (frames - index)) framesToSum = frames - index;
+
+        double energy = 0;
+        vDSP_svesqD(filtered + index, 1, &energy, framesToSum);
+
+        channel->_segmentEnergy += energy;
+        channel->_segmentFrames += framesToSum;
+        index += framesToSum;
+
+        if (channel->_segmentFrames == self->_samplesIn100ms) {
+            if (channel->_segmentsCount < channel->_segmentsCapacity) {
+                channel->_segments[channel->_segmentsCount++] = channel->_segmentEnergy;
+            }
+
+            channel->_segmentEnergy = 0;
+            channel->_segmentFrames = 0;
+        }
+    }
+}
+
+
+static inline void sAccumulateWaveform(const LoudnessMeasurer *self, LoudnessMeasurerChannel *channel, const float *samples, size_t frames)
+{
+    const size_t framesPer100ms = self->_samplesIn100ms;
+    size_t index = 0;
+
+    while (index < frames) {
+        size_t window      = channel->_waveformWindow;
+        size_t windowStart = (window       * framesPer100ms) / sWaveformWindowsPer100ms;
+        size_t windowEnd   = ((window + 1) * framesPer100ms) / sWaveformWindowsPer100ms;
+
+        size_t framesToScan = MIN(windowEnd - channel->_waveformFrame, frames - index);
+
+        if (framesToScan) {
+            float min, max, squares;
+
+            vDSP_minv( samples + index, 1, &min,     framesToScan);
+            vDSP_maxv( samples + index, 1, &max,     framesToScan);
+            vDSP_svesq(samples + index, 1, &squares, framesToScan);
+
+            if (min < channel->_waveformMin) channel->_waveformMin = min;
+            if (max > channel->_waveformMax) channel->_waveformMax = max;
+            channel->_waveformSquares += squares;
+
+            channel->_waveformFrame += framesToScan;
+            index += framesToScan;
+        }
+
+        if (channel->_waveformFrame == windowEnd) {
+            if (channel->_waveformCount < channel->_waveformCapacity) {
+                float *entry = &channel->_waveform[channel->_waveformCount++ * 3];
+
+                entry[0] = channel->_waveformMin;
+                entry[1] = channel->_waveformMax;
+                entry[2] = channel->_waveformSquares / MAX(windowEnd - windowStart, (size_t)1);
+            }
+
+            channel->_waveformMin = 0;
+            channel->_waveformMax = 0;
+            channel->_waveformSquares = 0;
+
+            if (++channel->_waveformWindow == sWaveformWindowsPer100ms) {
+                channel->_waveformWindow = 0;
+                channel->_waveformFrame  = 0;
+            }
+        }
+    }
+}
+
+
+static inline void sDetectAudibleFrames(const LoudnessMeasurer *self, LoudnessMeasurerChannel *channel, const float *samples, size_t frames)
+{
+    const float threshold = self->_silenceThreshold;
+    const size_t offset = channel->_measuredFrames;
+
+    channel->_measuredFrames += frames;
+
+    // Scan backwards for the last audible frame. In the middle of a track
+    // this stops almost immediately.
+    NSInteger last = frames - 1;
+    while (last >= 0 && fabsf(samples[last]) <= threshold) last--;
+
+    if (last < 0) return;
+
+    channel->_lastAudibleFrame = offset + last;
+
+    if (!channel->_hasAudibleFrame) {
+        size_t first = 0;
+        while (fabsf(samples[first]) <= threshold) first++;
+
+        channel->_firstAudibleFrame = offset + first;
+        channel->_hasAudibleFrame = YES;
+    }
+}
+
+
 static inline void sFilter(const LoudnessMeasurer *self, LoudnessMeasurerChannel *channel, const float* src, size_t inStride, size_t frames)
 {
     if (frames == 0) return;
 
     vDSP_Stride stride = (vDSP_Stride)inStride;
+    BOOL measurePeaks = (channel->_warmUpFrames == 0);
 
-    float max = 0;
-    vDSP_maxv(src, stride, &max, frames);
+    if (measurePeaks) {
+        float max = 0;
+        vDSP_maxv(src, stride, &max, frames);
 
-    float min = 0;
-    vDSP_minv(src, stride, &min, frames);
+        float min = 0;
+        vDSP_minv(src, stride, &min, frames);
 
-    if (-min > max) max = -min;
+        if (-min > max) max = -min;
 
-    if (max > channel->_samplePeak) {
-        channel->_samplePeak = max;
+        if (max > channel->_samplePeak) {
+            channel->_samplePeak = max;
+        }
     }
 
 #if defined(__x86_64__)
@@ -236,6 +427,13 @@ static inline void sFilter(const LoudnessMeasurer *self, LoudnessMeasurerChannel
         bufferPre[i] = s1[i];
     }
 
+    sCalculateTruePeak(channel, bufferPre, frames, measurePeaks);
+    sAccumulateWaveform(self, channel, bufferPre, frames);
+
+    if (measurePeaks) {
+        sDetectAudibleFrames(self, channel, bufferPre, frames);
+    }
+
     sBiquad(s1, s2, self->_coefficients[0], channel->_filterState[0], frames);
     sBiquad(s2, s1, self->_coefficients[1], channel->_filterState[1], frames);
 
@@ -245,6 +443,8 @@ static inline void sFilter(const LoudnessMeasurer *self, LoudnessMeasurerChannel
         bufferPost[i] = s1[i];
     }
 
+    sAccumulateSegments(self, channel, s1, frames);
+
 #if defined(__x86_64__)
     _mm_setcsr(mxcsr);
 #endif
@@ -357,6 +557,21 @@ static inline void sCalculateGatingBlock(const LoudnessMeasurer *self, LoudnessM
 }
 
 
+static void sFinishWarmUp(LoudnessMeasurerChannel *channel, size_t frames)
+{
+    if (!channel->_warmUpFrames) return;
+
+    channel->_warmUpFrames -= MIN(channel->_warmUpFrames, frames);
+
+    if (!channel->_warmUpFrames) {
+        channel->_blocksStart   = channel->_blocksCount;
+        channel->_overviewStart = channel->_overviewCount;
+        channel->_segmentsStart = channel->_segmentsCount;
+        channel->_waveformStart = channel->_waveformCount;
+    }
+}
+
+
 static void sProcess(const LoudnessMeasurer *self, LoudnessMeasurerChannel *channel, const float *source, size_t stride, size_t inFrames)
 {
     size_t index = 0;
@@ -364,10 +579,12 @@ static void sProcess(const LoudnessMeasurer *self, LoudnessMeasurerChannel *chan
 
     while (frames > 0) {
         if (frames >= channel->_neededFrames) {
-            sFilter(self, channel, source + (index * stride), stride, channel->_neededFrames);
-            index  += channel->_neededFrames;
-            frames -= channel->_neededFrames;
-            channel->_bufferIndex += channel->_neededFrames;
+            size_t neededFrames = channel->_neededFrames;
+
+            sFilter(self, channel, source + (index * stride), stride, neededFrames);
+            index  += neededFrames;
+            frames -= neededFrames;
+            channel->_bufferIndex += neededFrames;
             
             sCalculateGatingBlock(self, channel, self->_samplesIn400ms);
             sCalculateOverview(self, channel, self->_samplesIn100ms / 10, 40);
@@ -379,18 +596,29 @@ static void sProcess(const LoudnessMeasurer *self, LoudnessMeasurerChannel *chan
                 channel->_bufferIndex = 0;
             }
 
+            // Warm-up ends on a block boundary, after the block which ends there
+            sFinishWarmUp(channel, neededFrames);
+
         } else {
             sFilter(self, channel, source + (index * stride), stride, frames);
 
             channel->_bufferIndex  += frames;
             channel->_neededFrames -= frames;
 
+            sFinishWarmUp(channel, frames);
+
             frames = 0;
         }
     }
 }
 
 
+void LoudnessMeasurerSetSilenceThreshold(LoudnessMeasurer *self, double dBFS)
+{
+    self->_silenceThreshold = pow(10.0, dBFS / 20.0);
+}
+
+
 void LoudnessMeasurerScanAudioBuffer(LoudnessMeasurer *self, AudioBufferList *bufferList, size_t inFrames)
 {
     dispatch_apply(self->_channelCount, dispatch_get_global_queue(0, 0), ^(size_t c) {
@@ -400,6 +628,66 @@ void LoudnessMeasurerScanAudioBuffer(LoudnessMeasurer *self, AudioBufferList *bu
 }
 
 
+static void sAppendValues(double *values, size_t *count, size_t capacity, const double *source, size_t sourceCount)
+{
+    size_t toCopy = MIN(sourceCount, capacity - *count);
+
+    memcpy(values + *count, source, toCopy * sizeof(double));
+    *count += toCopy;
+}
+
+
+void LoudnessMeasurerAppendSegment(LoudnessMeasurer *self, const LoudnessMeasurer *segment)
+{
+    size_t channelCount = MIN(self->_channelCount, segment->_channelCount);
+
+    for (size_t c = 0; c < channelCount; c++) {
+        LoudnessMeasurerChannel *channel = &self->_channels[c];
+        const LoudnessMeasurerChannel *other = &segment->_channels[c];
+
+        // The segment ended during warm-up, nothing was measured
+        if (other->_warmUpFrames) continue;
+
+        sAppendValues(channel->_blocks, &channel->_blocksCount, channel->_blocksCapacity,
+            other->_blocks + other->_blocksStart, other->_blocksCount - other->_blocksStart);
+
+        sAppendValues(channel->_segments, &channel->_segmentsCount, channel->_segmentsCapacity,
+            other->_segments + other->_segmentsStart, other->_segmentsCount - other->_segmentsStart);
+
+        size_t waveformCount = MIN(other->_waveformCount - other->_waveformStart, channel->_waveformCapacity - channel->_waveformCount);
+        memcpy(channel->_waveform + (channel->_waveformCount * 3), other->_waveform + (other->_waveformStart * 3), waveformCount * sizeof(float) * 3);
+        channel->_waveformCount += waveformCount;
+
+        size_t overviewCount = MIN(other->_overviewCount - other->_overviewStart, channel->_overviewCapacity - channel->_overviewCount);
+        memcpy(channel->_overview + channel->_overviewCount, other->_overview + other->_overviewStart, overviewCount * sizeof(float));
+        channel->_overviewCount += overviewCount;
+
+        if (other->_hasAudibleFrame) {
+            if (!channel->_hasAudibleFrame) {
+                channel->_firstAudibleFrame = channel->_measuredFrames + other->_firstAudibleFrame;
+                channel->_hasAudibleFrame = YES;
+            }
+
+            channel->_lastAudibleFrame = channel->_measuredFrames + other->_lastAudibleFrame;
+        }
+
+        channel->_measuredFrames += other->_measuredFrames;
+
+        if (other->_samplePeak > channel->_samplePeak) channel->_samplePeak = other->_samplePeak;
+        if (other->_truePeak   > channel->_truePeak)   channel->_truePeak   = other->_truePeak;
+
+        channel->_segmentEnergy = other->_segmentEnergy;
+        channel->_segmentFrames = other->_segmentFrames;
+
+        channel->_waveformWindow  = other->_waveformWindow;
+        channel->_waveformFrame   = other->_waveformFrame;
+        channel->_waveformMin     = other->_waveformMin;
+        channel->_waveformMax     = other->_waveformMax;
+        channel->_waveformSquares = other->_waveformSquares;
+    }
+}
+
+
 NSData *LoudnessMeasurerGetOverview(LoudnessMeasurer *self)
 {
     size_t  overviewCount = self->_channels[0]._overviewCount;
@@ -425,6 +713,44 @@ NSData *LoudnessMeasurerGetOverview(LoudnessMeasurer *self)
 }
 
 
+NSData *LoudnessMeasurerGetWaveform(LoudnessMeasurer *self)
+{
+    size_t count = self->_channels[0]._waveformCount;
+
+    for (size_t c = 1; c < self->_channelCount; c++) {
+        count = MIN(count, self->_channels[c]._waveformCount);
+    }
+
+    float *mins        = malloc(MAX(count, 1) * sizeof(float));
+    float *maxs        = malloc(MAX(count, 1) * sizeof(float));
+    float *meanSquares = malloc(MAX(count, 1) * sizeof(float));
+
+    for (size_t i = 0; i < count; i++) {
+        float min = 0, max = 0, sum = 0;
+
+        for (size_t c = 0; c < self->_channelCount; c++) {
+            const float *entry = &self->_channels[c]._waveform[i * 3];
+
+            if (entry[0] < min) min = entry[0];
+            if (entry[1] > max) max = entry[1];
+            sum += entry[2];
+        }
+
+        mins[i]        = min;
+        maxs[i]        = max;
+        meanSquares[i] = self->_channelCount ? (sum / self->_channelCount) : 0;
+    }
+
+    NSData *result = WaveformPyramidCreateData(mins, maxs, meanSquares, count, sWaveformWindowsPer100ms * 10);
+
+    free(mins);
+    free(maxs);
+    free(meanSquares);
+
+    return result;
+}
+
+
 double LoudnessMeasurerGetLoudness(LoudnessMeasurer *self)
 {
     static double sRelativeGateFactor = 0;
@@ -493,6 +819,30 @@ double LoudnessMeasurerGetLoudness(LoudnessMeasurer *self)
 }
 
 
+BOOL LoudnessMeasurerGetAudibleFrames(LoudnessMeasurer *self, size_t *outFirstFrame, size_t *outLastFrame)
+{
+    BOOL   hasAudibleFrame = NO;
+    size_t firstFrame = SIZE_MAX;
+    size_t lastFrame  = 0;
+
+    for (size_t c = 0; c < self->_channelCount; c++) {
+        LoudnessMeasurerChannel *channel = &self->_channels[c];
+        if (!channel->_hasAudibleFrame) continue;
+
+        hasAudibleFrame = YES;
+        firstFrame = MIN(firstFrame, channel->_firstAudibleFrame);
+        lastFrame  = MAX(lastFrame,  channel->_lastAudibleFrame);
+    }
+
+    if (!hasAudibleFrame) return NO;
+
+    if (outFirstFrame) *outFirstFrame = firstFrame;
+    if (outLastFrame)  *outLastFrame  = lastFrame;
+
+    return YES;
+}
+
+
 double LoudnessMeasurerGetPeak(LoudnessMeasurer *self)
 {
     double result = 0;
@@ -507,3 +857,136 @@ double LoudnessMeasurerGetPeak(LoudnessMeasurer *self)
     return result;
 }
 
+
+double LoudnessMeasurerGetTruePeak(LoudnessMeasurer *self)
+{
+    double result = 0;
+
+    for (int c = 0; c < self->_channelCount; c++) {
+        LoudnessMeasurerChannel *channel = &self->_channels[c];
+
+        if (channel->_truePeak > result) {
+            result = channel->_truePeak;
+        }
+
+        if (channel->_samplePeak > result) {
+            result = channel->_samplePeak;
+        }
+    }
+
+    return result;
+}
+
+
+// Mean square of each short-term (3s) window, one per 100ms segment. The
+// first windows are shorter than 3s. Caller frees.
+//
+static double *sCopyShortTermPowers(LoudnessMeasurer *self, size_t *outCount)
+{
+    size_t segmentsCount = self->_channels[0]._segmentsCount;
+    double *powers = malloc(sizeof(double) * (segmentsCount ? segmentsCount : 1));
+
+    double windowSum = 0;
+
+    for (size_t i = 0; i < segmentsCount; i++) {
+        for (int c = 0; c < self->_channelCount; c++) {
+            windowSum += self->_channels[c]._segments[i];
+
+            if (i >= sShortTermSegmentCount) {
+                windowSum -= self->_channels[c]._segments[i - sShortTermSegmentCount];
+            }
+        }
+
+        size_t windowSegments = (i + 1) < sShortTermSegmentCount ? (i + 1) : sShortTermSegmentCount;
+        double power = windowSum / (double)(windowSegments * self->_samplesIn100ms);
+
+        powers[i] = power > 0 ? power : 0;
+    }
+
+    *outCount = segmentsCount;
+
+    return powers;
+}
+
+
+static double sGetLoudnessWithPower(double power)
+{
+    if (power <= 0) return sMinimumLoudness;
+
+    double loudness = 10 * (log(power) / log(10.0)) - 0.691;
+    return loudness < sMinimumLoudness ? sMinimumLoudness : loudness;
+}
+
+
+static int sCompareDoubles(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+
+    return (da > db) - (da < db);
+}
+
+
+NSData *LoudnessMeasurerGetShortTermLoudness(LoudnessMeasurer *self)
+{
+    size_t  count  = 0;
+    double *powers = sCopyShortTermPowers(self, &count);
+    float  *result = malloc(sizeof(float) * (count ? count : 1));
+
+    for (size_t i = 0; i < count; i++) {
+        result[i] = sGetLoudnessWithPower(powers[i]);
+    }
+
+    free(powers);
+
+    return [[NSData alloc] initWithBytesNoCopy:result length:(count * sizeof(float)) freeWhenDone:YES];
+}
+
+
+// EBU Tech 3342
+double LoudnessMeasurerGetLoudnessRange(LoudnessMeasurer *self)
+{
+    double absoluteGate = pow(10.0, (-70.0 + 0.691) / 10.0);
+    double relativeGateFactor = pow(10.0, -20.0 / 10.0);
+
+    size_t  count  = 0;
+    double *powers = sCopyShortTermPowers(self, &count);
+    size_t  gatedCount = 0;
+    double  gatedSum   = 0;
+
+    // Only full 3s windows, above the absolute gate
+    for (size_t i = sShortTermSegmentCount - 1; i < count; i++) {
+        if (powers[i] >= absoluteGate) {
+            powers[gatedCount++] = powers[i];
+            gatedSum += powers[i];
+        }
+    }
+
+    if (!gatedCount) {
+        free(powers);
+        return 0;
+    }
+
+    double relativeGate = (gatedSum / gatedCount) * relativeGateFactor;
+    size_t loudnessCount = 0;
+
+    for (size_t i = 0; i < gatedCount; i++) {
+        if (powers[i] >= relativeGate) {
+            powers[loudnessCount++] = sGetLoudnessWithPower(powers[i]);
+        }
+    }
+
+    if (!loudnessCount) {
+        free(powers);
+        return 0;
+    }
+
+    qsort(powers, loudnessCount, sizeof(double), sCompareDoubles);
+
+    double low  = powers[(size_t)round((loudnessCount - 1) * 0.10)];
+    double high = powers[(size_t)round((loudnessCount - 1) * 0.95)];
+
+    free(powers);
+
+    return high - low;
+}
@@ -4,7 +4,7 @@
 #import <Foundation/Foundation.h>
 
 @protocol PlayerListener, PlayerTrackProvider;
-@class Player, Track, Effect, HugAudioDevice, HugMeterData;
+@class Player, Track, Effect, HugAudioDevice, HugMeterData, HugLoudnessData;
 
 typedef NS_ENUM(NSInteger, PlayerIssue) {
     PlayerIssueNone = 0,
@@ -52,7 +52,9 @@ extern volatile NSInteger PlayerShouldUseCrashPad;
                  sampleRate: (double) sampleRate
                      frames: (UInt32) frames
                     hogMode: (BOOL) hogMode
-               resetsVolume: (BOOL) resetsVolume;
+               resetsVolume: (BOOL) resetsVolume
+            truePeakLimiter: (BOOL) truePeakLimiter
+               decodedAudio: (BOOL) usesDecodedAudio;
                    
 @property (nonatomic, readonly) HugAudioDevice *outputDevice;
 @property (nonatomic, readonly) double outputSampleRate;
@@ -73,6 +75,7 @@ extern volatile NSInteger PlayerShouldUseCrashPad;
 
 @property (nonatomic, readonly) HugMeterData *leftMeterData;
 @property (nonatomic, readonly) HugMeterData *rightMeterData;
+@property (nonatomic, readonly) HugLoudnessData *loudnessData;
 
 @property (nonatomic, readonly) Float32 dangerAverage;
 @property (nonatomic, readonly) Float32 dangerPeak;
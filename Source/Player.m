@@ -3,6 +3,7 @@
 
 #import "Player.h"
 #import "Track.h"
+#import "DecodedAudioCache.h"
 #import "Effect.h"
 #import "AppDelegate.h"
 #import "EffectType.h"
@@ -12,6 +13,7 @@
 #import "HugAudioSettings.h"
 #import "HugAudioSource.h"
 #import "HugAudioFile.h"
+#import "HugResampler.h"
 
 #import <pthread.h>
 #import <signal.h>
@@ -27,6 +29,26 @@ static NSString * const sStereoBalanceKey = @"stereo-balance";
 
 static double sMaxVolume = 1.0 - (2.0 / 32767.0);
 
+// Tracks longer than this are decoded into a sliding window rather than all at once
+static NSTimeInterval sStreamingBufferDuration = 45.0;
+
+// The next track is preloaded once the current track has this much time remaining
+static NSTimeInterval sPreloadTimeRemaining = 20.0;
+
+// The worker decodes the next track into DecodedAudioCache once the current track has this much time remaining
+static NSTimeInterval sPrepareDecodedAudioTimeRemaining = 60.0;
+
+// Resampling happens on the decoder thread, leaving only copies for the render thread
+static HugResamplerQuality sResamplerQuality = HugResamplerQualityHigh;
+static BOOL sResampleWhileDecoding = YES;
+
+// Times each render node for the Debug window
+#if DEBUG
+static BOOL sRenderProfiling = YES;
+#else
+static BOOL sRenderProfiling = NO;
+#endif
+
 
 @interface Player ()
 @property (nonatomic, strong) Track *currentTrack;
@@ -40,6 +62,8 @@ static double sMaxVolume = 1.0 - (2.0 / 32767.0);
 @implementation Player {
     Track         *_currentTrack;
     NSTimeInterval _currentPadding;
+    BOOL           _didPreloadForCurrentTrack;
+    BOOL           _didPrepareDecodedAudioForCurrentTrack;
 
     HugAudioEngine *_engine;
     
@@ -48,6 +72,8 @@ static double sMaxVolume = 1.0 - (2.0 / 32767.0);
     UInt32          _outputFrames;
     BOOL            _outputHogMode;
     BOOL            _outputResetsVolume;
+    BOOL            _outputTruePeakLimiter;
+    BOOL            _outputUsesDecodedAudio;
     
     AudioDeviceID _listeningDeviceID;
 
@@ -190,6 +216,7 @@ static double sMaxVolume = 1.0 - (2.0 / 32767.0);
     _timeRemaining    = [_engine timeRemaining];
     _leftMeterData    = [_engine leftMeterData];
     _rightMeterData   = [_engine rightMeterData];
+    _loudnessData     = [_engine loudnessData];
     _dangerPeak       = [_engine dangerLevel];
     _lastOverloadTime = [_engine lastOverloadTime];
 
@@ -250,7 +277,76 @@ static double sMaxVolume = 1.0 - (2.0 / 32767.0);
 
     if (done && !_preventNextTrack) {
         [self playNextTrack];
+
+    } else if ((playbackStatus == HugPlaybackStatusPlaying) && (_timeRemaining < sPreloadTimeRemaining)) {
+        [self _preloadNextTrack];
+
+    } else if ((playbackStatus == HugPlaybackStatusPlaying) && (_timeRemaining < sPrepareDecodedAudioTimeRemaining)) {
+        [self _prepareDecodedAudioForNextTrack];
+    }
+}
+
+
+- (void) _prepareDecodedAudioForNextTrack
+{
+    if (_didPrepareDecodedAudioForCurrentTrack || _preventNextTrack) return;
+    if ([_currentTrack stopsAfterPlaying] || !_outputUsesDecodedAudio) return;
+
+    _didPrepareDecodedAudioForCurrentTrack = YES;
+
+    Track *nextTrack = nil;
+    NSTimeInterval padding = 0;
+
+    [_trackProvider player:self getNextTrack:&nextTrack getPadding:&padding];
+
+    [nextTrack prepareDecodedAudio];
+}
+
+
+- (void) _preloadNextTrack
+{
+    if (_didPreloadForCurrentTrack || _preventNextTrack) return;
+    if ([_currentTrack stopsAfterPlaying]) return;
+
+    _didPreloadForCurrentTrack = YES;
+
+    Track *nextTrack = nil;
+    NSTimeInterval padding = 0;
+
+    [_trackProvider player:self getNextTrack:&nextTrack getPadding:&padding];
+
+    if ([_currentTrack ignoresAutoGap]) {
+        padding = 0;
     }
+
+    // Auto Stop is on, or the next track isn't ready. -_setupAndStartPlayback handles these.
+    if (!nextTrack || (padding >= 60)) return;
+    if ([nextTrack isResolvingURLs] || ![nextTrack didAnalyzeLoudness] || [nextTrack error]) return;
+
+    if (![nextTrack fileURL]) return;
+
+    EmbraceLog(@"Player", @"Preloading %@ with padding %g", nextTrack, padding);
+
+    HugAudioFile *file = [self _makeAudioFileWithTrack:nextTrack];
+    [_engine preloadAudioFile:file startTime:[nextTrack startTime] stopTime:[nextTrack stopTime] padding:padding];
+}
+
+
+- (HugAudioFile *) _makeAudioFileWithTrack:(Track *)track
+{
+    NSURL *fileURL = [track fileURL];
+    HugAudioFile *file = [[HugAudioFile alloc] initWithFileURL:fileURL];
+
+    if (_outputUsesDecodedAudio) {
+        NSString *key = [track analysisKey];
+        NSURL *decodedFileURL = [[DecodedAudioCache sharedInstance] fileURLForKey:key sampleRate:_outputSampleRate];
+
+        if (decodedFileURL) EmbraceLog(@"Player", @"Using decoded audio for %@", track);
+
+        [file setDecodedFileURL:decodedFileURL];
+    }
+
+    return file;
 }
 
 
@@ -263,7 +359,10 @@ static double sMaxVolume = 1.0 - (2.0 / 32767.0);
     }
 
     double trackLoudness = [_currentTrack trackLoudness];
-    double trackPeak     = [_currentTrack trackPeak];
+    double trackPeak     = [_currentTrack trackTruePeak];
+
+    // Tracks analyzed before true-peak support only have the sample peak
+    if (!trackPeak) trackPeak = [_currentTrack trackPeak];
 
     double preamp     = _preAmpLevel;
     double replayGain = (-18.0 - trackLoudness);
@@ -497,7 +596,12 @@ static OSStatus sHandleAudioDevicePropertyChanged(AudioObjectID inObjectID, UInt
     if (ok && deviceID) {
         ok = [_engine configureWithDeviceID:deviceID settings:@{
             HugAudioSettingSampleRate: @(_outputSampleRate),
-            HugAudioSettingFrameSize:  @(_outputFrames)
+            HugAudioSettingFrameSize:  @(_outputFrames),
+            HugAudioSettingStreamingBufferDuration: @(sStreamingBufferDuration),
+            HugAudioSettingTruePeakLimiter: @(_outputTruePeakLimiter),
+            HugAudioSettingResamplerQuality: @(sResamplerQuality),
+            HugAudioSettingResampleWhileDecoding: @(sResampleWhileDecoding),
+            HugAudioSettingRenderProfiling: @(sRenderProfiling)
         }];
         
         if (!ok) raiseIssue(PlayerIssueErrorConfiguringOutputDevice);
@@ -552,19 +656,15 @@ static OSStatus sHandleAudioDevicePropertyChanged(AudioObjectID inObjectID, UInt
         return;
     }
 
-    NSURL *fileURL = [track internalURL];
+    NSURL *fileURL = [track fileURL];
     if (!fileURL) {
         EmbraceLog(@"Player", @"No URL for %@!", track);
         [self hardStop];
         return;
     }
     
-    HugAudioFile *file = [[HugAudioFile alloc] initWithFileURL:fileURL];
-    if (![file open]) {
-        EmbraceLog(@"Player", @"Couldn't open %@", file);
-        [self hardStop];
-        return;
-    }
+    // The engine opens the file. It may already be open via -_preloadNextTrack
+    HugAudioFile *file = [self _makeAudioFileWithTrack:track];
 
     [self _updateLoudnessAndPreAmp];
 
@@ -713,8 +813,10 @@ static OSStatus sHandleAudioDevicePropertyChanged(AudioObjectID inObjectID, UInt
     [self setCurrentTrack:nil];
 
     [_engine stopPlayback];
+    [_engine cancelPreload];
 
     _leftMeterData = _rightMeterData = nil;
+    _loudnessData = nil;
     
     for (id<PlayerListener> listener in _listeners) {
         [listener player:self didUpdatePlaying:NO];
@@ -742,14 +844,23 @@ static OSStatus sHandleAudioDevicePropertyChanged(AudioObjectID inObjectID, UInt
                      frames: (UInt32) frames
                     hogMode: (BOOL) hogMode
                resetsVolume: (BOOL) resetsVolume
+            truePeakLimiter: (BOOL) truePeakLimiter
+               decodedAudio: (BOOL) usesDecodedAudio
 {
     EmbraceLog(@"Player", @"updateOutputDevice:%@ sampleRate:%lf frames:%lu hogMode:%ld", self, sampleRate, (unsigned long)frames, (long)hogMode);
 
-    if (_outputDevice       != outputDevice ||
-        _outputSampleRate   != sampleRate   ||
-        _outputFrames       != frames       ||
-        _outputHogMode      != hogMode      ||
-        _outputResetsVolume != resetsVolume)
+    // Doesn't affect the output, so no reconfigure is needed
+    if (_outputUsesDecodedAudio != usesDecodedAudio) {
+        _outputUsesDecodedAudio = usesDecodedAudio;
+        [GetAppDelegate() setDecodedAudioSampleRate:(usesDecodedAudio ? sampleRate : 0)];
+    }
+
+    if (_outputDevice          != outputDevice ||
+        _outputSampleRate      != sampleRate   ||
+        _outputFrames          != frames       ||
+        _outputHogMode         != hogMode      ||
+        _outputResetsVolume    != resetsVolume ||
+        _outputTruePeakLimiter != truePeakLimiter)
     {
         if (_outputDevice != outputDevice) {
             [_outputDevice removeObserver:self forKeyPath:@"connected"];
@@ -758,10 +869,13 @@ static OSStatus sHandleAudioDevicePropertyChanged(AudioObjectID inObjectID, UInt
             [_outputDevice addObserver:self forKeyPath:@"connected" options:0 context:NULL];
         }
 
-        _outputSampleRate   = sampleRate;
-        _outputFrames       = frames;
-        _outputHogMode      = hogMode;
-        _outputResetsVolume = resetsVolume;
+        _outputSampleRate      = sampleRate;
+        _outputFrames          = frames;
+        _outputHogMode         = hogMode;
+        _outputResetsVolume    = resetsVolume;
+        _outputTruePeakLimiter = truePeakLimiter;
+
+        [GetAppDelegate() setDecodedAudioSampleRate:(_outputUsesDecodedAudio ? sampleRate : 0)];
 
         [self _reconfigureOutput];
     }
@@ -787,6 +901,8 @@ static OSStatus sHandleAudioDevicePropertyChanged(AudioObjectID inObjectID, UInt
 {
     if (_currentTrack != currentTrack) {
         _currentTrack = currentTrack;
+        _didPreloadForCurrentTrack = NO;
+        _didPrepareDecodedAudioForCurrentTrack = NO;
         [_currentTrack setTrackStatus:TrackStatusPreparing];
 
         _timeElapsed = 0;
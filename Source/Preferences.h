@@ -88,5 +88,7 @@ extern NSString * const PreferencesDidChangeNotification;
 @property (nonatomic) UInt32          mainOutputFrames;
 @property (nonatomic) BOOL            mainOutputUsesHogMode;
 @property (nonatomic) BOOL            mainOutputResetsVolume;
+@property (nonatomic) BOOL            mainOutputUsesTruePeakLimiter;
+@property (nonatomic) BOOL            mainOutputUsesDecodedAudioCache;
 
 @end
@@ -51,7 +51,9 @@ static NSDictionary *sGetDefaultValues()
         @"mainOutputSampleRate":   @(44100),
         @"mainOutputFrames":       @(2048),
         @"mainOutputUsesHogMode":  @(NO),
-        @"mainOutputResetsVolume": @(YES)
+        @"mainOutputResetsVolume": @(YES),
+        @"mainOutputUsesTruePeakLimiter": @(NO),
+        @"mainOutputUsesDecodedAudioCache": @(YES)
     };
     
     });
@@ -6,6 +6,7 @@
 #import "HugAudioDevice.h"
 
 #import "Track.h"
+#import "DecodedAudioCache.h"
 #import "EffectType.h"
 #import "Effect.h"
 #import "Player.h"
@@ -159,6 +160,7 @@ static NSInteger sAutoGapMaximum = 16;
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_handleTrackDidModifyDuration:)          name:TrackDidModifyDurationNotificationName  object:nil];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_handleTrackDidModifyTitle:)             name:TrackDidModifyTitleNotificationName             object:nil];
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_handleTrackDidModifyExternalURL:)       name:TrackDidModifyExternalURLNotificationName       object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(_handleTrackDidWriteDecodedAudio:)       name:TrackDidWriteDecodedAudioNotificationName       object:nil];
 
     [self _handlePreferencesDidChange:nil];
 
@@ -294,9 +296,11 @@ static NSInteger sAutoGapMaximum = 16;
     UInt32          frames       = [preferences mainOutputFrames];
     BOOL            hogMode      = [preferences mainOutputUsesHogMode];
 
-    BOOL resetsVolume = hogMode && [preferences mainOutputResetsVolume];
+    BOOL resetsVolume    = hogMode && [preferences mainOutputResetsVolume];
+    BOOL truePeakLimiter = [preferences mainOutputUsesTruePeakLimiter];
+    BOOL decodedAudio    = [preferences mainOutputUsesDecodedAudioCache];
     
-    [[Player sharedInstance] updateOutputDevice:device sampleRate:sampleRate frames:frames hogMode:hogMode resetsVolume:resetsVolume];
+    [[Player sharedInstance] updateOutputDevice:device sampleRate:sampleRate frames:frames hogMode:hogMode resetsVolume:resetsVolume truePeakLimiter:truePeakLimiter decodedAudio:decodedAudio];
     
     NSWindow *window = [self window];
     if ([preferences floatsOnTop]) {
@@ -338,6 +342,21 @@ static NSInteger sAutoGapMaximum = 16;
 
 
 
+- (void) _handleTrackDidWriteDecodedAudio:(NSNotification *)note
+{
+    NSMutableSet *keys = [NSMutableSet set];
+
+    // Keep decoded audio for every track in the set
+    for (Track *track in [[self tracksController] tracks]) {
+        NSString *key = [track analysisKey];
+        if (key) [keys addObject:key];
+    }
+
+    [[DecodedAudioCache sharedInstance] trimRetainingKeys:keys];
+}
+
+
+
 - (void) _handleTrackDidModifyDuration:(NSNotification *)note
 {
     if (!_willCalculateStartAndEndTimes) {
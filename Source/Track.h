@@ -6,6 +6,7 @@
 extern NSString * const TrackDidModifyTitleNotificationName;
 extern NSString * const TrackDidModifyExternalURLNotificationName;
 extern NSString * const TrackDidModifyDurationNotificationName;
+extern NSString * const TrackDidWriteDecodedAudioNotificationName;
 
 @class TrackAnalyzer;
 
@@ -43,6 +44,9 @@ typedef NS_ENUM(NSInteger, TrackLabel) {
 - (void) clearAndCleanup;
 - (void) startPriorityAnalysis;
 
+// Asks the worker to write a DecodedAudioCache entry, for a track which plays soon
+- (void) prepareDecodedAudio;
+
 // playedTime represents the absolute timestamp when a track moved from queued to not-queued
 - (NSDate *) playedTimeDate;
 @property (nonatomic, readonly) NSTimeInterval playedTime;
@@ -59,7 +63,9 @@ typedef NS_ENUM(NSInteger, TrackLabel) {
 @property (nonatomic, readonly) BOOL isResolvingURLs;
 @property (nonatomic, readonly) NSURL *externalURL;
 @property (nonatomic, readonly) NSURL *internalURL;
+@property (nonatomic, readonly) NSURL *fileURL; // internalURL, or externalURL while it is being copied
 @property (nonatomic, readonly) NSUUID *UUID;
+@property (nonatomic, readonly) NSString *analysisKey; // AnalysisCache key of fileURL, nil until read
 
 
 // Read/Write
@@ -100,8 +106,21 @@ typedef NS_ENUM(NSInteger, TrackLabel) {
 @property (nonatomic, readonly) NSTimeInterval decodedDuration;
 @property (nonatomic, readonly) double  trackLoudness;
 @property (nonatomic, readonly) double  trackPeak;
+@property (nonatomic, readonly) double  trackTruePeak; // 0 if analyzed before true-peak support
+@property (nonatomic, readonly) double  loudnessRange;
+@property (nonatomic, readonly) NSData *shortTermLoudnessData; // Float32 LUFS
+@property (nonatomic, readonly) double  shortTermLoudnessRate;
 @property (nonatomic, readonly) NSData *overviewData;
 @property (nonatomic, readonly) double  overviewRate;
+@property (nonatomic, readonly) NSData *waveformData; // WaveformPyramid, nil for tracks analyzed by older versions
+
+// Times of the first and last samples above the silence threshold, exact to
+// the frame. audibleStopTime is 0 if analyzed by older versions.
+@property (nonatomic, readonly) NSTimeInterval audibleStartTime;
+@property (nonatomic, readonly) NSTimeInterval audibleStopTime;
+
+// Loudness analysis progress reported by the worker, from 0.0 to 1.0
+@property (nonatomic, readonly) double  analysisProgress;
 
 // Dynamic
 @property (nonatomic, readonly) NSTimeInterval playDuration;
@@ -2,8 +2,12 @@
 // MIT License (or) 1-clause BSD License
 
 #import "Track.h"
+#import "AnalysisCache.h"
+#import "DecodedAudioCache.h"
+#import "InternalFileStore.h"
 #import "MusicAppManager.h"
 #import "TrackKeys.h"
+#import "TrackStateStore.h"
 #import "AppDelegate.h"
 #import "ScriptsManager.h"
 #import "WorkerService.h"
@@ -14,6 +18,7 @@
 NSString * const TrackDidModifyTitleNotificationName       = @"TrackDidModifyTitleNotificationName";
 NSString * const TrackDidModifyExternalURLNotificationName = @"TrackDidModifyExternalURLNotificationName";
 NSString * const TrackDidModifyDurationNotificationName    = @"TrackDidModifyDurationNotificationName";
+NSString * const TrackDidWriteDecodedAudioNotificationName = @"TrackDidWriteDecodedAudioNotificationName";
 
 #define DUMP_UNKNOWN_TAGS 0
 
@@ -22,6 +27,8 @@ static NSString * const sStopsAfterPlayingKey = @"stopsAfterPlaying";
 static NSString * const sIgnoresAutoGapKey    = @"ignoresAutoGap";
 static NSString * const sStatusKey            = @"trackStatus";
 static NSString * const sPlayedTimeKey        = @"playedTime";
+static NSString * const sSilenceAtStartKey    = @"silenceAtStart";
+static NSString * const sSilenceAtEndKey      = @"silenceAtEnd";
 
 
 @interface Track ()
@@ -37,8 +44,16 @@ static NSString * const sPlayedTimeKey        = @"playedTime";
 @property (nonatomic) Tonality tonality;
 @property (nonatomic) double trackLoudness;
 @property (nonatomic) double trackPeak;
+@property (nonatomic) double trackTruePeak;
+@property (nonatomic) double loudnessRange;
+@property (nonatomic) NSData *shortTermLoudnessData;
+@property (nonatomic) double  shortTermLoudnessRate;
 @property (nonatomic) NSData *overviewData;
 @property (nonatomic) double  overviewRate;
+@property (nonatomic) NSData *waveformData;
+@property (nonatomic) NSTimeInterval audibleStartTime;
+@property (nonatomic) NSTimeInterval audibleStopTime;
+@property (nonatomic) double  analysisProgress;
 @property (nonatomic) NSInteger databaseID;
 @property (nonatomic) NSInteger energyLevel;
 @property (nonatomic) NSString *genre;
@@ -60,12 +75,17 @@ static NSString * const sPlayedTimeKey        = @"playedTime";
     BOOL            _dirty;
     BOOL            _cleared;
     BOOL            _priorityAnalysisRequested;
+
+    // Blobs which are in TrackStateStore but haven't been loaded yet
+    BOOL            _overviewDataInStore;
+    BOOL            _shortTermLoudnessDataInStore;
+    BOOL            _waveformDataInStore;
 }
 
 @dynamic playDuration, silenceAtStart, silenceAtEnd, tonality;
 
 
-static NSURL *sGetStateDirectoryURL()
+static NSURL *sGetLegacyStateDirectoryURL()
 {
     NSFileManager *manager = [NSFileManager defaultManager];
     NSString *appSupport = GetApplicationSupportDirectory();
@@ -82,48 +102,17 @@ static NSURL *sGetStateDirectoryURL()
 }
 
 
-static NSURL *sGetStateURLForUUID(NSUUID *UUID)
+static NSURL *sGetLegacyStateURLForUUID(NSUUID *UUID)
 {
     if (!UUID) return nil;
     
-    NSURL *result = [sGetStateDirectoryURL() URLByAppendingPathComponent:[UUID UUIDString]];
+    NSURL *result = [sGetLegacyStateDirectoryURL() URLByAppendingPathComponent:[UUID UUIDString]];
     result = [result URLByAppendingPathExtension:@"plist"];
 
     return result;
 }
 
 
-static NSURL *sGetInternalDirectoryURL()
-{
-    NSFileManager *manager = [NSFileManager defaultManager];
-    NSString *appSupport = GetApplicationSupportDirectory();
-    
-    NSString *files = [appSupport stringByAppendingPathComponent:@"Files"];
-    NSURL *result = [NSURL fileURLWithPath:files];
-
-    if (![manager fileExistsAtPath:files]) {
-        NSError *error = nil;
-        [manager createDirectoryAtURL:result withIntermediateDirectories:YES attributes:nil error:&error];
-    }
-    
-    return result;
-}
-
-
-static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
-{
-    if (!UUID) return nil;
-    
-    NSURL *result = [sGetInternalDirectoryURL() URLByAppendingPathComponent:[UUID UUIDString]];
-
-    if (extension) {
-        result = [result URLByAppendingPathExtension:extension];
-    }
-
-    return result;
-}
-
-
 + (NSSet *) keyPathsForValuesAffectingValueForKey:(NSString *)key
 {
     NSSet *keyPaths = [super keyPathsForValuesAffectingValueForKey:key];
@@ -132,9 +121,9 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     if ([key isEqualToString:@"playDuration"]) {
         affectingKeys = @[ @"duration", @"decodedDuration", @"stopTime", @"startTime" ];
     } else if ([key isEqualToString:@"silenceAtStart"]) {
-        affectingKeys = @[ @"overviewData", @"startTime" ];
+        affectingKeys = @[ @"overviewData", @"audibleStartTime", @"startTime" ];
     } else if ([key isEqualToString:@"silenceAtEnd"]) {
-        affectingKeys = @[ @"overviewData", @"stopTime" ];
+        affectingKeys = @[ @"overviewData", @"audibleStopTime", @"stopTime" ];
     } else if ([key isEqualToString:@"tonality"]) {
         affectingKeys = @[ @"initialKey" ];
     }
@@ -149,21 +138,47 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
 
 + (void) clearPersistedState
 {
+    [[TrackStateStore sharedInstance] removeAllStates];
+
     NSError *error;
-    [[NSFileManager defaultManager] removeItemAtURL:sGetStateDirectoryURL()    error:&error];
-    [[NSFileManager defaultManager] removeItemAtURL:sGetInternalDirectoryURL() error:&error];
+    [[NSFileManager defaultManager] removeItemAtURL:sGetLegacyStateDirectoryURL() error:&error];
+    [[InternalFileStore sharedInstance] removeAllFiles];
 }
 
 
 + (instancetype) trackWithUUID:(NSUUID *)UUID
 {
-    NSURL *stateURL = sGetStateURLForUUID(UUID);
-    NSDictionary *state = stateURL ? [NSDictionary dictionaryWithContentsOfURL:stateURL] : nil;
+    TrackStateStore *store = [TrackStateStore sharedInstance];
+    NSDictionary *state = [store stateForUUID:UUID];
+
+    if (state) {
+        Track *track = [[Track alloc] _initWithUUID:UUID state:state];
+
+        track->_overviewDataInStore          = [store hasBlobForKey:TrackKeyOverviewData          UUID:UUID];
+        track->_shortTermLoudnessDataInStore = [store hasBlobForKey:TrackKeyShortTermLoudnessData UUID:UUID];
+        track->_waveformDataInStore          = [store hasBlobForKey:TrackKeyWaveformData          UUID:UUID];
+
+        return track;
+    }
+
+    // Migrate from a per-track plist
+    NSURL *stateURL = sGetLegacyStateURLForUUID(UUID);
+    state = stateURL ? [NSDictionary dictionaryWithContentsOfURL:stateURL] : nil;
     
     if (!state) return nil;
 
     Track *track = [[Track alloc] _initWithUUID:UUID state:state];
 
+    // Keep the plist until the store has the state on disk
+    if ([track _writeStateToStore]) {
+        [store synchronizeWithCompletionHandler:^(BOOL didWrite) {
+            if (!didWrite) return;
+
+            NSError *error = nil;
+            [[NSFileManager defaultManager] removeItemAtURL:stateURL error:&error];
+        }];
+    }
+
     return track;
 }
 
@@ -271,6 +286,12 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     NSMutableDictionary *state = [NSMutableDictionary dictionary];
     [self _writeStateToDictionary:state];
 
+    // Blobs may not be loaded yet
+    for (NSString *key in [TrackStateStore blobKeys]) {
+        id value = [self valueForKey:key];
+        if (value) [state setObject:value forKey:key];
+    }
+
     Track *result = [[[self class] alloc] _initWithUUID:UUID state:state];
     result->_dirty = YES;
     
@@ -288,8 +309,18 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     BOOL postDurationChanged = NO;
 
     for (NSString *key in state) {
-        id oldValue = [self valueForKey:key];
         id newValue = [state objectForKey:key];
+
+        // Saved so that overviewData doesn't need to be loaded at launch
+        if ([key isEqualToString:sSilenceAtStartKey]) {
+            _silenceAtStart = [newValue doubleValue];
+            continue;
+        } else if ([key isEqualToString:sSilenceAtEndKey]) {
+            _silenceAtEnd = [newValue doubleValue];
+            continue;
+        }
+
+        id oldValue = [self valueForKey:key];
         
         if ([key isEqualToString:TrackKeyError] && [newValue isKindOfClass:[NSData class]]) {
             NSError *unarchiveError = nil;
@@ -318,12 +349,16 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
         }
     }
 
-    NSData   *overviewData = [state objectForKey:TrackKeyOverviewData];
-    NSNumber *startTime    = [state objectForKey:TrackKeyStartTime];
-    NSNumber *stopTime     = [state objectForKey:TrackKeyStopTime];
+    NSData   *overviewData    = [state objectForKey:TrackKeyOverviewData];
+    NSNumber *audibleStopTime = [state objectForKey:TrackKeyAudibleStopTime];
+    NSNumber *startTime       = [state objectForKey:TrackKeyStartTime];
+    NSNumber *stopTime        = [state objectForKey:TrackKeyStopTime];
 
-    if (overviewData || startTime || stopTime) {
-        [self _calculateSilence];
+    // Calculated lazily by -silenceAtStart and -silenceAtEnd. At launch, the
+    // saved values are used, as tracks analyzed by older versions would need
+    // to load overviewData.
+    if (!initialLoad && (overviewData || audibleStopTime || startTime || stopTime)) {
+        [self _invalidateSilence];
     }
     
     if (initialLoad) {
@@ -391,14 +426,52 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     if (_genre)            [state setObject:_genre                forKey:TrackKeyGenre];
     if (_grouping)         [state setObject:_grouping             forKey:TrackKeyGrouping];
     if (_initialKey)       [state setObject:  _initialKey         forKey:TrackKeyInitialKey];
+    if (_loudnessRange)    [state setObject:@(_loudnessRange)     forKey:TrackKeyLoudnessRange];
     if (_overviewData)     [state setObject:  _overviewData       forKey:TrackKeyOverviewData];
     if (_overviewRate)     [state setObject:@(_overviewRate)      forKey:TrackKeyOverviewRate];
+    if (_waveformData)     [state setObject:  _waveformData       forKey:TrackKeyWaveformData];
+
+    if (_audibleStartTime) [state setObject:@(_audibleStartTime)  forKey:TrackKeyAudibleStartTime];
+    if (_audibleStopTime)  [state setObject:@(_audibleStopTime)   forKey:TrackKeyAudibleStopTime];
+
+    if (_shortTermLoudnessData) [state setObject:  _shortTermLoudnessData  forKey:TrackKeyShortTermLoudnessData];
+    if (_shortTermLoudnessRate) [state setObject:@(_shortTermLoudnessRate) forKey:TrackKeyShortTermLoudnessRate];
+
     if (_startTime)        [state setObject:@(_startTime)         forKey:TrackKeyStartTime];
     if (_stopTime)         [state setObject:@(_stopTime)          forKey:TrackKeyStopTime];
     if (_title)            [state setObject:_title                forKey:TrackKeyTitle];
     if (_trackLoudness)    [state setObject:@(_trackLoudness)     forKey:TrackKeyTrackLoudness];
     if (_trackPeak)        [state setObject:@(_trackPeak)         forKey:TrackKeyTrackPeak];
+    if (_trackTruePeak)    [state setObject:@(_trackTruePeak)     forKey:TrackKeyTrackTruePeak];
     if (_year)             [state setObject:@(_year)              forKey:TrackKeyYear];
+
+    if (!isnan(_silenceAtStart)) [state setObject:@(_silenceAtStart) forKey:sSilenceAtStartKey];
+    if (!isnan(_silenceAtEnd))   [state setObject:@(_silenceAtEnd)   forKey:sSilenceAtEndKey];
+}
+
+
+- (BOOL) _writeStateToStore
+{
+    if (!_bookmark || _cleared || !_UUID) return NO;
+
+    TrackStateStore *store = [TrackStateStore sharedInstance];
+
+    NSMutableDictionary *state = [NSMutableDictionary dictionary];
+    [self _writeStateToDictionary:state];
+
+    // Only write blobs which changed, or which the store doesn't have
+    NSMutableDictionary *blobs = [NSMutableDictionary dictionary];
+
+    for (NSString *key in [TrackStateStore blobKeys]) {
+        NSData *blob = [state objectForKey:key];
+        [state removeObjectForKey:key];
+
+        if (blob && ([_dirtyKeys containsObject:key] || ![store hasBlobForKey:key UUID:_UUID])) {
+            [blobs setObject:blob forKey:key];
+        }
+    }
+
+    return [store setState:state blobs:blobs forUUID:_UUID];
 }
 
 
@@ -410,12 +483,7 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     // This track is dead
     if (_cleared) return;
 
-    NSMutableDictionary *state = [NSMutableDictionary dictionary];
-
-    [self _writeStateToDictionary:state];
-
-    NSURL *url = _UUID ? sGetStateURLForUUID(_UUID) : nil;
-    if (url) [state writeToURL:url atomically:YES];
+    [self _writeStateToStore];
     
     _dirty = NO;
     [_dirtyKeys removeAllObjects];
@@ -439,6 +507,9 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     if (_dirty) {
         [self _reallySaveState];
     }
+
+    // Only waits on the disk for the first track after a write
+    [[TrackStateStore sharedInstance] synchronize];
 }
 
 
@@ -458,16 +529,14 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     _internalURL = internalURL;
     _externalURL = externalURL;
 
+    // Analysis reads from externalURL until the internal copy finishes
+    if (!_internalURL && _externalURL) {
+        [self _copyExternalURLToInternalStore];
+    }
+
     [self _readMetadataViaManagerWithFileURL:externalURL];
     [self _requestWorkerCommand:WorkerTrackCommandReadMetadata];
-
-    if (!_overviewData) {
-        if (_priorityAnalysisRequested) {
-            [self _requestWorkerCommand:WorkerTrackCommandReadLoudnessImmediate];
-        } else {
-            [self _requestWorkerCommand:WorkerTrackCommandReadLoudness];
-        }
-    }
+    [self _readAnalysisKeyAndCachedLoudness];
      
     if (_dirty) {
         [self _saveStateImmediately:YES];
@@ -481,6 +550,39 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
 }
 
 
+- (void) _copyExternalURLToInternalStore
+{
+    __weak id weakSelf = self;
+    NSURL *externalURL = _externalURL;
+
+    [[InternalFileStore sharedInstance] copyFileAtURL:externalURL UUID:_UUID completionHandler:^(NSURL *fileURL, NSError *error) {
+        [weakSelf _handleCopiedInternalURL:fileURL error:error];
+    }];
+}
+
+
+- (void) _handleCopiedInternalURL:(NSURL *)internalURL error:(NSError *)error
+{
+    if (_cleared) {
+        [[InternalFileStore sharedInstance] removeFileAtURL:internalURL];
+        return;
+    }
+
+    // Playback and analysis keep using externalURL. The copy is retried the
+    // next time the bookmark resolves.
+    if (!internalURL) {
+        EmbraceLog(@"Track", @"%@, failed to copy to internal location, using %@: %@", self, _externalURL, error);
+        return;
+    }
+
+    EmbraceLog(@"Track", @"%@, copied %@ to internal location: %@", self, _externalURL, internalURL);
+
+    [self willChangeValueForKey:@"internalURL"];
+    _internalURL = internalURL;
+    [self didChangeValueForKey:@"internalURL"];
+}
+
+
 - (void) _resolveExternalURL:(NSURL *)inURL bookmark:(NSData *)inBookmark
 {
     static dispatch_queue_t sResolverQueue = NULL;
@@ -564,22 +666,15 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
                 }
             }
 
-            NSString *extension = [externalURL pathExtension];
-            internalURL = sGetInternalURLForUUID(UUID, extension);
+            InternalFileStore *fileStore = [InternalFileStore sharedInstance];
 
-            if (![[NSFileManager defaultManager] fileExistsAtPath:[internalURL path]]) {
-                if (externalURL) {
-                    if (![[NSFileManager defaultManager] copyItemAtURL:externalURL toURL:internalURL error:&error]) {
-                        EmbraceLog(@"Track", @"%@, failed to copy to internal location: %@", self, error);
+            // Hard link or clone when possible, otherwise internalURL stays nil and
+            // -_handleResolvedExternalURL: starts a background copy
+            internalURL = [fileStore fileURLForUUID:UUID extension:[externalURL pathExtension]];
+            if (!internalURL) internalURL = [fileStore linkFileAtURL:externalURL UUID:UUID];
 
-                        dispatch_async(dispatch_get_main_queue(), ^{
-                            setErrorToOpenFailed();
-                        });
-
-                    } else {
-                        EmbraceLog(@"Track", @"%@, copied %@ to internal location: %@", self, externalURL, internalURL);
-                    }
-                }
+            if (internalURL) {
+                EmbraceLog(@"Track", @"%@, linked %@ to internal location: %@", self, externalURL, internalURL);
             }
 
             dispatch_async(dispatch_get_main_queue(), ^{
@@ -610,10 +705,25 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
 
 - (void) _calculateSilence
 {
-    if (!_overviewData || !_overviewRate) return;
+    // Exact times from the analysis pass
+    if (_audibleStopTime) {
+        NSTimeInterval stopTime = _stopTime;
+
+        if (!stopTime) stopTime = _decodedDuration;
+        if (!stopTime) stopTime = _duration;
+
+        _silenceAtStart = MAX(0, _audibleStartTime - _startTime);
+        _silenceAtEnd   = MAX(0, stopTime - _audibleStopTime);
+
+        return;
+    }
+
+    // Tracks analyzed by older versions, to within 10ms
+    NSData *overviewData = [self overviewData];
+    if (!overviewData || !_overviewRate) return;
 
-    UInt8     *buffer      = (UInt8 *)[_overviewData bytes];
-    NSUInteger length      = [_overviewData length];
+    UInt8     *buffer      = (UInt8 *)[overviewData bytes];
+    NSUInteger length      = [overviewData length];
     UInt8      threshold   = 4;
 
     // Calculate silence at start
@@ -663,6 +773,45 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
 }
 
 
+// Hashing the file takes several reads, so the key is read once here rather
+// than by Player when the track starts
+- (void) _readAnalysisKeyAndCachedLoudness
+{
+    __weak id weakSelf = self;
+    NSURL *fileURL = [self fileURL];
+    BOOL needsLoudness = ![self didAnalyzeLoudness];
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        AnalysisCache *cache = [AnalysisCache sharedInstance];
+        NSString *key = [cache keyForFileURL:fileURL];
+        NSDictionary *results = needsLoudness ? [cache resultsForKey:key] : nil;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf _handleAnalysisKey:key cachedLoudness:results];
+        });
+    });
+}
+
+
+- (void) _handleAnalysisKey:(NSString *)key cachedLoudness:(NSDictionary *)results
+{
+    _analysisKey = key;
+
+    if ([self didAnalyzeLoudness]) return;
+
+    if (results) {
+        EmbraceLog(@"Track", @"%@ using cached loudness", self);
+        [self _updateState:results initialLoad:NO];
+
+    } else if (_priorityAnalysisRequested) {
+        [self _requestWorkerCommand:WorkerTrackCommandReadLoudnessImmediate];
+
+    } else {
+        [self _requestWorkerCommand:WorkerTrackCommandReadLoudness];
+    }
+}
+
+
 - (void) _requestWorkerCancel
 {
     id<WorkerProtocol> worker = [GetAppDelegate() workerProxyWithErrorHandler:^(NSError *error) {
@@ -670,6 +819,7 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     }];
 
     [worker cancelUUID:[self UUID]];
+    [GetAppDelegate() removeWorkerProgressHandlerForUUID:[self UUID]];
 }
 
 
@@ -678,7 +828,7 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     __weak id weakSelf = self;
 
     NSUUID *UUID        = [self UUID];
-    NSURL  *internalURL = [self internalURL];
+    NSURL  *fileURL     = [self fileURL];
     NSURL  *externalURL = [self externalURL];
 
     EmbraceLog(@"Track", @"%@ requesting worker command %ld", self, (long)command);
@@ -689,14 +839,41 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     
     
     NSError *error = nil;
-    NSData  *bookmarkData = [internalURL bookmarkDataWithOptions:0 includingResourceValuesForKeys:nil relativeToURL:nil error:&error];
+    NSData  *bookmarkData = [fileURL bookmarkDataWithOptions:0 includingResourceValuesForKeys:nil relativeToURL:nil error:&error];
 
     NSString *originalFilename = [externalURL lastPathComponent];
+
+    BOOL isLoudnessCommand = (command == WorkerTrackCommandReadLoudness || command == WorkerTrackCommandReadLoudnessImmediate);
+
+    if (isLoudnessCommand) {
+        [GetAppDelegate() setWorkerProgressHandler:^(double progress) {
+            [weakSelf setAnalysisProgress:progress];
+        } forUUID:UUID];
+    }
     
     [worker performTrackCommand:command UUID:UUID bookmarkData:bookmarkData originalFilename:originalFilename reply: ^(NSDictionary *dictionary) {
         dispatch_async(dispatch_get_main_queue(), ^{
             id strongSelf = weakSelf;
+
+            // An empty reply means the worker skipped or cancelled the command
+            BOOL didRun = ([dictionary count] > 0);
+
+            if (isLoudnessCommand) {
+                [GetAppDelegate() removeWorkerProgressHandlerForUUID:UUID];
+                if (didRun) [strongSelf setAnalysisProgress:1.0];
+            }
         
+            if (command == WorkerTrackCommandWriteDecodedAudio) {
+                EmbraceLog(@"Track", @"%@ worker finished decoded audio", self);
+                [[NSNotificationCenter defaultCenter] postNotificationName:TrackDidWriteDecodedAudioNotificationName object:strongSelf];
+                return;
+            }
+
+            if (!didRun) {
+                EmbraceLog(@"Track", @"%@ worker did not run command %ld", self, (long)command);
+                return;
+            }
+
             if (command == WorkerTrackCommandReadMetadata) {
                 EmbraceLog(@"Track", @"%@ received metadata from worker: %@", self, dictionary);
             } else if (command == WorkerTrackCommandReadLoudness) {
@@ -771,9 +948,8 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
 
 - (void) clearAndCleanup
 {
-    NSError *error = nil;
-    [[NSFileManager defaultManager] removeItemAtURL:sGetStateURLForUUID(_UUID) error:&error];
-    if (_internalURL) [[NSFileManager defaultManager] removeItemAtURL:_internalURL error:&error];
+    [[TrackStateStore sharedInstance] removeStateForUUID:_UUID];
+    [[InternalFileStore sharedInstance] removeFileAtURL:_internalURL];
 
     _cleared = YES;
 }
@@ -784,15 +960,35 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
     if (!_priorityAnalysisRequested) {
         _priorityAnalysisRequested = YES;
         
-        if ([self internalURL]) {
+        if ([self fileURL]) {
             [self _requestWorkerCommand:WorkerTrackCommandReadLoudnessImmediate];
         }
     }
 }
 
 
+- (void) prepareDecodedAudio
+{
+    if (!_analysisKey || ![self didAnalyzeLoudness]) return;
+
+    DecodedAudioCache *decodedCache = [DecodedAudioCache sharedInstance];
+    double sampleRate = [decodedCache sampleRate];
+
+    // Disabled, or already written
+    if (!sampleRate || [decodedCache fileURLForKey:_analysisKey sampleRate:sampleRate]) return;
+
+    [self _requestWorkerCommand:WorkerTrackCommandWriteDecodedAudio];
+}
+
+
 #pragma mark - Accessors
 
+- (NSURL *) fileURL
+{
+    return _internalURL ? _internalURL : _externalURL;
+}
+
+
 - (NSDate *) playedTimeDate
 {
     return _playedTime ? [NSDate dateWithTimeIntervalSinceReferenceDate:_playedTime] : nil;
@@ -943,7 +1139,40 @@ static NSURL *sGetInternalURLForUUID(NSUUID *UUID, NSString *extension)
 
 - (BOOL) didAnalyzeLoudness
 {
-    return (_overviewData != nil);
+    return _overviewData || _overviewDataInStore;
+}
+
+
+- (NSData *) overviewData
+{
+    if (!_overviewData && _overviewDataInStore) {
+        _overviewData = [[TrackStateStore sharedInstance] blobForKey:TrackKeyOverviewData UUID:_UUID];
+        _overviewDataInStore = NO;
+    }
+
+    return _overviewData;
+}
+
+
+- (NSData *) shortTermLoudnessData
+{
+    if (!_shortTermLoudnessData && _shortTermLoudnessDataInStore) {
+        _shortTermLoudnessData = [[TrackStateStore sharedInstance] blobForKey:TrackKeyShortTermLoudnessData UUID:_UUID];
+        _shortTermLoudnessDataInStore = NO;
+    }
+
+    return _shortTermLoudnessData;
+}
+
+
+- (NSData *) waveformData
+{
+    if (!_waveformData && _waveformDataInStore) {
+        _waveformData = [[TrackStateStore sharedInstance] blobForKey:TrackKeyWaveformData UUID:_UUID];
+        _waveformDataInStore = NO;
+    }
+
+    return _waveformData;
 }
 
 
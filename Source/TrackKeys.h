@@ -19,8 +19,15 @@ extern NSString * const TrackKeyInitialKey;
 extern NSString * const TrackKeyTonality;
 extern NSString * const TrackKeyTrackLoudness;
 extern NSString * const TrackKeyTrackPeak;
+extern NSString * const TrackKeyTrackTruePeak;
+extern NSString * const TrackKeyLoudnessRange;
+extern NSString * const TrackKeyShortTermLoudnessData;
+extern NSString * const TrackKeyShortTermLoudnessRate;
 extern NSString * const TrackKeyOverviewData;
 extern NSString * const TrackKeyOverviewRate;
+extern NSString * const TrackKeyWaveformData;
+extern NSString * const TrackKeyAudibleStartTime;
+extern NSString * const TrackKeyAudibleStopTime;
 extern NSString * const TrackKeyBPM;
 extern NSString * const TrackKeyDatabaseID;
 extern NSString * const TrackKeyGrouping;
@@ -22,8 +22,15 @@ NSString * const TrackKeyInitialKey       = @"initialKey";
 NSString * const TrackKeyTonality         = @"tonality";
 NSString * const TrackKeyTrackLoudness    = @"trackLoudness";
 NSString * const TrackKeyTrackPeak        = @"trackPeak";
+NSString * const TrackKeyTrackTruePeak    = @"trackTruePeak";
+NSString * const TrackKeyLoudnessRange    = @"loudnessRange";
+NSString * const TrackKeyShortTermLoudnessData = @"shortTermLoudnessData";
+NSString * const TrackKeyShortTermLoudnessRate = @"shortTermLoudnessRate";
 NSString * const TrackKeyOverviewData     = @"overviewData";
 NSString * const TrackKeyOverviewRate     = @"overviewRate";
+NSString * const TrackKeyWaveformData     = @"waveformData";
+NSString * const TrackKeyAudibleStartTime = @"audibleStartTime";
+NSString * const TrackKeyAudibleStopTime  = @"audibleStopTime";
 NSString * const TrackKeyBPM              = @"beatsPerMinute";
 NSString * const TrackKeyDatabaseID       = @"databaseID";
 NSString * const TrackKeyGrouping         = @"grouping";
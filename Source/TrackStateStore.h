@@ -0,0 +1,48 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import <Foundation/Foundation.h>
+
+
+// Single-file store for Track state, replacing one plist per track.
+//
+// The file is an append-only log of checksummed, fixed-layout records.
+// Large values (overview, waveform, and short-term loudness data) are written as
+// separate blob records and are only read when requested. A track's state
+// record acts as its commit: blob records written before it become visible
+// once it is written, and a record torn by a crash is discarded on open.
+//
+// Opening the store maps the file and reads record headers only. When most
+// of the file is made up of superseded records, it is compacted into a new
+// file which atomically replaces the old one.
+//
+// Main thread only. Records are written on a background queue, and reach
+// the disk in batches rather than once per write.
+//
+@interface TrackStateStore : NSObject
+
++ (instancetype) sharedInstance;
+
+// State keys which are stored out of line
++ (NSArray<NSString *> *) blobKeys;
+
+- (NSDictionary *) stateForUUID:(NSUUID *)UUID;
+
+- (NSData *) blobForKey:(NSString *)key UUID:(NSUUID *)UUID;
+- (BOOL) hasBlobForKey:(NSString *)key UUID:(NSUUID *)UUID;
+
+// Existing blobs which aren't in blobs are kept
+- (BOOL) setState:(NSDictionary *)state blobs:(NSDictionary<NSString *, NSData *> *)blobs forUUID:(NSUUID *)UUID;
+
+- (void) removeStateForUUID:(NSUUID *)UUID;
+- (void) removeAllStates;
+
+// Blocks until every queued record is on disk. Cheap if nothing was written
+// since the last call.
+- (void) synchronize;
+
+// Calls completionHandler on the main queue once every queued record is on
+// disk, with NO if any of them couldn't be written
+- (void) synchronizeWithCompletionHandler:(void (^)(BOOL didWrite))completionHandler;
+
+@end
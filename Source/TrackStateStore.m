@@ -0,0 +1,668 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import "TrackStateStore.h"
+#import "TrackKeys.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static UInt32 const sFileMagic    = 'ETSS';
+static UInt32 const sFileVersion  = 1;
+static UInt32 const sRecordMagic  = 'ETSR';
+
+// Compact when superseded records make up more than half of a file this large
+static UInt64 const sCompactionMinimumSize = 1024 * 1024;
+
+// Writes within this interval share one F_FULLFSYNC
+static NSTimeInterval const sSyncDelay = 2.0;
+
+typedef NS_ENUM(UInt16, TrackStateRecordType) {
+    TrackStateRecordTypeState  = 1, // Binary plist, commits preceding blobs
+    TrackStateRecordTypeBlob   = 2, // Raw bytes
+    TrackStateRecordTypeRemove = 3  // No payload
+};
+
+typedef struct {
+    UInt32 magic;
+    UInt32 version;
+    UInt64 reserved;
+} TrackStateFileHeader;
+
+typedef struct {
+    UInt32 magic;
+    UInt16 type;
+    UInt16 blobIndex;
+    UInt32 length;          // Payload length, the payload is padded to 8 bytes
+    UInt32 headerChecksum;  // Of this header, with headerChecksum set to 0
+    uuid_t uuid;
+    UInt64 payloadChecksum;
+} TrackStateRecordHeader;
+
+enum {
+    sBlobCount = 3
+};
+
+
+@interface TrackStateStoreEntry : NSObject {
+@public
+    UInt64 _stateOffset;
+    UInt64 _blobOffsets[sBlobCount]; // 0 if missing
+}
+@end
+
+@implementation TrackStateStoreEntry
+@end
+
+
+@implementation TrackStateStore {
+    NSString *_path;
+    int       _fd;
+    UInt8    *_map;
+    UInt64    _mapLength;
+    UInt64    _fileLength;     // Including records which are still queued
+    UInt64    _writtenLength;  // Records before this offset are safe to map
+
+    NSMutableDictionary<NSUUID *, TrackStateStoreEntry *> *_entries;
+
+    // Payloads of queued records by offset, read from here until written
+    NSMutableDictionary<NSNumber *, NSData *> *_queuedPayloads;
+    NSUInteger _generation; // Incremented when the file is replaced
+
+    // Used on _writeQueue only
+    dispatch_queue_t _writeQueue;
+    BOOL _needsSync;
+    BOOL _syncScheduled;
+    BOOL _writeFailed;
+}
+
+
++ (instancetype) sharedInstance
+{
+    static TrackStateStore *sSharedInstance = nil;
+    static dispatch_once_t onceToken;
+
+    dispatch_once(&onceToken, ^{
+        NSString *path = [GetApplicationSupportDirectory() stringByAppendingPathComponent:@"Tracks.store"];
+        sSharedInstance = [[TrackStateStore alloc] _initWithPath:path];
+    });
+
+    return sSharedInstance;
+}
+
+
++ (NSArray<NSString *> *) blobKeys
+{
+    // Order must not change, indices are persisted
+    return @[ TrackKeyOverviewData, TrackKeyShortTermLoudnessData, TrackKeyWaveformData ];
+}
+
+
+- (instancetype) _initWithPath:(NSString *)path
+{
+    if ((self = [super init])) {
+        _path = path;
+        _fd = -1;
+
+        _queuedPayloads = [NSMutableDictionary dictionary];
+        _writeQueue = dispatch_queue_create("TrackStateStore.write", dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0));
+
+        [self _open];
+
+        if (_fileLength > sCompactionMinimumSize && [self _liveLength] < (_fileLength / 2)) {
+            [self _compact];
+        }
+    }
+
+    return self;
+}
+
+
+- (void) dealloc
+{
+    [self _close];
+}
+
+
+#pragma mark - Private Functions
+
+static UInt64 sChecksum(const void *bytes, size_t length)
+{
+    // FNV-1a
+    const UInt8 *b = bytes;
+    UInt64 hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= b[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+static UInt64 sGetPaddedLength(UInt64 length)
+{
+    return (length + 7) & ~7ULL;
+}
+
+
+static UInt32 sGetHeaderChecksum(const TrackStateRecordHeader *header)
+{
+    TrackStateRecordHeader copy = *header;
+    copy.headerChecksum = 0;
+
+    return (UInt32)sChecksum(&copy, sizeof(copy));
+}
+
+
+static void sAppendRecord(NSMutableData *data, TrackStateRecordType type, NSInteger blobIndex, NSUUID *UUID, NSData *payload)
+{
+    TrackStateRecordHeader header = {0};
+
+    header.magic     = sRecordMagic;
+    header.type      = type;
+    header.blobIndex = blobIndex;
+    header.length    = (UInt32)[payload length];
+
+    [UUID getUUIDBytes:header.uuid];
+
+    header.payloadChecksum = sChecksum([payload bytes], [payload length]);
+    header.headerChecksum  = sGetHeaderChecksum(&header);
+
+    [data appendBytes:&header length:sizeof(header)];
+
+    if (payload) {
+        [data appendData:payload];
+        [data increaseLengthBy:(sGetPaddedLength([payload length]) - [payload length])];
+    }
+}
+
+
+#pragma mark - Private Methods
+
+- (void) _close
+{
+    if (_map) munmap(_map, _mapLength);
+    if (_fd >= 0) close(_fd);
+
+    _map = NULL;
+    _mapLength = 0;
+    _fileLength = 0;
+    _writtenLength = 0;
+    _fd = -1;
+}
+
+
+- (BOOL) _remap
+{
+    if (_map) munmap(_map, _mapLength);
+
+    _map = NULL;
+    _mapLength = 0;
+
+    if (_writtenLength == 0) return YES;
+
+    void *map = mmap(NULL, _writtenLength, PROT_READ, MAP_SHARED, _fd, 0);
+    if (map == MAP_FAILED) return NO;
+
+    _map = map;
+    _mapLength = _writtenLength;
+
+    return YES;
+}
+
+
+- (const TrackStateRecordHeader *) _headerAtOffset:(UInt64)offset
+{
+    if (offset + sizeof(TrackStateRecordHeader) > _writtenLength) {
+        return NULL;
+    }
+
+    // Records were appended since the last mapping
+    if (offset + sizeof(TrackStateRecordHeader) > _mapLength) {
+        if (![self _remap]) return NULL;
+    }
+
+    return (const TrackStateRecordHeader *)(_map + offset);
+}
+
+
+- (NSData *) _payloadAtOffset:(UInt64)offset
+{
+    NSData *queuedPayload = [_queuedPayloads objectForKey:@(offset)];
+    if (queuedPayload) return queuedPayload;
+
+    const TrackStateRecordHeader *header = [self _headerAtOffset:offset];
+    if (!header) return nil;
+
+    UInt64 end = offset + sizeof(TrackStateRecordHeader) + header->length;
+
+    if (end > _mapLength) {
+        if (end > _writtenLength || ![self _remap]) return nil;
+        header = (const TrackStateRecordHeader *)(_map + offset);
+    }
+
+    const UInt8 *bytes = (const UInt8 *)(header + 1);
+
+    if (sChecksum(bytes, header->length) != header->payloadChecksum) {
+        EmbraceLog(@"TrackStateStore", @"Checksum mismatch at %llu", offset);
+        return nil;
+    }
+
+    return [NSData dataWithBytes:bytes length:header->length];
+}
+
+
+- (UInt64) _recordLengthAtOffset:(UInt64)offset
+{
+    const TrackStateRecordHeader *header = [self _headerAtOffset:offset];
+    return header ? (sizeof(TrackStateRecordHeader) + sGetPaddedLength(header->length)) : 0;
+}
+
+
+- (UInt64) _liveLength
+{
+    UInt64 result = sizeof(TrackStateFileHeader);
+
+    for (TrackStateStoreEntry *entry in [_entries allValues]) {
+        result += [self _recordLengthAtOffset:entry->_stateOffset];
+
+        for (NSInteger i = 0; i < sBlobCount; i++) {
+            if (entry->_blobOffsets[i]) result += [self _recordLengthAtOffset:entry->_blobOffsets[i]];
+        }
+    }
+
+    return result;
+}
+
+
+- (void) _scan
+{
+    NSMutableDictionary *pendingBlobs = [NSMutableDictionary dictionary];
+
+    UInt64 offset = sizeof(TrackStateFileHeader);
+
+    while (offset + sizeof(TrackStateRecordHeader) <= _fileLength) {
+        const TrackStateRecordHeader *header = (const TrackStateRecordHeader *)(_map + offset);
+
+        if (header->magic != sRecordMagic || header->headerChecksum != sGetHeaderChecksum(header)) {
+            break;
+        }
+
+        UInt64 recordLength = sizeof(TrackStateRecordHeader) + sGetPaddedLength(header->length);
+        if (offset + recordLength > _fileLength) break;
+
+        NSUUID *UUID = [[NSUUID alloc] initWithUUIDBytes:header->uuid];
+
+        if (header->type == TrackStateRecordTypeBlob && header->blobIndex < sBlobCount) {
+            NSMutableDictionary *blobs = [pendingBlobs objectForKey:UUID];
+
+            if (!blobs) {
+                blobs = [NSMutableDictionary dictionary];
+                [pendingBlobs setObject:blobs forKey:UUID];
+            }
+
+            [blobs setObject:@(offset) forKey:@(header->blobIndex)];
+
+        } else if (header->type == TrackStateRecordTypeState) {
+            NSDictionary *blobs = [pendingBlobs objectForKey:UUID];
+            [pendingBlobs removeObjectForKey:UUID];
+
+            // Blob payloads are verified when read
+            const UInt8 *payload = (const UInt8 *)(header + 1);
+
+            if (sChecksum(payload, header->length) == header->payloadChecksum) {
+                TrackStateStoreEntry *entry = [_entries objectForKey:UUID];
+
+                if (!entry) {
+                    entry = [[TrackStateStoreEntry alloc] init];
+                    [_entries setObject:entry forKey:UUID];
+                }
+
+                entry->_stateOffset = offset;
+
+                for (NSNumber *blobIndex in blobs) {
+                    entry->_blobOffsets[[blobIndex integerValue]] = [[blobs objectForKey:blobIndex] unsignedLongLongValue];
+                }
+            }
+
+        } else if (header->type == TrackStateRecordTypeRemove) {
+            [_entries removeObjectForKey:UUID];
+            [pendingBlobs removeObjectForKey:UUID];
+        }
+
+        offset += recordLength;
+    }
+
+    // Discard a torn record from an interrupted write
+    if (offset < _fileLength) {
+        EmbraceLog(@"TrackStateStore", @"Truncating %llu bytes at %llu", _fileLength - offset, offset);
+
+        if (ftruncate(_fd, offset) == 0) {
+            _fileLength = _writtenLength = offset;
+        }
+    }
+}
+
+
+- (BOOL) _open
+{
+    _entries = [NSMutableDictionary dictionary];
+
+    _fd = open([_path fileSystemRepresentation], O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (_fd < 0) return NO;
+
+    struct stat s;
+    if (fstat(_fd, &s) != 0) {
+        [self _close];
+        return NO;
+    }
+
+    _fileLength = _writtenLength = s.st_size;
+
+    TrackStateFileHeader header = { sFileMagic, sFileVersion, 0 };
+
+    if (_fileLength < sizeof(header) || ![self _remap] || memcmp(_map, &header, sizeof(header)) != 0) {
+        if (_fileLength > 0) {
+            EmbraceLog(@"TrackStateStore", @"Resetting unreadable store");
+        }
+
+        if (ftruncate(_fd, 0) != 0 || pwrite(_fd, &header, sizeof(header), 0) != sizeof(header)) {
+            [self _close];
+            return NO;
+        }
+
+        _fileLength = _writtenLength = sizeof(header);
+        [self _remap];
+
+    } else {
+        [self _scan];
+    }
+
+    return YES;
+}
+
+
+- (void) _compact
+{
+    NSString *temporaryPath = [_path stringByAppendingString:@"-new"];
+
+    NSMutableData *data = [NSMutableData data];
+
+    TrackStateFileHeader header = { sFileMagic, sFileVersion, 0 };
+    [data appendBytes:&header length:sizeof(header)];
+
+    for (TrackStateStoreEntry *entry in [_entries allValues]) {
+        UInt64 offsets[sBlobCount + 1];
+
+        for (NSInteger i = 0; i < sBlobCount; i++) {
+            offsets[i] = entry->_blobOffsets[i];
+        }
+
+        // The state record goes last, it commits the blobs
+        offsets[sBlobCount] = entry->_stateOffset;
+
+        for (NSInteger i = 0; i < (sBlobCount + 1); i++) {
+            UInt64 length = offsets[i] ? [self _recordLengthAtOffset:offsets[i]] : 0;
+            if (length) [data appendBytes:(_map + offsets[i]) length:length];
+        }
+    }
+
+    NSError *error = nil;
+    if (![data writeToFile:temporaryPath options:0 error:&error]) {
+        EmbraceLog(@"TrackStateStore", @"Compaction failed: %@", error);
+        return;
+    }
+
+    int fd = open([temporaryPath fileSystemRepresentation], O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+
+    [self _close];
+
+    if (rename([temporaryPath fileSystemRepresentation], [_path fileSystemRepresentation]) != 0) {
+        EmbraceLog(@"TrackStateStore", @"Rename failed: %d", errno);
+    }
+
+    [self _open];
+}
+
+
+// Called on _writeQueue
+- (void) _sync
+{
+    _syncScheduled = NO;
+
+    if (!_needsSync || _fd < 0) return;
+    _needsSync = NO;
+
+    if (fcntl(_fd, F_FULLFSYNC) == -1) {
+        fsync(_fd);
+    }
+}
+
+
+// Called on _writeQueue
+- (BOOL) _writeData:(NSData *)data atOffset:(UInt64)offset
+{
+    // Records after a failed write would leave a gap, which -_scan stops at
+    if (_writeFailed || _fd < 0) return NO;
+
+    ssize_t written = pwrite(_fd, [data bytes], [data length], offset);
+
+    if (written != (ssize_t)[data length]) {
+        int error = errno;
+
+        // Drop whatever part of the write made it to disk
+        ftruncate(_fd, offset);
+        _writeFailed = YES;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            EmbraceLog(@"TrackStateStore", @"Write failed: %d, changes after this won't be saved", error);
+        });
+
+        return NO;
+    }
+
+    _needsSync = YES;
+
+    if (!_syncScheduled) {
+        _syncScheduled = YES;
+
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, sSyncDelay * NSEC_PER_SEC), _writeQueue, ^{
+            [self _sync];
+        });
+    }
+
+    return YES;
+}
+
+
+- (void) _didWriteToOffset:(UInt64)endOffset queuedOffsets:(NSArray<NSNumber *> *)queuedOffsets generation:(NSUInteger)generation
+{
+    if (generation != _generation || endOffset <= _writtenLength) return;
+
+    _writtenLength = endOffset;
+    [_queuedPayloads removeObjectsForKeys:queuedOffsets];
+}
+
+
+// Queues data to be written at the end of the file. Its offsets are valid
+// immediately, with payloads read from queuedPayloads until written. If the
+// write fails, they stay there.
+//
+- (BOOL) _appendData:(NSData *)data queuedPayloads:(NSDictionary<NSNumber *, NSData *> *)queuedPayloads
+{
+    if (_fd < 0) return NO;
+
+    UInt64 offset    = _fileLength;
+    UInt64 endOffset = _fileLength + [data length];
+
+    _fileLength = endOffset;
+    [_queuedPayloads addEntriesFromDictionary:queuedPayloads];
+
+    NSArray *queuedOffsets = [queuedPayloads allKeys];
+    NSUInteger generation = _generation;
+
+    dispatch_async(_writeQueue, ^{
+        if (![self _writeData:data atOffset:offset]) return;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [self _didWriteToOffset:endOffset queuedOffsets:queuedOffsets generation:generation];
+        });
+    });
+
+    return YES;
+}
+
+
+#pragma mark - Public Methods
+
+- (NSDictionary *) stateForUUID:(NSUUID *)UUID
+{
+    TrackStateStoreEntry *entry = UUID ? [_entries objectForKey:UUID] : nil;
+    if (!entry) return nil;
+
+    NSData *payload = [self _payloadAtOffset:entry->_stateOffset];
+    if (!payload) return nil;
+
+    NSError *error = nil;
+    NSDictionary *state = [NSPropertyListSerialization propertyListWithData:payload options:NSPropertyListImmutable format:NULL error:&error];
+
+    return [state isKindOfClass:[NSDictionary class]] ? state : nil;
+}
+
+
+- (NSData *) blobForKey:(NSString *)key UUID:(NSUUID *)UUID
+{
+    NSUInteger blobIndex = [[[self class] blobKeys] indexOfObject:key];
+    if (blobIndex == NSNotFound) return nil;
+
+    TrackStateStoreEntry *entry = UUID ? [_entries objectForKey:UUID] : nil;
+    UInt64 offset = entry ? entry->_blobOffsets[blobIndex] : 0;
+
+    return offset ? [self _payloadAtOffset:offset] : nil;
+}
+
+
+- (BOOL) hasBlobForKey:(NSString *)key UUID:(NSUUID *)UUID
+{
+    NSUInteger blobIndex = [[[self class] blobKeys] indexOfObject:key];
+    if (blobIndex == NSNotFound) return NO;
+
+    TrackStateStoreEntry *entry = UUID ? [_entries objectForKey:UUID] : nil;
+    return entry && entry->_blobOffsets[blobIndex];
+}
+
+
+- (BOOL) setState:(NSDictionary *)state blobs:(NSDictionary<NSString *, NSData *> *)blobs forUUID:(NSUUID *)UUID
+{
+    if (!UUID || !state) return NO;
+
+    NSError *error = nil;
+    NSData *statePayload = [NSPropertyListSerialization dataWithPropertyList:state format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+
+    if (!statePayload) {
+        EmbraceLog(@"TrackStateStore", @"Could not serialize state for %@: %@", UUID, error);
+        return NO;
+    }
+
+    NSArray *blobKeys = [[self class] blobKeys];
+    NSMutableData *data = [NSMutableData data];
+    NSMutableDictionary *queuedPayloads = [NSMutableDictionary dictionary];
+
+    UInt64 blobOffsets[sBlobCount] = {0};
+
+    for (NSInteger i = 0; i < sBlobCount; i++) {
+        NSData *blob = [[blobs objectForKey:[blobKeys objectAtIndex:i]] copy];
+        if (!blob) continue;
+
+        blobOffsets[i] = _fileLength + [data length];
+        sAppendRecord(data, TrackStateRecordTypeBlob, i, UUID, blob);
+
+        [queuedPayloads setObject:blob forKey:@(blobOffsets[i])];
+    }
+
+    UInt64 stateOffset = _fileLength + [data length];
+    sAppendRecord(data, TrackStateRecordTypeState, 0, UUID, statePayload);
+
+    [queuedPayloads setObject:statePayload forKey:@(stateOffset)];
+
+    if (![self _appendData:data queuedPayloads:queuedPayloads]) return NO;
+
+    TrackStateStoreEntry *entry = [_entries objectForKey:UUID];
+
+    if (!entry) {
+        entry = [[TrackStateStoreEntry alloc] init];
+        [_entries setObject:entry forKey:UUID];
+    }
+
+    entry->_stateOffset = stateOffset;
+
+    for (NSInteger i = 0; i < sBlobCount; i++) {
+        if (blobOffsets[i]) entry->_blobOffsets[i] = blobOffsets[i];
+    }
+
+    return YES;
+}
+
+
+- (void) removeStateForUUID:(NSUUID *)UUID
+{
+    if (!UUID || ![_entries objectForKey:UUID]) return;
+
+    NSMutableData *data = [NSMutableData data];
+    sAppendRecord(data, TrackStateRecordTypeRemove, 0, UUID, nil);
+
+    if ([self _appendData:data queuedPayloads:@{ }]) {
+        [_entries removeObjectForKey:UUID];
+    }
+}
+
+
+- (void) removeAllStates
+{
+    // Let queued writes finish before the file goes away
+    dispatch_sync(_writeQueue, ^{
+        _needsSync = NO;
+        _writeFailed = NO;
+    });
+
+    [_queuedPayloads removeAllObjects];
+    _generation++;
+
+    [self _close];
+
+    NSError *error = nil;
+    [[NSFileManager defaultManager] removeItemAtPath:_path error:&error];
+
+    [self _open];
+}
+
+
+- (void) synchronize
+{
+    dispatch_sync(_writeQueue, ^{
+        [self _sync];
+    });
+}
+
+
+- (void) synchronizeWithCompletionHandler:(void (^)(BOOL didWrite))completionHandler
+{
+    dispatch_async(_writeQueue, ^{
+        [self _sync];
+
+        BOOL didWrite = !_writeFailed;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            completionHandler(didWrite);
+        });
+    });
+}
+
+
+@end
@@ -0,0 +1,38 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import <Foundation/Foundation.h>
+
+// Multi-resolution waveform, written by the worker at analysis time and
+// drawn by WaveformView.
+//
+// Level 0 holds the min, max, and RMS of each window of audio at
+// WaveformPyramidGetRate(). Each following level halves the resolution of
+// the one before it, until a level has WaveformPyramidMinimumLevelCount
+// entries or fewer. A view can then pick the level closest to its pixel
+// density and sample it in O(pixels).
+
+enum {
+    WaveformPyramidMinimumLevelCount = 64
+};
+
+typedef struct {
+    SInt8 min; // -127 to 127
+    SInt8 max; // -127 to 127
+    UInt8 rms; //    0 to 255
+} WaveformPyramidEntry;
+
+// mins, maxs, and meanSquares are linear, with count entries at rate
+extern NSData *WaveformPyramidCreateData(const float *mins, const float *maxs, const float *meanSquares, size_t count, double rate);
+
+extern BOOL WaveformPyramidIsValid(NSData *data);
+
+extern double WaveformPyramidGetRate(NSData *data);
+extern NSTimeInterval WaveformPyramidGetDuration(NSData *data);
+
+extern NSInteger WaveformPyramidGetLevelCount(NSData *data);
+extern const WaveformPyramidEntry *WaveformPyramidGetLevel(NSData *data, NSInteger level, size_t *outCount);
+
+// Fills outEntries with outCount entries spanning startTime to stopTime.
+// Reads at most a few entries per output entry. Returns NO if data is invalid.
+extern BOOL WaveformPyramidSample(NSData *data, NSTimeInterval startTime, NSTimeInterval stopTime, WaveformPyramidEntry *outEntries, size_t outCount);
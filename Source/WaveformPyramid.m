@@ -0,0 +1,232 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import "WaveformPyramid.h"
+
+static UInt32 const sMagic = 'WPY1';
+
+typedef struct {
+    UInt32 magic;
+    UInt32 levelCount;
+    UInt64 count;  // Entries in level 0
+    double rate;   // Entries per second in level 0
+} WaveformPyramidHeader;
+
+
+static const WaveformPyramidHeader *sGetHeader(NSData *data)
+{
+    if ([data length] < sizeof(WaveformPyramidHeader)) return NULL;
+
+    const WaveformPyramidHeader *header = [data bytes];
+    if (header->magic != sMagic || header->rate <= 0) return NULL;
+
+    return header;
+}
+
+
+static size_t sGetLevelCount(size_t count)
+{
+    size_t result = 1;
+
+    while (count > WaveformPyramidMinimumLevelCount) {
+        count = (count + 1) / 2;
+        result++;
+    }
+
+    return result;
+}
+
+
+static size_t sGetTotalCount(size_t count, size_t levelCount)
+{
+    size_t result = 0;
+
+    for (size_t level = 0; level < levelCount; level++) {
+        result += count;
+        count = (count + 1) / 2;
+    }
+
+    return result;
+}
+
+
+static SInt8 sQuantizeSigned(float value)
+{
+    long result = lrintf(value * 127.0f);
+    return (SInt8)MAX(-127, MIN(127, result));
+}
+
+
+static UInt8 sQuantizeRMS(float meanSquare)
+{
+    long result = lrintf(sqrtf(MAX(meanSquare, 0)) * 255.0f);
+    return (UInt8)MAX(0, MIN(255, result));
+}
+
+
+NSData *WaveformPyramidCreateData(const float *inMins, const float *inMaxs, const float *inMeanSquares, size_t count, double rate)
+{
+    size_t levelCount = sGetLevelCount(count);
+    size_t totalCount = sGetTotalCount(count, levelCount);
+
+    NSMutableData *data = [NSMutableData dataWithLength:sizeof(WaveformPyramidHeader) + (totalCount * sizeof(WaveformPyramidEntry))];
+
+    WaveformPyramidHeader *header = [data mutableBytes];
+    header->magic      = sMagic;
+    header->levelCount = (UInt32)levelCount;
+    header->count      = count;
+    header->rate       = rate;
+
+    WaveformPyramidEntry *entries = (WaveformPyramidEntry *)(header + 1);
+
+    // Reduce in floating point, quantize each level as it's written
+    float *mins        = malloc(MAX(count, 1) * sizeof(float));
+    float *maxs        = malloc(MAX(count, 1) * sizeof(float));
+    float *meanSquares = malloc(MAX(count, 1) * sizeof(float));
+
+    memcpy(mins,        inMins,        count * sizeof(float));
+    memcpy(maxs,        inMaxs,        count * sizeof(float));
+    memcpy(meanSquares, inMeanSquares, count * sizeof(float));
+
+    for (size_t level = 0; level < levelCount; level++) {
+        for (size_t i = 0; i < count; i++) {
+            entries[i].min = sQuantizeSigned(mins[i]);
+            entries[i].max = sQuantizeSigned(maxs[i]);
+            entries[i].rms = sQuantizeRMS(meanSquares[i]);
+        }
+
+        entries += count;
+
+        size_t nextCount = (count + 1) / 2;
+
+        for (size_t i = 0; i < nextCount; i++) {
+            size_t a = i * 2;
+            size_t b = MIN(a + 1, count - 1);
+
+            mins[i]        = MIN(mins[a], mins[b]);
+            maxs[i]        = MAX(maxs[a], maxs[b]);
+            meanSquares[i] = (meanSquares[a] + meanSquares[b]) * 0.5f;
+        }
+
+        count = nextCount;
+    }
+
+    free(mins);
+    free(maxs);
+    free(meanSquares);
+
+    return data;
+}
+
+
+BOOL WaveformPyramidIsValid(NSData *data)
+{
+    const WaveformPyramidHeader *header = sGetHeader(data);
+    if (!header) return NO;
+
+    size_t levelCount = sGetLevelCount(header->count);
+    size_t totalCount = sGetTotalCount(header->count, levelCount);
+
+    return header->levelCount == levelCount &&
+           [data length] >= sizeof(WaveformPyramidHeader) + (totalCount * sizeof(WaveformPyramidEntry));
+}
+
+
+double WaveformPyramidGetRate(NSData *data)
+{
+    const WaveformPyramidHeader *header = sGetHeader(data);
+    return header ? header->rate : 0;
+}
+
+
+NSTimeInterval WaveformPyramidGetDuration(NSData *data)
+{
+    const WaveformPyramidHeader *header = sGetHeader(data);
+    return header ? (header->count / header->rate) : 0;
+}
+
+
+NSInteger WaveformPyramidGetLevelCount(NSData *data)
+{
+    const WaveformPyramidHeader *header = sGetHeader(data);
+    return header ? header->levelCount : 0;
+}
+
+
+const WaveformPyramidEntry *WaveformPyramidGetLevel(NSData *data, NSInteger level, size_t *outCount)
+{
+    if (!WaveformPyramidIsValid(data)) return NULL;
+
+    const WaveformPyramidHeader *header = [data bytes];
+    if (level < 0 || level >= header->levelCount) return NULL;
+
+    const WaveformPyramidEntry *entries = (const WaveformPyramidEntry *)(header + 1);
+    size_t count = header->count;
+
+    for (NSInteger i = 0; i < level; i++) {
+        entries += count;
+        count = (count + 1) / 2;
+    }
+
+    if (outCount) *outCount = count;
+
+    return entries;
+}
+
+
+BOOL WaveformPyramidSample(NSData *data, NSTimeInterval startTime, NSTimeInterval stopTime, WaveformPyramidEntry *outEntries, size_t outCount)
+{
+    if (!WaveformPyramidIsValid(data) || outCount == 0) return NO;
+
+    const WaveformPyramidHeader *header = [data bytes];
+
+    if (stopTime <= startTime) {
+        memset(outEntries, 0, outCount * sizeof(WaveformPyramidEntry));
+        return YES;
+    }
+
+    // Pick the coarsest level with at least one entry per output entry
+    double entriesPerOutput = ((stopTime - startTime) * header->rate) / outCount;
+    NSInteger level = 0;
+
+    while ((level + 1) < header->levelCount && entriesPerOutput >= 2.0) {
+        entriesPerOutput /= 2.0;
+        level++;
+    }
+
+    size_t count = 0;
+    const WaveformPyramidEntry *entries = WaveformPyramidGetLevel(data, level, &count);
+
+    double rate  = header->rate / (1 << level);
+    double start = startTime * rate;
+    double step  = ((stopTime - startTime) * rate) / outCount;
+
+    for (size_t o = 0; o < outCount; o++) {
+        NSInteger from = (NSInteger)floor(start + (o * step));
+        NSInteger to   = (NSInteger)floor(start + ((o + 1) * step));
+
+        if (to <= from) to = from + 1;
+
+        from = MAX(from, 0);
+        to   = MIN(to, (NSInteger)count);
+
+        WaveformPyramidEntry result = { 0, 0, 0 };
+
+        if (from < to) {
+            result = entries[from];
+            UInt32 sumSquares = result.rms * result.rms;
+
+            for (NSInteger i = from + 1; i < to; i++) {
+                result.min = MIN(result.min, entries[i].min);
+                result.max = MAX(result.max, entries[i].max);
+                sumSquares += entries[i].rms * entries[i].rms;
+            }
+
+            result.rms = (UInt8)lrint(sqrt(sumSquares / (double)(to - from)));
+        }
+
+        outEntries[o] = result;
+    }
+
+    return YES;
+}
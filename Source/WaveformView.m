@@ -3,6 +3,7 @@
 
 #import "WaveformView.h"
 #import "Track.h"
+#import "WaveformPyramid.h"
 
 #import <Accelerate/Accelerate.h>
 
@@ -48,6 +49,7 @@
 - (void) dealloc
 {
     [_track removeObserver:self forKeyPath:@"overviewData"];
+    [_track removeObserver:self forKeyPath:@"waveformData"];
 }
 
 
@@ -73,7 +75,7 @@
 - (void) observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
 {
     if (object == _track) {
-        if ([keyPath isEqualToString:@"overviewData"]) {
+        if ([keyPath isEqualToString:@"overviewData"] || [keyPath isEqualToString:@"waveformData"]) {
             [_activeLayer   setNeedsDisplay];
             [_inactiveLayer setNeedsDisplay];
         }
@@ -187,8 +189,68 @@
 }
 
 
+- (void) _drawWaveformData:(NSData *)waveformData inContext:(CGContextRef)context color:(NSColor *)color
+{
+    CGSize size = [self bounds].size;
+    CGFloat scale = [[self window] backingScaleFactor];
+    if (!scale) scale = 1;
+
+    NSInteger count = size.width * scale;
+    if (count <= 0) return;
+
+    NSTimeInterval startTime = [_track startTime];
+    NSTimeInterval stopTime  = [_track stopTime];
+    if (!stopTime) stopTime = WaveformPyramidGetDuration(waveformData);
+
+    WaveformPyramidEntry *entries = malloc(count * sizeof(WaveformPyramidEntry));
+
+    if (!WaveformPyramidSample(waveformData, startTime, stopTime, entries, count)) {
+        free(entries);
+        return;
+    }
+
+    CGContextSetInterpolationQuality(context, kCGInterpolationLow);
+
+    CGAffineTransform transform = CGAffineTransformMakeScale(size.width / count, 1);
+    transform = CGAffineTransformTranslate(transform, 0, size.height / 2);
+    CGContextConcatCTM(context, transform);
+
+    CGFloat scalar = size.height / (2 * 127);
+    CGFloat minThickness = 1.0 / scale;
+
+    CGContextMoveToPoint(context, 0, MAX(entries[0].max * scalar, minThickness));
+
+    for (NSInteger i = 1; i < count; i++) {
+        CGContextAddLineToPoint(context, i, MAX(entries[i].max * scalar, minThickness));
+    }
+
+    for (NSInteger i = count - 1; i >= 0; i--) {
+        CGContextAddLineToPoint(context, i, MIN(entries[i].min * scalar, -minThickness));
+    }
+
+    free(entries);
+
+    CGContextClosePath(context);
+
+    PerformWithAppearance([self effectiveAppearance], ^{
+        CGContextSetFillColorWithColor(context, [color CGColor]);
+    });
+
+    CGContextFillPath(context);
+}
+
+
 - (void) drawLayer:(CALayer *)layer inContext:(CGContextRef)context
 {
+    NSData *waveformData = [_track waveformData];
+
+    if (WaveformPyramidIsValid(waveformData)) {
+        NSColor *color = (layer == _activeLayer) ? _activeWaveformColor : _inactiveWaveformColor;
+        [self _drawWaveformData:waveformData inContext:context color:color];
+        return;
+    }
+
+    // Tracks analyzed before waveformData existed
     if (![_track overviewData]) return;
 
     CGSize size = [self bounds].size;
@@ -267,8 +329,12 @@
 {
     if (_track != track) {
         [_track removeObserver:self forKeyPath:@"overviewData"];
+        [_track removeObserver:self forKeyPath:@"waveformData"];
+
         _track = track;
+
         [_track addObserver:self forKeyPath:@"overviewData" options:0 context:NULL];
+        [_track addObserver:self forKeyPath:@"waveformData" options:0 context:NULL];
 
         [self setPercentage:FLT_EPSILON];
 
@@ -0,0 +1,70 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSInteger, WorkerJobPriority) {
+    WorkerJobPriorityBackground = 0, // Loudness of queued tracks
+    WorkerJobPriorityUpcoming   = 1, // Decoded audio of the next track
+    WorkerJobPriorityMetadata   = 2, // Metadata, cheap and needed for display
+    WorkerJobPriorityImmediate  = 3  // Loudness of a track which is about to play
+};
+
+
+@interface WorkerJob : NSObject
+
+@property (nonatomic, readonly) NSString *identifier;
+@property (nonatomic, readonly) NSUUID *UUID;
+@property (readonly) WorkerJobPriority priority;
+@property (readonly, getter=isCancelled) BOOL cancelled;
+
+// Called periodically from the job's work loop. Blocks while the job is
+// preempted by higher priority jobs. Returns NO once the job is cancelled.
+- (BOOL) checkpoint;
+
+// Thread-safe. The progress handler is called each time the completed
+// fraction advances by at least 1%.
+@property (atomic) int64_t totalUnitCount;
+- (void) addCompletedUnitCount:(int64_t)unitCount;
+
+// Set by the job's block, passed to every completion handler
+@property (atomic, strong) id result;
+
+@end
+
+
+// Runs jobs in priority order, at most maximumConcurrency at a time.
+//
+// A job whose priority is higher than a running job's may start even when
+// all slots are taken. The lowest priority running jobs are then paused at
+// their next checkpoint until enough higher priority jobs finish.
+//
+@interface WorkerScheduler : NSObject
+
+- (instancetype) initWithMaximumConcurrency:(NSInteger)maximumConcurrency;
+
+// Jobs are identified by an identifier/UUID pair. If a matching job is
+// already pending or running, it is promoted to priority, completionHandler
+// is added to it, and NO is returned. Also returns NO if the UUID was
+// cancelled.
+//
+// completionHandler is called exactly once, on a background queue, after
+// the job finishes or is cancelled. A job which never ran is cancelled and
+// has no result.
+//
+- (BOOL) addJobWithIdentifier: (NSString *) identifier
+                         UUID: (NSUUID *) UUID
+                     priority: (WorkerJobPriority) priority
+              progressHandler: (void (^)(double progress)) progressHandler
+                        block: (void (^)(WorkerJob *job)) block
+            completionHandler: (void (^)(WorkerJob *job)) completionHandler;
+
+// Cancels all pending and running jobs for UUID, along with any added later
+- (void) cancelUUID:(NSUUID *)UUID;
+
+// Allows jobs for a cancelled UUID to be added again
+- (void) uncancelUUID:(NSUUID *)UUID;
+
+@property (nonatomic, readonly) NSInteger maximumConcurrency;
+
+@end
@@ -0,0 +1,353 @@
+// (c) 2024 Ricci Adams
+// MIT License (or) 1-clause BSD License
+
+#import "WorkerScheduler.h"
+
+#include <stdatomic.h>
+
+
+@interface WorkerJob ()
+@property (nonatomic) NSString *identifier;
+@property (nonatomic) NSUUID *UUID;
+@property WorkerJobPriority priority;
+@property (getter=isCancelled) BOOL cancelled;
+
+@property (nonatomic) NSInteger sequence;
+@property (nonatomic, copy) void (^progressHandler)(double);
+@property (nonatomic, copy) void (^block)(WorkerJob *);
+@property (nonatomic) NSMutableArray *completionHandlers;
+@property (nonatomic, weak) WorkerScheduler *scheduler;
+@end
+
+
+@interface WorkerScheduler ()
+- (BOOL) _waitForJob:(WorkerJob *)job;
+@end
+
+
+@implementation WorkerJob {
+    atomic_llong _completedUnitCount;
+    atomic_llong _reportedPercent;
+}
+
+
+- (BOOL) checkpoint
+{
+    return [_scheduler _waitForJob:self];
+}
+
+
+- (void) addCompletedUnitCount:(int64_t)unitCount
+{
+    int64_t totalUnitCount = [self totalUnitCount];
+    if (totalUnitCount <= 0) return;
+
+    int64_t completed = atomic_fetch_add(&_completedUnitCount, unitCount) + unitCount;
+    long long percent = MIN(completed, totalUnitCount) * 100 / totalUnitCount;
+    long long reported = atomic_load(&_reportedPercent);
+
+    while (percent > reported) {
+        if (atomic_compare_exchange_weak(&_reportedPercent, &reported, percent)) {
+            if (_progressHandler) _progressHandler(percent / 100.0);
+            break;
+        }
+    }
+}
+
+
+@end
+
+
+@implementation WorkerScheduler {
+    NSCondition    *_condition;
+    NSMutableArray *_pendingJobs; // Highest priority first, then in order added
+    NSMutableArray *_runningJobs;
+    NSMutableSet   *_cancelledUUIDs;
+    NSInteger       _nextSequence;
+}
+
+
+- (instancetype) initWithMaximumConcurrency:(NSInteger)maximumConcurrency
+{
+    if ((self = [super init])) {
+        _maximumConcurrency = MAX(maximumConcurrency, 1);
+
+        _condition      = [[NSCondition alloc] init];
+        _pendingJobs    = [NSMutableArray array];
+        _runningJobs    = [NSMutableArray array];
+        _cancelledUUIDs = [NSMutableSet set];
+    }
+
+    return self;
+}
+
+
+#pragma mark - Private Methods
+
+static void sCallCompletionHandlers(WorkerJob *job, NSArray *completionHandlers)
+{
+    for (void (^completionHandler)(WorkerJob *) in completionHandlers) {
+        completionHandler(job);
+    }
+}
+
+
+static void sCallCompletionHandlersAsync(WorkerJob *job, NSArray *completionHandlers)
+{
+    if (![completionHandlers count]) return;
+
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        sCallCompletionHandlers(job, completionHandlers);
+    });
+}
+
+
+static BOOL sJobPrecedesJob(WorkerJob *a, WorkerJob *b)
+{
+    if ([a priority] != [b priority]) {
+        return [a priority] > [b priority];
+    }
+
+    return [a sequence] < [b sequence];
+}
+
+
+// All methods below must be called with _condition locked
+
+// A cancelled job may still be running, but won't produce a result to share
+- (WorkerJob *) _jobWithIdentifier:(NSString *)identifier UUID:(NSUUID *)UUID
+{
+    for (NSArray *jobs in @[ _pendingJobs, _runningJobs ]) {
+        for (WorkerJob *job in jobs) {
+            if ([job isCancelled]) continue;
+
+            if ([[job UUID] isEqual:UUID] && [[job identifier] isEqualToString:identifier]) {
+                return job;
+            }
+        }
+    }
+
+    return nil;
+}
+
+
+- (void) _insertPendingJob:(WorkerJob *)job
+{
+    NSUInteger index = 0;
+
+    for (WorkerJob *pendingJob in _pendingJobs) {
+        if (sJobPrecedesJob(job, pendingJob)) break;
+        index++;
+    }
+
+    [_pendingJobs insertObject:job atIndex:index];
+}
+
+
+- (NSInteger) _countOfRunningJobsPrecedingJob:(WorkerJob *)job includeEqualPriority:(BOOL)includeEqualPriority
+{
+    NSInteger count = 0;
+
+    for (WorkerJob *runningJob in _runningJobs) {
+        if (runningJob == job) continue;
+
+        if (sJobPrecedesJob(runningJob, job) ||
+            (includeEqualPriority && [runningJob priority] == [job priority]))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+- (void) _runJob:(WorkerJob *)job
+{
+    WorkerJobPriority priority = [job priority];
+
+    dispatch_qos_class_t qos = QOS_CLASS_UTILITY;
+    if (priority == WorkerJobPriorityImmediate) qos = QOS_CLASS_USER_INITIATED;
+
+    dispatch_async(dispatch_get_global_queue(qos, 0), ^{
+        @autoreleasepool {
+            if (![job isCancelled]) [job block](job);
+        }
+
+        [self _finishJob:job];
+    });
+}
+
+
+- (void) _startJobsIfNeeded
+{
+    while ([_pendingJobs count]) {
+        WorkerJob *job = [_pendingJobs firstObject];
+
+        // Jobs of lower priority don't count, they will pause at their next checkpoint
+        if ([self _countOfRunningJobsPrecedingJob:job includeEqualPriority:YES] >= _maximumConcurrency) {
+            break;
+        }
+
+        [_pendingJobs removeObjectAtIndex:0];
+        [_runningJobs addObject:job];
+
+        [self _runJob:job];
+    }
+}
+
+
+- (void) _finishJob:(WorkerJob *)job
+{
+    [_condition lock];
+
+    NSArray *completionHandlers = [job completionHandlers];
+
+    [job setBlock:nil];
+    [job setCompletionHandlers:nil];
+    [_runningJobs removeObject:job];
+    [self _startJobsIfNeeded];
+    [_condition broadcast];
+
+    [_condition unlock];
+
+    sCallCompletionHandlers(job, completionHandlers);
+}
+
+
+- (BOOL) _waitForJob:(WorkerJob *)job
+{
+    [_condition lock];
+
+    while (![job isCancelled] && [self _countOfRunningJobsPrecedingJob:job includeEqualPriority:NO] >= _maximumConcurrency) {
+        [_condition wait];
+    }
+
+    BOOL result = ![job isCancelled];
+
+    [_condition unlock];
+
+    return result;
+}
+
+
+#pragma mark - Public Methods
+
+- (BOOL) addJobWithIdentifier: (NSString *) identifier
+                         UUID: (NSUUID *) UUID
+                     priority: (WorkerJobPriority) priority
+              progressHandler: (void (^)(double progress)) progressHandler
+                        block: (void (^)(WorkerJob *job)) block
+            completionHandler: (void (^)(WorkerJob *job)) completionHandler
+{
+    BOOL result = NO;
+    WorkerJob *rejectedJob = nil;
+
+    [_condition lock];
+
+    WorkerJob *existingJob = [self _jobWithIdentifier:identifier UUID:UUID];
+
+    if ([_cancelledUUIDs containsObject:UUID]) {
+        rejectedJob = [[WorkerJob alloc] init];
+
+        [rejectedJob setIdentifier:identifier];
+        [rejectedJob setUUID:UUID];
+        [rejectedJob setPriority:priority];
+        [rejectedJob setCancelled:YES];
+
+    } else if (existingJob) {
+        if (completionHandler) {
+            [[existingJob completionHandlers] addObject:[completionHandler copy]];
+        }
+
+        if (priority > [existingJob priority]) {
+            [existingJob setPriority:priority];
+
+            if ([_pendingJobs containsObject:existingJob]) {
+                [_pendingJobs removeObject:existingJob];
+                [self _insertPendingJob:existingJob];
+            }
+
+            [self _startJobsIfNeeded];
+            [_condition broadcast];
+        }
+
+    } else {
+        WorkerJob *job = [[WorkerJob alloc] init];
+
+        [job setIdentifier:identifier];
+        [job setUUID:UUID];
+        [job setPriority:priority];
+        [job setSequence:_nextSequence++];
+        [job setProgressHandler:progressHandler];
+        [job setBlock:block];
+        [job setCompletionHandlers:[NSMutableArray array]];
+        [job setScheduler:self];
+
+        if (completionHandler) {
+            [[job completionHandlers] addObject:[completionHandler copy]];
+        }
+
+        [self _insertPendingJob:job];
+        [self _startJobsIfNeeded];
+
+        result = YES;
+    }
+
+    [_condition unlock];
+
+    if (rejectedJob && completionHandler) {
+        sCallCompletionHandlersAsync(rejectedJob, @[ completionHandler ]);
+    }
+
+    return result;
+}
+
+
+- (void) cancelUUID:(NSUUID *)UUID
+{
+    [_condition lock];
+
+    [_cancelledUUIDs addObject:UUID];
+
+    NSMutableArray *removedJobs = [NSMutableArray array];
+    NSMutableArray *removedCompletionHandlers = [NSMutableArray array];
+
+    for (WorkerJob *job in [_pendingJobs copy]) {
+        if ([[job UUID] isEqual:UUID]) {
+            [job setCancelled:YES];
+            [_pendingJobs removeObject:job];
+
+            [removedJobs addObject:job];
+            [removedCompletionHandlers addObject:[job completionHandlers]];
+
+            [job setBlock:nil];
+            [job setCompletionHandlers:nil];
+        }
+    }
+
+    for (WorkerJob *job in _runningJobs) {
+        if ([[job UUID] isEqual:UUID]) {
+            [job setCancelled:YES];
+        }
+    }
+
+    [_condition broadcast];
+    [_condition unlock];
+
+    // Running jobs call their completion handlers when they return
+    [removedJobs enumerateObjectsUsingBlock:^(WorkerJob *job, NSUInteger i, BOOL *stop) {
+        sCallCompletionHandlersAsync(job, [removedCompletionHandlers objectAtIndex:i]);
+    }];
+}
+
+
+- (void) uncancelUUID:(NSUUID *)UUID
+{
+    [_condition lock];
+    [_cancelledUUIDs removeObject:UUID];
+    [_condition unlock];
+}
+
+
+@end
@@ -6,7 +6,8 @@
 typedef NS_ENUM(NSInteger, WorkerTrackCommand) {
     WorkerTrackCommandReadMetadata,         // Reads the file metadating using AVAsset
     WorkerTrackCommandReadLoudness,         // Reads loudness via LoudnessAnalyzer
-    WorkerTrackCommandReadLoudnessImmediate // Reads loudness via LoudnessAnalyzer immediately
+    WorkerTrackCommandReadLoudnessImmediate, // Reads loudness via LoudnessAnalyzer immediately
+    WorkerTrackCommandWriteDecodedAudio      // Writes a DecodedAudioCache entry if needed, for an upcoming track
 };
 
 
@@ -14,6 +15,9 @@ typedef NS_ENUM(NSInteger, WorkerTrackCommand) {
 
 - (void) cancelUUID:(NSUUID *)uuid;
 
+// Sets -[DecodedAudioCache sampleRate] in the worker
+- (void) setDecodedAudioSampleRate:(double)sampleRate;
+
 - (void) performTrackCommand: (WorkerTrackCommand) command
                         UUID: (NSUUID *) uuid
                 bookmarkData: (NSData *) bookmarkData
@@ -23,3 +27,12 @@ typedef NS_ENUM(NSInteger, WorkerTrackCommand) {
 - (void) performLibraryParseWithReply: (void (^)(NSDictionary *))reply;
 
 @end
+
+
+// Exported by the app on its connection to the worker
+@protocol WorkerClientProtocol
+
+// Progress of a loudness analysis, from 0.0 to 1.0
+- (void) reportAnalysisProgress:(double)progress forUUID:(NSUUID *)uuid;
+
+@end
@@ -3,21 +3,24 @@
 
 #import "WorkerService.h"
 
+#import "AnalysisCache.h"
+#import "DecodedAudioCache.h"
+#import "HugError.h"
 #import "HugAudioFile.h"
+#import "HugPCMFile.h"
+#import "HugResampler.h"
 #import "HugUtils.h"
 #import "TrackKeys.h"
 #import "LoudnessMeasurer.h"
 #import "MetadataParser.h"
+#import "WorkerScheduler.h"
 
 #import <iTunesLibrary/iTunesLibrary.h>
 
-static dispatch_queue_t sMetadataQueue           = nil;
-static dispatch_queue_t sLibraryQueue            = nil;
-static dispatch_queue_t sLoudnessImmediateQueue  = nil;
-static dispatch_queue_t sLoudnessBackgroundQueue = nil;
+static dispatch_queue_t sLibraryQueue = nil;
+static WorkerScheduler *sScheduler    = nil;
 
-static NSMutableSet *sCancelledUUIDs = nil;
-static NSMutableSet *sLoudnessUUIDs  = nil;
+static NSMutableSet *sLoudnessUUIDs = nil;
 
 
 @interface Worker : NSObject <WorkerProtocol>
@@ -34,13 +37,10 @@ static NSMutableSet *sLoudnessUUIDs  = nil;
     static dispatch_once_t onceToken;
 
     dispatch_once(&onceToken, ^{
-        sMetadataQueue           = dispatch_queue_create("metadata",            DISPATCH_QUEUE_SERIAL);
-        sLibraryQueue            = dispatch_queue_create("library",             DISPATCH_QUEUE_SERIAL);
-        sLoudnessImmediateQueue  = dispatch_queue_create("loudness-immediate",  DISPATCH_QUEUE_SERIAL);
-        sLoudnessBackgroundQueue = dispatch_queue_create("loudness-background", DISPATCH_QUEUE_SERIAL);
+        sLibraryQueue = dispatch_queue_create("library", DISPATCH_QUEUE_SERIAL);
+        sScheduler    = [[WorkerScheduler alloc] initWithMaximumConcurrency:[[NSProcessInfo processInfo] activeProcessorCount]];
 
-        sCancelledUUIDs = [NSMutableSet set];
-        sLoudnessUUIDs  = [NSMutableSet set];
+        sLoudnessUUIDs = [NSMutableSet set];
     });
 }
 
@@ -55,7 +55,135 @@ static NSDictionary *sReadMetadata(NSURL *internalURL, NSString *originalFilenam
 }
 
 
-static NSDictionary *sReadLoudness(NSURL *internalURL)
+static const UInt32 sScanBufferFrames = 4096 * 16;
+
+// Segments shorter than this aren't worth their warm-up and extra decoder
+static const NSTimeInterval sMinimumSegmentDuration = 30.0;
+
+
+static BOOL sScanAudioFile(HugAudioFile *audioFile, LoudnessMeasurer *measurer, AudioBufferList *bufferList, NSInteger frameCount, WorkerJob *job)
+{
+    UInt32 bytesPerFrame = [audioFile format].mBytesPerFrame;
+
+    while (frameCount > 0) {
+        if (![job checkpoint]) return NO;
+
+        UInt32 framesToRead = (UInt32)MIN(frameCount, (NSInteger)sScanBufferFrames);
+
+        for (NSInteger i = 0; i < bufferList->mNumberBuffers; i++) {
+            bufferList->mBuffers[i].mDataByteSize = sScanBufferFrames * bytesPerFrame;
+        }
+
+        if (![audioFile readFrames:&framesToRead intoBufferList:bufferList]) {
+            return NO;
+        }
+
+        if (!framesToRead) break;
+
+        LoudnessMeasurerScanAudioBuffer(measurer, bufferList, framesToRead);
+        frameCount -= framesToRead;
+
+        [job addCompletedUnitCount:framesToRead];
+    }
+
+    return YES;
+}
+
+
+static NSInteger sGetSegmentCount(AudioStreamBasicDescription format, NSInteger fileLengthFrames)
+{
+    NSTimeInterval duration = fileLengthFrames / format.mSampleRate;
+
+    NSInteger maxCount = [[NSProcessInfo processInfo] activeProcessorCount];
+    NSInteger count    = MIN(maxCount, (NSInteger)(duration / sMinimumSegmentDuration));
+
+    return MAX(count, 1);
+}
+
+
+/*
+    Splits the file into segments which are decoded and measured on separate
+    cores. Each segment has its own HugAudioFile and starts decoding early
+    so that the K-weighting filters are warmed up at its boundary.
+    The first segment is measured by the returned measurer, the others are
+    appended to it in order.
+*/
+static LoudnessMeasurer *sMeasureSegments(HugAudioFile *audioFile, NSInteger segmentCount, WorkerJob *job)
+{
+    AudioStreamBasicDescription format = [audioFile format];
+    NSInteger fileLengthFrames = [audioFile fileLengthFrames];
+    NSURL *fileURL = [audioFile fileURL];
+
+    NSInteger alignment    = LoudnessMeasurerGetSegmentAlignment(format.mSampleRate);
+    NSInteger warmUpFrames = LoudnessMeasurerGetSegmentWarmUpFrames(format.mSampleRate);
+
+    NSInteger segmentFrames = fileLengthFrames / segmentCount;
+    segmentFrames -= segmentFrames % alignment;
+
+    if (segmentFrames < warmUpFrames) return NULL;
+
+    [job setTotalUnitCount:fileLengthFrames + (warmUpFrames * (segmentCount - 1))];
+
+    LoudnessMeasurer **measurers = calloc(segmentCount, sizeof(LoudnessMeasurer *));
+    BOOL *results = calloc(segmentCount, sizeof(BOOL));
+
+    dispatch_apply(segmentCount, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t s) { @autoreleasepool {
+        NSInteger startFrame = segmentFrames * s;
+        NSInteger endFrame   = (s == segmentCount - 1) ? fileLengthFrames : (startFrame + segmentFrames);
+
+        HugAudioFile *segmentFile = (s == 0) ? audioFile : [[HugAudioFile alloc] initWithFileURL:fileURL];
+        AudioBufferList *bufferList = HugAudioBufferListCreate(format.mChannelsPerFrame, sScanBufferFrames, YES);
+
+        LoudnessMeasurer *measurer;
+        NSInteger readFrame;
+
+        if (s == 0) {
+            measurer  = LoudnessMeasurerCreate(format.mChannelsPerFrame, format.mSampleRate, fileLengthFrames);
+            readFrame = 0;
+        } else {
+            measurer  = LoudnessMeasurerCreateSegment(format.mChannelsPerFrame, format.mSampleRate, endFrame - startFrame);
+            readFrame = startFrame - warmUpFrames;
+        }
+
+        BOOL ok = [segmentFile open] &&
+            [segmentFile fileLengthFrames] == fileLengthFrames &&
+            [segmentFile format].mChannelsPerFrame == format.mChannelsPerFrame &&
+            [segmentFile seekToFrame:readFrame];
+
+        if (ok) {
+            ok = sScanAudioFile(segmentFile, measurer, bufferList, endFrame - readFrame, job);
+        }
+
+        HugAudioBufferListFree(bufferList, YES);
+
+        measurers[s] = measurer;
+        results[s] = ok;
+    } });
+
+    LoudnessMeasurer *result = [job isCancelled] ? NULL : measurers[0];
+
+    for (NSInteger s = 0; s < segmentCount; s++) {
+        if (!results[s] && ![job isCancelled]) {
+            HugLog(@"Worker", @"Segmented loudness scan of %@ failed, segment %ld", fileURL, (long)s);
+            result = NULL;
+        }
+    }
+
+    for (NSInteger s = 1; s < segmentCount; s++) {
+        if (result) LoudnessMeasurerAppendSegment(result, measurers[s]);
+        LoudnessMeasurerFree(measurers[s]);
+    }
+
+    if (!result) LoudnessMeasurerFree(measurers[0]);
+
+    free(measurers);
+    free(results);
+
+    return result;
+}
+
+
+static NSDictionary *sReadLoudness(NSURL *internalURL, BOOL allowsSegments, WorkerJob *job)
 {
     NSMutableDictionary *result = [NSMutableDictionary dictionary];
 
@@ -65,32 +193,49 @@ static NSDictionary *sReadLoudness(NSURL *internalURL)
         NSInteger fileLengthFrames = [audioFile fileLengthFrames];
         AudioStreamBasicDescription format = [audioFile format];
 
-        NSInteger framesRemaining = fileLengthFrames;
-        NSInteger bytesRemaining  = framesRemaining * format.mBytesPerFrame;
-        NSInteger bytesRead = 0;
+        LoudnessMeasurer *measurer = NULL;
+        
+        NSInteger segmentCount = allowsSegments ? sGetSegmentCount(format, fileLengthFrames) : 1;
+
+        if (segmentCount > 1) {
+            measurer = sMeasureSegments(audioFile, segmentCount, job);
+
+            if ([job isCancelled]) return nil;
 
-        LoudnessMeasurer *measurer = LoudnessMeasurerCreate(format.mChannelsPerFrame, format.mSampleRate, framesRemaining);
+            // Start over with a serial scan
+            if (!measurer) {
+                audioFile = [[HugAudioFile alloc] initWithFileURL:internalURL];
+                [audioFile open];
+            }
+        }
 
-        AudioBufferList *fillBufferList = HugAudioBufferListCreate(format.mChannelsPerFrame, 4096 * 16, YES);
+        if (!measurer) {
+            measurer = LoudnessMeasurerCreate(format.mChannelsPerFrame, format.mSampleRate, fileLengthFrames);
 
-        BOOL ok = YES;
-        while (ok) {
-            UInt32 frameCount = (UInt32)framesRemaining;
-            ok = [audioFile readFrames:&frameCount intoBufferList:fillBufferList];
+            [job setTotalUnitCount:fileLengthFrames];
 
-            if (frameCount) {
-                LoudnessMeasurerScanAudioBuffer(measurer, fillBufferList, frameCount);
-            } else {
-                break;
+            AudioBufferList *fillBufferList = HugAudioBufferListCreate(format.mChannelsPerFrame, sScanBufferFrames, YES);
+            BOOL ok = sScanAudioFile(audioFile, measurer, fillBufferList, fileLengthFrames, job);
+            HugAudioBufferListFree(fillBufferList, YES);
+
+            if ([job isCancelled]) {
+                LoudnessMeasurerFree(measurer);
+                return nil;
             }
-            
-            framesRemaining -= frameCount;
-        
-            bytesRead      += frameCount * format.mBytesPerFrame;
-            bytesRemaining -= frameCount * format.mBytesPerFrame;
 
-            if (framesRemaining == 0) {
-                break;
+            // A partial scan must not be reported, or cached, as the file's analysis
+            if (!ok) {
+                LoudnessMeasurerFree(measurer);
+
+                HugLog(@"Worker", @"Loudness scan of %@ failed", internalURL);
+
+                NSError *error = [audioFile error];
+                if (!error) error = [NSError errorWithDomain:HugErrorDomain code:HugErrorReadFailed userInfo:nil];
+
+                NSData *errorData = [NSKeyedArchiver archivedDataWithRootObject:error requiringSecureCoding:NO error:nil];
+                if (errorData) [result setObject:errorData forKey:TrackKeyError];
+
+                return result;
             }
         }
        
@@ -99,10 +244,22 @@ static NSDictionary *sReadLoudness(NSURL *internalURL)
         [result setObject:@(decodedDuration)                       forKey:TrackKeyDecodedDuration];
         [result setObject:LoudnessMeasurerGetOverview(measurer)    forKey:TrackKeyOverviewData];
         [result setObject:@(100)                                   forKey:TrackKeyOverviewRate];
+        [result setObject:LoudnessMeasurerGetWaveform(measurer)    forKey:TrackKeyWaveformData];
         [result setObject:@(LoudnessMeasurerGetLoudness(measurer)) forKey:TrackKeyTrackLoudness];
         [result setObject:@(LoudnessMeasurerGetPeak(measurer))     forKey:TrackKeyTrackPeak];
+        [result setObject:@(LoudnessMeasurerGetTruePeak(measurer)) forKey:TrackKeyTrackTruePeak];
+
+        [result setObject:@(LoudnessMeasurerGetLoudnessRange(measurer))   forKey:TrackKeyLoudnessRange];
+        [result setObject:LoudnessMeasurerGetShortTermLoudness(measurer)  forKey:TrackKeyShortTermLoudnessData];
+        [result setObject:@(10)                                           forKey:TrackKeyShortTermLoudnessRate];
+
+        size_t firstAudibleFrame, lastAudibleFrame;
+
+        if (LoudnessMeasurerGetAudibleFrames(measurer, &firstAudibleFrame, &lastAudibleFrame)) {
+            [result setObject:@(firstAudibleFrame       / format.mSampleRate) forKey:TrackKeyAudibleStartTime];
+            [result setObject:@((lastAudibleFrame + 1)  / format.mSampleRate) forKey:TrackKeyAudibleStopTime];
+        }
 
-        HugAudioBufferListFree(fillBufferList, YES);
         LoudnessMeasurerFree(measurer);
 
     } else {
@@ -116,9 +273,140 @@ static NSDictionary *sReadLoudness(NSURL *internalURL)
 }
 
 
+/*
+    Decodes the entire file into a HugPCMFile at sampleRate. This uses the
+    same resampler as HugAudioSource, so playback from the cache matches
+    playback from the original file.
+*/
+static BOOL sWriteDecodedAudio(NSURL *internalURL, NSURL *outputURL, double sampleRate, WorkerJob *job)
+{
+    HugAudioFile *audioFile = [[HugAudioFile alloc] initWithFileURL:internalURL];
+    if (![audioFile open]) return NO;
+
+    AudioStreamBasicDescription format = [audioFile format];
+    NSInteger fileLengthFrames = [audioFile fileLengthFrames];
+    UInt32 channelCount = format.mChannelsPerFrame;
+
+    HugResampler *resampler = NULL;
+    NSInteger outputFrames = fileLengthFrames;
+
+    if (format.mSampleRate != sampleRate) {
+        resampler = HugResamplerCreate(format.mSampleRate, sampleRate, channelCount, HugResamplerQualityHigh, sScanBufferFrames);
+        if (!resampler) return NO;
+
+        outputFrames = HugResamplerGetOutputLength(resampler, fileLengthFrames);
+    }
+
+    [job setTotalUnitCount:outputFrames];
+
+    AudioBufferList *bufferList = HugAudioBufferListCreate(channelCount, sScanBufferFrames, YES);
+
+    BOOL ok = [HugPCMFile writeToURL:outputURL sampleRate:sampleRate channelCount:channelCount frameCount:outputFrames sourceFrameCount:fileLengthFrames usingBlock:^(float * const *channels) {
+        const float *inputs[channelCount];
+        float *outputs[channelCount];
+
+        NSInteger framesRemaining = fileLengthFrames;
+        NSInteger written = 0;
+
+        while (written < outputFrames) {
+            if (![job checkpoint]) return NO;
+
+            UInt32 framesToRead = (UInt32)MIN(framesRemaining, (NSInteger)sScanBufferFrames);
+
+            for (NSInteger i = 0; i < channelCount; i++) {
+                bufferList->mBuffers[i].mDataByteSize = sScanBufferFrames * sizeof(float);
+            }
+
+            if (framesToRead && ![audioFile readFrames:&framesToRead intoBufferList:bufferList]) {
+                return NO;
+            }
+
+            framesRemaining = framesToRead ? (framesRemaining - framesToRead) : 0;
+
+            if (!resampler) {
+                if (!framesToRead) break;
+
+                framesToRead = (UInt32)MIN(framesToRead, outputFrames - written);
+
+                for (NSInteger i = 0; i < channelCount; i++) {
+                    memcpy(channels[i] + written, bufferList->mBuffers[i].mData, framesToRead * sizeof(float));
+                }
+
+                written += framesToRead;
+                [job addCompletedUnitCount:framesToRead];
+
+                continue;
+            }
+
+            // Past the end of the file, flush the filter with silence
+            UInt32 inputFrames = framesToRead ? framesToRead : sScanBufferFrames;
+
+            for (NSInteger i = 0; i < channelCount; i++) {
+                float *input = bufferList->mBuffers[i].mData;
+                memset(input + framesToRead, 0, (inputFrames - framesToRead) * sizeof(float));
+
+                inputs[i]  = input;
+                outputs[i] = channels[i] + written;
+            }
+
+            size_t inputUsed = inputFrames;
+            size_t processed = HugResamplerProcess(resampler, inputs, &inputUsed, outputs, outputFrames - written);
+
+            if (inputUsed != inputFrames) {
+                HugLog(@"Worker", @"Resampler dropped %ld input frames of %@", (long)(inputFrames - inputUsed), internalURL);
+                return NO;
+            }
+
+            written += processed;
+            [job addCompletedUnitCount:processed];
+        }
+
+        // Copying stops early if the file was shorter than fileLengthFrames
+        return (BOOL)(written == outputFrames);
+    }];
+
+    HugAudioBufferListFree(bufferList, YES);
+    HugResamplerFree(resampler);
+
+    return ok;
+}
+
+
+static void sAddDecodedAudioJob(NSURL *internalURL, NSString *cacheKey, NSUUID *UUID, void (^completion)(void))
+{
+    DecodedAudioCache *decodedCache = [DecodedAudioCache sharedInstance];
+    double sampleRate = [decodedCache sampleRate];
+
+    if (!cacheKey || !sampleRate || [decodedCache fileURLForKey:cacheKey sampleRate:sampleRate]) {
+        if (completion) completion();
+        return;
+    }
+
+    // Ahead of queued analysis, as the app only asks for tracks which play soon
+    [sScheduler addJobWithIdentifier:@"decode" UUID:UUID priority:WorkerJobPriorityUpcoming progressHandler:nil block:^(WorkerJob *job) {
+        BOOL ok = [decodedCache storeFileForKey:cacheKey sampleRate:sampleRate usingBlock:^(NSURL *outputURL) {
+            return sWriteDecodedAudio(internalURL, outputURL, sampleRate, job);
+        }];
+
+        if (!ok && ![job isCancelled]) {
+            HugLog(@"Worker", @"Could not write decoded audio for %@", internalURL);
+        }
+
+    } completionHandler:^(WorkerJob *job) {
+        if (completion) completion();
+    }];
+}
+
+
 - (void) cancelUUID:(NSUUID *)UUID
 {
-    [sCancelledUUIDs addObject:UUID];
+    [sScheduler cancelUUID:UUID];
+}
+
+
+- (void) setDecodedAudioSampleRate:(double)sampleRate
+{
+    [[DecodedAudioCache sharedInstance] setSampleRate:sampleRate];
 }
 
 
@@ -137,28 +425,82 @@ static NSDictionary *sReadLoudness(NSURL *internalURL)
 
     if (error) NSLog(@"%@", error);
 
+    // The app only sends commands for tracks it still has, so an earlier
+    // cancel no longer applies. Jobs the worker adds itself don't do this.
+    [sScheduler uncancelUUID:UUID];
+
+    // Every path below replies exactly once, with an empty dictionary if
+    // the job didn't run, so that the app can clean up its handlers
     if (command == WorkerTrackCommandReadMetadata) {
-        dispatch_async(sMetadataQueue, ^{ @autoreleasepool {
-            if (![sCancelledUUIDs containsObject:UUID]) {
-                reply(sReadMetadata(internalURL, originalFilename));
-            }
-        } });
+        [sScheduler addJobWithIdentifier:@"metadata" UUID:UUID priority:WorkerJobPriorityMetadata progressHandler:nil block:^(WorkerJob *job) {
+            [job setResult:sReadMetadata(internalURL, originalFilename)];
+
+        } completionHandler:^(WorkerJob *job) {
+            NSDictionary *dictionary = [job result];
+            reply(dictionary ? dictionary : @{ });
+        }];
 
     } else if (command == WorkerTrackCommandReadLoudness || command == WorkerTrackCommandReadLoudnessImmediate) {
-        BOOL             isImmediate = (command == WorkerTrackCommandReadLoudnessImmediate);
-        dispatch_queue_t queue       = isImmediate ? sLoudnessImmediateQueue : sLoudnessBackgroundQueue;
+        BOOL              isImmediate = (command == WorkerTrackCommandReadLoudnessImmediate);
+        WorkerJobPriority priority    = isImmediate ? WorkerJobPriorityImmediate : WorkerJobPriorityBackground;
 
-        dispatch_async(queue, ^{ @autoreleasepool {
-            if (![sCancelledUUIDs containsObject:UUID] && ![sLoudnessUUIDs containsObject:UUID]) {
-                [sLoudnessUUIDs addObject:UUID];
+        BOOL didReadLoudness;
 
-                NSDictionary *dictionary = sReadLoudness(internalURL);
+        @synchronized (sLoudnessUUIDs) {
+            didReadLoudness = [sLoudnessUUIDs containsObject:UUID];
+        }
 
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    reply(dictionary);
-                });
+        // The app already received the results of this UUID
+        if (didReadLoudness) {
+            reply(@{ });
+            return;
+        }
+
+        id<WorkerClientProtocol> client = [[NSXPCConnection currentConnection] remoteObjectProxy];
+
+        [sScheduler addJobWithIdentifier:@"loudness" UUID:UUID priority:priority progressHandler:^(double progress) {
+            [client reportAnalysisProgress:progress forUUID:UUID];
+
+        } block:^(WorkerJob *job) {
+            // The job may have been promoted while pending
+            BOOL allowsSegments = ([job priority] == WorkerJobPriorityImmediate);
+
+            AnalysisCache *cache = [AnalysisCache sharedInstance];
+            NSString *cacheKey = [cache keyForFileURL:internalURL];
+
+            NSDictionary *dictionary = [cache resultsForKey:cacheKey];
+
+            if (!dictionary) {
+                dictionary = sReadLoudness(internalURL, allowsSegments, job);
+                if (!dictionary) return;
+
+                if (![dictionary objectForKey:TrackKeyError]) {
+                    [cache storeResults:dictionary forKey:cacheKey];
+                }
+            }
+
+            @synchronized (sLoudnessUUIDs) {
+                [sLoudnessUUIDs addObject:UUID];
             }
-        } });
+
+            [job setResult:dictionary];
+
+        } completionHandler:^(WorkerJob *job) {
+            NSDictionary *dictionary = [job result];
+
+            dispatch_async(dispatch_get_main_queue(), ^{
+                reply(dictionary ? dictionary : @{ });
+            });
+        }];
+
+    } else if (command == WorkerTrackCommandWriteDecodedAudio) {
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            NSString *cacheKey = [[AnalysisCache sharedInstance] keyForFileURL:internalURL];
+
+            sAddDecodedAudioJob(internalURL, cacheKey, UUID, ^{
+                reply(@{ });
+            });
+        });
     }
 }
 
@@ -212,6 +554,9 @@ static NSDictionary *sReadLoudness(NSURL *internalURL)
 {
     NSXPCInterface *exportedInterface = [NSXPCInterface interfaceWithProtocol:@protocol(WorkerProtocol)];
     [connection setExportedInterface:exportedInterface];
+
+    NSXPCInterface *remoteInterface = [NSXPCInterface interfaceWithProtocol:@protocol(WorkerClientProtocol)];
+    [connection setRemoteObjectInterface:remoteInterface];
     
     Worker *exportedObject = [[Worker alloc] init];
     [connection setExportedObject:exportedObject];